@@ -0,0 +1,34 @@
+# Setup the memory allocator and the allocation accounting of a target
+#
+# CHESS_ALLOCATOR           system (default), jemalloc or mimalloc
+# CHESS_MEMORY_ACCOUNTING   charge allocations to subsystems (sessions, rooms, uploads...)
+
+set(CHESS_ALLOCATOR "system" CACHE STRING "Memory allocator: system, jemalloc or mimalloc")
+set_property(CACHE CHESS_ALLOCATOR PROPERTY STRINGS system jemalloc mimalloc)
+
+option(CHESS_MEMORY_ACCOUNTING "Account heap allocations per subsystem in get_stats" OFF)
+
+function(setup_allocator target)
+    if(CHESS_ALLOCATOR STREQUAL "jemalloc")
+        find_library(JEMALLOC_LIBRARY NAMES jemalloc REQUIRED)
+        find_path(JEMALLOC_INCLUDE_DIR NAMES jemalloc/jemalloc.h REQUIRED)
+
+        target_include_directories(${target} PRIVATE ${JEMALLOC_INCLUDE_DIR})
+        target_link_libraries(${target} PRIVATE ${JEMALLOC_LIBRARY})
+        target_compile_definitions(${target} PRIVATE CHESS_ALLOCATOR_JEMALLOC)
+    elseif(CHESS_ALLOCATOR STREQUAL "mimalloc")
+        find_package(mimalloc CONFIG REQUIRED)
+
+        # The shared library overrides malloc/free process-wide when linked
+        target_link_libraries(${target} PRIVATE mimalloc)
+        target_compile_definitions(${target} PRIVATE CHESS_ALLOCATOR_MIMALLOC)
+    elseif(NOT CHESS_ALLOCATOR STREQUAL "system")
+        message(FATAL_ERROR "Unknown CHESS_ALLOCATOR: ${CHESS_ALLOCATOR}")
+    endif()
+
+    if(CHESS_MEMORY_ACCOUNTING)
+        target_compile_definitions(${target} PRIVATE CHESS_MEMORY_ACCOUNTING)
+    endif()
+
+    message(STATUS "${target}: allocator ${CHESS_ALLOCATOR}, memory accounting ${CHESS_MEMORY_ACCOUNTING}")
+endfunction()
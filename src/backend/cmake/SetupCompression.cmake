@@ -0,0 +1,41 @@
+# Setup the zstd compression offered to clients
+#
+# CHESS_COMPRESSION   link zstd when found (default ON); without it, compression is never offered
+
+option(CHESS_COMPRESSION "Offer zstd compression of large messages to clients" ON)
+
+if(CHESS_COMPRESSION AND NOT TARGET chess_zstd)
+    # vcpkg ships a CMake package, distributions often only a pkg-config file
+    find_package(zstd CONFIG QUIET)
+
+    if(TARGET zstd::libzstd_shared)
+        set(CHESS_ZSTD_TARGET zstd::libzstd_shared)
+    elseif(TARGET zstd::libzstd_static)
+        set(CHESS_ZSTD_TARGET zstd::libzstd_static)
+    else()
+        find_package(PkgConfig QUIET)
+        if(PKG_CONFIG_FOUND)
+            pkg_check_modules(ZSTD QUIET IMPORTED_TARGET libzstd)
+            if(ZSTD_FOUND)
+                set(CHESS_ZSTD_TARGET PkgConfig::ZSTD)
+            endif()
+        endif()
+    endif()
+
+    if(CHESS_ZSTD_TARGET)
+        add_library(chess_zstd INTERFACE)
+        target_link_libraries(chess_zstd INTERFACE ${CHESS_ZSTD_TARGET})
+        target_compile_definitions(chess_zstd INTERFACE CHESS_COMPRESSION_ZSTD)
+    else()
+        message(WARNING "zstd not found: clients won't be offered compression")
+    endif()
+endif()
+
+function(setup_compression target)
+    if(TARGET chess_zstd)
+        target_link_libraries(${target} PRIVATE chess_zstd)
+        message(STATUS "${target}: zstd compression ON")
+    else()
+        message(STATUS "${target}: zstd compression OFF")
+    endif()
+endfunction()
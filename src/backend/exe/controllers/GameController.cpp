@@ -1,31 +1,111 @@
 #include "GameController.hpp"
 
+#include <algorithm>
+#include <random>
+#include <thread>
 #include <utility>
 
+#include "CommandTable.hpp"
 #include "GameContext.hpp"
+#include "MemoryAccounting.hpp"
+#include "Metrics.hpp"
 #include "MoveParser.hpp"
 #include "ParserFactory.hpp"
 
 using json = nlohmann::json;
 
-GameController::GameController(ParserType parser)
-    : game_context_(std::make_unique<GameContext>()),
-      parser_(std::move(ParserFactory::createParser(parser))),
+namespace {
+
+/// Answer to a command missing from the command table (also sent before parsing).
+const std::string kUnknownCommand = R"({"error":"Unknown command"})";
+
+/**
+ * @brief Check a message against the field schema of its command.
+ * @return Error message, empty if the fields are valid
+ */
+std::string checkFields(const CommandSpec& spec, const json& message) {
+    for (const auto& field : spec.fields) {
+        if (field.name.empty()) {
+            break;
+        }
+
+        auto value = message.find(field.name);
+        if (value == message.end()) {
+            if (field.required) {
+                return "Missing field: " + std::string(field.name);
+            }
+            continue;
+        }
+
+        bool valid = false;
+        switch (field.type) {
+            case FieldType::STRING:
+                valid = value->is_string();
+                break;
+            case FieldType::BOOLEAN:
+                valid = value->is_boolean();
+                break;
+            case FieldType::UNSIGNED:
+                valid = value->is_number_unsigned();
+                break;
+            case FieldType::OBJECT:
+                valid = value->is_object();
+                break;
+        }
+        if (!valid) {
+            return "Invalid field: " + std::string(field.name);
+        }
+    }
+    return {};
+}
+
+/**
+ * @brief Generate an unguessable resume token.
+ * @return 128 random bits as 32 hex digits
+ */
+std::string generateResumeToken() {
+    static constexpr char kHexDigits[] = "0123456789abcdef";
+
+    std::random_device random;  // Reads the kernel entropy source on Linux
+    std::string token;
+    token.reserve(32);
+    for (int i = 0; i < 4; ++i) {
+        uint32_t bits = random();
+        for (int j = 0; j < 8; ++j) {
+            token += kHexDigits[(bits >> (j * 4)) & 0xf];
+        }
+    }
+    return token;
+}
+
+}  // namespace
+
+GameController::GameController(ParserType parser, UploadWorker& uploads)
+    : upload_worker_(uploads),
+      parser_(ParserFactory::sharedParser(parser)),
       logger_(Logger::instance()) {
     logger_.debug("GameController initialised");
 }
 
+GameController::~GameController() {
+    // The worker must not play an upload into a destroyed room
+    upload_worker_.cancel(*this);
+}
+
 void GameController::setSendCallbacks(UnicastCallback unicast, BroadcastCallback broadcast) {
-    if (game_context_) {
-        game_context_->setSendCallbacks(std::move(unicast), std::move(broadcast));
-    }
+    game_context_.setSendCallbacks(std::move(unicast), std::move(broadcast));
 }
 
 std::optional<std::string> GameController::routeMessage(const std::string& message,
-                                                        const std::string& session_id) {
+                                                        const std::string& session_id,
+                                                        int64_t received_ns) {
+    if (received_ns == 0) {
+        received_ns = GameClock::now();
+    }
+
     // Parse application message (should be JSON)
     try {
-        return handleMessage(session_id, message);
+        return handleMessage(session_id, message, received_ns);
 
     } catch (const json::parse_error& e) {
         logger_.error("JSON parse error: " + std::string(e.what()));
@@ -59,6 +139,154 @@ void GameController::routeDisconnect(const std::string& session_id) {
 
     logger_.debug("Handling disconnect for session: " + session_id);
 
+    // A client dropping mid-upload would otherwise leave its partial file behind forever
+    discardUploads(session_id);
+
+    {
+        std::lock_guard<std::mutex> lock(game_context_.getMutex());
+        game_context_.removeLegalMoveSubscriber(session_id);
+    }
+    {
+        std::lock_guard<std::mutex> lock(lags_mutex_);
+        lags_.erase(session_id);
+    }
+
+    // A player's seat is held for a while: it may come back with its resume token
+    if (holdSeat(session_id)) {
+        return;
+    }
+
+    releaseSeat(session_id);
+}
+
+std::string GameController::issueResumeToken(const std::string& session_id) {
+    std::string token = generateResumeToken();
+
+    std::lock_guard<std::mutex> lock(resume_mutex_);
+    resume_tickets_[token] = ResumeTicket{session_id};
+    session_tokens_[session_id] = token;
+
+    return token;
+}
+
+bool GameController::holdSeat(const std::string& session_id) {
+    std::lock_guard<std::mutex> lock(game_context_.getMutex());
+    std::string color = game_context_.getPlayerColor(session_id);
+
+    std::lock_guard<std::mutex> resume_lock(resume_mutex_);
+    auto session_token = session_tokens_.find(session_id);
+    if (session_token == session_tokens_.end()) {
+        return false;
+    }
+
+    std::string token = std::move(session_token->second);
+    session_tokens_.erase(session_token);
+
+    if (color.empty() || resume_grace_.count() == 0) {
+        resume_tickets_.erase(token);
+        return false;
+    }
+
+    auto& ticket = resume_tickets_[token];
+    ticket.held = true;
+    ticket.hold_until = std::chrono::steady_clock::now() + resume_grace_;
+    updateHoldDeadline();
+
+    logger_.info(color + " player disconnected, seat held for " +
+                 std::to_string(resume_grace_.count()) + " s");
+    Metrics::instance().increment(Counter::SEATS_HELD);
+
+    json hold_broadcast = {{"type", "player_disconnected"},
+                           {"color", color},
+                           {"grace_seconds", resume_grace_.count()}};
+    game_context_.broadcastToOthers(session_id, hold_broadcast.dump());
+
+    return true;
+}
+
+void GameController::expireSeatHolds() {
+    std::vector<std::string> expired;
+    auto now = std::chrono::steady_clock::now();
+    if (hold_deadline_.load(std::memory_order_relaxed) > now.time_since_epoch().count()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(resume_mutex_);
+        for (auto it = resume_tickets_.begin(); it != resume_tickets_.end();) {
+            if (it->second.held && it->second.hold_until <= now) {
+                expired.push_back(std::move(it->second.session_id));
+                it = resume_tickets_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        updateHoldDeadline();
+    }
+
+    // The tickets are gone: the seats can't be resumed while being released
+    for (const auto& session_id : expired) {
+        logger_.info("Seat hold of session " + session_id + " expired");
+        releaseSeat(session_id);
+    }
+}
+
+bool GameController::hasSeatHolds() {
+    return hold_deadline_.load(std::memory_order_relaxed) != kNoHold;
+}
+
+void GameController::updateHoldDeadline() {
+    int64_t deadline = kNoHold;
+    for (const auto& ticket : resume_tickets_) {
+        if (ticket.second.held) {
+            int64_t until = ticket.second.hold_until.time_since_epoch().count();
+            deadline = std::min(deadline, until);
+        }
+    }
+    hold_deadline_.store(deadline, std::memory_order_relaxed);
+}
+
+json GameController::exportRoom() {
+    std::lock_guard<std::mutex> lock(game_context_.getMutex());
+    json room = {{"game", game_context_.exportState()}, {"tickets", json::array()}};
+
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> resume_lock(resume_mutex_);
+    for (const auto& [token, ticket] : resume_tickets_) {
+        json entry = {{"token", token}, {"session_id", ticket.session_id}};
+        if (ticket.held) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::max(ticket.hold_until - now, std::chrono::steady_clock::duration::zero()));
+            entry["hold_ms"] = left.count();
+        }
+        room["tickets"].push_back(entry);
+    }
+
+    return room;
+}
+
+void GameController::importRoom(const json& room) {
+    std::lock_guard<std::mutex> lock(game_context_.getMutex());
+    game_context_.importState(room.at("game"));
+
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> resume_lock(resume_mutex_);
+    for (const auto& entry : room.at("tickets")) {
+        std::string token = entry.at("token").get<std::string>();
+        ResumeTicket ticket{entry.at("session_id").get<std::string>()};
+
+        if (entry.contains("hold_ms")) {
+            ticket.held = true;
+            ticket.hold_until = now + std::chrono::milliseconds(entry["hold_ms"].get<int64_t>());
+        } else {
+            session_tokens_[ticket.session_id] = token;
+        }
+        resume_tickets_[token] = std::move(ticket);
+    }
+    updateHoldDeadline();
+}
+
+void GameController::releaseSeat(const std::string& session_id) {
     std::string disconnected_color;
 
     // Only reset the game if disconnected player had joined it.
@@ -66,16 +294,16 @@ void GameController::routeDisconnect(const std::string& session_id) {
 
     // Thread-safe instruction block
     {
-        std::lock_guard<std::mutex> lock(game_context_->getMutex());
+        std::lock_guard<std::mutex> lock(game_context_.getMutex());
 
         // Check if this session was a player
-        if (game_context_->getWhitePlayer() == session_id) {
+        if (game_context_.getWhitePlayer() == session_id) {
             disconnected_color = "white";
-            game_context_->setWhitePlayer("");  // Clear white player
+            game_context_.setWhitePlayer("");  // Clear white player
             hadPlayerJoined = true;
-        } else if (game_context_->getBlackPlayer() == session_id) {
+        } else if (game_context_.getBlackPlayer() == session_id) {
             disconnected_color = "black";
-            game_context_->setBlackPlayer("");  // Clear black player
+            game_context_.setBlackPlayer("");  // Clear black player
             hadPlayerJoined = true;
         }
 
@@ -83,7 +311,7 @@ void GameController::routeDisconnect(const std::string& session_id) {
 
         if (hadPlayerJoined) {
             logger_.info("Resetting game");
-            game_context_->resetGame("");
+            game_context_.resetGame("");
         }
     }
 
@@ -95,40 +323,110 @@ void GameController::routeDisconnect(const std::string& session_id) {
             json reset_broadcast = {{"type", "game_reset"},
                                     {"reason", "all_players_disconnected"},
                                     {"status", "Waiting for players..."}};
-            game_context_->broadcastToOthers(session_id, reset_broadcast.dump());
+            game_context_.broadcastToOthers(session_id, reset_broadcast.dump());
         }
     }
 }
 
 std::optional<std::string> GameController::handleMessage(const std::string& session_id,
-                                                         const std::string& message) {
+                                                         const std::string& message,
+                                                         int64_t received_ns) {
     logger_.debug("Routing message for session: " + session_id);
 
-    auto json_message = json::parse(message);
+    // Game state changes are charged to the room, except for the nested scopes below
+    MemoryScope scope(MemoryTag::ROOMS);
 
-    // Command-based routing
-    if (json_message.contains("command")) {
-        std::string command = json_message["command"];
+    // Unknown commands are rejected before parsing, with a single table lookup
+    std::string_view raw_command = commandName(message);
+    if (!raw_command.empty() && findCommand(raw_command) == CommandId::COUNT) {
+        logger_.warning("Unknown command");
+        return kUnknownCommand;
+    }
+
+    json json_message;
+    {
+        MemoryScope json_scope(MemoryTag::JSON);
+        json_message = json::parse(message);
+    }
+
+    CommandId command = CommandId::COUNT;
+    auto command_field = json_message.find("command");
+    if (command_field != json_message.end() && command_field->is_string()) {
+        command = findCommand(command_field->get_ref<const std::string&>());
+    }
+
+    // Rate limits were charged on the raw scan: a message the parser reads as
+    // another command (escaped key) must not be played under the wrong class
+    if (command != findCommand(raw_command)) {
+        logger_.warning("Command field doesn't match the raw message");
+        return kUnknownCommand;
+    }
+
+    if (command != CommandId::COUNT) {
+        std::string invalid = checkFields(commandSpec(command), json_message);
+        if (!invalid.empty()) {
+            logger_.warning("Rejected " + std::string(commandSpec(command).name) + ": " + invalid);
+
+            json error;
+            error["type"] = "error";
+            error["error"] = "Invalid message structure";
+            error["details"] = invalid;
+            return error.dump();
+        }
+    }
 
-        if (command == "upload_game") {
+    // Command-based routing (fields checked against the command table)
+    switch (command) {
+        case CommandId::UPLOAD_GAME:
             return handleFileUploadChunk(json_message, session_id);
-        } else if (command == "join_game") {
+        case CommandId::JOIN_GAME:
             return handleJoinGame(session_id, json_message["single_player"], json_message["color"]);
-        } else if (command == "start_game") {
-            return handleStartGame(session_id);
-        } else if (command == "make_move") {
-            return handleMoveToParse(session_id, json_message["move"]);
-        } else if (command == "end_game") {
+        case CommandId::START_GAME: {
+            auto control = TimeControl::fromClient(json_message.value("clock_ms", uint64_t{0}),
+                                                   json_message.value("increment_ms", uint64_t{0}));
+            if (!control) {
+                json error;
+                error["type"] = "error";
+                error["error"] = "Invalid message structure";
+                error["details"] = "clock_ms and increment_ms must not exceed " +
+                                   std::to_string(TimeControl::kMaxMs);
+                return error.dump();
+            }
+            return handleStartGame(session_id, *control);
+        }
+        case CommandId::MAKE_MOVE:
+            return handleMoveToParse(session_id, json_message["move"], received_ns);
+        case CommandId::END_GAME:
             return handleEndGame(session_id);
-        } else if (command == "display_board") {
+        case CommandId::DISPLAY_BOARD:
             return handleDisplayBoard();
+        case CommandId::GET_SNAPSHOT:
+            return handleGetSnapshot();
+        case CommandId::RESUME:
+            return handleResume(session_id, json_message["token"]);
+        case CommandId::RESYNC:
+            return handleResync(session_id, json_message.value("since", uint64_t{0}));
+        case CommandId::GET_STATS:
+            return handleGetStats();
+        case CommandId::SET_POSITION:
+            return handleSetPosition(session_id, json_message["fen"]);
+        case CommandId::PREMOVE:
+            return handlePremove(session_id, json_message["move"], received_ns);
+        case CommandId::PING:
+            return handlePing(session_id, json_message, received_ns);
+        case CommandId::LEGAL_MOVES: {
+            auto push = json_message.find("push");
+            return handleLegalMoves(session_id, push == json_message.end()
+                                                    ? std::nullopt
+                                                    : std::optional<bool>(push->get<bool>()));
         }
+        default:
+            // Including the session commands, which never reach the controller
+            break;
     }
 
     logger_.warning("Unknown message type");
-    json error;
-    error["error"] = "Unknown command";
-    return error.dump();
+    return kUnknownCommand;
 }
 
 std::string GameController::handleJoinGame(const std::string& session_id, bool single_player,
@@ -138,50 +436,55 @@ std::string GameController::handleJoinGame(const std::string& session_id, bool s
     json response;
 
     if (single_player) {
-        std::lock_guard<std::mutex> lock(game_context_->getMutex());
-        response = game_context_->handleJoinRequestAsSinglePlayer(session_id);
+        std::lock_guard<std::mutex> lock(game_context_.getMutex());
+        response = game_context_.handleJoinRequestAsSinglePlayer(session_id);
     } else {
-        std::lock_guard<std::mutex> lock(game_context_->getMutex());
-        response = game_context_->handleJoinRequest(session_id, color);
+        std::lock_guard<std::mutex> lock(game_context_.getMutex());
+        response = game_context_.handleJoinRequest(session_id, color);
     }
 
     return response.dump();
 }
 
-std::string GameController::handleStartGame(const std::string& session_id) {
+std::string GameController::handleStartGame(const std::string& session_id,
+                                            const TimeControl& control) {
     logger_.info("Session " + session_id + " starting game");
 
     json response;
 
     // Thread-safe instruction block
     {
-        std::lock_guard<std::mutex> lock(game_context_->getMutex());
-        response = game_context_->handleStartRequest(session_id);
+        std::lock_guard<std::mutex> lock(game_context_.getMutex());
+        response = game_context_.handleStartRequest(session_id, control);
     }
 
     return response.dump();
 }
 
 std::string GameController::handleMoveToParse(const std::string& session_id,
-                                              const std::string& move) {
-    logger_.debug("Session " + session_id + " parsing move with " + parser_->getParserType() +
+                                              const std::string& move, int64_t received_ns) {
+    logger_.debug("Session " + session_id + " parsing move with " + parser_.getParserType() +
                   ": " + move);
 
-    auto parsed_move = parser_->parseMove(move);
+    std::optional<ParsedMove> parsed_move;
+    {
+        MemoryScope parser_scope(MemoryTag::PARSER);
+        parsed_move = parser_.parseMove(move);
+    }
 
     if (!parsed_move) {
         json error;
         error["type"] = "error";
-        error["error"] = "Couldn't parse move using " + parser_->getParserType();
-        error["parser_used"] = parser_->getParserType();
+        error["error"] = "Couldn't parse move using " + parser_.getParserType();
+        error["parser_used"] = parser_.getParserType();
         return error.dump();
     }
 
-    return handleParsedMove(session_id, *parsed_move);
+    return handleParsedMove(session_id, *parsed_move, moveTiming(session_id, received_ns));
 }
 
 std::string GameController::handleParsedMove(const std::string& session_id,
-                                             const ParsedMove& move) {
+                                             const ParsedMove& move, const MoveTiming& timing) {
     if (move.is_san) {
         logger_.info("Session " + session_id + " move: " + move.notation);
     } else {
@@ -192,13 +495,87 @@ std::string GameController::handleParsedMove(const std::string& session_id,
 
     // Thread-safe instruction block
     {
-        std::lock_guard<std::mutex> lock(game_context_->getMutex());
-        response = game_context_->handleMoveRequest(session_id, move);
+        std::lock_guard<std::mutex> lock(game_context_.getMutex());
+        response = game_context_.handleMoveRequest(session_id, move, timing);
+    }
+
+    return response.dump();
+}
+
+std::string GameController::handlePremove(const std::string& session_id,
+                                          const std::string& move, int64_t received_ns) {
+    logger_.debug("Session " + session_id + " premove: " + move);
+
+    // An empty move clears the queue
+    std::optional<ParsedMove> parsed_move;
+    if (!move.empty()) {
+        {
+            MemoryScope parser_scope(MemoryTag::PARSER);
+            parsed_move = parser_.parseMove(move);
+        }
+
+        if (!parsed_move) {
+            json error;
+            error["type"] = "error";
+            error["error"] = "Couldn't parse move using " + parser_.getParserType();
+            error["parser_used"] = parser_.getParserType();
+            return error.dump();
+        }
+    }
+
+    json response;
+
+    // Thread-safe instruction block
+    {
+        std::lock_guard<std::mutex> lock(game_context_.getMutex());
+        response = game_context_.handlePremoveRequest(session_id, std::move(parsed_move),
+                                                       moveTiming(session_id, received_ns));
+    }
+
+    return response.dump();
+}
+
+std::string GameController::handlePing(const std::string& session_id, const json& message,
+                                       int64_t received_ns) {
+    int64_t rtt_ns = 0;
+    size_t samples = 0;
+    {
+        std::lock_guard<std::mutex> lock(lags_mutex_);
+        auto& lag = lags_[session_id];
+
+        // From our latest pong to this ping, measured on our clock alone
+        if (auto echo = message.find("echo"); echo != message.end()) {
+            lag.addEcho(echo->get<uint64_t>(), received_ns);
+        }
+        rtt_ns = lag.roundTrip();
+        samples = lag.samples();
+    }
+
+    json response = {{"type", "pong"},
+                     {"t1_us", received_ns / 1000},
+                     {"rtt_us", rtt_ns / 1000},
+                     {"samples", samples}};
+    if (auto t0 = message.find("t0"); t0 != message.end()) {
+        response["t0"] = *t0;
+    }
+    int64_t sent_ns = GameClock::now();
+    response["t2_us"] = sent_ns / 1000;
+    {
+        std::lock_guard<std::mutex> lock(lags_mutex_);
+        lags_[session_id].pongSent(sent_ns);
     }
 
     return response.dump();
 }
 
+MoveTiming GameController::moveTiming(const std::string& session_id, int64_t received_ns) {
+    int64_t cap_ns = std::chrono::nanoseconds(max_lag_).count();
+
+    std::lock_guard<std::mutex> lock(lags_mutex_);
+    auto lag = lags_.find(session_id);
+    return {received_ns, lag == lags_.end() ? 0 : lag->second.compensation(cap_ns)};
+}
+
 std::string GameController::handleEndGame(const std::string& session_id) {
     logger_.info("Session " + session_id + " ending game");
 
@@ -206,8 +583,8 @@ std::string GameController::handleEndGame(const std::string& session_id) {
 
     // Thread-safe instruction block
     {
-        std::lock_guard<std::mutex> lock(game_context_->getMutex());
-        response = game_context_->handleEndRequest(session_id);
+        std::lock_guard<std::mutex> lock(game_context_.getMutex());
+        response = game_context_.handleEndRequest(session_id);
     }
 
     return response.dump();
@@ -220,17 +597,160 @@ std::string GameController::handleDisplayBoard() {
 
     // Thread-safe instruction block
     {
-        std::lock_guard<std::mutex> lock(game_context_->getMutex());
-        response = game_context_->handleDisplayBoard();
+        std::lock_guard<std::mutex> lock(game_context_.getMutex());
+        response = game_context_.handleDisplayBoard();
+    }
+
+    return response.dump();
+}
+
+std::string GameController::handleSetPosition(const std::string& session_id,
+                                              const std::string& fen) {
+    logger_.info("Session " + session_id + " setting the start position");
+
+    json response;
+
+    // Thread-safe instruction block
+    {
+        std::lock_guard<std::mutex> lock(game_context_.getMutex());
+        response = game_context_.handleSetPosition(session_id, fen);
+    }
+
+    return response.dump();
+}
+
+std::string GameController::handleLegalMoves(const std::string& session_id,
+                                             std::optional<bool> push) {
+    logger_.debug("Sending legal moves to session " + session_id);
+
+    json response;
+
+    // Thread-safe instruction block
+    {
+        std::lock_guard<std::mutex> lock(game_context_.getMutex());
+        response = game_context_.handleLegalMoves(session_id, push);
+    }
+
+    return response.dump();
+}
+
+std::string GameController::handleGetSnapshot() {
+    logger_.debug("Sending position snapshot");
+    Metrics::instance().increment(Counter::SNAPSHOTS_SENT);
+
+    json response;
+
+    // Thread-safe instruction block
+    {
+        std::lock_guard<std::mutex> lock(game_context_.getMutex());
+        response = game_context_.handleSnapshot();
+    }
+
+    return response.dump();
+}
+
+std::optional<std::string> GameController::handleResync(const std::string& session_id,
+                                                        uint64_t since) {
+    logger_.debug("Resyncing session " + session_id + " since event " + std::to_string(since));
+
+    std::lock_guard<std::mutex> lock(game_context_.getMutex());
+    game_context_.resync(session_id, since);
+
+    return std::nullopt;
+}
+
+std::string GameController::handleResume(const std::string& session_id,
+                                         const std::string& token) {
+    logger_.debug("Session " + session_id + " resuming a seat");
+
+    json response;
+
+    // Thread-safe instruction block
+    {
+        std::lock_guard<std::mutex> lock(game_context_.getMutex());
+        std::lock_guard<std::mutex> resume_lock(resume_mutex_);
+
+        auto ticket = resume_tickets_.find(token);
+        if (ticket == resume_tickets_.end()) {
+            return json{{"type", "error"}, {"error", "Unknown or expired resume token"}}.dump();
+        }
+
+        // The previous session may not have noticed its connection dropped yet: once
+        // it has lost the seat and the token, its disconnection changes nothing
+        std::string previous_session = ticket->second.session_id;
+        std::string color = previous_session == session_id
+                                ? game_context_.getPlayerColor(session_id)
+                                : game_context_.replacePlayer(previous_session, session_id);
+        if (color.empty()) {
+            return json{{"type", "error"}, {"error", "No seat to resume"}}.dump();
+        }
+
+        if (previous_session != session_id) {
+            // This session keeps the token it resumed with, instead of its own
+            auto own_token = session_tokens_.find(session_id);
+            if (own_token != session_tokens_.end()) {
+                resume_tickets_.erase(own_token->second);
+            }
+            session_tokens_.erase(previous_session);
+            session_tokens_[session_id] = token;
+
+            ticket = resume_tickets_.find(token);
+            ticket->second = ResumeTicket{session_id};
+            updateHoldDeadline();
+
+            logger_.info("Session " + session_id + " resumed the " + color + " seat");
+            Metrics::instance().increment(Counter::SEATS_RESUMED);
+
+            json resume_broadcast = {{"type", "player_reconnected"}, {"color", color}};
+            game_context_.broadcastToOthers(session_id, resume_broadcast.dump());
+        }
+
+        // The client catches up with `resync` from the last event it saw
+        response = {{"type", "resumed"},
+                    {"color", color},
+                    {"seq", game_context_.lastSequence()},
+                    {"status", game_context_.getStatusMessage()}};
+    }
+
+    return response.dump();
+}
+
+std::string GameController::handleGetStats() {
+    logger_.debug("Reporting server stats");
+
+    json response = Metrics::instance().snapshot();
+    response["type"] = "stats";
+
+    {
+        std::lock_guard<std::mutex> lock(uploads_mutex_);
+        response["uploads_pending"] = file_uploads_.size() + upload_worker_.pending(*this);
     }
 
     return response.dump();
 }
 
+void GameController::discardUploads(const std::string& session_id) {
+    std::lock_guard<std::mutex> lock(uploads_mutex_);
+
+    const std::string prefix = session_id + ":";
+
+    for (auto it = file_uploads_.begin(); it != file_uploads_.end();) {
+        if (it->first.compare(0, prefix.size(), prefix) == 0) {
+            logger_.info("Discarding incomplete upload: " + it->second.filename);
+            Metrics::instance().increment(Counter::UPLOADS_ABORTED);
+            it = file_uploads_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
 // TODO: file chunk upload and file reconstruction should be moved to a separate
 // class in the Utils part of the backend source code.
 std::optional<std::string> GameController::handleFileUploadChunk(const nlohmann::json& json_message,
                                                                  const std::string& session_id) {
+    MemoryScope scope(MemoryTag::UPLOADS);
+
     try {
         auto metadata = json_message["metadata"];
         std::string filename = metadata["filename"];
@@ -240,24 +760,61 @@ std::optional<std::string> GameController::handleFileUploadChunk(const nlohmann:
         std::string chunk_data = json_message["data"];
 
         std::string upload_key = session_id + ":" + filename;
-        auto& upload = file_uploads_[upload_key];
-
-        if (chunk_current == 1) {
-            upload.filename = filename;
-            upload.total_size = total_size;
-            upload.chunks_total = chunks_total;
-            upload.chunks_received = 0;
-            upload.accumulated_data.clear();
-            upload.accumulated_data.reserve(total_size);
-
-            logger_.info("Starting file upload: " + filename + " (" + std::to_string(total_size) +
-                         " bytes) for session " + session_id);
+        std::string completed_data;
+        bool load = false;
+
+        // New uploads wait for the load to drop; the ones in progress complete
+        if (chunk_current == 1 && overload_ && overload_->level() >= OverloadLevel::ELEVATED) {
+            logger_.warning("Deferring upload of " + filename + ": server overloaded");
+            Metrics::instance().increment(Counter::UPLOADS_DEFERRED);
+
+            json error;
+            error["type"] = "error";
+            error["error"] = "Server overloaded, upload deferred";
+            error["filename"] = filename;
+            error["retry_after_ms"] = OverloadController::kRetryAfter.count();
+            return error.dump();
         }
 
-        upload.accumulated_data += chunk_data;
+        // Thread-safe instruction block
+        {
+            std::lock_guard<std::mutex> lock(uploads_mutex_);
+
+            // Remaining chunks of a deferred upload are dropped without a reply each
+            if (chunk_current != 1 && !file_uploads_.contains(upload_key)) {
+                logger_.debug("Dropping chunk " + std::to_string(chunk_current) +
+                              " of an upload not started: " + filename);
+                return std::nullopt;
+            }
+
+            auto& upload = file_uploads_[upload_key];
+
+            if (chunk_current == 1) {
+                upload.filename = filename;
+                upload.total_size = total_size;
+                upload.chunks_total = chunks_total;
+                upload.chunks_received = 0;
+                upload.accumulated_data.clear();
+                upload.accumulated_data.reserve(total_size);
+                upload.load = metadata.value("mode", "") == "load";
+
+                Metrics::instance().increment(Counter::UPLOADS_STARTED);
+                logger_.info("Starting file upload: " + filename + " (" +
+                             std::to_string(total_size) + " bytes) for session " + session_id);
+            }
+
+            upload.accumulated_data += chunk_data;
 
-        // TCP or Unix stream socket IPC guarantee packet order
-        upload.chunks_received = chunk_current;
+            // TCP or Unix stream socket IPC guarantee packet order
+            upload.chunks_received = chunk_current;
+
+            if (chunk_current >= chunks_total) {
+                // Clean up upload state before replaying the game (which takes a while)
+                completed_data = std::move(upload.accumulated_data);
+                load = upload.load;
+                file_uploads_.erase(upload_key);
+            }
+        }
 
         int percent = (chunk_current * 100) / chunks_total;
         logger_.info("Upload progress " + filename + ": " + std::to_string(percent) + "% (" +
@@ -265,12 +822,12 @@ std::optional<std::string> GameController::handleFileUploadChunk(const nlohmann:
 
         if (chunk_current >= chunks_total) {
             logger_.info("File upload complete: " + filename);
-            processFileContent(session_id, filename, upload.accumulated_data);
+            Metrics::instance().increment(Counter::UPLOADS_COMPLETED);
 
-            // Clean up upload state
-            file_uploads_.erase(upload_key);
+            // Played back on the upload worker: the event loop must not wait for it
+            upload_worker_.submit(*this, {session_id, filename, std::move(completed_data), load});
 
-            // Return empty string - responses already sent progressively
+            // Return empty string - responses sent progressively by the worker
             return std::nullopt;
         }
 
@@ -293,9 +850,41 @@ std::optional<std::string> GameController::handleFileUploadChunk(const nlohmann:
     }
 }
 
+void GameController::playUpload(const CompletedUpload& upload, const std::stop_token& st) {
+    if (!waitWhileOverloaded(st)) {
+        return;
+    }
+
+    MemoryScope scope(MemoryTag::UPLOADS);
+    processFileContent(upload.session_id, upload.filename, upload.data, upload.load, st);
+}
+
+bool GameController::waitWhileOverloaded(const std::stop_token& st) {
+    if (!overload_ || overload_->level() < OverloadLevel::ELEVATED) {
+        return !st.stop_requested();
+    }
+
+    logger_.info("Upload playback paused: server overloaded");
+
+    while (overload_->level() >= OverloadLevel::ELEVATED && !st.stop_requested()) {
+        std::this_thread::sleep_for(OverloadController::kSampleInterval);
+    }
+
+    logger_.info("Upload playback resumed");
+    return !st.stop_requested();
+}
+
 void GameController::processFileContent(const std::string& session_id, const std::string& filename,
-                                        const std::string& data) {
-    auto moves = parser_->parseGame(data);
+                                        const std::string& data, bool load,
+                                        const std::stop_token& st) {
+    std::optional<std::vector<ParsedMove>> moves;
+    {
+        MemoryScope parser_scope(MemoryTag::PARSER);
+        moves = parser_.parseGame(data);
+    }
+
+    // Replayed moves change the game state
+    MemoryScope scope(MemoryTag::ROOMS);
 
     if (!moves.has_value() || (*moves).empty()) {
         logger_.warning("No valid moves found in game file");
@@ -305,12 +894,17 @@ void GameController::processFileContent(const std::string& session_id, const std
                                {"total_moves", 0},
                                {"error", "No valid moves found. Check file format."}};
 
-        game_context_->unicast(session_id, error_response.dump());
+        game_context_.unicast(session_id, error_response.dump());
         return;
     }
 
     logger_.info("Parsed " + std::to_string((*moves).size()) + " moves from file");
 
+    if (load) {
+        loadGame(session_id, filename, *moves);
+        return;
+    }
+
     // Execute each move and send move_result
     int successful_moves = 0;
     std::string last_error;
@@ -321,6 +915,12 @@ void GameController::processFileContent(const std::string& session_id, const std
     for (size_t i = 0; i < (*moves).size(); ++i) {
         const auto& move = (*moves)[i];
 
+        // Player moves come first: pause between replayed moves while overloaded
+        if (!waitWhileOverloaded(st)) {
+            last_error = "Server stopping";
+            break;
+        }
+
         try {
             std::string move_response = handleParsedMove(session_id, move);
             json move_json = json::parse(move_response);
@@ -336,7 +936,7 @@ void GameController::processFileContent(const std::string& session_id, const std
             }
 
             // Send move_result immediately to client
-            game_context_->unicast(session_id, move_response);
+            game_context_.unicast(session_id, move_response);
 
             successful_moves++;
 
@@ -374,6 +974,50 @@ void GameController::processFileContent(const std::string& session_id, const std
             final_response["error"] = last_error;
         }
 
-        game_context_->unicast(session_id, final_response.dump());
+        game_context_.unicast(session_id, final_response.dump());
     }
-}
\ No newline at end of file
+}
+
+void GameController::loadGame(const std::string& session_id, const std::string& filename,
+                              const std::vector<ParsedMove>& moves) {
+    ChessGame loaded;
+    json response;
+
+    // Copy the game, so players keep moving while the uploaded moves are checked
+    {
+        std::lock_guard<std::mutex> lock(game_context_.getMutex());
+        GameState state = game_context_.getState();
+        if (accepts(state, GameCommand::Move)) {
+            loaded = *game_context_.getChessGame();
+        } else {
+            response = {{"type", "error"}, {"error", rejection(state, GameCommand::Move)}};
+        }
+    }
+
+    if (response.empty()) {
+        int base_ply = loaded.getPly();
+        std::string base_hash = loaded.getPositionHash();
+
+        // A move after the end of the game is illegal as well: the whole file is refused
+        size_t played = loaded.playMoves(moves);
+        if (played < moves.size()) {
+            // Nothing was committed: the room never sees any of the moves
+            logger_.warning("Illegal move " + std::to_string(played + 1) + " in " + filename);
+            response = {{"type", "error"},
+                        {"error", "Illegal move " + std::to_string(played + 1) + ": " +
+                                      moves[played].notation},
+                        {"move_index", played + 1}};
+        } else {
+            std::lock_guard<std::mutex> lock(game_context_.getMutex());
+            response = game_context_.handleLoadRequest(session_id, base_ply, base_hash,
+                                                        std::move(loaded));
+        }
+    }
+
+    bool rejected = response.value("type", "") == "error";
+    Metrics::instance().increment(rejected ? Counter::GAME_LOADS_REJECTED : Counter::GAMES_LOADED);
+
+    response["filename"] = filename;
+    response["requested_moves"] = moves.size();
+    game_context_.unicast(session_id, response.dump());
+}
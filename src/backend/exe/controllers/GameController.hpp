@@ -8,13 +8,23 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include <string>
+#include <stop_token>
 #include <unordered_map>
+#include <utility>
 
 #include "GameContext.hpp"
+#include "LagEstimator.hpp"
 #include "Logger.hpp"
+#include "OverloadController.hpp"
+#include "SlabPool.hpp"
+#include "UploadWorker.hpp"
 
 /**
  * @struct FileUploadState
@@ -26,14 +36,46 @@ struct FileUploadState {
     int chunks_total = 0;          ///< Total number of chunks
     int chunks_received = 0;       ///< Chunks received so far
     std::string accumulated_data;  ///< Accumulated file data
+    bool load = false;             ///< Load the game at once instead of playing it back
 };
 
+/**
+ * @struct ResumeTicket
+ * @brief Session owning a resume token, and its seat hold once disconnected.
+ */
+struct ResumeTicket {
+    std::string session_id;                              ///< Session the token was issued to
+    bool held = false;                                   ///< Player left, seat held for it
+    std::chrono::steady_clock::time_point hold_until{};  ///< End of the grace period, if held
+};
+
+/**
+ * @brief Map keyed by session, upload or token, whose entries come from slab pools.
+ *
+ * Empty maps allocate nothing, so opening and closing a room don't touch the
+ * global allocator for them. Entries are recycled across the rooms of the
+ * process; only bucket arrays and keys too long for the string's inline
+ * buffer still come from the global allocator.
+ */
+template <typename Value>
+using RoomMap = std::unordered_map<std::string, Value, std::hash<std::string>,
+                                   std::equal_to<std::string>,
+                                   SlabAllocator<std::pair<const std::string, Value>>>;
+
 /**
  * @class GameController
  * @brief Controller routing application messages to model handlers.
  *
  * Parses JSON application messages and delegates to GameContext state machine.
- * Handles file uploads for game playback mode.
+ * Handles file uploads for game playback mode: completed files are played
+ * back by the server's upload worker, since playback is paced and the event
+ * loop serving every session must not block. Under overload, new uploads are
+ * rejected with a retry delay and playback pauses, so player moves don't
+ * compete with replayed ones for the game lock.
+ *
+ * Each session gets a resume token in its handshake. When a player's
+ * connection drops, its seat is held for a grace period instead of resetting
+ * the game, and a new session presenting the token takes the seat over.
  */
 
 class GameController {
@@ -41,22 +83,33 @@ class GameController {
     /**
      * @brief Construct game controller with parser type.
      * @param parser Parser type for game notation
+     * @param uploads Upload worker of the server (must outlive this controller)
      */
-    GameController(ParserType parser);
+    GameController(ParserType parser, UploadWorker& uploads);
 
     /**
-     * @brief Destructor.
+     * @brief Destructor, stopping the playback of this room's uploads.
      */
-    ~GameController() = default;
+    ~GameController();
+
+    /**
+     * @brief Play back or load a completed upload (upload worker thread).
+     * @param upload Completed upload
+     * @param st Stops the playback (room closing, or server stopping)
+     */
+    void playUpload(const CompletedUpload& upload, const std::stop_token& st);
 
     /**
      * @brief Route message to appropriate handler.
      * @param content Raw message string (should be JSON)
      * @param session_id Unique identifier for client session
+     * @param received_ns Time the message was read from the socket, on the steady clock
+     * (0: now)
      * @return JSON response string (optional)
      */
     std::optional<std::string> routeMessage(const std::string& content,
-                                            const std::string& session_id);
+                                            const std::string& session_id,
+                                            int64_t received_ns = 0);
 
     /**
      * @brief Route disconnect event.
@@ -71,15 +124,88 @@ class GameController {
      */
     void setSendCallbacks(UnicastCallback unicast, BroadcastCallback broadcast);
 
+    /**
+     * @brief Name the room whose game this controller plays.
+     * @param room Room name (empty for the default room)
+     */
+    void setRoom(std::string room) { room_ = std::move(room); }
+
+    /**
+     * @brief Get the room whose game this controller plays (empty for the default room).
+     */
+    const std::string& getRoom() const { return room_; }
+
+    /**
+     * @brief Shed upload work while the server is overloaded.
+     * @param overload Overload controller (must outlive this controller)
+     */
+    void setOverloadController(const OverloadController& overload) { overload_ = &overload; }
+
+    /**
+     * @brief Check if a session plays the game (as opposed to spectating it).
+     * @param session_id Session ID
+     * @return True if the session is the white or black player
+     */
+    bool isPlayer(const std::string& session_id) const {
+        return game_context_.isPlayer(session_id);
+    }
+
+    /**
+     * @brief Issue the token a client presents to take its seat back after a reconnection.
+     * @param session_id Session ID
+     * @return Resume token (32 hex digits)
+     */
+    std::string issueResumeToken(const std::string& session_id);
+
+    /**
+     * @brief Set how long the seat of a disconnected player is held for it to resume.
+     * @param grace Grace period (0: reset the game as soon as a player leaves)
+     */
+    void setResumeGrace(std::chrono::seconds grace) { resume_grace_ = grace; }
+
+    /**
+     * @brief Set the most lag compensated on the clock of a move.
+     * @param cap Cap on the round trip not charged to the mover (0: no compensation)
+     */
+    void setMaxLagCompensation(std::chrono::milliseconds cap) { max_lag_ = cap; }
+
+    /**
+     * @brief Release the seats held past their grace period, resetting the game (cleanup thread).
+     */
+    void expireSeatHolds();
+
+    /**
+     * @brief Check if the seat of a disconnected player is still held.
+     */
+    bool hasSeatHolds();
+
+    /**
+     * @brief Serialise the game and the resume tickets, to move the room to another process.
+     *
+     * The room's sessions must no longer be read. Uploads being played back are not
+     * included.
+     *
+     * @return Game state and resume tickets (with the remaining hold of held seats)
+     */
+    nlohmann::json exportRoom();
+
+    /**
+     * @brief Take over a room serialised by exportRoom(), before its sessions start.
+     * @param room Serialised room
+     * @throws std::runtime_error or json::exception if the room is invalid
+     */
+    void importRoom(const nlohmann::json& room);
+
    private:
     /**
      * @brief Handle message from session.
      * @param session_id Client session ID
      * @param message Message content
+     * @param received_ns Time the message was read from the socket, on the steady clock
      * @return JSON response (optional)
      */
     std::optional<std::string> handleMessage(const std::string& session_id,
-                                             const std::string& message);
+                                             const std::string& message, int64_t received_ns);
 
     /**
      * @brief Handle join_game command.
@@ -94,25 +220,61 @@ class GameController {
     /**
      * @brief Handle start_game command.
      * @param session_id Client session ID
+     * @param control Time control (default: untimed)
      * @return JSON response
      */
-    std::string handleStartGame(const std::string& session_id);
+    std::string handleStartGame(const std::string& session_id, const TimeControl& control);
 
     /**
      * @brief Handle make_move command with unparsed move.
      * @param session_id Client session ID
      * @param move Move string to parse
+     * @param received_ns Receive time of the move, on the steady clock
      * @return JSON response
      */
-    std::string handleMoveToParse(const std::string& session_id, const std::string& move);
+    std::string handleMoveToParse(const std::string& session_id, const std::string& move,
+                                  int64_t received_ns);
 
     /**
      * @brief Handle parsed move.
      * @param session_id Client session ID
      * @param move Parsed move (simple or SAN notation)
+     * @param timing Receive time and lag of the sender (default: now, no lag)
+     * @return JSON response
+     */
+    std::string handleParsedMove(const std::string& session_id, const ParsedMove& move,
+                                 const MoveTiming& timing = {});
+
+    /**
+     * @brief Handle premove command.
+     * @param session_id Client session ID
+     * @param move Move string to parse and queue (empty: clear the queue)
+     * @param received_ns Receive time of the premove, on the steady clock
+     * @return JSON response
+     */
+    std::string handlePremove(const std::string& session_id, const std::string& move,
+                              int64_t received_ns);
+
+    /**
+     * @brief Handle ping command: one exchange of the lag measurement.
+     *
+     * The client sends the next ping as soon as it gets the pong, echoing its
+     * `t2_us`: the time between the two is a round trip sample. The pong also
+     * carries the receive and send times (`t1_us`, `t2_us`), with which the
+     * client works out its clock offset like NTP.
+     *
+     * @param session_id Client session ID
+     * @param message Parsed ping, with the optional `t0` and `echo`
+     * @param received_ns Receive time of the ping, on the steady clock
      * @return JSON response
      */
-    std::string handleParsedMove(const std::string& session_id, const ParsedMove& move);
+    std::string handlePing(const std::string& session_id, const nlohmann::json& message,
+                           int64_t received_ns);
+
+    /**
+     * @brief Get the timing of a move: its receive time and the capped lag of its sender.
+     */
+    MoveTiming moveTiming(const std::string& session_id, int64_t received_ns);
 
     /**
      * @brief Handle end_game command.
@@ -127,6 +289,77 @@ class GameController {
      */
     std::string handleDisplayBoard();
 
+    /**
+     * @brief Handle set_position command.
+     * @param session_id Client session ID
+     * @param fen Start position of the next game (empty: the standard one)
+     * @return JSON response
+     */
+    std::string handleSetPosition(const std::string& session_id, const std::string& fen);
+
+    /**
+     * @brief Handle legal_moves command.
+     * @param session_id Client session ID
+     * @param push Subscribe to (true) or unsubscribe from (false) the legal moves after every
+     * move, nullopt to leave the subscription unchanged
+     * @return JSON response
+     */
+    std::string handleLegalMoves(const std::string& session_id, std::optional<bool> push);
+
+    /**
+     * @brief Handle get_snapshot command.
+     * @return JSON response with the full position, for clients in delta mode
+     */
+    std::string handleGetSnapshot();
+
+    /**
+     * @brief Handle resync command: send the events missed since a sequence number.
+     * @param session_id Client session ID
+     * @param since Last sequence number seen by the client
+     * @return Nothing: the answer is sent in order with the broadcasts
+     */
+    std::optional<std::string> handleResync(const std::string& session_id, uint64_t since);
+
+    /**
+     * @brief Handle resume command: give the seat of a previous session to this one.
+     * @param session_id Client session ID
+     * @param token Resume token of the previous session
+     * @return JSON response
+     */
+    std::string handleResume(const std::string& session_id, const std::string& token);
+
+    /**
+     * @brief Hold the seat of a disconnected player during the grace period.
+     * @param session_id Session ID of disconnected client
+     * @return True if the seat is held (the game goes on for now)
+     */
+    bool holdSeat(const std::string& session_id);
+
+    /**
+     * @brief Publish the end of the earliest seat hold, for the sweeps to skip this room.
+     *
+     * Must be called with resume_mutex_ held, after changing a ticket.
+     */
+    void updateHoldDeadline();
+
+    /**
+     * @brief Free the seat of a player who left for good, resetting the game.
+     * @param session_id Session ID of the player
+     */
+    void releaseSeat(const std::string& session_id);
+
+    /**
+     * @brief Handle get_stats command.
+     * @return JSON response with server counters and resource usage
+     */
+    std::string handleGetStats();
+
+    /**
+     * @brief Drop partially uploaded files of a session.
+     * @param session_id Client session ID
+     */
+    void discardUploads(const std::string& session_id);
+
     /**
      * @brief Handle file upload chunk.
      * @param msg Parsed JSON message with chunk data
@@ -136,17 +369,58 @@ class GameController {
     std::optional<std::string> handleFileUploadChunk(const nlohmann::json& msg,
                                                      const std::string& session_id);
 
+    /**
+     * @brief Hold upload playback while the server is overloaded (upload worker thread).
+     * @param st Stop token of the playback
+     * @return False if the playback was asked to stop meanwhile
+     */
+    bool waitWhileOverloaded(const std::stop_token& st);
+
     /**
      * @brief Process complete uploaded file content.
      * @param session_id Client session ID
      * @param filename Uploaded filename
      * @param data Complete file content
+     * @param load Load the game at once instead of playing it back
+     * @param st Stop token of the playback
      */
     void processFileContent(const std::string& session_id, const std::string& filename,
-                            const std::string& data);
+                            const std::string& data, bool load, const std::stop_token& st);
+
+    /**
+     * @brief Apply the moves of an uploaded game at once, or none of them (upload worker thread).
+     *
+     * The moves are played on a copy of the game without the game lock, then
+     * the copy replaces the game in one short critical section, with a single
+     * broadcast. On an illegal move, the game is left untouched.
+     *
+     * @param session_id Client session ID
+     * @param filename Uploaded filename
+     * @param moves Parsed moves of the file
+     */
+    void loadGame(const std::string& session_id, const std::string& filename,
+                  const std::vector<ParsedMove>& moves);
+
+    static constexpr int64_t kNoHold = INT64_MAX;
+    /// End of the earliest seat hold (steady clock ticks), first in the room's slot:
+    /// the cleanup sweeps read this line alone in rooms holding no seat due
+    std::atomic<int64_t> hold_deadline_{kNoHold};
+
+    GameContext game_context_;                                       ///< Game state machine, inline
+    RoomMap<FileUploadState> file_uploads_;         ///< File upload tracking
+    std::mutex uploads_mutex_;                      ///< Protects upload tracking
+    UploadWorker& upload_worker_;                   ///< Plays back completed uploads
+    IGameParser& parser_;                           ///< Game notation parser, shared by all rooms
+    Logger& logger_;                                ///< Logger instance
+    const OverloadController* overload_ = nullptr;  ///< Load shedding (optional)
+    std::string room_;                              ///< Room name (empty: default room)
+
+    RoomMap<ResumeTicket> resume_tickets_;   ///< By resume token
+    RoomMap<std::string> session_tokens_;    ///< Token of each session
+    std::mutex resume_mutex_;                ///< After the game mutex
+    std::chrono::seconds resume_grace_{30};  ///< Seat hold grace period
 
-    std::unique_ptr<GameContext> game_context_;                      ///< Game state machine
-    std::unordered_map<std::string, FileUploadState> file_uploads_;  ///< File upload tracking
-    std::unique_ptr<IGameParser> parser_;                            ///< Game notation parser
-    Logger& logger_;                                                 ///< Logger instance
+    RoomMap<LagEstimator> lags_;              ///< Round trip of each pinging session
+    std::mutex lags_mutex_;                   ///< Innermost lock
+    std::chrono::milliseconds max_lag_{500};  ///< Lag compensation cap
 };
\ No newline at end of file
@@ -0,0 +1,76 @@
+#include "UploadWorker.hpp"
+
+#include <algorithm>
+
+#include "GameController.hpp"
+#include "Logger.hpp"
+
+void UploadWorker::submit(GameController& room, CompletedUpload upload) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back({&room, std::move(upload)});
+
+        if (!thread_.joinable()) {
+            thread_ = std::jthread([this](std::stop_token st) { run(st); });
+        }
+    }
+    changed_.notify_all();
+}
+
+void UploadWorker::cancel(const GameController& room) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::erase_if(jobs_, [&room](const Job& job) { return job.room == &room; });
+
+    if (playing_ == &room) {
+        playing_stop_.request_stop();
+        changed_.wait(lock, [this, &room] { return playing_ != &room; });
+    }
+}
+
+size_t UploadWorker::pending(const GameController& room) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto queued = std::count_if(jobs_.begin(), jobs_.end(),
+                                [&room](const Job& job) { return job.room == &room; });
+    return static_cast<size_t>(queued) + (playing_ == &room ? 1 : 0);
+}
+
+void UploadWorker::run(std::stop_token st) {
+    auto& logger = Logger::instance();
+    logger.debug("Upload worker started");
+
+    // Stopping the worker also stops the playback in progress
+    std::stop_callback stop_playback(st, [this] {
+        std::lock_guard<std::mutex> lock(mutex_);
+        playing_stop_.request_stop();
+    });
+
+    while (true) {
+        Job job;
+        std::stop_token playback;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (!changed_.wait(lock, st, [this] { return !jobs_.empty(); })) {
+                break;  // Stop requested
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+
+            playing_ = job.room;
+            playing_stop_ = std::stop_source();
+            playback = playing_stop_.get_token();
+            if (st.stop_requested()) {
+                playing_stop_.request_stop();
+            }
+        }
+
+        job.room->playUpload(job.upload, playback);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            playing_ = nullptr;
+        }
+        changed_.notify_all();
+    }
+
+    logger.debug("Upload worker exiting");
+}
@@ -0,0 +1,84 @@
+/**
+ * @file UploadWorker.hpp
+ * @brief Thread playing back the completed uploads of every room.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <thread>
+
+class GameController;
+
+/**
+ * @struct CompletedUpload
+ * @brief Uploaded game waiting to be played back.
+ */
+struct CompletedUpload {
+    std::string session_id;  ///< Uploading session
+    std::string filename;    ///< Uploaded file name
+    std::string data;        ///< Complete file content
+    bool load = false;       ///< Load the game at once instead of playing it back
+};
+
+/**
+ * @class UploadWorker
+ * @brief One thread and one queue for the upload playback of all the rooms of a server.
+ *
+ * Playback is paced, so it can't run on the event loop, but a thread per room
+ * would leave an idle thread and its stack behind every open room. The uploads
+ * of all rooms are played one after the other instead, in the order they
+ * completed. The thread only starts with the first upload.
+ */
+class UploadWorker {
+   public:
+    UploadWorker() = default;
+    UploadWorker(const UploadWorker&) = delete;
+    UploadWorker& operator=(const UploadWorker&) = delete;
+
+    /**
+     * @brief Stop the playback in progress and the thread (queued uploads are dropped).
+     */
+    ~UploadWorker() = default;
+
+    /**
+     * @brief Queue a completed upload of a room.
+     * @param room Controller playing the upload (must call cancel() before being destroyed)
+     * @param upload Completed upload
+     */
+    void submit(GameController& room, CompletedUpload upload);
+
+    /**
+     * @brief Drop the queued uploads of a room, and stop the one it is playing, if any.
+     *
+     * Returns once the worker no longer uses the room.
+     */
+    void cancel(const GameController& room);
+
+    /**
+     * @brief Get the number of uploads of a room queued or being played.
+     */
+    size_t pending(const GameController& room) const;
+
+   private:
+    struct Job {
+        GameController* room = nullptr;
+        CompletedUpload upload;
+    };
+
+    /// Play back the queued uploads, one at a time (worker thread)
+    void run(std::stop_token st);
+
+    mutable std::mutex mutex_;
+    std::condition_variable_any changed_;  ///< New upload queued, or playback finished
+    std::deque<Job> jobs_;
+    const GameController* playing_ = nullptr;  ///< Room whose upload is played back
+    std::stop_source playing_stop_;            ///< Stops the playback in progress
+
+    std::jthread thread_;  ///< Started by the first upload (declared last: stopped first)
+};
@@ -1,13 +1,18 @@
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
+#include <sys/resource.h>
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 
 #include "Logger.hpp"
+#include "Metrics.hpp"
 #include "NetworkMode.hpp"
 #include "ParserFactory.hpp"
 #include "Server.hpp"
+#include "Warmup.hpp"
 
 using namespace std;
 
@@ -21,10 +26,51 @@ void printUsage(const string& program_name) {
         << "  -v                  Show debug level logging\n"
         << "  --parser <type>     Parser type: 'simple' or 'pgn' (default: simple)\n"
         << "  --local             Use local IPC network (instead of TCP)\n"
-        << "  --socket <socket>   Socket path (only for IPC) (default: `/tmp/chess_server.sock`)\n";
+        << "  --websocket         Serve WebSocket clients (e.g. browsers) over TCP\n"
+        << "  --socket <socket>   Socket path (only for IPC) (default: `/tmp/chess_server.sock`)\n"
+        << "  --record <file>     Record inbound session traffic for replay with `chess_replay`\n"
+        << "  --rate-limit <class>=<rate>/<burst>\n"
+        << "                      Per-session limit of a command class: move, query, control,\n"
+        << "                      upload (e.g. `move=10/20`, rate 0 for unlimited)\n"
+        << "  --rate-limit-ip <class>=<rate>/<burst>\n"
+        << "                      Same, shared by all sessions of a client IP address\n"
+        << "  --no-rate-limit     Disable rate limiting (e.g. for replays at full speed)\n"
+        << "  --max-rss-mb <MB>   Memory shedding load from 70% of it (default: not watched)\n"
+        << "  --no-overload-control\n"
+        << "                      Never shed load (uploads, spectator updates, new connections)\n"
+        << "  --compression-dict <file>\n"
+        << "                      zstd dictionary offered to clients (see `chess_dictionary`)\n"
+        << "  --compression-min <bytes>\n"
+        << "                      Smallest message compressed (default: 256)\n"
+        << "  --no-compression    Don't offer compression to clients\n"
+        << "  --resume-grace <s>  Seat hold for a disconnected player to resume (default: 30,\n"
+        << "                      0 resets the game at once)\n"
+        << "  --max-lag-ms <ms>   Most round trip not charged to a mover's clock (default: 500)\n"
+        << "  --worker <socket>   Serve the clients handed over by `chess_router` on this socket\n";
+}
+
+/**
+ * @brief Raise the open file limit to its maximum: every connection holds a descriptor.
+ */
+void raiseFileDescriptorLimit() {
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+/**
+ * @brief Convert a duration to milliseconds with a fractional part, for the logs.
+ */
+string toMilliseconds(chrono::microseconds duration) {
+    return to_string(duration.count() / 1000) + "." + to_string(duration.count() % 1000 / 100) +
+           " ms";
 }
 
 int main(int argc, char* argv[]) {
+    const auto start_time = chrono::steady_clock::now();
+
     auto& logger = Logger::instance();
 
     // Default values
@@ -33,6 +79,16 @@ int main(int argc, char* argv[]) {
     int port = 2000;
     string socket_path = "/tmp/chess_server.sock";
     ParserType parser = ParserType::SIMPLE_NOTATION;
+    string record_path;
+    RateLimits rate_limits = RateLimits::defaults();
+    bool rate_limiting = true;
+    OverloadThresholds overload_thresholds;
+    bool overload_control = true;
+    CompressionSettings compression_settings;
+    bool compression = Compression::supported();
+    int resume_grace = 30;
+    int max_lag_ms = 500;
+    string worker_channel;
 
     // Parse command line arguments
     const string program_name = argv[0];
@@ -50,8 +106,38 @@ int main(int argc, char* argv[]) {
         } else if (arg == "--local") {
             network = NetworkMode::IPC;
             logger.info("Using IPC network protocol");
+        } else if (arg == "--websocket") {
+            network = NetworkMode::WEBSOCKET;
+            logger.info("Using WebSocket network protocol");
         } else if (arg == "--socket" && i + 1 < argc) {
             socket_path = argv[++i];
+        } else if (arg == "--record" && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if ((arg == "--rate-limit" || arg == "--rate-limit-ip") && i + 1 < argc) {
+            if (!rate_limits.set(argv[++i], arg == "--rate-limit-ip")) {
+                cerr << "Invalid rate limit: " << argv[i] << "\n";
+                printUsage(program_name);
+                return 1;
+            }
+        } else if (arg == "--no-rate-limit") {
+            rate_limiting = false;
+        } else if (arg == "--max-rss-mb" && i + 1 < argc) {
+            overload_thresholds.max_rss_bytes = stoll(argv[++i]) * 1024 * 1024;
+        } else if (arg == "--no-overload-control") {
+            overload_control = false;
+        } else if (arg == "--compression-dict" && i + 1 < argc) {
+            compression_settings.dictionary_path = argv[++i];
+            compression = true;  // Fails to start without zstd support
+        } else if (arg == "--compression-min" && i + 1 < argc) {
+            compression_settings.min_size = stoul(argv[++i]);
+        } else if (arg == "--no-compression") {
+            compression = false;
+        } else if (arg == "--resume-grace" && i + 1 < argc) {
+            resume_grace = stoi(argv[++i]);
+        } else if (arg == "--max-lag-ms" && i + 1 < argc) {
+            max_lag_ms = stoi(argv[++i]);
+        } else if (arg == "--worker" && i + 1 < argc) {
+            worker_channel = argv[++i];
         } else if (arg == "--parser" && i + 1 < argc) {
             string parser_arg = argv[++i];
             if (parser_arg == "pgn") {
@@ -70,16 +156,53 @@ int main(int argc, char* argv[]) {
                     ((parser == ParserType::PGN) ? string("PGN") : string("Simple")));
         logger.info("Port: " + to_string(port));
 
+        raiseFileDescriptorLimit();
+
         Server server(network, port, parser);
 
-        if (network == NetworkMode::IPC) {
+        if (!record_path.empty()) {
+            server.enableTrafficRecording(record_path);
+        }
+
+        if (rate_limiting) {
+            server.setRateLimits(rate_limits);
+        }
+
+        if (overload_control) {
+            server.setOverloadControl(overload_thresholds);
+        }
+
+        if (compression) {
+            server.setCompression(compression_settings);
+        }
+
+        server.setResumeGrace(chrono::seconds(max(resume_grace, 0)));
+        server.setMaxLagCompensation(chrono::milliseconds(max(max_lag_ms, 0)));
+
+        // Before binding: clients can't connect until the cold paths are warm
+        WarmupReport warmup = Warmup::run();
+        logger.info("Warm-up done in " + toMilliseconds(warmup.total) +
+                    " (simple parser " + toMilliseconds(warmup.simple_parser) + ", PGN parser " +
+                    toMilliseconds(warmup.pgn_parser) + ", chess " + toMilliseconds(warmup.chess) +
+                    ", pools " + toMilliseconds(warmup.pools) + ")");
+
+        if (!worker_channel.empty()) {
+            server.start_worker(worker_channel);
+        } else if (network == NetworkMode::IPC) {
             server.start_unix(socket_path);
         } else {
             server.start(ip_address);
         }
 
+        auto time_to_ready = chrono::duration_cast<chrono::microseconds>(
+            chrono::steady_clock::now() - start_time);
+        Metrics::instance().setStartupTimes(time_to_ready, warmup.total);
+
+        string address = (network == NetworkMode::IPC) ? socket_path : ip_address;
         logger.info("Server running on address: " +
-                    ((network == NetworkMode::IPC) ? socket_path : ip_address));
+                    (worker_channel.empty() ? address : worker_channel));
+        logger.info("Ready to accept clients " + toMilliseconds(time_to_ready) +
+                    " after startup");
         cout << "Press Enter to stop..." << endl;
 
         cin.get();
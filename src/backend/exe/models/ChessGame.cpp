@@ -1,11 +1,16 @@
 #include "ChessGame.hpp"
 
+#include <algorithm>
+#include <cstdio>
 #include <sstream>
 
+#include "FenValidator.hpp"
 #include "Logger.hpp"
+#include "Metrics.hpp"
 
 ChessGame::ChessGame() : moveNumber_(1) {
     board_.setFen(chess::constants::STARTPOS);
+    refreshLegalMoves();
 }
 
 std::optional<StrikeData> ChessGame::applyMove(const ParsedMove& move) {
@@ -25,7 +30,9 @@ std::optional<StrikeData> ChessGame::applyMove(const ParsedMove& move) {
     fillStrikeDataBeforeMove(data, *chess_move);
     board_.makeMove(*chess_move);
     moveNumber_++;  // Need to manually increment move number
+    refreshLegalMoves();
     fillStrikeDataAfterMove(data, *chess_move);
+    moves_.push_back(data.uci);
 
     return data;
 }
@@ -38,34 +45,187 @@ std::string ChessGame::getFEN() const {
     return board_.getFen();
 }
 
+std::string ChessGame::getPositionHash() const {
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(board_.hash()));
+    return hex;
+}
+
+int ChessGame::getPly() const {
+    return moveNumber_ - 1;
+}
+
 void ChessGame::reset() {
-    board_.setFen(chess::constants::STARTPOS);
+    board_.setFen(start_fen_.empty() ? chess::constants::STARTPOS : start_fen_);
     moveNumber_ = 1;
+    refreshLegalMoves();
+    moves_.clear();
+}
+
+std::string_view ChessGame::setStartPosition(std::string_view fen) {
+    if (!fen.empty()) {
+        std::string_view error = fen::validate(fen);
+        if (!error.empty()) {
+            return error;
+        }
+    }
+
+    start_fen_ = fen;
+    reset();
+    return {};
+}
+
+void ChessGame::refreshLegalMoves() {
+    cached_ = false;
+    has_san_ = false;
+    has_masks_ = false;
+
+    // Past the opening, games rarely share positions: not worth caching
+    if (getPly() >= MoveCache::kMaxPly) {
+        chess::movegen::legalmoves(legal_moves_, board_);
+        return;
+    }
+
+    auto& cache = MoveCache::shared();
+    uint64_t key = board_.hash();
+
+    if (cache.lookup(key, position_)) {
+        Metrics::instance().increment(Counter::MOVE_CACHE_HITS);
+        legal_moves_.clear();
+        for (size_t i = 0; i < position_.count; ++i) {
+            legal_moves_.add(chess::Move(position_.moves[i]));
+        }
+        cached_ = true;
+        has_san_ = position_.hasSan();
+        position_key_ = key;
+        return;
+    }
+
+    Metrics::instance().increment(Counter::MOVE_CACHE_MISSES);
+    chess::movegen::legalmoves(legal_moves_, board_);
+    if (legal_moves_.size() > CachedMoves::kMaxMoves) {
+        return;
+    }
+
+    // The moves alone: their SAN costs a move generation each, only paid by SAN lookups
+    position_.count = static_cast<uint8_t>(legal_moves_.size());
+    for (size_t i = 0; i < legal_moves_.size(); ++i) {
+        position_.moves[i] = legal_moves_[i].move();
+    }
+    position_.san = {};
+
+    cache.store(key, position_);
+    cached_ = true;
+    position_key_ = key;
 }
 
-bool ChessGame::isGameOver() const {
-    auto [reason, result] = board_.isGameOver();
-    return result == chess::GameResult::LOSE;
+void ChessGame::fillSan() {
+    if (!cached_ || has_san_) {
+        return;
+    }
+
+    for (size_t i = 0; i < position_.count; ++i) {
+        std::string san = chess::uci::moveToSan(board_, legal_moves_[i]);
+        if (san.size() > CachedMoves::kSanSize) {
+            position_.san = {};
+            cached_ = false;
+            return;
+        }
+        position_.san[i] = {};
+        std::copy(san.begin(), san.end(), position_.san[i].begin());
+    }
+
+    // The next games reaching the position get its SAN too
+    MoveCache::shared().store(position_key_, position_);
+    has_san_ = true;
+}
+
+const MoveMasks& ChessGame::getLegalMoveMasks() {
+    if (has_masks_) {
+        return masks_;
+    }
+
+    masks_ = MoveMasks{};
+    for (const auto& move : legal_moves_) {
+        int from = move.from().index();
+        int to = move.to().index();
+        // The library encodes castling as the king taking its rook: clients expect e1g1
+        if (move.typeOf() == chess::Move::CASTLING) {
+            to = to > from ? from + 2 : from - 2;
+        }
+        masks_.add(from, to);
+    }
+
+    has_masks_ = true;
+    return masks_;
+}
+
+bool ChessGame::replayMoves(const std::vector<std::string>& moves) {
+    reset();
+
+    for (const auto& uci : moves) {
+        auto move = std::find_if(legal_moves_.begin(), legal_moves_.end(),
+                                 [&uci](const chess::Move& m) {
+                                     return chess::uci::moveToUci(m) == uci;
+                                 });
+        if (move == legal_moves_.end()) {
+            reset();
+            return false;
+        }
+
+        board_.makeMove(*move);
+        moveNumber_++;
+        refreshLegalMoves();
+        moves_.push_back(uci);
+    }
+
+    return true;
+}
+
+size_t ChessGame::playMoves(const std::vector<ParsedMove>& moves) {
+    size_t played = 0;
+
+    for (const auto& parsed : moves) {
+        if (isOver()) {
+            break;
+        }
+
+        auto move = parsed.is_san ? findMoveFromSan(parsed.notation)
+                                  : findMove(parsed.from, parsed.to);
+        if (!move) {
+            break;
+        }
+
+        board_.makeMove(*move);
+        moveNumber_++;
+        refreshLegalMoves();
+        moves_.push_back(chess::uci::moveToUci(*move));
+        ++played;
+    }
+
+    return played;
 }
 
 bool ChessGame::inCheck() const {
     return board_.inCheck();
 }
 
+// Same outcomes as board_.isGameOver(), which would generate the legal moves again
+
 bool ChessGame::isCheckmate() const {
-    auto [reason, result] = board_.isGameOver();
-    return result == chess::GameResult::LOSE;
+    return legal_moves_.empty() && inCheck();
 }
 
 bool ChessGame::isStalemate() const {
-    auto [reason, result] = board_.isGameOver();
-    return result == chess::GameResult::DRAW;
+    if (legal_moves_.empty()) {
+        return !inCheck();
+    }
+    return board_.isHalfMoveDraw() || board_.isInsufficientMaterial() || board_.isRepetition();
 }
 
 std::optional<chess::Move> ChessGame::findMove(const std::string& from,
                                                const std::string& to) const {
-    chess::Movelist moves;
-    chess::movegen::legalmoves(moves, board_);
+    const auto& moves = legal_moves_;
 
     chess::Square from_sq(from);
     chess::Square to_sq(to);
@@ -92,14 +252,18 @@ std::optional<chess::Move> ChessGame::findMove(const std::string& from,
     return std::nullopt;
 }
 
-std::optional<chess::Move> ChessGame::findMoveFromSan(const std::string& san_move) const {
-    chess::Movelist moves;
-    chess::movegen::legalmoves(moves, board_);
+std::optional<chess::Move> ChessGame::findMoveFromSan(const std::string& san_move) {
+    fillSan();
+    const auto& moves = legal_moves_;
+
+    for (size_t i = 0; i < moves.size(); ++i) {
+        const auto& move = moves[i];
 
-    for (const auto& move : moves) {
         // The library provides a utility to convert a Move object + Board State -> SAN string
-        // We generate the SAN for every legal move and see if it matches the user input.
-        std::string generatedSan = chess::uci::moveToSan(board_, move);
+        // We generate the SAN for every legal move (unless cached) and see if it matches the
+        // user input.
+        std::string generatedSan = has_san_ ? std::string(position_.sanOf(i))
+                                            : chess::uci::moveToSan(board_, move);
 
         // 1. Direct Match (Most accurate)
         if (generatedSan == san_move) {
@@ -137,13 +301,16 @@ void ChessGame::fillStrikeDataBeforeMove(StrikeData& data, const chess::Move& mo
 
     data.is_capture = (captured != chess::Piece::NONE);
 
+    // From the board rather than the ply: a custom start position may have black to move
+    bool white_to_move = board_.sideToMove() == chess::Color::WHITE;
+
     if (data.is_capture) {
-        data.captured_color = (moveNumber_ % 2 == 1) ? "black" : "white";
+        data.captured_color = white_to_move ? "black" : "white";
         data.captured_piece = getPieceName(captured.type());
     }
 
     data.strike_number = moveNumber_;
-    data.color = (moveNumber_ % 2 == 1) ? "white" : "black";
+    data.color = white_to_move ? "white" : "black";
 }
 
 // TODO: consider returning a variable copy rather than passing the variable by
@@ -151,6 +318,7 @@ void ChessGame::fillStrikeDataBeforeMove(StrikeData& data, const chess::Move& mo
 void ChessGame::fillStrikeDataAfterMove(StrikeData& data, const chess::Move& move) const {
     data.case_src = std::string(move.from());
     data.case_dest = std::string(move.to());
+    data.uci = chess::uci::moveToUci(move);
     data.piece = getPieceName(board_.at(move.to()).type());
 
     data.is_check = inCheck();
@@ -1,9 +1,13 @@
 #pragma once
 
 #include <chess.hpp>
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <vector>
 
+#include "MoveCache.hpp"
+#include "MoveMasks.hpp"
 #include "ParserFactory.hpp"
 #include "StrikeData.hpp"
 
@@ -13,6 +17,13 @@
  * This class is a thin wrapper for the `chess.hpp` library
  * (https://github.com/Disservin/chess-library) which manages some internal
  * chess board states.
+ *
+ * The legal moves of the current position are generated once, right after
+ * each move: they give the check, checkmate and stalemate of the strike data,
+ * and the next move is looked up in them. In the opening, they're copied
+ * from the MoveCache shared by all games, when another game already went
+ * through the position. Their SAN is only computed by the first SAN lookup
+ * in the position, and shared through the cache in turn.
  */
 class ChessGame {
    public:
@@ -34,31 +45,111 @@ class ChessGame {
      */
     std::string getFEN() const;
 
+    /**
+     * @brief Get Zobrist hash of current position (Polyglot keys)
+     * @return 16 hex digits: a string, since JSON numbers lose 64-bit precision in clients
+     */
+    std::string getPositionHash() const;
+
+    /**
+     * @brief Get number of half-moves played since the start
+     */
+    int getPly() const;
+
     /**
      * @brief Get ASCII representation of board
      */
     std::string getBoardFormatted() const;
 
     /**
-     * @brief Reset to starting position
+     * @brief Get the moves played since the start, in UCI notation
+     */
+    const std::vector<std::string>& getMoves() const { return moves_; }
+
+    /**
+     * @brief Reset, then play moves from the start position (e.g. a migrated game)
+     *
+     * Replaying rather than setting the FEN keeps the position history, on
+     * which repetition draws depend.
+     *
+     * @param moves Moves in UCI notation
+     * @return False if a move is illegal (the game is then reset)
+     */
+    bool replayMoves(const std::vector<std::string>& moves);
+
+    /**
+     * @brief Play moves without building their strike data (e.g. a whole game loaded at once)
+     *
+     * Stops at the first illegal move, or once the game is over.
+     *
+     * @param moves Parsed moves
+     * @return Number of moves played
+     */
+    size_t playMoves(const std::vector<ParsedMove>& moves);
+
+    /**
+     * @brief Check whether the game is over: checkmate or any draw
+     */
+    bool isOver() const { return isCheckmate() || isStalemate(); }
+
+    // Game state queries (from the legal moves of the position, no move generation)
+    bool isCheckmate() const;
+    bool isStalemate() const;  ///< Any draw: stalemate, repetition, 50 moves, material
+
+    /**
+     * @brief Reset to the start position of the game
      */
     void reset();
 
+    /**
+     * @brief Start the game from another position (e.g. a puzzle or an adjourned game)
+     *
+     * The FEN is validated first (see FenValidator.hpp), so an illegal position
+     * never reaches the board. The game is then reset to it, and so are later resets.
+     *
+     * @param fen Start position, empty for the standard one
+     * @return Error message, empty if the position was set
+     */
+    std::string_view setStartPosition(std::string_view fen);
+
+    /**
+     * @brief Get the start position set by setStartPosition() (empty for the standard one)
+     */
+    const std::string& getStartFen() const { return start_fen_; }
+
+    /**
+     * @brief Get the legal moves of the current position as destination bitmasks
+     *
+     * Built from the legal moves already generated for the position (no move
+     * generation), on the first request of each ply.
+     */
+    const MoveMasks& getLegalMoveMasks();
+
    private:
-    // Internal state queries
-    bool isGameOver() const;
     bool inCheck() const;
-    bool isCheckmate() const;
-    bool isStalemate() const;
+
+    void refreshLegalMoves();  ///< After every change of position
 
     // Helper methods
     std::optional<chess::Move> findMove(const std::string& from, const std::string& to) const;
-    std::optional<chess::Move> findMoveFromSan(const std::string& san_move) const;
+    std::optional<chess::Move> findMoveFromSan(const std::string& san_move);
+
+    /// Compute the SAN of position_ and publish it to the MoveCache, on the first SAN lookup
+    void fillSan();
 
     void fillStrikeDataBeforeMove(StrikeData& data, const chess::Move& move) const;
     void fillStrikeDataAfterMove(StrikeData& data, const chess::Move& move) const;
     std::string getPieceName(chess::PieceType type) const;
 
     chess::Board board_;
-    int moveNumber_;
+    chess::Movelist legal_moves_;  ///< Legal moves of board_ (the only move generation)
+    CachedMoves position_;         ///< legal_moves_ with their SAN, if has_san_
+    bool cached_ = false;          ///< position_ matches the current position
+    bool has_san_ = false;         ///< position_ has the SAN of the current position
+    uint64_t position_key_ = 0;    ///< Zobrist hash of position_, if cached_
+    MoveMasks masks_;              ///< legal_moves_ as bitmasks, if has_masks_
+    bool has_masks_ = false;       ///< masks_ matches the current position
+    int moveNumber_;                  ///< Ply from the start position, plus one
+    std::string start_fen_;           ///< Custom start position (empty: standard)
+    std::vector<std::string> moves_;  ///< Moves played since the start (UCI)
 };
\ No newline at end of file
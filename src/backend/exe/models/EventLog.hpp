@@ -0,0 +1,150 @@
+/**
+ * @file EventLog.hpp
+ * @brief Bounded log of the events broadcast in a room, numbered for resync.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class EventLog
+ * @brief Ring buffer of the latest broadcast messages, each one stamped with its sequence number.
+ *
+ * Sequence numbers start at 1 and never go back, even across game resets, so a
+ * client only needs to remember the last one it saw. A client that comes back
+ * with a number still covered by the log is sent the missed events; one that
+ * fell further behind needs a snapshot instead.
+ *
+ * The slots are only allocated with the first event, so opening a room that
+ * never broadcasts costs no allocation.
+ *
+ * Not thread-safe: the owner serialises appends and replays, and sends each
+ * event while still holding its lock so clients receive them in order.
+ */
+class EventLog {
+   public:
+    static constexpr size_t kDefaultCapacity = 256;  ///< Events kept (about a 128-move game)
+
+    /**
+     * @brief Create an empty log.
+     * @param capacity Number of events kept (at least 1)
+     */
+    explicit EventLog(size_t capacity = kDefaultCapacity)
+        : capacity_(capacity > 0 ? capacity : 1) {}
+
+    /**
+     * @brief Add `"seq":<n>` as the first member of a JSON object, without parsing it.
+     * @param message Serialised JSON object
+     * @param seq Sequence number
+     * @return Stamped message
+     */
+    static std::string stamp(std::string_view message, uint64_t seq) {
+        std::string stamped = "{\"seq\":" + std::to_string(seq);
+        if (message.size() < 2 || message.front() != '{') {
+            return stamped + "}";
+        }
+
+        std::string_view members = message.substr(1);
+        if (members.front() != '}') {
+            stamped += ',';
+        }
+        stamped += members;
+        return stamped;
+    }
+
+    /**
+     * @brief Number and store a new event, replacing the oldest one when full.
+     * @param message Serialised JSON object
+     * @return Stamped message, to broadcast
+     */
+    const std::string& append(std::string_view message) {
+        if (events_.empty()) {
+            events_.resize(capacity_);
+        }
+        ++last_seq_;
+        std::string& slot = events_[last_seq_ % capacity_];
+        slot = stamp(message, last_seq_);
+        return slot;
+    }
+
+    /**
+     * @brief Sequence number of the latest event (0 if none yet).
+     */
+    uint64_t lastSequence() const { return last_seq_; }
+
+    /**
+     * @brief Sequence number of the oldest event still kept (0 if none yet).
+     */
+    uint64_t firstSequence() const {
+        if (last_seq_ == 0) {
+            return 0;
+        }
+        return last_seq_ >= capacity_ ? last_seq_ - capacity_ + 1 : 1;
+    }
+
+    /**
+     * @brief Serialise the events following a sequence number as a JSON array.
+     * @param seq Last sequence number seen by the client
+     * @return Array of the missed events (possibly empty), or nullopt if some of
+     *         them were dropped or the number is unknown (the client needs a snapshot)
+     */
+    std::optional<std::string> replaySince(uint64_t seq) const {
+        if (seq > last_seq_ || (seq < last_seq_ && seq + 1 < firstSequence())) {
+            return std::nullopt;
+        }
+
+        std::string array = "[";
+        for (uint64_t next = seq + 1; next <= last_seq_; ++next) {
+            if (next > seq + 1) {
+                array += ',';
+            }
+            array += events_[next % capacity_];
+        }
+        array += ']';
+        return array;
+    }
+
+    /**
+     * @brief Number of events a replay since a sequence number would send.
+     */
+    uint64_t missedSince(uint64_t seq) const { return seq < last_seq_ ? last_seq_ - seq : 0; }
+
+    /**
+     * @brief Copy the events still kept, oldest first (e.g. to migrate the room).
+     */
+    std::vector<std::string> entries() const {
+        std::vector<std::string> kept;
+        for (uint64_t seq = firstSequence(); seq != 0 && seq <= last_seq_; ++seq) {
+            kept.push_back(events_[seq % capacity_]);
+        }
+        return kept;
+    }
+
+    /**
+     * @brief Replace the content of the log, so numbering carries on where another log stopped.
+     * @param last_seq Sequence number of the latest event
+     * @param entries Stamped events up to last_seq, oldest first (extra old ones are dropped)
+     */
+    void restore(uint64_t last_seq, const std::vector<std::string>& entries) {
+        events_.assign(last_seq > 0 ? capacity_ : 0, std::string());
+        last_seq_ = last_seq;
+
+        size_t count = std::min<size_t>({entries.size(), capacity_, last_seq});
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t seq = last_seq - i;
+            events_[seq % capacity_] = entries[entries.size() - 1 - i];
+        }
+    }
+
+   private:
+    std::vector<std::string> events_;  ///< Slot of event n: n % capacity (empty until the first)
+    size_t capacity_;                  ///< Events kept
+    uint64_t last_seq_ = 0;            ///< Sequence number of the latest event
+};
@@ -0,0 +1,269 @@
+/**
+ * @file FenValidator.hpp
+ * @brief Validation of FEN and EPD positions, before they're loaded into a board.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace fen {
+
+/// Square contents, indexed by rank * 8 + file (a1 = 0, h8 = 63); '.' for empty.
+using Squares = std::array<char, 64>;
+
+/**
+ * @brief Split the next space-separated field off a FEN.
+ */
+constexpr std::string_view nextField(std::string_view& text) {
+    size_t start = text.find_first_not_of(' ');
+    if (start == std::string_view::npos) {
+        text = {};
+        return {};
+    }
+    text.remove_prefix(start);
+    size_t end = text.find(' ');
+    std::string_view field = text.substr(0, end);
+    text.remove_prefix(end == std::string_view::npos ? text.size() : end);
+    return field;
+}
+
+constexpr bool isCounter(std::string_view field) {
+    if (field.empty() || field.size() > 6) {
+        return false;
+    }
+    for (char c : field) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+    }
+    return true;
+}
+
+constexpr char pieceOf(char piece, bool white) {
+    return white ? static_cast<char>(piece - 'a' + 'A') : piece;
+}
+
+/**
+ * @brief Check whether a square is attacked by a side.
+ * @param squares Board
+ * @param square Target square index
+ * @param white True for the white pieces
+ */
+constexpr bool isAttacked(const Squares& squares, int square, bool white) {
+    int rank = square / 8;
+    int file = square % 8;
+
+    auto at = [&squares](int r, int f) -> char {
+        return (r < 0 || r > 7 || f < 0 || f > 7) ? '\0' : squares[r * 8 + f];
+    };
+
+    // Pawns attack forward diagonally: a white pawn hits the square from the rank below
+    int pawn_rank = white ? rank - 1 : rank + 1;
+    if (at(pawn_rank, file - 1) == pieceOf('p', white) ||
+        at(pawn_rank, file + 1) == pieceOf('p', white)) {
+        return true;
+    }
+
+    constexpr std::array<std::array<int, 2>, 8> kKnight = {
+        {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}}};
+    constexpr std::array<std::array<int, 2>, 8> kKing = {
+        {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}}};
+
+    for (const auto& [dr, df] : kKnight) {
+        if (at(rank + dr, file + df) == pieceOf('n', white)) {
+            return true;
+        }
+    }
+    for (const auto& [dr, df] : kKing) {
+        if (at(rank + dr, file + df) == pieceOf('k', white)) {
+            return true;
+        }
+    }
+
+    // Sliders: the same directions as the king, rooks along lines, bishops along diagonals
+    for (const auto& [dr, df] : kKing) {
+        bool diagonal = dr != 0 && df != 0;
+        char slider = pieceOf(diagonal ? 'b' : 'r', white);
+        for (int r = rank + dr, f = file + df; at(r, f) != '\0'; r += dr, f += df) {
+            char piece = at(r, f);
+            if (piece == '.') {
+                continue;
+            }
+            if (piece == slider || piece == pieceOf('q', white)) {
+                return true;
+            }
+            break;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Check that a FEN describes a legal position, without exceptions nor allocations.
+ *
+ * Accepts the 4 position fields of EPD, with or without the 2 move counters.
+ * Rejects malformed fields, a count of kings other than one per side, pawns on
+ * the first or last rank, more than 16 pieces or 8 pawns per side, castling
+ * rights without their king and rook, en passant squares no pawn could have
+ * skipped, and the side that just moved left in check.
+ *
+ * @param text FEN
+ * @return Error message, empty if the position is legal
+ */
+constexpr std::string_view validate(std::string_view text) {
+    std::string_view placement = nextField(text);
+    std::string_view side = nextField(text);
+    std::string_view castling = nextField(text);
+    std::string_view en_passant = nextField(text);
+    std::string_view halfmove = nextField(text);
+    std::string_view fullmove = nextField(text);
+
+    if (en_passant.empty()) {
+        return "Missing FEN fields";
+    }
+    if (!nextField(text).empty()) {
+        return "Too many FEN fields";
+    }
+
+    // Piece placement, from rank 8 down to rank 1
+    Squares squares{};
+    int rank = 7;
+    int file = 0;
+    std::array<int, 2> pieces{};  // Black, white
+    std::array<int, 2> pawns{};
+    std::array<int, 2> kings{};
+    std::array<int, 2> king_square{};
+
+    for (char c : placement) {
+        if (c == '/') {
+            if (file != 8 || rank == 0) {
+                return "Invalid rank in FEN";
+            }
+            --rank;
+            file = 0;
+        } else if (c >= '1' && c <= '8') {
+            for (int i = 0; i < c - '0'; ++i) {
+                if (file > 7) {
+                    return "Invalid rank in FEN";
+                }
+                squares[rank * 8 + file++] = '.';
+            }
+        } else {
+            bool white = c >= 'A' && c <= 'Z';
+            char type = white ? static_cast<char>(c - 'A' + 'a') : c;
+            if (std::string_view("pnbrqk").find(type) == std::string_view::npos || file > 7) {
+                return "Invalid piece placement in FEN";
+            }
+            if (type == 'p' && (rank == 0 || rank == 7)) {
+                return "Pawn on the first or last rank";
+            }
+            if (type == 'p') {
+                ++pawns[white];
+            }
+            if (type == 'k') {
+                ++kings[white];
+                king_square[white] = rank * 8 + file;
+            }
+            ++pieces[white];
+            squares[rank * 8 + file++] = c;
+        }
+    }
+    if (rank != 0 || file != 8) {
+        return "Invalid piece placement in FEN";
+    }
+    if (kings[0] != 1 || kings[1] != 1) {
+        return "Each side needs exactly one king";
+    }
+    if (pieces[0] > 16 || pieces[1] > 16 || pawns[0] > 8 || pawns[1] > 8) {
+        return "Too many pieces";
+    }
+
+    if (side != "w" && side != "b") {
+        return "Invalid side to move";
+    }
+    bool white_to_move = side == "w";
+
+    // The side that just moved can't have left its king in check
+    if (isAttacked(squares, king_square[!white_to_move], white_to_move)) {
+        return "Side not to move is in check";
+    }
+
+    if (castling != "-") {
+        if (castling.empty() || castling.size() > 4) {
+            return "Invalid castling rights";
+        }
+        std::string_view order = "KQkq";
+        size_t next = 0;  // Rights are listed once each, in this order
+        for (char c : castling) {
+            size_t index = order.find(c, next);
+            if (index == std::string_view::npos) {
+                return "Invalid castling rights";
+            }
+            next = index + 1;
+
+            bool white = index < 2;
+            int home = white ? 0 : 56;
+            int rook = home + (index % 2 == 0 ? 7 : 0);
+            if (squares[home + 4] != pieceOf('k', white) || squares[rook] != pieceOf('r', white)) {
+                return "Castling rights without king and rook";
+            }
+        }
+    }
+
+    if (en_passant != "-") {
+        if (en_passant.size() != 2 || en_passant[0] < 'a' || en_passant[0] > 'h') {
+            return "Invalid en passant square";
+        }
+
+        // The pawn of the side that just moved skipped this square
+        int ep_rank = white_to_move ? 5 : 2;
+        int ep_file = en_passant[0] - 'a';
+        int pawn_rank = white_to_move ? 4 : 3;
+        int start_rank = white_to_move ? 6 : 1;
+        if (en_passant[1] - '1' != ep_rank ||
+            squares[pawn_rank * 8 + ep_file] != pieceOf('p', !white_to_move) ||
+            squares[ep_rank * 8 + ep_file] != '.' || squares[start_rank * 8 + ep_file] != '.') {
+            return "Invalid en passant square";
+        }
+    }
+
+    if (!halfmove.empty() && (!isCounter(halfmove) || !isCounter(fullmove) || fullmove == "0")) {
+        return "Invalid move counters";
+    }
+
+    return {};
+}
+
+/**
+ * @brief Get the FEN of an EPD record (its 4 position fields, move counters reset).
+ * @param line EPD line, possibly with operations (`bm`, `id`, ...)
+ * @return FEN, or nullopt for a blank or comment line
+ */
+inline std::optional<std::string> fromEpd(std::string_view line) {
+    if (line.empty() || line.front() == '#') {
+        return std::nullopt;
+    }
+
+    std::string fen;
+    for (int i = 0; i < 4; ++i) {
+        std::string_view field = nextField(line);
+        if (field.empty()) {
+            // Incomplete records are left for the validation to reject
+            return i == 0 ? std::nullopt : std::optional<std::string>(fen);
+        }
+        if (i > 0) {
+            fen += ' ';
+        }
+        fen += field;
+    }
+    return fen + " 0 1";
+}
+
+}  // namespace fen
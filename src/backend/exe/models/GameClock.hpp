@@ -0,0 +1,172 @@
+/**
+ * @file GameClock.hpp
+ * @brief Chess clock of a game, charged from the server-side receive times of the moves.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+/**
+ * @struct TimeControl
+ * @brief Time of each side at the start, and time added after each move.
+ */
+struct TimeControl {
+    static constexpr int64_t kMaxMs = 24 * 60 * 60 * 1000;  ///< Longest base time or increment
+
+    int64_t base_ms = 0;       ///< 0: untimed game
+    int64_t increment_ms = 0;  ///< Fischer increment
+
+    /**
+     * @brief Make a time control from the values sent by a client.
+     *
+     * Bounding them keeps every clock computation in nanoseconds far from overflowing.
+     *
+     * @return Time control, or nullopt if a value exceeds kMaxMs
+     */
+    static constexpr std::optional<TimeControl> fromClient(uint64_t base_ms,
+                                                           uint64_t increment_ms) {
+        if (base_ms > kMaxMs || increment_ms > kMaxMs) {
+            return std::nullopt;
+        }
+        return TimeControl{static_cast<int64_t>(base_ms), static_cast<int64_t>(increment_ms)};
+    }
+};
+
+/**
+ * @struct MoveTiming
+ * @brief When the server received a move, and the lag of its sender to compensate.
+ */
+struct MoveTiming {
+    int64_t received_ns = 0;  ///< Steady clock, read once per socket read (0: unknown)
+    int64_t lag_ns = 0;       ///< Round trip of the sender, already capped
+};
+
+/**
+ * @class GameClock
+ * @brief Remaining time of both sides, without timers.
+ *
+ * A turn starts when the previous move was received. The mover is charged the
+ * time until its own move was received, less its measured round trip: the
+ * position took half of it to reach the client and the move the other half to
+ * come back, and neither is thinking time. A flag falls when the side to move
+ * has no time left at the next move received from either player, so nothing
+ * runs on the server between moves.
+ */
+class GameClock {
+   public:
+    /**
+     * @brief Current time on the steady clock, in nanoseconds (same clock as the receive times).
+     */
+    static int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    /**
+     * @brief Start the clock of a new game.
+     * @param control Time control (base 0: no clock)
+     * @param white_to_move Side to move in the start position
+     * @param now_ns Start of the first turn
+     */
+    void start(const TimeControl& control, bool white_to_move, int64_t now_ns) {
+        enabled_ = control.base_ms > 0;
+        remaining_ns_.fill(control.base_ms * 1'000'000);
+        increment_ns_ = control.increment_ms * 1'000'000;
+        turn_start_ns_ = now_ns;
+        white_to_move_ = white_to_move;
+    }
+
+    /**
+     * @brief Stop the clock (untimed game).
+     */
+    void stop() { enabled_ = false; }
+
+    /**
+     * @brief Check whether the game is timed.
+     */
+    bool enabled() const { return enabled_; }
+
+    /**
+     * @brief Get the time left to a side.
+     * @param white True for white
+     * @param timing Time to read the clock at, and lag not charged to the side to move
+     * @return Nanoseconds, negative once the flag fell
+     */
+    int64_t remaining(bool white, const MoveTiming& timing) const {
+        int64_t left = remaining_ns_[white ? 0 : 1];
+        if (white == white_to_move_) {
+            left -= charged(timing);
+        }
+        return left;
+    }
+
+    /**
+     * @brief Check whether the side to move ran out of time.
+     */
+    bool flagged(const MoveTiming& timing) const {
+        return enabled() && remaining(white_to_move_, timing) < 0;
+    }
+
+    /**
+     * @brief Charge the side to move for the move received, add its increment and switch sides.
+     * @param timing Receive time of the move and lag of its sender
+     */
+    void punch(const MoveTiming& timing) {
+        if (!enabled()) {
+            return;
+        }
+        remaining_ns_[white_to_move_ ? 0 : 1] += increment_ns_ - charged(timing);
+        turn_start_ns_ = std::max(turn_start_ns_, timing.received_ns);
+        white_to_move_ = !white_to_move_;
+    }
+
+    /**
+     * @brief Get the time a side had at the start of the current turn, in nanoseconds.
+     */
+    int64_t banked(bool white) const { return remaining_ns_[white ? 0 : 1]; }
+
+    /**
+     * @brief Check whether white is to move on the clock.
+     */
+    bool whiteToMove() const { return white_to_move_; }
+
+    /**
+     * @brief Get the increment, in nanoseconds.
+     */
+    int64_t increment() const { return increment_ns_; }
+
+    /**
+     * @brief Get the start of the current turn, on the steady clock.
+     */
+    int64_t turnStart() const { return turn_start_ns_; }
+
+    /**
+     * @brief Restore a clock saved from banked(), increment(), turnStart() and whiteToMove().
+     */
+    void restore(int64_t white_ns, int64_t black_ns, int64_t increment_ns, int64_t turn_start_ns,
+                 bool white_to_move) {
+        enabled_ = true;
+        remaining_ns_ = {white_ns, black_ns};
+        increment_ns_ = increment_ns;
+        turn_start_ns_ = turn_start_ns;
+        white_to_move_ = white_to_move;
+    }
+
+   private:
+    /// Thinking time of the side to move: never negative, lag compensated
+    int64_t charged(const MoveTiming& timing) const {
+        return std::max<int64_t>(0, timing.received_ns - turn_start_ns_ - timing.lag_ns);
+    }
+
+    bool enabled_ = false;
+    std::array<int64_t, 2> remaining_ns_{};  ///< White, black, at the start of the turn
+    int64_t increment_ns_ = 0;
+    int64_t turn_start_ns_ = 0;
+    bool white_to_move_ = true;
+};
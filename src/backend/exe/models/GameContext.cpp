@@ -1,11 +1,11 @@
 #include "GameContext.hpp"
 
-#include "GameState.hpp"
+#include <algorithm>
+
 #include "Logger.hpp"
+#include "Metrics.hpp"
 
-GameContext::GameContext()
-    : current_state_(std::make_unique<WaitingForPlayersState>()),
-      chess_game_(std::make_unique<ChessGame>()) {
+GameContext::GameContext() {
     auto& logger = Logger::instance();
     logger.info("GameContext initialised");
 }
@@ -22,15 +22,123 @@ void GameContext::unicast(const std::string& session_id, const std::string& mess
 }
 
 void GameContext::broadcastToAll(const std::string& session_id, const std::string& message) {
+    std::lock_guard<std::mutex> lock(events_mutex_);
+    const std::string& event = events_.append(message);
+
     if (broadcast_callback_) {
-        broadcast_callback_(session_id, message, true);
+        broadcast_callback_(session_id, event, true, std::string());
     }
 }
 
 void GameContext::broadcastToOthers(const std::string& session_id, const std::string& message) {
+    std::lock_guard<std::mutex> lock(events_mutex_);
+    const std::string& event = events_.append(message);
+
     if (broadcast_callback_) {
-        broadcast_callback_(session_id, message, false);
+        broadcast_callback_(session_id, event, false, std::string());
+    }
+}
+
+void GameContext::broadcastMove(const std::string& session_id, const std::string& message,
+                                const std::string& delta) {
+    std::lock_guard<std::mutex> lock(events_mutex_);
+    const std::string& event = events_.append(message);
+
+    if (broadcast_callback_) {
+        broadcast_callback_(session_id, event, false,
+                            EventLog::stamp(delta, events_.lastSequence()));
+    }
+}
+
+uint64_t GameContext::lastSequence() const {
+    std::lock_guard<std::mutex> lock(events_mutex_);
+    return events_.lastSequence();
+}
+
+void GameContext::resync(const std::string& session_id, uint64_t since) {
+    std::lock_guard<std::mutex> lock(events_mutex_);
+    uint64_t last = events_.lastSequence();
+
+    // Unicast under the lock: a later broadcast can't overtake the answer
+    if (auto events = events_.replaySince(since)) {
+        Metrics::instance().increment(Counter::EVENTS_REPLAYED, events_.missedSince(since));
+        unicast(session_id, R"({"type":"resync","seq":)" + std::to_string(last) +
+                                R"(,"events":)" + *events + "}");
+        return;
+    }
+
+    Logger::instance().debug("Session " + session_id + " too far behind (seq " +
+                             std::to_string(since) + "), sending snapshot");
+    Metrics::instance().increment(Counter::RESYNC_SNAPSHOTS);
+
+    json snapshot = buildSnapshot(last);
+    snapshot["resync"] = true;
+    unicast(session_id, snapshot.dump());
+}
+
+json GameContext::exportState() const {
+    json state = {{"state", stateName(state_)},
+                  {"start_fen", chess_game_.getStartFen()},
+                  {"white", getWhitePlayer()},
+                  {"black", getBlackPlayer()},
+                  {"moves", chess_game_.getMoves()},
+                  {"timer_started", timer_started_}};
+
+    if (timer_started_) {
+        auto elapsed = std::chrono::steady_clock::now() - game_start_time_;
+        state["elapsed_ms"] =
+            std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+    }
+
+    if (clock_.enabled()) {
+        state["clock"] = {{"white_ms", clock_.banked(true) / 1'000'000},
+                          {"black_ms", clock_.banked(false) / 1'000'000},
+                          {"increment_ms", clock_.increment() / 1'000'000},
+                          {"turn_ms", (GameClock::now() - clock_.turnStart()) / 1'000'000},
+                          {"white_to_move", clock_.whiteToMove()}};
+    }
+
+    std::lock_guard<std::mutex> lock(events_mutex_);
+    state["seq"] = events_.lastSequence();
+    state["events"] = events_.entries();
+    return state;
+}
+
+void GameContext::importState(const json& state) {
+    std::string name = state.at("state").get<std::string>();
+    auto game_state = parseGameState(name);
+    if (!game_state) {
+        throw std::runtime_error("Unknown game state: " + name);
+    }
+
+    std::string_view fen_error = chess_game_.setStartPosition(state.value("start_fen", ""));
+    if (!fen_error.empty()) {
+        throw std::runtime_error("Invalid start position: " + std::string(fen_error));
+    }
+    if (!chess_game_.replayMoves(state.at("moves").get<std::vector<std::string>>())) {
+        throw std::runtime_error("Illegal move in the imported game");
     }
+
+    setWhitePlayer(state.at("white").get<std::string>());
+    setBlackPlayer(state.at("black").get<std::string>());
+    state_ = *game_state;
+
+    timer_started_ = state.value("timer_started", false);
+    game_start_time_ = std::chrono::steady_clock::now() -
+                       std::chrono::milliseconds(state.value("elapsed_ms", int64_t{0}));
+
+    if (state.contains("clock")) {
+        const json& clock = state["clock"];
+        clock_.restore(clock.at("white_ms").get<int64_t>() * 1'000'000,
+                       clock.at("black_ms").get<int64_t>() * 1'000'000,
+                       clock.at("increment_ms").get<int64_t>() * 1'000'000,
+                       GameClock::now() - clock.at("turn_ms").get<int64_t>() * 1'000'000,
+                       clock.at("white_to_move").get<bool>());
+    }
+
+    std::lock_guard<std::mutex> lock(events_mutex_);
+    events_.restore(state.at("seq").get<uint64_t>(),
+                    state.at("events").get<std::vector<std::string>>());
 }
 
 void GameContext::startGameTimer() {
@@ -52,18 +160,21 @@ int GameContext::getElapsedSeconds() const {
 json GameContext::resetGame(const std::string& player_id) {
     auto& logger = Logger::instance();
     logger.info("Game reset requested by: " + (player_id.empty() ? "system" : player_id));
+    Metrics::instance().increment(Counter::GAME_RESETS);
 
     // Clear players
     setWhitePlayer("");
     setBlackPlayer("");
 
-    // Reset chess game state
-    if (chess_game_) {
-        chess_game_->reset();
+    // Reset chess game state, back to the standard start position
+    chess_game_.setStartPosition({});
+    for (auto& queue : premoves_) {
+        queue.clear();
     }
+    clock_.stop();
 
     // Reset and go back to waiting
-    transitionTo(std::make_unique<WaitingForPlayersState>());
+    transitionTo(GameEvent::Reset);
 
     return json{{"type", "game_reset"}, {"status", "Waiting for new players"}};
 
@@ -86,65 +197,169 @@ json GameContext::resetGame(const std::string& player_id) {
     return end_response;
 }
 
-void GameContext::transitionTo(std::unique_ptr<IGameState> new_state) {
-    std::string old_state = current_state_->getStateName();
-    current_state_ = std::move(new_state);
-    std::string new_state_name = current_state_->getStateName();
+void GameContext::transitionTo(GameEvent event) {
+    GameState old_state = state_;
+    state_ = nextState(state_, event);
 
     auto& logger = Logger::instance();
-    logger.debug("State transition: " + old_state + " -> " + new_state_name);
+    logger.debug("State transition: " + std::string(stateName(old_state)) + " -> " +
+                 std::string(stateName(state_)));
 }
 
 json GameContext::handleJoinRequest(const std::string& player_id, const std::string& color) {
-    return current_state_->handleJoinRequest(this, player_id, color);
+    if (!accepts(state_, GameCommand::Join)) {
+        return stateError(rejection(state_, GameCommand::Join));
+    }
+    return joinPlayer(player_id, color);
 }
 
 json GameContext::handleJoinRequestAsSinglePlayer(const std::string& player_id) {
-    return current_state_->handleJoinRequestAsSinglePlayer(this, player_id);
+    if (!accepts(state_, GameCommand::JoinAsSinglePlayer)) {
+        return stateError(rejection(state_, GameCommand::JoinAsSinglePlayer));
+    }
+    return joinSinglePlayer(player_id);
 }
 
-json GameContext::handleStartRequest(const std::string& player_id) {
-    return current_state_->handleStartRequest(this, player_id);
+json GameContext::handleStartRequest(const std::string& player_id, const TimeControl& control) {
+    if (!accepts(state_, GameCommand::Start)) {
+        return stateError(rejection(state_, GameCommand::Start));
+    }
+    return startGame(player_id, control);
+}
+
+json GameContext::handleMoveRequest(const std::string& player_id, const ParsedMove& move,
+                                    MoveTiming timing) {
+    if (!accepts(state_, GameCommand::Move)) {
+        return stateError(rejection(state_, GameCommand::Move));
+    }
+    if (timing.received_ns == 0) {
+        timing.received_ns = GameClock::now();
+    }
+    return playMove(player_id, move, timing);
+}
+
+json GameContext::handlePremoveRequest(const std::string& player_id,
+                                       std::optional<ParsedMove> move, MoveTiming timing) {
+    if (!accepts(state_, GameCommand::Premove)) {
+        return stateError(rejection(state_, GameCommand::Premove));
+    }
+    if (timing.received_ns == 0) {
+        timing.received_ns = GameClock::now();
+    }
+    return queuePremove(player_id, std::move(move), timing);
 }
 
-json GameContext::handleMoveRequest(const std::string& player_id, const ParsedMove& move) {
-    return current_state_->handleMoveRequest(this, player_id, move);
+json GameContext::handleLoadRequest(const std::string& player_id, int base_ply,
+                                    const std::string& base_hash, ChessGame&& loaded) {
+    if (!accepts(state_, GameCommand::Move)) {
+        return stateError(rejection(state_, GameCommand::Move));
+    }
+    return loadGame(player_id, base_ply, base_hash, std::move(loaded));
 }
 
 json GameContext::handleEndRequest(const std::string& player_id) {
-    return current_state_->handleEndRequest(this, player_id);
+    if (!accepts(state_, GameCommand::End)) {
+        return stateError(rejection(state_, GameCommand::End));
+    }
+    return resetGame(player_id);
 }
 
 json GameContext::handleDisplayBoard() {
-    return current_state_->handleDisplayBoard(this);
+    if (!accepts(state_, GameCommand::DisplayBoard)) {
+        return stateError(rejection(state_, GameCommand::DisplayBoard));
+    }
+    return displayBoard();
 }
 
-std::string GameContext::getStatusMessage() const {
-    std::string state_name = current_state_->getStateName();
+json GameContext::handleSetPosition(const std::string& player_id, const std::string& fen) {
+    if (!accepts(state_, GameCommand::SetPosition)) {
+        return stateError(rejection(state_, GameCommand::SetPosition));
+    }
+    return setPosition(player_id, fen);
+}
+
+json GameContext::handleSnapshot() const {
+    std::lock_guard<std::mutex> lock(events_mutex_);
+    return buildSnapshot(events_.lastSequence());
+}
 
-    if (state_name == "WaitingForPlayers") {
-        if (hasWhitePlayer() && !hasBlackPlayer()) {
-            return "Player 1 (White) joined. Waiting for Player 2 (Black)";
-        }
-        if (hasBlackPlayer() && !hasWhitePlayer()) {
-            return "Player 1 (Black) joined. Waiting for Player 2 (White)";
-        }
-        return "Waiting for players to join";
+json GameContext::buildSnapshot(uint64_t seq) const {
+    return {{"type", "snapshot"},
+            {"seq", seq},
+            {"state", stateName(state_)},
+            {"ply", chess_game_.getPly()},
+            {"hash", chess_game_.getPositionHash()},
+            {"board", {{"fen", chess_game_.getFEN()}}}};
+}
+
+json GameContext::handleLegalMoves(const std::string& player_id, std::optional<bool> push) {
+    auto subscriber = std::find(legal_move_subscribers_.begin(), legal_move_subscribers_.end(),
+                                player_id);
+    bool subscribed = subscriber != legal_move_subscribers_.end();
+
+    if (push && *push && !subscribed) {
+        legal_move_subscribers_.push_back(player_id);
+    } else if (push && !*push && subscribed) {
+        legal_move_subscribers_.erase(subscriber);
     }
 
-    if (state_name == "ReadyToStart") {
-        return "Ready to start. Wait for start command to be sent";
+    json response = buildLegalMoves();
+    response["push"] = push.value_or(subscribed);
+    return response;
+}
+
+json GameContext::clockState(const MoveTiming& timing) const {
+    return {{"white_ms", clock_.remaining(true, timing) / 1'000'000},
+            {"black_ms", clock_.remaining(false, timing) / 1'000'000}};
+}
+
+json GameContext::buildLegalMoves() {
+    const MoveMasks& masks = chess_game_.getLegalMoveMasks();
+    bool over = state_ == GameState::GameOver;
+
+    return {{"type", "legal_moves"},
+            {"ply", chess_game_.getPly()},
+            {"hash", chess_game_.getPositionHash()},
+            {"turn", chess_game_.getCurrentPlayer() == chess::Color::WHITE ? "white" : "black"},
+            {"count", over ? 0 : masks.count()},
+            {"from", MoveMasks::toHex(over ? 0 : masks.origins)},
+            {"to", over ? std::vector<std::string>() : masks.targetsHex()}};
+}
+
+void GameContext::pushLegalMoves() {
+    if (legal_move_subscribers_.empty()) {
+        return;
     }
 
-    if (state_name == "InProgress") {
-        // Query the chess game model for whose turn it is
-        if (chess_game_) {
-            auto current_player = chess_game_->getCurrentPlayer();
-            return current_player == chess::Color::WHITE ? "Game in progress - White's turn"
-                                                         : "Game in progress - Black's turn";
-        }
-        return "Game in progress";
+    std::string message = buildLegalMoves().dump();
+    for (const auto& session_id : legal_move_subscribers_) {
+        unicast(session_id, message);
+    }
+}
+
+std::string GameContext::getStatusMessage() const {
+    switch (state_) {
+        case GameState::WaitingForPlayers:
+            if (hasWhitePlayer() && !hasBlackPlayer()) {
+                return "Player 1 (White) joined. Waiting for Player 2 (Black)";
+            }
+            if (hasBlackPlayer() && !hasWhitePlayer()) {
+                return "Player 1 (Black) joined. Waiting for Player 2 (White)";
+            }
+            return "Waiting for players to join";
+
+        case GameState::ReadyToStart:
+            return "Ready to start. Wait for start command to be sent";
+
+        case GameState::InProgress:
+            // Query the chess game model for whose turn it is
+            return chess_game_.getCurrentPlayer() == chess::Color::WHITE
+                       ? "Game in progress - White's turn"
+                       : "Game in progress - Black's turn";
+
+        case GameState::GameOver:
+            break;
     }
 
     return "Game over";
-}
\ No newline at end of file
+}
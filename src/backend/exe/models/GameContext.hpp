@@ -8,33 +8,56 @@
 
 #pragma once
 
+#include <array>
 #include <chrono>
 #include <memory>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "ChessGame.hpp"
-#include "IGameState.hpp"
+#include "EventLog.hpp"
+#include "GameClock.hpp"
+#include "GameState.hpp"
 #include "ParserFactory.hpp"
+#include "SmallFunction.hpp"
+
+using json = nlohmann::json;
 
 /**
  * @brief Callback to send message to specific session.
+ *
+ * Stored inline (a capture of one pointer), and the serialised message is
+ * passed through as is.
  */
-using UnicastCallback = std::function<void(const std::string& session_id, const json& message)>;
+using UnicastCallback =
+    SmallFunction<void(const std::string& session_id, const std::string& message)>;
 
 /**
  * @brief Callback to broadcast message to sessions.
+ *
+ * `delta` is the compact form of a move result, sent instead of `message` to
+ * the sessions that asked for delta broadcasts (empty for other messages).
+ * Stored inline, with room for a capture of two pointers.
  */
-using BroadcastCallback = std::function<void(const std::string& originating_session_id,
-                                             const json& message, bool to_all)>;
+using BroadcastCallback =
+    SmallFunction<void(const std::string& originating_session_id, const std::string& message,
+                       bool to_all, const std::string& delta),
+                  2 * sizeof(void*)>;
 
 /**
  * @class GameContext
  * @brief Manages game session state and transitions.
  *
- * Owns the ChessGame instance, coordinates state transitions,
+ * Owns the ChessGame instance, coordinates state transitions (a plain
+ * GameState value, checked against the tables of GameState.hpp),
  * tracks players, manages game timer, and provides message routing.
+ *
+ * Every broadcast is numbered (`seq`) and kept in a bounded event log, so a
+ * client coming back can be sent only the events it missed.
  */
 class GameContext {
    public:
@@ -76,6 +99,50 @@ class GameContext {
      */
     void broadcastToOthers(const std::string& session_id, const std::string& message);
 
+    /**
+     * @brief Broadcast a move to all sessions except originator.
+     * @param session_id Originating session ID to exclude
+     * @param message Full move result
+     * @param delta Compact form: encoded move, ply and position hash
+     */
+    void broadcastMove(const std::string& session_id, const std::string& message,
+                       const std::string& delta);
+
+    /**
+     * @brief Sequence number of the latest broadcast (0 if none yet).
+     */
+    uint64_t lastSequence() const;
+
+    /**
+     * @brief Send a client the events it missed, or a snapshot if they're no longer logged.
+     *
+     * Must be called with the game mutex held. The answer is sent before any later
+     * broadcast, so the client can apply live events right after it.
+     *
+     * @param session_id Client session ID
+     * @param since Last sequence number seen by the client (0: none)
+     */
+    void resync(const std::string& session_id, uint64_t since);
+
+    /**
+     * @brief Serialise the whole game, to move the room to another server process.
+     *
+     * Must be called with the game mutex held.
+     *
+     * @return State name, players, moves, elapsed time and event log
+     */
+    nlohmann::json exportState() const;
+
+    /**
+     * @brief Take over a game serialised by exportState().
+     *
+     * Must be called with the game mutex held, before any session of the room starts.
+     *
+     * @param state Serialised game
+     * @throws std::runtime_error if the state is invalid
+     */
+    void importState(const nlohmann::json& state);
+
     /**
      * @brief Reset game to initial state.
      * @param player_id Player requesting reset
@@ -95,46 +162,111 @@ class GameContext {
     int getElapsedSeconds() const;
 
     /**
-     * @brief Transition to new state.
-     * @param state New state instance (ownership transferred)
+     * @brief Move to the state reached on an event (see nextState()).
+     * @param event Event that occurred in the current state
      */
-    void transitionTo(std::unique_ptr<IGameState> state);
+    void transitionTo(GameEvent event);
+
+    /**
+     * @brief Get the current state.
+     */
+    GameState getState() const { return state_; }
 
     /**
      * @brief Set white player session ID.
      * @param id White player's session ID
      */
-    void setWhitePlayer(const std::string& id) { white_player_id_ = id; }
+    void setWhitePlayer(const std::string& id) {
+        std::lock_guard<std::mutex> lock(players_mutex_);
+        white_player_id_ = id;
+    }
 
     /**
      * @brief Set black player session ID.
      * @param id Black player's session ID
      */
-    void setBlackPlayer(const std::string& id) { black_player_id_ = id; }
+    void setBlackPlayer(const std::string& id) {
+        std::lock_guard<std::mutex> lock(players_mutex_);
+        black_player_id_ = id;
+    }
 
     /**
      * @brief Get white player session ID.
      * @return White player's session ID
      */
-    std::string getWhitePlayer() const { return white_player_id_; }
+    std::string getWhitePlayer() const {
+        std::lock_guard<std::mutex> lock(players_mutex_);
+        return white_player_id_;
+    }
 
     /**
      * @brief Get black player session ID.
      * @return Black player's session ID
      */
-    std::string getBlackPlayer() const { return black_player_id_; }
+    std::string getBlackPlayer() const {
+        std::lock_guard<std::mutex> lock(players_mutex_);
+        return black_player_id_;
+    }
 
     /**
      * @brief Check if white player joined.
      * @return True if white player assigned
      */
-    bool hasWhitePlayer() const { return !white_player_id_.empty(); }
+    bool hasWhitePlayer() const {
+        std::lock_guard<std::mutex> lock(players_mutex_);
+        return !white_player_id_.empty();
+    }
 
     /**
      * @brief Check if black player joined.
      * @return True if black player assigned
      */
-    bool hasBlackPlayer() const { return !black_player_id_.empty(); }
+    bool hasBlackPlayer() const {
+        std::lock_guard<std::mutex> lock(players_mutex_);
+        return !black_player_id_.empty();
+    }
+
+    /**
+     * @brief Check if a session plays the game (as opposed to spectating it).
+     *
+     * Doesn't need the game mutex, so it can be called from broadcast callbacks.
+     *
+     * @param session_id Session ID
+     * @return True if the session is the white or black player
+     */
+    bool isPlayer(const std::string& session_id) const {
+        std::lock_guard<std::mutex> lock(players_mutex_);
+        return session_id == white_player_id_ || session_id == black_player_id_;
+    }
+
+    /**
+     * @brief Get the color played by a session.
+     * @param session_id Session ID
+     * @return "white", "black", "both" (single player) or empty for a spectator
+     */
+    std::string getPlayerColor(const std::string& session_id) const {
+        std::lock_guard<std::mutex> lock(players_mutex_);
+        return seatName(session_id == white_player_id_, session_id == black_player_id_);
+    }
+
+    /**
+     * @brief Give the seats of a session to another one (e.g. a player reconnecting).
+     * @param old_id Session ID holding the seats
+     * @param new_id Session ID taking them over
+     * @return Color taken over, as in getPlayerColor() (empty if the old session had no seat)
+     */
+    std::string replacePlayer(const std::string& old_id, const std::string& new_id) {
+        std::lock_guard<std::mutex> lock(players_mutex_);
+        bool white = old_id == white_player_id_;
+        bool black = old_id == black_player_id_;
+        if (white) {
+            white_player_id_ = new_id;
+        }
+        if (black) {
+            black_player_id_ = new_id;
+        }
+        return seatName(white, black);
+    }
 
     /**
      * @brief Check if both players joined.
@@ -152,13 +284,13 @@ class GameContext {
      * @brief Get chess game instance (mutable).
      * @return Pointer to ChessGame
      */
-    ChessGame* getChessGame() { return chess_game_.get(); }
+    ChessGame* getChessGame() { return &chess_game_; }
 
     /**
      * @brief Get chess game instance (const).
      * @return Const pointer to ChessGame
      */
-    const ChessGame* getChessGame() const { return chess_game_.get(); }
+    const ChessGame* getChessGame() const { return &chess_game_; }
 
     /**
      * @brief Get mutex for thread-safe access.
@@ -167,7 +299,7 @@ class GameContext {
     std::mutex& getMutex() { return mutex_; }
 
     /**
-     * @brief Handle join request (delegates to current state).
+     * @brief Handle join request (checked against the current state).
      * @param player_id Joining player's session ID
      * @param color Requested color
      * @return JSON response
@@ -175,48 +307,176 @@ class GameContext {
     nlohmann::json handleJoinRequest(const std::string& player_id, const std::string& color);
 
     /**
-     * @brief Handle single-player join request (delegates to current state).
+     * @brief Handle single-player join request (checked against the current state).
      * @param player_id Joining player's session ID
      * @return JSON response
      */
     nlohmann::json handleJoinRequestAsSinglePlayer(const std::string& player_id);
 
     /**
-     * @brief Handle start request (delegates to current state).
+     * @brief Handle start request (checked against the current state).
      * @param player_id Requesting player's session ID
+     * @param control Time control (default: untimed)
      * @return JSON response
      */
-    nlohmann::json handleStartRequest(const std::string& player_id);
+    nlohmann::json handleStartRequest(const std::string& player_id,
+                                      const TimeControl& control = {});
 
     /**
-     * @brief Handle move request (delegates to current state).
+     * @brief Handle move request (checked against the current state).
      * @param player_id Moving player's session ID
      * @param move Parsed move
+     * @param timing Receive time and lag of the sender, charged on a timed game (default: now)
+     * @return JSON response
+     */
+    nlohmann::json handleMoveRequest(const std::string& player_id, const ParsedMove& move,
+                                     MoveTiming timing = {});
+
+    /**
+     * @brief Handle premove request (checked against the current state).
+     *
+     * Queues a move played as soon as the opponent moves, in the same critical
+     * section. On the player's own turn, with nothing queued, the move is played at once.
+     *
+     * @param player_id Player's session ID
+     * @param move Parsed move to queue, nullopt to clear the queue
+     * @param timing Receive time and lag of the sender, if the move is played at once
+     * @return JSON response
+     */
+    nlohmann::json handlePremoveRequest(const std::string& player_id,
+                                        std::optional<ParsedMove> move, MoveTiming timing = {});
+
+    /**
+     * @brief Commit a game loaded at once, as moves (checked against the current state).
+     *
+     * The moves were played off-lock on a copy of the game: they're only taken
+     * if no other move was made meanwhile. Sends a single `game_loaded` broadcast.
+     *
+     * @param player_id Loading player's session ID
+     * @param base_ply Ply of the game copied before playing the moves
+     * @param base_hash Position hash of that copy
+     * @param loaded Copy with the moves played
      * @return JSON response
      */
-    nlohmann::json handleMoveRequest(const std::string& player_id, const ParsedMove& move);
+    nlohmann::json handleLoadRequest(const std::string& player_id, int base_ply,
+                                     const std::string& base_hash, ChessGame&& loaded);
 
     /**
-     * @brief Handle end/reset request (delegates to current state).
+     * @brief Handle end/reset request (checked against the current state).
      * @param player_id Requesting player's session ID
      * @return JSON response
      */
     nlohmann::json handleEndRequest(const std::string& player_id);
 
     /**
-     * @brief Handle display board request (delegates to current state).
+     * @brief Handle display board request (checked against the current state).
      * @return JSON response with board state
      */
     nlohmann::json handleDisplayBoard();
 
+    /**
+     * @brief Handle set position request, before the game starts (checked against the current state).
+     * @param player_id Requesting session ID
+     * @param fen Start position of the next game (empty: the standard one)
+     * @return JSON response with the position
+     */
+    nlohmann::json handleSetPosition(const std::string& player_id, const std::string& fen);
+
+    /**
+     * @brief Handle snapshot request, to resync a client whose position hash mismatches.
+     * @return JSON response with ply, position hash and FEN
+     */
+    nlohmann::json handleSnapshot() const;
+
+    /**
+     * @brief Handle legal moves request, in any state (empty set once the game is over).
+     *
+     * Must be called with the game mutex held.
+     *
+     * @param player_id Requesting session ID
+     * @param push Also send the legal moves after every move (true), stop (false), or leave
+     * the subscription unchanged (nullopt)
+     * @return JSON response with the origin squares and their destination bitmasks
+     */
+    nlohmann::json handleLegalMoves(const std::string& player_id, std::optional<bool> push);
+
+    /**
+     * @brief Stop pushing the legal moves to a session (e.g. disconnected).
+     *
+     * Must be called with the game mutex held.
+     */
+    void removeLegalMoveSubscriber(const std::string& session_id) {
+        std::erase(legal_move_subscribers_, session_id);
+    }
+
    private:
-    std::unique_ptr<IGameState> current_state_;
-    std::unique_ptr<ChessGame> chess_game_;
-    UnicastCallback unicast_callback_;
-    BroadcastCallback broadcast_callback_;
+    /// Handlers of the commands, called once the current state accepted them (GameState.cpp)
+    nlohmann::json joinPlayer(const std::string& player_id, const std::string& color);
+    nlohmann::json joinSinglePlayer(const std::string& player_id);
+    nlohmann::json startGame(const std::string& player_id, const TimeControl& control);
+    nlohmann::json playMove(const std::string& player_id, const ParsedMove& move,
+                            MoveTiming timing);
+    nlohmann::json applyMove(const std::string& player_id, const ParsedMove& move,
+                             const MoveTiming& timing, bool premove);
+    nlohmann::json playPremove(const std::string& mover_id, int64_t received_ns);  ///< Or null
+    nlohmann::json queuePremove(const std::string& player_id, std::optional<ParsedMove> move,
+                                MoveTiming timing);
+    nlohmann::json flagFall(const std::string& player_id, const MoveTiming& timing);
+    nlohmann::json loadGame(const std::string& player_id, int base_ply,
+                            const std::string& base_hash, ChessGame&& loaded);
+    nlohmann::json displayBoard();
+    nlohmann::json setPosition(const std::string& player_id, const std::string& fen);
+
+    static nlohmann::json stateError(std::string_view message) {
+        return {{"type", "error"}, {"error", message}};
+    }
+
+    static std::string seatName(bool white, bool black) {
+        return white ? (black ? "both" : "white") : (black ? "black" : "");
+    }
+
+    /**
+     * @brief Build the snapshot of the current position.
+     * @param seq Sequence number of the latest event it includes
+     */
+    nlohmann::json buildSnapshot(uint64_t seq) const;
+
+    /**
+     * @brief Get the time left to both sides, in milliseconds.
+     */
+    nlohmann::json clockState(const MoveTiming& timing) const;
+
+    /**
+     * @brief Build the legal moves of the current position (see MoveMasks).
+     */
+    nlohmann::json buildLegalMoves();
+
+    /**
+     * @brief Send the legal moves of the new position to the sessions that asked for them.
+     */
+    void pushLegalMoves();
+
+    // Read by every move, first in the room's slot: the lock, state, clocks and board
+    mutable std::mutex mutex_;
+    GameState state_ = GameState::WaitingForPlayers;  ///< Game mutex held
+    GameClock clock_;                                 ///< Game mutex held
+
+    static constexpr size_t kMaxPremoves = 4;          ///< Queued moves per color
+    std::array<std::vector<ParsedMove>, 2> premoves_;  ///< White, black (game mutex held)
+
+    mutable std::mutex players_mutex_;  ///< Protects the player IDs (innermost lock)
     std::string white_player_id_;
     std::string black_player_id_;
-    mutable std::mutex mutex_;
+    ChessGame chess_game_;  ///< Inline: no pointer to chase to the board
+
+    // Used on broadcasts and queries only
+    UnicastCallback unicast_callback_;
+    BroadcastCallback broadcast_callback_;
+
+    std::vector<std::string> legal_move_subscribers_;  ///< Pushed legal moves (game mutex held)
+
+    EventLog events_;                  ///< Latest broadcasts, numbered
+    mutable std::mutex events_mutex_;  ///< Numbers and sends broadcasts in order (after mutex_)
 
     std::chrono::steady_clock::time_point game_start_time_;
     bool timer_started_ = false;
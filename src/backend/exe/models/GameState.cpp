@@ -2,90 +2,92 @@
 
 #include "GameContext.hpp"
 #include "Logger.hpp"
+#include "Metrics.hpp"
 
-json WaitingForPlayersState::handleJoinRequest(GameContext* context, const std::string& player_id,
-                                               const std::string& color) {
+// Handlers of the commands accepted by each state (see the rejection table)
+
+json GameContext::joinPlayer(const std::string& player_id, const std::string& color) {
     auto& logger = Logger::instance();
 
     // Validate and assign player color
     if (color == "white") {
-        if (context->hasWhitePlayer() && context->getWhitePlayer() != player_id) {
-            return buildError("White player slot already taken");
+        if (hasWhitePlayer() && getWhitePlayer() != player_id) {
+            return stateError("White player slot already taken");
         }
-        context->setWhitePlayer(player_id);
+        setWhitePlayer(player_id);
         logger.info("Player " + player_id + " joined as White");
     } else if (color == "black") {
-        if (context->hasBlackPlayer() && context->getBlackPlayer() != player_id) {
-            return buildError("Black player slot already taken");
+        if (hasBlackPlayer() && getBlackPlayer() != player_id) {
+            return stateError("Black player slot already taken");
         }
-        context->setBlackPlayer(player_id);
+        setBlackPlayer(player_id);
         logger.info("Player " + player_id + " joined as Black");
     } else {
-        return buildError("Invalid color");
+        return stateError("Invalid color");
     }
 
-    if (context->bothPlayersJoined()) {
-        context->transitionTo(std::make_unique<ReadyToStartState>());
+    if (bothPlayersJoined()) {
+        transitionTo(GameEvent::PlayersJoined);
 
         logger.info("Both players joined! Ready to start.");
 
         json ready_broadcast = {{"type", "game_ready"},
                                 {"status", "Both players joined. You can now start the game!"},
-                                {"white_player", context->getWhitePlayer()},
-                                {"black_player", context->getBlackPlayer()}};
-        context->broadcastToAll(player_id, ready_broadcast.dump());
+                                {"white_player", getWhitePlayer()},
+                                {"black_player", getBlackPlayer()}};
+        broadcastToAll(player_id, ready_broadcast.dump());
 
     } else {
         // Only one player joined so far Broadcast player_joined to other clients
         json player_joined = {
-            {"type", "player_joined"}, {"color", color}, {"status", context->getStatusMessage()}};
-        context->broadcastToOthers(player_id, player_joined.dump());
+            {"type", "player_joined"}, {"color", color}, {"status", getStatusMessage()}};
+        broadcastToOthers(player_id, player_joined.dump());
     }
 
     // Send response for the joining player
     json join_response = {{"type", "join_success"},
                           {"session_id", player_id},
                           {"color", color},
-                          {"status", context->getStatusMessage()},
+                          {"status", getStatusMessage()},
                           {"single_player", false}};
 
     return join_response;
 }
 
-json WaitingForPlayersState::handleJoinRequestAsSinglePlayer(GameContext* context,
-                                                             const std::string& player_id) {
+json GameContext::joinSinglePlayer(const std::string& player_id) {
     auto& logger = Logger::instance();
 
     // Single player mode: player plays both colors
-    context->setWhitePlayer(player_id);
-    context->setBlackPlayer(player_id);
+    setWhitePlayer(player_id);
+    setBlackPlayer(player_id);
     logger.info("Player " + player_id + " joined as single player");
 
     logger.info("Single player joined! Ready to start.");
 
-    context->transitionTo(std::make_unique<ReadyToStartState>());
+    transitionTo(GameEvent::PlayersJoined);
 
     json join_response = {{"type", "join_success"},
                           {"session_id", player_id},
-                          {"status", context->getStatusMessage()},
+                          {"status", getStatusMessage()},
                           {"single_player", true}};
 
     // Send response to the single player
     return join_response;
 }
 
-json ReadyToStartState::handleStartRequest(GameContext* context, const std::string& player_id) {
+json GameContext::startGame(const std::string& player_id, const TimeControl& control) {
     auto& logger = Logger::instance();
     logger.info("Session " + player_id + " starting game");
 
-    context->transitionTo(std::make_unique<InProgressState>());
+    transitionTo(GameEvent::Started);
 
     // Initialise chess game
-    auto* game = context->getChessGame();
+    ChessGame* game = &chess_game_;
     game->reset();
 
-    // Start the game timer
-    context->startGameTimer();
+    // Start the game timer, and the clocks of a timed game
+    startGameTimer();
+    clock_.start(control, game->getCurrentPlayer() == chess::Color::WHITE, GameClock::now());
 
     logger.info("Game started");
 
@@ -95,49 +97,79 @@ json ReadyToStartState::handleStartRequest(GameContext* context, const std::stri
     // Build response for the player who started
     json start_response = {
         {"type", "game_started"},
-        {"status", context->getStatusMessage()},
+        {"status", getStatusMessage()},
         {"board", {{"fen", fen}}},
     };
 
     // Broadcast game_started to ALL players
     json game_started_broadcast = {{"type", "game_started"},
-                                   {"status", context->getStatusMessage()},
-                                   {"white_player", context->getWhitePlayer()},
-                                   {"black_player", context->getBlackPlayer()},
+                                   {"status", getStatusMessage()},
+                                   {"white_player", getWhitePlayer()},
+                                   {"black_player", getBlackPlayer()},
                                    {"board", {{"fen", fen}}}};
-    context->broadcastToOthers(player_id, game_started_broadcast.dump());
+    if (clock_.enabled()) {
+        json clock = {{"white_ms", control.base_ms},
+                      {"black_ms", control.base_ms},
+                      {"increment_ms", control.increment_ms}};
+        start_response["clock"] = clock;
+        game_started_broadcast["clock"] = clock;
+    }
+    broadcastToOthers(player_id, game_started_broadcast.dump());
+    pushLegalMoves();
 
     return start_response;
 }
 
-json ReadyToStartState::handleEndRequest(GameContext* context, const std::string& player_id) {
-    return context->resetGame(player_id);
-}
+json GameContext::playMove(const std::string& player_id, const ParsedMove& move,
+                           MoveTiming timing) {
+    // Any move received once the side to move ran out of time claims the win
+    if (clock_.flagged(timing)) {
+        return flagFall(player_id, timing);
+    }
 
-json InProgressState::handleMoveRequest(GameContext* context, const std::string& player_id,
-                                        const ParsedMove& move) {
-    auto* game = context->getChessGame();
-    if (!game) {
-        return buildError("Game not initialised");
+    json response = applyMove(player_id, move, timing, false);
+    if (response["type"] == "error") {
+        return response;
     }
 
+    // The opponent's premove answers at once, in the same critical section
+    if (state_ == GameState::InProgress) {
+        json premove = playPremove(player_id, timing.received_ns);
+        if (!premove.is_null()) {
+            response["premove"] = std::move(premove);
+        }
+    }
+
+    pushLegalMoves();
+
+    return response;
+}
+
+json GameContext::applyMove(const std::string& player_id, const ParsedMove& move,
+                            const MoveTiming& timing, bool premove) {
+    ChessGame* game = &chess_game_;
+
     // Apply move to model
     auto strike_data = game->applyMove(move);
     if (!strike_data) {
-        return buildError("Invalid move");
+        return stateError("Invalid move");
     }
 
-    // Get FEN representation
+    clock_.punch(timing);
+
+    // Get FEN representation and its hash
     std::string fen = game->getFEN();
+    std::string hash = game->getPositionHash();
 
     // Get elapsed time since game started
-    int elapsed_seconds = context->getElapsedSeconds();
+    int elapsed_seconds = getElapsedSeconds();
 
     // Build response
     json response;
     response["type"] = "move_result";
     response["success"] = true;
     response["timestamp"] = elapsed_seconds;
+    response["received_us"] = timing.received_ns / 1000;
     response["strike"] = {{"case_src", strike_data->case_src},
                           {"case_dest", strike_data->case_dest},
                           {"piece", strike_data->piece},
@@ -153,11 +185,17 @@ json InProgressState::handleMoveRequest(GameContext* context, const std::string&
                           {"stalemate", strike_data->is_stalemate}};
 
     // Add board data with both formats
-    response["board"] = {{"fen", fen}};
+    response["board"] = {{"fen", fen}, {"hash", hash}};
+    if (premove) {
+        response["premove"] = true;
+    }
+    if (clock_.enabled()) {
+        response["clock"] = clockState(timing);
+    }
 
     // Check if game ended
     if (strike_data->is_checkmate || strike_data->is_stalemate) {
-        context->transitionTo(std::make_unique<GameOverState>());
+        transitionTo(GameEvent::Ended);
 
         auto& logger = Logger::instance();
         if (strike_data->is_checkmate) {
@@ -167,23 +205,154 @@ json InProgressState::handleMoveRequest(GameContext* context, const std::string&
         }
     }
 
+    // Clients in delta mode replay the move on their own board and check the hash
+    json delta = {{"type", "move_delta"},
+                  {"move", strike_data->uci},
+                  {"ply", strike_data->strike_number},
+                  {"hash", hash}};
+    if (strike_data->is_checkmate || strike_data->is_stalemate) {
+        delta["end"] = strike_data->is_checkmate ? "checkmate" : "stalemate";
+    }
+    if (clock_.enabled()) {
+        delta["clock"] = response["clock"];
+    }
+
     // Broadcast move to other players
-    context->broadcastToOthers(player_id, response.dump());
+    broadcastMove(player_id, response.dump(), delta.dump());
+
+    // Same number as the broadcast, so the mover doesn't replay its own move on resync
+    response["seq"] = lastSequence();
 
     return response;
 }
 
-json InProgressState::handleEndRequest(GameContext* context, const std::string& player_id) {
-    return context->resetGame(player_id);
+json GameContext::flagFall(const std::string& player_id, const MoveTiming& timing) {
+    bool white = clock_.whiteToMove();
+    json response = {{"type", "game_over"},
+                     {"reason", "timeout"},
+                     {"loser", white ? "white" : "black"},
+                     {"clock", clockState(timing)}};
+
+    Logger::instance().info(std::string("Game over - ") + (white ? "White" : "Black") +
+                            " ran out of time");
+
+    transitionTo(GameEvent::Ended);
+    clock_.stop();
+
+    broadcastToOthers(player_id, response.dump());
+    response["seq"] = lastSequence();
+
+    return response;
 }
 
-json InProgressState::handleDisplayBoard(GameContext* context) {
-    auto& logger = Logger::instance();
-    auto* game = context->getChessGame();
+json GameContext::playPremove(const std::string& mover_id, int64_t received_ns) {
+    bool white = chess_game_.getCurrentPlayer() == chess::Color::WHITE;
+    auto& queue = premoves_[white ? 0 : 1];
+    if (queue.empty()) {
+        return nullptr;
+    }
+
+    ParsedMove move = std::move(queue.front());
+    queue.erase(queue.begin());
+
+    // Sent to everyone but the mover, who gets it in its own answer. Played as the
+    // opponent's move arrived: the premove costs no thinking time
+    json result = applyMove(mover_id, move, MoveTiming{received_ns, 0}, true);
+    if (result["type"] != "error") {
+        Metrics::instance().increment(Counter::PREMOVES_PLAYED);
+        return result;
+    }
+
+    // Premoves are meant for the position they were queued in: drop the rest as well
+    Metrics::instance().increment(Counter::PREMOVES_CANCELLED);
+    json cancelled = {{"type", "premove_cancelled"},
+                      {"move", move.notation},
+                      {"dropped", queue.size() + 1},
+                      {"error", result["error"]}};
+    queue.clear();
+    unicast(white ? getWhitePlayer() : getBlackPlayer(), cancelled.dump());
+
+    return nullptr;
+}
+
+json GameContext::queuePremove(const std::string& player_id, std::optional<ParsedMove> move,
+                               MoveTiming timing) {
+    std::string color = getPlayerColor(player_id);
+    if (color.empty()) {
+        return stateError("Only players can premove");
+    }
+    if (color == "both") {
+        return stateError("No premoves in single player mode");
+    }
+
+    bool white = color == "white";
+    auto& queue = premoves_[white ? 0 : 1];
+
+    if (!move) {
+        queue.clear();
+        return {{"type", "premoves"}, {"color", color}, {"queued", 0}};
+    }
+
+    // Too late to premove: the player's turn came already
+    bool to_move = (chess_game_.getCurrentPlayer() == chess::Color::WHITE) == white;
+    if (to_move && queue.empty()) {
+        return playMove(player_id, *move, timing);
+    }
 
-    if (!game) {
-        return buildError("Game not initialised");
+    if (queue.size() >= kMaxPremoves) {
+        return stateError("Premove queue full");
     }
+    queue.push_back(std::move(*move));
+
+    return {{"type", "premoves"}, {"color", color}, {"queued", queue.size()}};
+}
+
+json GameContext::loadGame(const std::string& player_id, int base_ply,
+                           const std::string& base_hash, ChessGame&& loaded) {
+    // Loading a whole game at once would bypass the clocks
+    if (clock_.enabled()) {
+        return stateError("Cannot load moves into a timed game");
+    }
+
+    // The moves were checked against the position they were loaded on
+    if (chess_game_.getPly() != base_ply || chess_game_.getPositionHash() != base_hash) {
+        return stateError("Game changed while loading");
+    }
+
+    int played = loaded.getPly() - base_ply;
+    chess_game_ = std::move(loaded);
+
+    // Premoves were meant for the position before the load
+    for (auto& queue : premoves_) {
+        queue.clear();
+    }
+
+    json response = {{"type", "game_loaded"},
+                     {"moves", played},
+                     {"ply", chess_game_.getPly()},
+                     {"board", {{"fen", chess_game_.getFEN()},
+                                {"hash", chess_game_.getPositionHash()}}}};
+
+    if (chess_game_.isOver()) {
+        transitionTo(GameEvent::Ended);
+        response["end"] = chess_game_.isCheckmate() ? "checkmate" : "stalemate";
+    }
+    response["status"] = getStatusMessage();
+
+    Logger::instance().info("Session " + player_id + " loaded " + std::to_string(played) +
+                            " moves");
+
+    // One event for the whole game: clients in delta mode resync from its position
+    broadcastToOthers(player_id, response.dump());
+    response["seq"] = lastSequence();
+    pushLegalMoves();
+
+    return response;
+}
+
+json GameContext::displayBoard() {
+    auto& logger = Logger::instance();
+    ChessGame* game = &chess_game_;
 
     try {
         std::string boardASCII = game->getBoardFormatted();
@@ -199,10 +368,25 @@ json InProgressState::handleDisplayBoard(GameContext* context) {
     } catch (const std::exception& e) {
         logger.error("Failed to display board: " + std::string(e.what()));
 
-        return buildError("Failed to display board");
+        return stateError("Failed to display board");
     }
 }
 
-json GameOverState::handleEndRequest(GameContext* context, const std::string& player_id) {
-    return context->resetGame(player_id);
-}
\ No newline at end of file
+json GameContext::setPosition(const std::string& player_id, const std::string& fen) {
+    std::string_view error = chess_game_.setStartPosition(fen);
+    if (!error.empty()) {
+        return stateError("Invalid position: " + std::string(error));
+    }
+
+    Logger::instance().info("Session " + player_id + " set the start position: " +
+                            (fen.empty() ? "standard" : fen));
+
+    json position = {{"type", "position_set"},
+                     {"board", {{"fen", chess_game_.getFEN()},
+                                {"hash", chess_game_.getPositionHash()}}},
+                     {"status", getStatusMessage()}};
+    broadcastToOthers(player_id, position.dump());
+    pushLegalMoves();
+
+    return position;
+}
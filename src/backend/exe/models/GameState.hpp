@@ -1,253 +1,145 @@
 /**
  * @file GameState.hpp
- * @brief Game state machine implementations for chess game lifecycle.
+ * @brief Game state machine for the chess game lifecycle.
  *
- * Defines concrete state classes implementing IGameState interface.
- * States: WaitingForPlayers, ReadyToStart, InProgress, GameOver.
+ * States: WaitingForPlayers, ReadyToStart, InProgress, GameOver. The state is
+ * a one-byte enum; which commands each state accepts and where each event
+ * leads are constexpr tables, so a command costs a table lookup and a
+ * transition allocates nothing. The handlers of the accepted commands are
+ * GameContext members, defined in GameState.cpp.
  */
 
 #pragma once
 
-#include "IGameState.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
 
 /**
- * @class WaitingForPlayersState
- * @brief Initial state waiting for player join requests.
- *
- * Accepts join requests until both players connected.
- * Transitions to ReadyToStart when both players joined.
+ * @enum GameState
+ * @brief State of the game of a room.
  */
-class WaitingForPlayersState : public IGameState {
-   public:
-    /**
-     * @brief Handle player join request.
-     * @param context Game context
-     * @param player_id Joining player's session ID
-     * @param color Requested color ("white" or "black")
-     * @return JSON response with join result
-     */
-    json handleJoinRequest(GameContext* context, const std::string& player_id,
-                           const std::string& color) override;
-
-    /**
-     * @brief Handle single-player join request.
-     * @param context Game context
-     * @param player_id Joining player's session ID
-     * @return JSON response with join result
-     */
-    json handleJoinRequestAsSinglePlayer(GameContext* context,
-                                         const std::string& player_id) override;
-
-    // Parameter name hidden to avoid unused parameter warnings
-    json handleStartRequest(GameContext* /*context*/, const std::string& /*player_id*/) override {
-        return buildError("Cannot start: waiting for players");
-    }
-
-    json handleMoveRequest(GameContext* context, const std::string& player_id,
-                           const ParsedMove& move) override {
-        return buildError("Cannot move: game not started");
-    }
-
-    json handleEndRequest(GameContext* /*context*/, const std::string& /*player_id*/) override {
-        return buildError("No game to end");
-    }
-
-    json handleDisplayBoard(GameContext* /*context*/) override {
-        return buildError("No game to display");
-    }
-
-    std::string getStateName() const override { return "WaitingForPlayers"; }
-    bool canJoin() const override { return true; }
-    bool canStart() const override { return false; }
-    bool canMove() const override { return false; }
-
-   private:
-    json buildError(const std::string& msg) const {
-        return json{{"type", "error"}, {"error", msg}};
-    }
+enum class GameState : uint8_t {
+    WaitingForPlayers,  ///< Accepts join requests until both players connected
+    ReadyToStart,       ///< Both players joined, waiting for the start command
+    InProgress,         ///< Accepts moves and board display requests
+    GameOver,           ///< Checkmate or stalemate: rejects all requests but reset
 };
 
 /**
- * @class ReadyToStartState
- * @brief State when both players joined, waiting for start command.
- *
- * Accepts start request from either player.
- * Transitions to InProgress when game started.
+ * @enum GameCommand
+ * @brief Client request handled according to the game state.
  */
-class ReadyToStartState : public IGameState {
-   public:
-    /**
-     * @brief Reject join request (game full).
-     * @return JSON error response
-     */
-    json handleJoinRequest(GameContext* /*context*/, const std::string& /*player_id*/,
-                           const std::string& /*color*/) override {
-        return buildError("Both players already joined");
-    }
-
-    /**
-     * @brief Reject single-player join request.
-     * @return JSON error response
-     */
-    json handleJoinRequestAsSinglePlayer(GameContext* /*context*/,
-                                         const std::string& /*player_id*/) override {
-        return buildError("Game already in progress");
-    }
-
-    /**
-     * @brief Handle game start request.
-     * @param context Game context
-     * @param player_id Requesting player's session ID
-     * @return JSON response with start result
-     */
-    json handleStartRequest(GameContext* context, const std::string& player_id) override;
-
-    /**
-     * @brief Reject move request (game not started).
-     * @return JSON error response
-     */
-    json handleMoveRequest(GameContext* /*context*/, const std::string& /*player_id*/,
-                           const ParsedMove& /*move*/) override {
-        return buildError("Game not started yet");
-    }
-
-    /**
-     * @brief Handle end/reset request.
-     * @param player_id Requesting player's session ID
-     * @return JSON response with reset result
-     */
-    json handleEndRequest(GameContext* /*context*/, const std::string& player_id) override;
-
-    /**
-     * @brief Reject board display (game not started).
-     * @return JSON error response
-     */
-    json handleDisplayBoard(GameContext* /*context*/) override {
-        return buildError("Game not started yet");
-    }
-
-    std::string getStateName() const override { return "ReadyToStart"; }
-    bool canJoin() const override { return false; }
-    bool canStart() const override { return true; }
-    bool canMove() const override { return false; }
-
-   private:
-    json buildError(const std::string& msg) const {
-        return json{{"type", "error"}, {"error", msg}};
-    }
+enum class GameCommand : uint8_t {
+    Join,
+    JoinAsSinglePlayer,
+    Start,
+    Move,
+    End,
+    DisplayBoard,
+    SetPosition,
+    Premove,
 };
 
 /**
- * @class InProgressState
- * @brief Active game state handling move requests.
- *
- * Accepts move and display board requests.
- * Transitions to GameOver when game ends (checkmate/stalemate).
+ * @enum GameEvent
+ * @brief Event moving the game to another state.
  */
-class InProgressState : public IGameState {
-   public:
-    /**
-     * @brief Reject join request (game in progress).
-     * @return JSON error response
-     */
-    json handleJoinRequest(GameContext* /*context*/, const std::string& /*player_id*/,
-                           const std::string& /*color*/) override {
-        return buildError("Game already in progress");
-    }
-
-    /**
-     * @brief Reject single-player join request.
-     * @return JSON error response
-     */
-    json handleJoinRequestAsSinglePlayer(GameContext* /*context*/,
-                                         const std::string& /*player_id*/) override {
-        return buildError("Game already in progress");
-    }
-
-    /**
-     * @brief Reject start request (game already started).
-     * @return JSON error response
-     */
-    json handleStartRequest(GameContext* /*context*/, const std::string& /*player_id*/) override {
-        return buildError("Game already started");
-    }
-
-    /**
-     * @brief Handle move request - validates and executes move.
-     * @param context Game context
-     * @param move Parsed move from player
-     * @return JSON response with move result
-     */
-    json handleMoveRequest(GameContext* context, const std::string& /*player_id*/,
-                           const ParsedMove& /*move*/) override;
-
-    /**
-     * @brief Handle end/reset request.
-     * @param context Game context
-     * @param player_id Requesting player's session ID
-     * @return JSON response with reset result
-     */
-    json handleEndRequest(GameContext* context, const std::string& player_id) override;
-
-    /**
-     * @brief Handle board display request.
-     * @param context Game context
-     * @return JSON response with board state
-     */
-    json handleDisplayBoard(GameContext* context) override;
-
-    std::string getStateName() const override { return "InProgress"; }
-    bool canJoin() const override { return false; }
-    bool canStart() const override { return false; }
-    bool canMove() const override { return true; }
-
-   private:
-    json buildError(const std::string& msg) const {
-        return json{{"type", "error"}, {"error", msg}};
-    }
+enum class GameEvent : uint8_t {
+    PlayersJoined,  ///< Both colors taken
+    Started,        ///< Start command accepted
+    Ended,          ///< Checkmate or stalemate
+    Reset,          ///< End command or server reset
 };
 
+inline constexpr size_t kGameStateCount = 4;
+inline constexpr size_t kGameCommandCount = 8;
+inline constexpr size_t kGameEventCount = 4;
+
+namespace game_state {
+
+/// State names, as sent to clients and serialised for migration.
+inline constexpr std::array<std::string_view, kGameStateCount> kNames = {
+    "WaitingForPlayers", "ReadyToStart", "InProgress", "GameOver"};
+
+/// Error sent for each command in each state (empty: the state handles the command).
+inline constexpr std::array<std::array<std::string_view, kGameCommandCount>, kGameStateCount>
+    kRejections = {{
+        // Join, JoinAsSinglePlayer, Start, Move, End, DisplayBoard, SetPosition, Premove
+        {"", "", "Cannot start: waiting for players", "Cannot move: game not started",
+         "No game to end", "No game to display", "", "Cannot move: game not started"},
+        {"Both players already joined", "Game already in progress", "", "Game not started yet",
+         "", "Game not started yet", "", "Game not started yet"},
+        {"Game already in progress", "Game already in progress", "Game already started", "", "",
+         "", "Game already started", ""},
+        {"Game is over. Start a new game", "Game already in progress",
+         "Game is over. Reset first", "Game is over", "", "Game is over. Start a new game",
+         "Game is over. Reset first", "Game is over"},
+    }};
+
+using S = GameState;
+
+/// State reached on each event from each state (unchanged where the event can't happen).
+inline constexpr std::array<std::array<GameState, kGameEventCount>, kGameStateCount>
+    kTransitions = {{
+        // PlayersJoined, Started, Ended, Reset
+        {S::ReadyToStart, S::WaitingForPlayers, S::WaitingForPlayers, S::WaitingForPlayers},
+        {S::ReadyToStart, S::InProgress, S::ReadyToStart, S::WaitingForPlayers},
+        {S::InProgress, S::InProgress, S::GameOver, S::WaitingForPlayers},
+        {S::GameOver, S::GameOver, S::GameOver, S::WaitingForPlayers},
+    }};
+
+}  // namespace game_state
+
 /**
- * @class GameOverState
- * @brief Final state after game ends.
- *
- * Rejects all requests except reset.
- * Transitions to WaitingForPlayers on reset.
+ * @brief Get the name of a state.
  */
-class GameOverState : public IGameState {
-   public:
-    json handleJoinRequest(GameContext* /*context*/, const std::string& /*player_id*/,
-                           const std::string& /*color*/) override {
-        return buildError("Game is over. Start a new game");
-    }
-
-    json handleJoinRequestAsSinglePlayer(GameContext* /*context*/,
-                                         const std::string& /*player_id*/) override {
-        return buildError("Game already in progress");
-    }
-
-    json handleStartRequest(GameContext* /*context*/, const std::string& /*player_id*/) override {
-        return buildError("Game is over. Reset first");
-    }
+constexpr std::string_view stateName(GameState state) {
+    return game_state::kNames[static_cast<size_t>(state)];
+}
 
-    json handleMoveRequest(GameContext* /*context*/, const std::string& /*player_id*/,
-                           const ParsedMove& /*move*/) override {
-        return buildError("Game is over");
+/**
+ * @brief Find a state by name.
+ * @return State, or nullopt for an unknown name
+ */
+constexpr std::optional<GameState> parseGameState(std::string_view name) {
+    for (size_t i = 0; i < kGameStateCount; ++i) {
+        if (game_state::kNames[i] == name) {
+            return static_cast<GameState>(i);
+        }
     }
+    return std::nullopt;
+}
 
-    json handleEndRequest(GameContext* context, const std::string& player_id) override;
-
-    json handleDisplayBoard(GameContext* /*context*/) override {
-        return buildError("Game is over. Start a new game");
-    }
+/**
+ * @brief Get the error answering a command the state doesn't handle.
+ * @return Error message, empty if the state handles the command
+ */
+constexpr std::string_view rejection(GameState state, GameCommand command) {
+    return game_state::kRejections[static_cast<size_t>(state)][static_cast<size_t>(command)];
+}
 
-    std::string getStateName() const override { return "GameOver"; }
-    bool canJoin() const override { return false; }
-    bool canStart() const override { return false; }
-    bool canMove() const override { return false; }
+/**
+ * @brief Check whether a state handles a command.
+ */
+constexpr bool accepts(GameState state, GameCommand command) {
+    return rejection(state, command).empty();
+}
 
-   private:
-    json buildError(const std::string& msg) const {
-        return json{{"type", "error"}, {"error", msg}};
-    }
-};
\ No newline at end of file
+/**
+ * @brief Get the state reached on an event.
+ * @return Next state (the same one if the event can't happen in this state)
+ */
+constexpr GameState nextState(GameState state, GameEvent event) {
+    return game_state::kTransitions[static_cast<size_t>(state)][static_cast<size_t>(event)];
+}
+
+static_assert(nextState(GameState::WaitingForPlayers, GameEvent::PlayersJoined) ==
+              GameState::ReadyToStart);
+static_assert(nextState(GameState::ReadyToStart, GameEvent::Started) == GameState::InProgress);
+static_assert(nextState(GameState::InProgress, GameEvent::Ended) == GameState::GameOver);
+static_assert(nextState(GameState::GameOver, GameEvent::Reset) == GameState::WaitingForPlayers);
+static_assert(accepts(GameState::InProgress, GameCommand::Move));
+static_assert(!accepts(GameState::GameOver, GameCommand::Move));
@@ -0,0 +1,170 @@
+/**
+ * @file MoveCache.hpp
+ * @brief Process-wide cache of the legal moves of common positions, shared by all rooms.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+/**
+ * @struct CachedMoves
+ * @brief Legal moves of a position with their SAN, as copied in and out of the MoveCache.
+ *
+ * An empty list is a terminal position: checkmate if the side to move is in
+ * check, stalemate otherwise. The SAN is left out (all NUL) until a game
+ * needs it: rooms using simple notation never compute it.
+ */
+struct CachedMoves {
+    static constexpr size_t kMaxMoves = 64;  ///< Positions with more moves aren't cached
+    static constexpr size_t kSanSize = 8;    ///< Longest SAN, e.g. "Qh4xe1+" (not terminated)
+
+    uint8_t count = 0;                                        ///< Number of legal moves
+    std::array<uint16_t, kMaxMoves> moves{};                  ///< Encoded moves (chess::Move)
+    std::array<std::array<char, kSanSize>, kMaxMoves> san{};  ///< SAN, NUL-padded
+
+    /// Check whether the SAN of the moves is known.
+    bool hasSan() const { return count == 0 || san[0][0] != '\0'; }
+
+    /// SAN of the i-th move.
+    std::string_view sanOf(size_t i) const {
+        const auto& text = san[i];
+        size_t size = 0;
+        while (size < kSanSize && text[size] != '\0') {
+            ++size;
+        }
+        return {text.data(), size};
+    }
+};
+
+/**
+ * @class MoveCache
+ * @brief Fixed-size, lock-free table of CachedMoves keyed by Zobrist hash.
+ *
+ * Thousands of games go through the same opening positions: the first room to
+ * reach one generates its moves and SAN, the others copy them. Each slot is a
+ * seqlock made of relaxed atomic words: a reader retries nothing and treats a
+ * slot being written as a miss, and a writer finding a slot busy skips the
+ * store. Slots are direct-mapped and overwritten on collision.
+ */
+class MoveCache {
+   public:
+    static constexpr size_t kDefaultSlots = 4096;  ///< About 2.7 MB
+    static constexpr int kMaxPly = 20;             ///< Only positions of the opening phase
+
+    /**
+     * @brief Create an empty cache.
+     * @param slots Number of slots (rounded down to a power of two, at least 1)
+     */
+    explicit MoveCache(size_t slots = kDefaultSlots)
+        : mask_(std::bit_floor(std::max<size_t>(slots, 1)) - 1),
+          slots_(std::make_unique<Slot[]>(mask_ + 1)) {}
+
+    /**
+     * @brief Get the cache shared by all the games of the process.
+     */
+    static MoveCache& shared() {
+        static MoveCache cache;
+        return cache;
+    }
+
+    /**
+     * @brief Copy the moves of a position, if cached.
+     * @param key Zobrist hash of the position
+     * @param out Moves of the position (partly overwritten on a miss)
+     * @return True on a hit
+     */
+    bool lookup(uint64_t key, CachedMoves& out) const {
+        const Slot& slot = slots_[key & mask_];
+
+        // Version 0 is an empty slot, an odd version a slot being written
+        uint64_t version = slot.version.load(std::memory_order_acquire);
+        if (version == 0 || (version & 1) != 0 ||
+            slot.key.load(std::memory_order_relaxed) != key) {
+            return false;
+        }
+
+        uint64_t count = slot.count.load(std::memory_order_relaxed);
+        if (count > CachedMoves::kMaxMoves) {
+            return false;
+        }
+        out.count = static_cast<uint8_t>(count);
+        for (size_t i = 0; i < (count + 3) / 4; ++i) {
+            uint64_t word = slot.moves[i].load(std::memory_order_relaxed);
+            for (size_t j = 0; j < 4 && i * 4 + j < count; ++j) {
+                out.moves[i * 4 + j] = static_cast<uint16_t>(word >> (j * 16));
+            }
+        }
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t word = slot.san[i].load(std::memory_order_relaxed);
+            for (size_t j = 0; j < CachedMoves::kSanSize; ++j) {
+                out.san[i][j] = static_cast<char>(word >> (j * 8));
+            }
+        }
+
+        // Nothing was overwritten while copying
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.version.load(std::memory_order_relaxed) == version;
+    }
+
+    /**
+     * @brief Store the moves of a position, unless another thread is writing its slot.
+     * @param key Zobrist hash of the position
+     * @param entry Moves of the position
+     */
+    void store(uint64_t key, const CachedMoves& entry) {
+        Slot& slot = slots_[key & mask_];
+
+        uint64_t version = slot.version.load(std::memory_order_relaxed);
+        if ((version & 1) != 0 ||
+            !slot.version.compare_exchange_strong(version, version + 1,
+                                                  std::memory_order_acquire)) {
+            return;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.key.store(key, std::memory_order_relaxed);
+        slot.count.store(entry.count, std::memory_order_relaxed);
+        for (size_t i = 0; i < (entry.count + 3u) / 4; ++i) {
+            uint64_t word = 0;
+            for (size_t j = 0; j < 4 && i * 4 + j < entry.count; ++j) {
+                word |= uint64_t{entry.moves[i * 4 + j]} << (j * 16);
+            }
+            slot.moves[i].store(word, std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < entry.count; ++i) {
+            uint64_t word = 0;
+            for (size_t j = 0; j < CachedMoves::kSanSize; ++j) {
+                word |= uint64_t{static_cast<uint8_t>(entry.san[i][j])} << (j * 8);
+            }
+            slot.san[i].store(word, std::memory_order_relaxed);
+        }
+
+        slot.version.store(version + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Get the number of slots.
+     */
+    size_t slots() const { return mask_ + 1; }
+
+   private:
+    /// Seqlock-protected entry, in words so concurrent copies are plain atomic loads.
+    struct Slot {
+        std::atomic<uint64_t> version{0};
+        std::atomic<uint64_t> key{0};
+        std::atomic<uint64_t> count{0};
+        std::array<std::atomic<uint64_t>, CachedMoves::kMaxMoves / 4> moves{};
+        std::array<std::atomic<uint64_t>, CachedMoves::kMaxMoves> san{};
+    };
+
+    size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+};
@@ -0,0 +1,75 @@
+/**
+ * @file MoveMasks.hpp
+ * @brief Legal moves of a position as destination bitmasks per origin square.
+ */
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @struct MoveMasks
+ * @brief Compact legal move set: which squares can move, and where to.
+ *
+ * Squares are numbered a1 = 0, b1 = 1, ..., h8 = 63, as bits of 64-bit masks.
+ * Castling moves the king two squares (e1g1, e1c1). A pawn reaching the last
+ * rank may promote to any piece, so promotions are one destination.
+ */
+struct MoveMasks {
+    uint64_t origins = 0;                ///< Squares holding a piece with a legal move
+    std::array<uint64_t, 64> targets{};  ///< Destinations of each origin square
+
+    /**
+     * @brief Add a move (a promotion may be added once per piece).
+     * @param from Origin square index
+     * @param to Destination square index
+     */
+    void add(int from, int to) {
+        origins |= uint64_t{1} << from;
+        targets[from] |= uint64_t{1} << to;
+    }
+
+    /**
+     * @brief Check whether a move is legal (promotion piece aside).
+     */
+    bool allows(int from, int to) const { return (targets[from] >> to & 1) != 0; }
+
+    /**
+     * @brief Get the number of legal (origin, destination) pairs.
+     */
+    int count() const {
+        int total = 0;
+        for (uint64_t mask = origins; mask != 0; mask &= mask - 1) {
+            total += std::popcount(targets[std::countr_zero(mask)]);
+        }
+        return total;
+    }
+
+    /**
+     * @brief Format a mask as 16 hex digits (JSON numbers lose 64-bit precision in clients).
+     */
+    static std::string toHex(uint64_t mask) {
+        static constexpr char kDigits[] = "0123456789abcdef";
+        std::string hex(16, '0');
+        for (int i = 15; i >= 0; --i, mask >>= 4) {
+            hex[i] = kDigits[mask & 0xf];
+        }
+        return hex;
+    }
+
+    /**
+     * @brief Get the destination masks of the origin squares, in increasing square order.
+     */
+    std::vector<std::string> targetsHex() const {
+        std::vector<std::string> hex;
+        hex.reserve(std::popcount(origins));
+        for (uint64_t mask = origins; mask != 0; mask &= mask - 1) {
+            hex.push_back(toHex(targets[std::countr_zero(mask)]));
+        }
+        return hex;
+    }
+};
@@ -10,7 +10,8 @@ struct StrikeData {
     std::string color;      // "white", "black"
     std::string case_src;   // e.g., "e2"
     std::string case_dest;  // e.g., "e4"
-    int strike_number;      // Move number
+    std::string uci;        // Encoded move, e.g., "e2e4", "e7e8q", "e1g1"
+    int strike_number;      // Move number (ply, from 1)
 
     // Optional fields
     bool is_capture = false;
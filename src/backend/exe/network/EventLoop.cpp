@@ -0,0 +1,210 @@
+#include "EventLoop.hpp"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "Logger.hpp"
+
+EventLoop::EventLoop() {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        throw std::runtime_error("Cannot create epoll instance: " + std::string(strerror(errno)));
+    }
+
+    wake_up_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_up_fd_ < 0) {
+        ::close(epoll_fd_);
+        throw std::runtime_error("Cannot create eventfd: " + std::string(strerror(errno)));
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = kWakeUpId;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_up_fd_, &event);
+}
+
+EventLoop::~EventLoop() {
+    stop();
+    ::close(wake_up_fd_);
+    ::close(epoll_fd_);
+}
+
+void EventLoop::start() {
+    if (thread_.joinable()) {
+        return;
+    }
+
+    thread_ = std::jthread([this](std::stop_token st) { run(st); });
+}
+
+void EventLoop::stop() {
+    if (!thread_.joinable()) {
+        return;
+    }
+
+    thread_.request_stop();
+    wakeUp();
+    thread_.join();
+}
+
+uint64_t EventLoop::add(int fd, EventHandler& handler) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    uint64_t id = next_id_++;
+
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP;
+    event.data.u64 = id;
+
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+        throw std::runtime_error("Cannot watch fd " + std::to_string(fd) + ": " +
+                                 std::string(strerror(errno)));
+    }
+
+    registrations_.emplace(id, Registration{fd, &handler});
+    return id;
+}
+
+void EventLoop::watchWritable(uint64_t id, bool enable) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = registrations_.find(id);
+    if (it == registrations_.end()) {
+        return;  // Removed meanwhile
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP | (enable ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+    event.data.u64 = id;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, it->second.fd, &event);
+}
+
+void EventLoop::remove(uint64_t id) {
+    if (id == kWakeUpId) {
+        return;  // Never registered
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    auto it = registrations_.find(id);
+    if (it != registrations_.end()) {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, it->second.fd, nullptr);
+        registrations_.erase(it);
+    }
+
+    // A handler removing itself returns to the loop, which won't call it again
+    if (!isLoopThread()) {
+        dispatch_done_.wait(lock, [this, id] { return dispatching_ != id; });
+    }
+}
+
+size_t EventLoop::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return registrations_.size();
+}
+
+void EventLoop::probeLag() {
+    int64_t idle = 0;
+    if (probe_sent_ns_.compare_exchange_strong(idle, now(), std::memory_order_relaxed)) {
+        wakeUp();
+    }
+}
+
+int64_t EventLoop::lagMicroseconds() const {
+    int64_t lag = lag_ns_.load(std::memory_order_relaxed);
+
+    // A loop stuck in a handler never answers: the pending probe tells how long it's been stuck
+    int64_t sent = probe_sent_ns_.load(std::memory_order_relaxed);
+    if (sent != 0) {
+        lag = std::max(lag, now() - sent);
+    }
+
+    return lag / 1000;
+}
+
+int64_t EventLoop::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void EventLoop::wakeUp() {
+    uint64_t one = 1;
+    [[maybe_unused]] ssize_t n = write(wake_up_fd_, &one, sizeof(one));
+}
+
+void EventLoop::run(std::stop_token st) {
+    auto& logger = Logger::instance();
+    logger.debug("Event loop started");
+
+    loop_thread_id_ = std::this_thread::get_id();
+
+    std::array<epoll_event, kMaxEvents> events;
+
+    while (!st.stop_requested()) {
+        int n = epoll_wait(epoll_fd_, events.data(), kMaxEvents, -1);
+
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;  // Interrupted by signal, retry
+            }
+            logger.error("epoll_wait failed: " + std::string(strerror(errno)));
+            break;
+        }
+
+        if (static_cast<uint64_t>(n) > max_ready_.load(std::memory_order_relaxed)) {
+            max_ready_.store(n, std::memory_order_relaxed);
+        }
+
+        for (int i = 0; i < n; ++i) {
+            uint64_t id = events[i].data.u64;
+
+            if (id == kWakeUpId) {
+                uint64_t count;
+                [[maybe_unused]] ssize_t r = read(wake_up_fd_, &count, sizeof(count));
+
+                int64_t sent = probe_sent_ns_.exchange(0, std::memory_order_relaxed);
+                if (sent != 0) {
+                    lag_ns_.store(now() - sent, std::memory_order_relaxed);
+                }
+                continue;
+            }
+
+            EventHandler* handler = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = registrations_.find(id);
+                if (it == registrations_.end()) {
+                    continue;  // Removed earlier in this batch
+                }
+                handler = it->second.handler;
+                dispatching_ = id;
+            }
+
+            // Drain queued output first: the reply to what is read next goes after it
+            uint32_t ready = events[i].events;
+            if (ready & EPOLLOUT) {
+                handler->onWritable();
+            }
+            if (ready & ~static_cast<uint32_t>(EPOLLOUT)) {
+                handler->onReadable();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                dispatching_ = kWakeUpId;
+            }
+            dispatch_done_.notify_all();
+        }
+    }
+
+    loop_thread_id_ = std::thread::id();
+    logger.debug("Event loop exiting");
+}
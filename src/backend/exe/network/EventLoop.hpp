@@ -0,0 +1,194 @@
+/**
+ * @file EventLoop.hpp
+ * @brief epoll reactor reading all client connections from one thread.
+ */
+
+#pragma once
+
+#include <sys/epoll.h>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <unordered_map>
+
+/**
+ * @class EventHandler
+ * @brief Object notified by the event loop when its descriptor is readable or writable.
+ */
+class EventHandler {
+   public:
+    virtual ~EventHandler() = default;
+
+    /**
+     * @brief Called on the loop thread when the descriptor is readable, hung up or in error.
+     */
+    virtual void onReadable() = 0;
+
+    /**
+     * @brief Called on the loop thread when the descriptor is writable, while watched for it.
+     *
+     * Called before onReadable() for the same readiness, and must not remove
+     * the registration: errors are left to onReadable().
+     */
+    virtual void onWritable() {}
+};
+
+/**
+ * @class EventLoop
+ * @brief Level-triggered epoll loop dispatching readiness to transports.
+ *
+ * Replaces the reader thread per connection: an idle connection only costs its
+ * registration. Handlers run on the loop thread and read into a scratch buffer
+ * shared by all connections (readBuffer()), so no connection holds a receive
+ * buffer while idle.
+ *
+ * Writes don't block the loop either: a transport whose socket is full queues
+ * the rest and asks to be told when it drains (watchWritable()).
+ *
+ * Registrations are identified by a 64-bit ID rather than the handler address,
+ * so events already fetched for a handler removed during the same batch are
+ * dropped instead of reaching a destroyed object.
+ */
+class EventLoop {
+   public:
+    /**
+     * @brief Create the epoll instance.
+     * @throws std::runtime_error if epoll or its wake-up descriptor can't be created
+     */
+    EventLoop();
+
+    /**
+     * @brief Stop the loop and release its descriptors.
+     */
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /**
+     * @brief Start the loop thread.
+     */
+    void start();
+
+    /**
+     * @brief Stop the loop thread and wait for it to exit.
+     *
+     * Must not be called while holding a lock a handler may take.
+     */
+    void stop();
+
+    /**
+     * @brief Watch a descriptor for readability.
+     * @param fd Descriptor to watch
+     * @param handler Handler notified on readiness (must outlive the registration)
+     * @return Registration ID, for remove()
+     * @throws std::runtime_error if the descriptor can't be watched
+     */
+    uint64_t add(int fd, EventHandler& handler);
+
+    /**
+     * @brief Watch a descriptor for writability too, or stop.
+     *
+     * Thread-safe; ignored once the registration is removed.
+     *
+     * @param id Registration ID returned by add()
+     * @param enable Call EventHandler::onWritable() while the descriptor is writable
+     */
+    void watchWritable(uint64_t id, bool enable);
+
+    /**
+     * @brief Stop watching a descriptor (idempotent).
+     *
+     * Off the loop thread, this waits for a running dispatch of the handler to
+     * return, so the handler can be destroyed right after. The caller must not
+     * hold a lock the handler may take.
+     *
+     * @param id Registration ID returned by add() (0 is ignored)
+     */
+    void remove(uint64_t id);
+
+    /**
+     * @brief Scratch buffer for reads done by handlers (loop thread only).
+     */
+    std::span<char> readBuffer() { return read_buffer_; }
+
+    /**
+     * @brief Get the number of watched descriptors.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Measure the loop lag: wake the loop up and time how long it takes to notice.
+     *
+     * Does nothing while the previous probe is pending.
+     */
+    void probeLag();
+
+    /**
+     * @brief Get the lag measured by the last probe, or the age of a pending probe if larger.
+     * @return Lag in microseconds
+     */
+    int64_t lagMicroseconds() const;
+
+    /**
+     * @brief Get the most descriptors ready at once since the previous call, and reset it.
+     */
+    uint64_t takeReadyDepth() { return max_ready_.exchange(0, std::memory_order_relaxed); }
+
+    /**
+     * @brief Current time on the steady clock, in nanoseconds.
+     */
+    static int64_t now();
+
+   private:
+    /**
+     * @brief Loop thread body.
+     * @param st Stop token
+     */
+    void run(std::stop_token st);
+
+    /**
+     * @brief Wake up epoll_wait() (e.g. to observe a stop request).
+     */
+    void wakeUp();
+
+    /**
+     * @brief Check whether the caller runs on the loop thread.
+     */
+    bool isLoopThread() const { return std::this_thread::get_id() == loop_thread_id_; }
+
+    /**
+     * @struct Registration
+     * @brief Watched descriptor and its handler.
+     */
+    struct Registration {
+        int fd;
+        EventHandler* handler;
+    };
+
+    static constexpr uint64_t kWakeUpId = 0;  ///< Registration ID of the wake-up eventfd
+    static constexpr int kMaxEvents = 64;     ///< Events fetched per epoll_wait()
+
+    int epoll_fd_ = -1;    ///< epoll instance
+    int wake_up_fd_ = -1;  ///< eventfd used by wakeUp()
+
+    std::unordered_map<uint64_t, Registration> registrations_;  ///< Watched descriptors
+    uint64_t next_id_ = kWakeUpId + 1;                           ///< Next registration ID
+    uint64_t dispatching_ = kWakeUpId;       ///< Registration whose handler is running (if any)
+    mutable std::mutex mutex_;               ///< Protects the three members above
+    std::condition_variable dispatch_done_;  ///< Signalled after each dispatch
+
+    std::array<char, 16 * 1024> read_buffer_;  ///< Scratch buffer shared by all handlers
+
+    std::atomic<int64_t> probe_sent_ns_{0};  ///< Time of the pending lag probe (0 if none)
+    std::atomic<int64_t> lag_ns_{0};         ///< Lag measured by the last probe
+    std::atomic<uint64_t> max_ready_{0};     ///< Most descriptors ready at once (see takeReadyDepth)
+
+    std::jthread thread_;                          ///< Loop thread
+    std::atomic<std::thread::id> loop_thread_id_;  ///< ID of the loop thread
+};
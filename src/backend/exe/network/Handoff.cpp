@@ -0,0 +1,114 @@
+#include "Handoff.hpp"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+constexpr size_t kHeaderSize = 3;  ///< Kind, then room name size (big-endian)
+constexpr size_t kMaxPacketSize =
+    kHeaderSize + HandoffChannel::kMaxRoomSize + HandoffChannel::kMaxPayloadSize;
+constexpr size_t kControlSize = CMSG_SPACE(sizeof(int) * HandoffChannel::kMaxFds);
+
+}  // namespace
+
+bool HandoffChannel::send(int channel_fd, HandoffKind kind, std::string_view room,
+                          std::string_view payload, const std::vector<int>& fds) {
+    if (room.size() > kMaxRoomSize || payload.size() > kMaxPayloadSize || fds.size() > kMaxFds) {
+        errno = EMSGSIZE;
+        return false;
+    }
+
+    std::string packet(kHeaderSize, '\0');
+    packet[0] = static_cast<char>(kind);
+    packet[1] = static_cast<char>(room.size() >> 8);
+    packet[2] = static_cast<char>(room.size() & 0xff);
+    packet.append(room);
+    packet.append(payload);
+
+    iovec data{packet.data(), packet.size()};
+
+    alignas(cmsghdr) char control[kControlSize] = {};
+    msghdr message{};
+    message.msg_iov = &data;
+    message.msg_iovlen = 1;
+
+    if (!fds.empty()) {
+        message.msg_control = control;
+        message.msg_controllen = CMSG_SPACE(sizeof(int) * fds.size());
+
+        cmsghdr* header = CMSG_FIRSTHDR(&message);
+        header->cmsg_level = SOL_SOCKET;
+        header->cmsg_type = SCM_RIGHTS;
+        header->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+        std::memcpy(CMSG_DATA(header), fds.data(), sizeof(int) * fds.size());
+    }
+
+    ssize_t sent;
+    do {
+        sent = sendmsg(channel_fd, &message, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+
+    return sent >= 0;
+}
+
+std::optional<Handoff> HandoffChannel::receive(int channel_fd) {
+    std::string packet(kMaxPacketSize, '\0');
+    iovec data{packet.data(), packet.size()};
+
+    alignas(cmsghdr) char control[kControlSize] = {};
+    msghdr message{};
+    message.msg_iov = &data;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    ssize_t received;
+    do {
+        received = recvmsg(channel_fd, &message, MSG_CMSG_CLOEXEC);
+    } while (received < 0 && errno == EINTR);
+
+    if (received < 0) {
+        throw std::runtime_error("Handoff channel error: " + std::string(strerror(errno)));
+    }
+    if (received == 0) {
+        return std::nullopt;  // Other end gone
+    }
+
+    Handoff handoff;
+    for (cmsghdr* header = CMSG_FIRSTHDR(&message); header;
+         header = CMSG_NXTHDR(&message, header)) {
+        if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS) {
+            size_t count = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            size_t offset = handoff.fds.size();
+            handoff.fds.resize(offset + count);
+            std::memcpy(handoff.fds.data() + offset, CMSG_DATA(header), sizeof(int) * count);
+        }
+    }
+
+    size_t size = static_cast<size_t>(received);
+    size_t room_size = size >= kHeaderSize ? (static_cast<uint8_t>(packet[1]) << 8) |
+                                                 static_cast<uint8_t>(packet[2])
+                                           : 0;
+    auto kind = static_cast<HandoffKind>(size >= kHeaderSize ? packet[0] : 0);
+
+    if ((message.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) || size < kHeaderSize ||
+        kind > HandoffKind::ROOM_FAILED || room_size > kMaxRoomSize ||
+        kHeaderSize + room_size > size ||
+        (kind == HandoffKind::CLIENT && handoff.fds.size() != 1)) {
+        for (int fd : handoff.fds) {
+            close(fd);
+        }
+        throw std::runtime_error("Malformed handoff packet");
+    }
+
+    handoff.kind = kind;
+    handoff.room.assign(packet, kHeaderSize, room_size);
+    handoff.payload.assign(packet, kHeaderSize + room_size, size - kHeaderSize - room_size);
+    return handoff;
+}
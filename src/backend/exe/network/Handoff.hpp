@@ -0,0 +1,102 @@
+/**
+ * @file Handoff.hpp
+ * @brief Passing accepted client connections and rooms between the router and worker processes.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @enum HandoffKind
+ * @brief Purpose of a packet on a handoff channel.
+ *
+ * A room migration runs as MIGRATE (router to source worker), then ROOM_STATE
+ * chunks, ROOM_SESSIONS batches and ROOM_END (source to router, forwarded as
+ * is to the target worker), and finally ROOM_READY (target to router), or
+ * ROOM_FAILED from either worker.
+ */
+enum class HandoffKind : uint8_t {
+    CLIENT,         ///< New client: one socket, payload = bytes already read from it
+    MIGRATE,        ///< Move a room out: no socket, no payload
+    ROOM_STATE,     ///< Chunk of the serialised room (JSON)
+    ROOM_SESSIONS,  ///< Sessions of the room: their sockets, payload = JSON line + pending bytes
+    ROOM_END,       ///< Last packet of a room sent out, payload = JSON summary
+    ROOM_READY,     ///< Room taken over, payload = JSON summary
+    ROOM_FAILED,    ///< Migration aborted, payload = error message
+};
+
+/**
+ * @struct Handoff
+ * @brief Packet received on a handoff channel.
+ */
+struct Handoff {
+    HandoffKind kind = HandoffKind::CLIENT;  ///< Purpose of the packet
+    std::string room;                        ///< Room name (empty: default room)
+    std::string payload;                     ///< Pending client bytes or migration data
+    std::vector<int> fds;                    ///< Sockets attached, now owned by the receiver
+
+    /// Client socket of a CLIENT packet.
+    int clientFd() const { return fds.empty() ? -1 : fds.front(); }
+};
+
+/**
+ * @class HandoffChannel
+ * @brief Unix seqpacket channel carrying client sockets between processes.
+ *
+ * Each packet is the kind (1 byte), the room name size (2 bytes), the room
+ * name and a payload, with sockets attached as SCM_RIGHTS ancillary data. The
+ * kernel duplicates the descriptors into the receiving process, so the
+ * client's traffic never goes through the router afterwards.
+ */
+class HandoffChannel {
+   public:
+    static constexpr size_t kMaxRoomSize = 64;          ///< Longest room name
+    static constexpr size_t kMaxPendingSize = 4096;     ///< Most bytes read before the handoff
+    static constexpr size_t kMaxPayloadSize = 1 << 16;  ///< Largest payload of a packet
+    static constexpr size_t kMaxFds = 128;              ///< Most sockets per packet (kernel: 253)
+
+    /**
+     * @brief Pass a client socket to the process at the other end of a channel.
+     *
+     * The caller still owns its copy of the socket and closes it afterwards.
+     *
+     * @param channel_fd Connected seqpacket socket
+     * @param client_fd Client socket
+     * @param room Room name (at most kMaxRoomSize bytes)
+     * @param pending Bytes already read from the client (at most kMaxPendingSize)
+     * @return False if the channel failed (errno is set)
+     */
+    static bool send(int channel_fd, int client_fd, std::string_view room,
+                     std::string_view pending) {
+        return send(channel_fd, HandoffKind::CLIENT, room, pending, {client_fd});
+    }
+
+    /**
+     * @brief Send a packet, with sockets attached.
+     *
+     * The caller still owns its copies of the sockets.
+     *
+     * @param channel_fd Connected seqpacket socket
+     * @param kind Purpose of the packet
+     * @param room Room name (at most kMaxRoomSize bytes)
+     * @param payload Payload (at most kMaxPayloadSize bytes)
+     * @param fds Sockets (at most kMaxFds)
+     * @return False if the channel failed (errno is set)
+     */
+    static bool send(int channel_fd, HandoffKind kind, std::string_view room,
+                     std::string_view payload, const std::vector<int>& fds = {});
+
+    /**
+     * @brief Wait for the next packet.
+     * @param channel_fd Connected seqpacket socket
+     * @return Packet, or nullopt once the other end closed the channel
+     * @throws std::runtime_error on a channel error or a malformed packet
+     */
+    static std::optional<Handoff> receive(int channel_fd);
+};
@@ -1,3 +1,3 @@
 #pragma once
 
-enum class NetworkMode { TCP, IPC };
+enum class NetworkMode { TCP, IPC, WEBSOCKET };
@@ -0,0 +1,91 @@
+#include "OverloadController.hpp"
+
+#include <unistd.h>
+
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+#include "Logger.hpp"
+#include "Metrics.hpp"
+
+OverloadController::OverloadController(EventLoop& loop, const OverloadThresholds& thresholds)
+    : loop_(loop), policy_(thresholds) {}
+
+void OverloadController::start(OverloadSampleCallback on_sample) {
+    if (thread_.joinable()) {
+        return;
+    }
+
+    on_sample_ = on_sample;
+    thread_ = std::jthread([this](std::stop_token st) { run(st); });
+}
+
+void OverloadController::stop() {
+    if (thread_.joinable()) {
+        thread_.request_stop();
+        thread_.join();
+    }
+}
+
+void OverloadController::run(std::stop_token st) {
+    auto& logger = Logger::instance();
+    logger.debug("Overload controller started");
+
+    std::mutex mutex;
+    std::condition_variable_any stopped;
+
+    while (!st.stop_requested()) {
+        OverloadSample sample;
+        sample.loop_lag_us = loop_.lagMicroseconds();
+        sample.ready_depth = loop_.takeReadyDepth();
+        sample.rss_bytes = residentBytes();
+
+        OverloadLevel previous = level_.load(std::memory_order_relaxed);
+        OverloadLevel level = policy_.update(sample, EventLoop::now());
+        level_.store(level, std::memory_order_relaxed);
+
+        if (level != previous) {
+            std::string message = std::string("Overload level ") +
+                                  kOverloadLevelNames[static_cast<size_t>(previous)] + " -> " +
+                                  kOverloadLevelNames[static_cast<size_t>(level)] + " (loop lag " +
+                                  std::to_string(sample.loop_lag_us) + " us, ready " +
+                                  std::to_string(sample.ready_depth) + ", RSS " +
+                                  std::to_string(sample.rss_bytes / (1024 * 1024)) + " MB)";
+            if (level > previous) {
+                logger.warning(message);
+            } else {
+                logger.info(message);
+            }
+        }
+
+        Metrics::instance().setOverload(static_cast<int>(level), sample.loop_lag_us,
+                                        sample.ready_depth, sample.rss_bytes);
+
+        if (on_sample_) {
+            on_sample_(level);
+        }
+
+        // Next probe: answered by the loop before the next sample unless it's lagging
+        loop_.probeLag();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        stopped.wait_for(lock, st, kSampleInterval, [] { return false; });
+    }
+
+    logger.debug("Overload controller exiting");
+}
+
+int64_t OverloadController::residentBytes() {
+    // Second field of statm: resident pages (cheaper than parsing /proc/self/status)
+    std::ifstream statm("/proc/self/statm");
+    int64_t size = 0;
+    int64_t resident = 0;
+
+    if (!(statm >> size >> resident)) {
+        return 0;
+    }
+
+    return resident * sysconf(_SC_PAGESIZE);
+}
@@ -0,0 +1,82 @@
+/**
+ * @file OverloadController.hpp
+ * @brief Sample server load and decide which work to shed.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "EventLoop.hpp"
+#include "OverloadPolicy.hpp"
+#include "SmallFunction.hpp"
+
+/// Called on the sampling thread after each sample, with the current level.
+using OverloadSampleCallback = SmallFunction<void(OverloadLevel level)>;
+
+/**
+ * @class OverloadController
+ * @brief Admission control: degrade gracefully instead of letting every latency explode.
+ *
+ * A background thread samples the event loop lag, the number of connections
+ * ready at once and the resident memory every 100 ms, and feeds them to an
+ * OverloadPolicy. Components query level() on their own paths and shed their
+ * work from the cheapest measure to the most visible one (see OverloadLevel).
+ */
+class OverloadController {
+   public:
+    static constexpr std::chrono::milliseconds kSampleInterval{100};  ///< Time between samples
+    static constexpr std::chrono::milliseconds kRetryAfter{2000};  ///< Delay suggested to clients
+
+    /**
+     * @brief Construct the controller (not sampling yet).
+     * @param loop Event loop reading all sessions
+     * @param thresholds Signal thresholds of each level
+     */
+    OverloadController(EventLoop& loop, const OverloadThresholds& thresholds);
+
+    /**
+     * @brief Stop sampling.
+     */
+    ~OverloadController() { stop(); }
+
+    OverloadController(const OverloadController&) = delete;
+    OverloadController& operator=(const OverloadController&) = delete;
+
+    /**
+     * @brief Start the sampling thread.
+     * @param on_sample Called after each sample (e.g. to flush deferred updates)
+     */
+    void start(OverloadSampleCallback on_sample);
+
+    /**
+     * @brief Stop the sampling thread and wait for it to exit.
+     */
+    void stop();
+
+    /**
+     * @brief Get the current shedding level (any thread).
+     */
+    OverloadLevel level() const { return level_.load(std::memory_order_relaxed); }
+
+   private:
+    /**
+     * @brief Sampling thread body.
+     * @param st Stop token
+     */
+    void run(std::stop_token st);
+
+    /**
+     * @brief Read the resident memory of the process.
+     * @return RSS in bytes (0 if unavailable)
+     */
+    static int64_t residentBytes();
+
+    EventLoop& loop_;
+    OverloadPolicy policy_;  ///< Sampling thread only
+    OverloadSampleCallback on_sample_;
+    std::atomic<OverloadLevel> level_{OverloadLevel::NORMAL};
+    std::jthread thread_;  ///< Sampling thread
+};
@@ -1,53 +1,103 @@
 #include "Server.hpp"
 
 #include <arpa/inet.h>
+#include <fcntl.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/un.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <nlohmann/json.hpp>
 
 #include "GameController.hpp"
+#include "Handoff.hpp"
 #include "Logger.hpp"
+#include "MemoryAccounting.hpp"
+#include "Metrics.hpp"
+#include "SlabPool.hpp"
 
 using json = nlohmann::json;
 
 Server::Server(NetworkMode mode, int port, ParserType parser)
-    : network(mode), port(port), shared_controller_(std::make_shared<GameController>(parser)) {
-    setupSendCallbacks();
+    : network(mode),
+      port(port),
+      parser_(parser),
+      shared_controller_(std::make_shared<GameController>(parser, upload_worker_)) {
+    setupSendCallbacks(*shared_controller_, std::string());
 }
 
-void Server::setupSendCallbacks() {
-    shared_controller_->setSendCallbacks(
+void Server::setupSendCallbacks(GameController& controller, const std::string& room) {
+    // The callbacks are stored inline: they capture pointers, the room is kept by the controller
+    controller.setRoom(room);
+    controller.setSendCallbacks(
         [this](const std::string& session_id, const std::string& message) {
             auto& logger = Logger::instance();
             logger.trace("Unicast callback called with message: " + message);
 
             this->unicastTo(session_id, message);
         },
-        [this](const std::string& originating_session_id, const std::string& message, bool to_all) {
+        [this, controller = &controller](const std::string& originating_session_id,
+                                         const std::string& message, bool to_all,
+                                         const std::string& delta) {
             auto& logger = Logger::instance();
             logger.trace("Broadcast callback called with message: `" + message + "` sent to " +
                          (to_all ? "all" : ("others than " + originating_session_id)));
 
             if (to_all) {
-                this->broadcastToAll(message);
+                this->broadcastToAll(controller->getRoom(), message, delta);
             } else {
-                this->broadcastToOthers(originating_session_id, message);
+                this->broadcastToOthers(controller->getRoom(), originating_session_id, message,
+                                        delta);
             }
         });
 }
 
+void Server::enableTrafficRecording(const std::string& path) {
+    recorder_ = std::make_shared<TrafficRecorder>(path);
+    Logger::instance().info("Recording inbound traffic to: " + path);
+}
+
+void Server::setRateLimits(const RateLimits& limits) {
+    rate_limiter_ = std::make_unique<RateLimiter>(limits);
+}
+
+void Server::setOverloadControl(const OverloadThresholds& thresholds) {
+    overload_ = std::make_unique<OverloadController>(loop_, thresholds);
+    shared_controller_->setOverloadController(*overload_);
+}
+
+void Server::setResumeGrace(std::chrono::seconds grace) {
+    resume_grace_ = grace;
+    shared_controller_->setResumeGrace(grace);
+}
+
+void Server::setMaxLagCompensation(std::chrono::milliseconds cap) {
+    max_lag_ = cap;
+    shared_controller_->setMaxLagCompensation(cap);
+}
+
+void Server::setCompression(const CompressionSettings& settings) {
+    compression_ = std::make_unique<Compression>(settings);
+
+    auto& logger = Logger::instance();
+    logger.info("Offering zstd compression from " + std::to_string(settings.min_size) +
+                " bytes, dictionary " +
+                (compression_->dictionaryId() ? std::to_string(compression_->dictionaryId())
+                                              : std::string("none")));
+}
+
 void Server::start(const std::string& ip) {
     running = true;
 
     auto& logger = Logger::instance();
 
     connectTCP(ip, port);
-    logger.info("Server started on TCP " + ip + ":" + std::to_string(port));
+    logger.info("Server started on " +
+                std::string(network == NetworkMode::WEBSOCKET ? "WebSocket" : "TCP") + " " + ip +
+                ":" + std::to_string(port));
 
     start_threads();
 }
@@ -63,9 +113,36 @@ void Server::start_unix(const std::string& socket_path) {
     start_threads();
 }
 
+void Server::start_worker(const std::string& channel_path) {
+    running = true;
+    worker_ = true;
+
+    auto& logger = Logger::instance();
+
+    // Session IDs stay unique across the workers a room can migrate to
+    Session::setIdPrefix(std::to_string(getpid()) + "_");
+
+    connectIPC(channel_path, SOCK_SEQPACKET);
+    logger.info("Worker waiting for the router on: " + channel_path);
+
+    start_threads();
+}
+
 void Server::start_threads() {
-    // Start accept thread
-    acceptThread = std::jthread([this](std::stop_token st) { acceptLoop(st); });
+    // Start the event loop reading all sessions
+    loop_.start();
+
+    // Start sampling the load, which flushes the updates held back from spectators
+    if (overload_) {
+        overload_->start([this](OverloadLevel level) { flushSpectatorUpdate(level); });
+    }
+
+    // Start accept thread (or handoff thread, behind the router)
+    if (worker_) {
+        acceptThread = std::jthread([this](std::stop_token st) { handoffLoop(st); });
+    } else {
+        acceptThread = std::jthread([this](std::stop_token st) { acceptLoop(st); });
+    }
 
     // Start cleanup thread
     cleanupThread = std::jthread([this](std::stop_token st) { cleanupLoop(st); });
@@ -78,6 +155,15 @@ void Server::stop() {
     acceptThread.request_stop();
     cleanupThread.request_stop();
 
+    // The sampling thread sends to sessions too
+    if (overload_) {
+        overload_->stop();
+    }
+
+    // Stop reading first: closing a session being read would wait for its handler, which may
+    // itself wait for the sessions lock held below
+    loop_.stop();
+
     // Shutdown all sessions
     {
         std::lock_guard<std::mutex> lock(sessions_mutex_);
@@ -86,6 +172,13 @@ void Server::stop() {
         }
     }
 
+    // Wakes the handoff thread up
+    int channel_fd = channel_fd_.exchange(-1);
+    if (channel_fd >= 0) {
+        shutdown(channel_fd, SHUT_RDWR);
+        close(channel_fd);
+    }
+
     // Shutdown server socket
     if (server_fd >= 0) {
         shutdown(server_fd, SHUT_RDWR);
@@ -94,7 +187,7 @@ void Server::stop() {
     }
 
     // Clean up Unix socket file if it exists
-    if (network == NetworkMode::IPC && !unix_socket_path_.empty()) {
+    if ((network == NetworkMode::IPC || worker_) && !unix_socket_path_.empty()) {
         unlink(unix_socket_path_.c_str());
     }
 }
@@ -103,7 +196,11 @@ void Server::acceptLoop(std::stop_token st) {
     auto& logger = Logger::instance();
 
     while (!st.stop_requested() && running.load()) {
-        int client_fd = accept(server_fd, nullptr, nullptr);
+        sockaddr_storage peer{};
+        socklen_t peer_len = sizeof(peer);
+        // Non-blocking: the event loop writes to every client and must never wait for one
+        int client_fd = accept4(server_fd, reinterpret_cast<sockaddr*>(&peer), &peer_len,
+                                SOCK_NONBLOCK | SOCK_CLOEXEC);
 
         if (client_fd < 0) {
             if (errno == EINTR) {
@@ -115,11 +212,106 @@ void Server::acceptLoop(std::stop_token st) {
 
         logger.debug("Client connected on fd " + std::to_string(client_fd));
 
-        // Create   a unique transport layer for this session
-        auto transport = TransportFactory::create(client_fd, network);
+        // Existing players come first: no session is created while overloaded
+        if (overload_ && overload_->level() == OverloadLevel::CRITICAL) {
+            rejectConnection(client_fd);
+            continue;
+        }
+
+        addSession(client_fd, peerAddress(peer), std::string(), {});
+    }
+}
+
+void Server::handoffLoop(std::stop_token st) {
+    auto& logger = Logger::instance();
+
+    while (!st.stop_requested() && running.load()) {
+        // A single router at a time: a new one connects after the previous one left
+        int channel_fd = accept4(server_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (channel_fd < 0) {
+            if (errno != EINTR && running.load()) {
+                logger.error("Router accept failed: " + std::string(strerror(errno)));
+            }
+            continue;
+        }
+        channel_fd_ = channel_fd;
+        logger.info("Router connected");
+
+        try {
+            while (auto handoff = HandoffChannel::receive(channel_fd)) {
+                if (handoff->kind == HandoffKind::MIGRATE) {
+                    migrateOut(channel_fd, handoff->room);
+                    continue;
+                }
+                if (handoff->kind != HandoffKind::CLIENT) {
+                    migrateIn(channel_fd, *handoff);
+                    continue;
+                }
+
+                Metrics::instance().increment(Counter::HANDOFFS_RECEIVED);
+
+                if (overload_ && overload_->level() == OverloadLevel::CRITICAL) {
+                    rejectConnection(handoff->clientFd());
+                    continue;
+                }
+
+                sockaddr_storage peer{};
+                socklen_t peer_len = sizeof(peer);
+                getpeername(handoff->clientFd(), reinterpret_cast<sockaddr*>(&peer), &peer_len);
+
+                addSession(handoff->clientFd(), peerAddress(peer), handoff->room, handoff->payload);
+            }
+            logger.warning("Router disconnected");
+        } catch (const std::exception& e) {
+            if (running.load()) {
+                logger.error(e.what());
+            }
+        }
+
+        if (channel_fd_.compare_exchange_strong(channel_fd, -1)) {
+            close(channel_fd);
+        }
+    }
+}
+
+void Server::addSession(int client_fd, const std::string& address, const std::string& room,
+                        std::string_view pending) {
+    auto session = createSession(client_fd, address, room, std::string());
+
+    if (!room.empty()) {
+        Logger::instance().debug("Session " + session->getSessionId() + " joined room " + room);
+    }
+
+    // Start the session (e.g., begin receiving messages)
+    session->start(pending);
+}
+
+std::shared_ptr<Session> Server::createSession(int client_fd, const std::string& address,
+                                               const std::string& room, std::string session_id) {
+    // Transport, session and their registration are charged to the sessions
+    MemoryScope scope(MemoryTag::SESSIONS);
+
+    // Sockets handed over by the router or another worker may still be blocking
+    int flags = fcntl(client_fd, F_GETFL);
+    if (flags >= 0 && !(flags & O_NONBLOCK)) {
+        fcntl(client_fd, F_SETFL, flags | O_NONBLOCK);
+    }
+
+    std::shared_ptr<Session> session;
+    {
+        // Held until the session is registered: the room can't be pruned meanwhile
+        std::lock_guard<std::mutex> rooms_lock(rooms_mutex_);
+        auto controller = roomController(room);
+
+        // Create a session with its own transport and the controller of its room
+        session = SessionFactory::create(client_fd, network, loop_, *controller, recorder_.get(),
+                                         std::move(session_id));
+        session->setRoom(room);
 
-        // Create a session with its own transport and the shared controller
-        auto session = std::make_shared<Session>(std::move(transport), shared_controller_);
+        if (rate_limiter_) {
+            session->setRateLimiter(rate_limiter_->createSessionLimiter(address));
+        }
+        session->setCompression(compression_.get());
 
         // Set close callback
         session->setCloseCallback(
@@ -129,11 +321,345 @@ void Server::acceptLoop(std::stop_token st) {
             // Add the session to the list of active sessions (thread-safe)
             std::lock_guard<std::mutex> lock(sessions_mutex_);
             sessions[session->getSessionId()] = session;
+            room_sessions_[room].push_back(session);
+        }
+    }
+
+    return session;
+}
+
+void Server::migrateOut(int channel_fd, const std::string& room) {
+    auto& logger = Logger::instance();
+    auto started = std::chrono::steady_clock::now();
+
+    std::shared_ptr<GameController> controller;
+    std::vector<std::shared_ptr<Session>> members;
+    {
+        std::lock_guard<std::mutex> rooms_lock(rooms_mutex_);
+        auto it = rooms_.find(room);
+        if (it != rooms_.end()) {
+            controller = it->second;
+
+            std::lock_guard<std::mutex> lock(sessions_mutex_);
+            members = room_sessions_[room];
+        }
+    }
+
+    if (!controller) {
+        // The default room isn't in rooms_: its clients aren't routed by name
+        HandoffChannel::send(channel_fd, HandoffKind::ROOM_FAILED, room, "Room not open here");
+        return;
+    }
+
+    logger.info("Migrating room " + room + " out with " + std::to_string(members.size()) +
+                " sessions");
+
+    // Stop reading every session first: no command can reach the game past this point
+    std::vector<std::shared_ptr<Session>> moving;
+    std::vector<std::shared_ptr<Session>> dropped;
+    std::vector<SessionTransfer> transfers;
+    for (const auto& session : members) {
+        if (auto transfer = session->detach()) {
+            moving.push_back(session);
+            transfers.push_back(std::move(*transfer));
+        } else {
+            // Can't be handed over (e.g. WebSocket): closed, the client reconnects
+            dropped.push_back(session);
+        }
+    }
+
+    json state;
+    {
+        // Unlink the room: it can't be joined or pruned here any more, and broadcasts of
+        // an upload still playing back reach nobody (the clients resync on the seq gap)
+        std::lock_guard<std::mutex> rooms_lock(rooms_mutex_);
+        {
+            std::lock_guard<std::mutex> lock(sessions_mutex_);
+            rooms_.erase(room);
+            room_sessions_.erase(room);
+            spectator_updates_.erase(room);
+            for (const auto& session : members) {
+                sessions.erase(session->getSessionId());
+            }
+        }
+
+        state = controller->exportRoom();
+    }
+    auto export_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                         std::chrono::steady_clock::now() - started)
+                         .count();
+
+    std::string data = state.dump();
+    bool sent = true;
+    for (size_t offset = 0; sent && offset < data.size();
+         offset += HandoffChannel::kMaxPayloadSize) {
+        sent = HandoffChannel::send(
+            channel_fd, HandoffKind::ROOM_STATE, room,
+            std::string_view(data).substr(offset, HandoffChannel::kMaxPayloadSize));
+    }
+
+    // Sessions in batches: a JSON line describing them, then their pending bytes in order
+    size_t handed_over = 0;
+    while (sent && handed_over < transfers.size()) {
+        std::string header;
+        std::string pending;
+        std::vector<int> fds;
+
+        size_t next = handed_over;
+        while (next < transfers.size() && fds.size() < HandoffChannel::kMaxFds) {
+            const auto& transfer = transfers[next];
+            std::string record = json{{"id", transfer.session_id},
+                                      {"pending", transfer.pending.size()},
+                                      {"delta", transfer.delta_broadcasts}}
+                                     .dump();
+
+            // "[", the records, "]\n", the pending bytes
+            size_t size = header.size() + record.size() + pending.size() +
+                          transfer.pending.size() + 3;
+            if (size > HandoffChannel::kMaxPayloadSize) {
+                break;
+            }
+
+            header += (header.empty() ? "" : ",") + record;
+            pending += transfer.pending;
+            fds.push_back(transfer.fd);
+            ++next;
+        }
+
+        if (fds.empty()) {
+            // A single session over the packet size: the rest is closed below
+            logger.warning("Session " + transfers[next].session_id + " too large to migrate");
+            break;
+        }
+
+        sent = HandoffChannel::send(channel_fd, HandoffKind::ROOM_SESSIONS, room,
+                                    "[" + header + "]\n" + pending, fds);
+        if (sent) {
+            handed_over = next;
+        }
+    }
+
+    if (sent) {
+        json summary = {{"sessions", handed_over}, {"export_us", export_us}};
+        sent = HandoffChannel::send(channel_fd, HandoffKind::ROOM_END, room, summary.dump());
+    }
+    if (!sent) {
+        logger.error("Migration of room " + room + " failed: " + strerror(errno));
+    }
+
+    // The other process owns the sockets handed over; the others are disconnected
+    for (size_t i = 0; i < moving.size(); ++i) {
+        if (i < handed_over) {
+            moving[i]->release();
+        } else {
+            moving[i]->close();
+        }
+    }
+    for (const auto& session : dropped) {
+        session->close();
+    }
+
+    Metrics::instance().increment(Counter::ROOMS_MIGRATED_OUT);
+    Metrics::instance().increment(Counter::ROOMS_CLOSED);
+
+    logger.info("Room " + room + " migrated out: " + std::to_string(handed_over) +
+                " sessions, exported in " + std::to_string(export_us) + " us");
+}
+
+void Server::migrateIn(int channel_fd, Handoff& packet) {
+    auto& logger = Logger::instance();
+    const std::string& room = packet.room;
+
+    if (packet.kind == HandoffKind::ROOM_READY) {
+        logger.warning("Unexpected handoff packet for room " + room);
+        return;
+    }
+
+    auto& incoming = incoming_rooms_[room];
+    if (incoming.started == std::chrono::steady_clock::time_point{}) {
+        incoming.started = std::chrono::steady_clock::now();
+    }
+
+    if (packet.kind == HandoffKind::ROOM_FAILED) {
+        // The source gave up: whatever was adopted stays here as an open room
+        logger.warning("Migration of room " + room + " aborted: " + packet.payload);
+        incoming_rooms_.erase(room);
+        return;
+    }
+
+    if (packet.kind == HandoffKind::ROOM_STATE) {
+        incoming.state += packet.payload;
+        return;
+    }
+
+    try {
+        if (!incoming.controller) {
+            json state = json::parse(incoming.state);
+            incoming.state.clear();
+
+            std::lock_guard<std::mutex> rooms_lock(rooms_mutex_);
+            if (rooms_.count(room)) {
+                throw std::runtime_error("Room already open here");
+            }
+
+            auto controller = roomController(room);
+            try {
+                controller->importRoom(state);
+            } catch (...) {
+                rooms_.erase(room);
+                throw;
+            }
+            incoming.controller = controller;
+        }
+
+        if (packet.kind == HandoffKind::ROOM_SESSIONS) {
+            size_t newline = packet.payload.find('\n');
+            json records = json::parse(packet.payload.substr(0, newline));
+            if (newline == std::string::npos || !records.is_array() ||
+                records.size() != packet.fds.size()) {
+                throw std::runtime_error("Malformed room sessions");
+            }
+
+            std::string_view pending(packet.payload);
+            pending.remove_prefix(newline + 1);
+
+            for (size_t i = 0; i < records.size(); ++i) {
+                SessionTransfer transfer;
+                transfer.session_id = records[i].at("id").get<std::string>();
+                transfer.fd = packet.fds[i];
+                transfer.delta_broadcasts = records[i].value("delta", false);
+
+                size_t size = records[i].at("pending").get<size_t>();
+                if (size > pending.size()) {
+                    throw std::runtime_error("Malformed room sessions");
+                }
+                transfer.pending.assign(pending.substr(0, size));
+                pending.remove_prefix(size);
+
+                sockaddr_storage peer{};
+                socklen_t peer_len = sizeof(peer);
+                getpeername(transfer.fd, reinterpret_cast<sockaddr*>(&peer), &peer_len);
+
+                // The session owns the socket from here on
+                packet.fds[i] = -1;
+                auto session = createSession(transfer.fd, peerAddress(peer), room,
+                                             transfer.session_id);
+                session->adopt(transfer);
+                ++incoming.sessions;
+            }
+            return;
+        }
+
+        // ROOM_END
+        auto import_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                             std::chrono::steady_clock::now() - incoming.started)
+                             .count();
+        json summary = {{"sessions", incoming.sessions}, {"import_us", import_us}};
+        HandoffChannel::send(channel_fd, HandoffKind::ROOM_READY, room, summary.dump());
+
+        Metrics::instance().increment(Counter::ROOMS_MIGRATED_IN);
+
+        logger.info("Room " + room + " migrated in: " + std::to_string(incoming.sessions) +
+                    " sessions, imported in " + std::to_string(import_us) + " us");
+        incoming_rooms_.erase(room);
+    } catch (const std::exception& e) {
+        for (int fd : packet.fds) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+
+        logger.error("Migration of room " + room + " failed: " + e.what());
+        HandoffChannel::send(channel_fd, HandoffKind::ROOM_FAILED, room, e.what());
+        incoming_rooms_.erase(room);
+    }
+}
+
+std::shared_ptr<GameController> Server::roomController(const std::string& room) {
+    if (room.empty()) {
+        return shared_controller_;
+    }
+
+    auto& controller = rooms_[room];
+    if (!controller) {
+        // One slab slot holds the controller, its game and board, and the shared count;
+        // a closed room's slot is reused by the next one opened
+        MemoryScope scope(MemoryTag::ROOMS);
+        controller = std::allocate_shared<GameController>(SlabAllocator<GameController>(), parser_,
+                                                          upload_worker_);
+        setupSendCallbacks(*controller, room);
+        controller->setResumeGrace(resume_grace_);
+        controller->setMaxLagCompensation(max_lag_);
+        if (overload_) {
+            controller->setOverloadController(*overload_);
+        }
+
+        Metrics::instance().increment(Counter::ROOMS_OPENED);
+        Logger::instance().info("Room opened: " + room);
+    }
+    return controller;
+}
+
+void Server::pruneRooms() {
+    // Destroyed after releasing the locks: a controller joins its upload worker
+    std::vector<std::shared_ptr<GameController>> closed;
+
+    {
+        std::lock_guard<std::mutex> rooms_lock(rooms_mutex_);
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+
+        for (auto it = rooms_.begin(); it != rooms_.end();) {
+            auto members = room_sessions_.find(it->first);
+            bool empty = members == room_sessions_.end() || members->second.empty();
+
+            // A player who dropped may still come back to an empty room
+            if (empty && !it->second->hasSeatHolds()) {
+                Logger::instance().info("Room closed: " + it->first);
+                Metrics::instance().increment(Counter::ROOMS_CLOSED);
+
+                if (members != room_sessions_.end()) {
+                    room_sessions_.erase(members);
+                }
+                spectator_updates_.erase(it->first);
+                closed.push_back(std::move(it->second));
+                it = rooms_.erase(it);
+            } else {
+                ++it;
+            }
         }
+    }
+}
+
+void Server::rejectConnection(int client_fd) {
+    static const std::string kOverloadedError =
+        json{{"type", "error"},
+             {"error", "Server overloaded"},
+             {"retry_after_ms", OverloadController::kRetryAfter.count()}}
+            .dump() +
+        "\n";
+
+    // Best effort: the accept loop must not wait for a client that doesn't read
+    [[maybe_unused]] ssize_t n = ::send(client_fd, kOverloadedError.data(),
+                                        kOverloadedError.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+    close(client_fd);
+
+    Metrics::instance().increment(Counter::CONNECTIONS_SHED);
+    Logger::instance().debug("Connection rejected: server overloaded");
+}
 
-        // Start the session (e.g., begin receiving messages)
-        session->start();
+std::string Server::peerAddress(const sockaddr_storage& peer) {
+    char address[INET6_ADDRSTRLEN] = {};
+
+    if (peer.ss_family == AF_INET) {
+        inet_ntop(AF_INET, &reinterpret_cast<const sockaddr_in&>(peer).sin_addr, address,
+                  sizeof(address));
+    } else if (peer.ss_family == AF_INET6) {
+        inet_ntop(AF_INET6, &reinterpret_cast<const sockaddr_in6&>(peer).sin6_addr, address,
+                  sizeof(address));
     }
+
+    // Unix socket clients have no address
+    return address;
 }
 
 void Server::connectTCP(const std::string& ip, int port) {
@@ -157,17 +683,17 @@ void Server::connectTCP(const std::string& ip, int port) {
     if (bind(server_fd, (sockaddr*)&addr, sizeof(addr)) < 0)
         throw std::runtime_error("TCP bind failed");
 
-    if (listen(server_fd, 10) < 0)
+    if (listen(server_fd, SOMAXCONN) < 0)
         throw std::runtime_error("TCP listen failed");
 }
 
-void Server::connectIPC(const std::string& socket_path) {
+void Server::connectIPC(const std::string& socket_path, int type) {
     auto& logger = Logger::instance();
 
     // Remove existing socket file if it exists
     unlink(socket_path.c_str());
 
-    server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    server_fd = socket(AF_UNIX, type, 0);
     if (server_fd < 0) {
         throw std::runtime_error("Cannot create Unix socket: " + std::string(strerror(errno)));
     }
@@ -196,7 +722,7 @@ void Server::connectIPC(const std::string& socket_path) {
                                  std::string(strerror(errno)));
     }
 
-    if (listen(server_fd, 10) < 0) {
+    if (listen(server_fd, SOMAXCONN) < 0) {
         close(server_fd);
         unlink(socket_path.c_str());
         throw std::runtime_error("Unix socket listen failed: " + std::string(strerror(errno)));
@@ -208,48 +734,170 @@ void Server::connectIPC(const std::string& socket_path) {
     logger.info("Unix socket listening on " + socket_path);
 }
 
-void Server::broadcastToAll(const std::string& message) {
+void Server::broadcastToAll(const std::string& room, const std::string& message,
+                            const std::string& delta) {
     std::lock_guard<std::mutex> lock(sessions_mutex_);
 
     auto& logger = Logger::instance();
     logger.debug("Broadcasting to all sessions: " + message);
 
+    auto members = room_sessions_.find(room);
+    if (members == room_sessions_.end()) {
+        return;
+    }
+
+    bool hold = holdForSpectators(room, message);
+    uint64_t held = 0;
+    uint64_t deltas = 0;
+
     int count = 0;
-    for (const auto& session : sessions) {
+    for (const auto& session : members->second) {
         // Skip if session is null or closed
-        if (!session.second || !session.second->isActive()) {
+        if (!session || !session->isActive()) {
             logger.trace("Skipping inactive session");
             continue;
         }
-        session.second->send(message);
+        if (hold && !session->isPlayer()) {
+            held++;
+            continue;
+        }
+        deltas += sendBroadcast(*session, message, delta);
         count++;
     }
 
+    if (held > 0) {
+        Metrics::instance().increment(Counter::SPECTATOR_UPDATES_THINNED, held);
+    }
+    if (deltas > 0) {
+        Metrics::instance().increment(Counter::MOVE_DELTAS_SENT, deltas);
+    }
+
     logger.debug("Broadcast sent to " + std::to_string(count) + " sessions");
 }
 
-void Server::broadcastToOthers(const std::string& exclude_session_id, const std::string& message) {
+void Server::broadcastToOthers(const std::string& room, const std::string& exclude_session_id,
+                               const std::string& message, const std::string& delta) {
     std::lock_guard<std::mutex> lock(sessions_mutex_);
 
     auto& logger = Logger::instance();
     logger.debug("Broadcasting to others (excluding " + exclude_session_id + "): " + message);
 
+    auto members = room_sessions_.find(room);
+    if (members == room_sessions_.end()) {
+        return;
+    }
+
+    bool hold = holdForSpectators(room, message);
+    uint64_t held = 0;
+    uint64_t deltas = 0;
+
     int count = 0;
-    for (const auto& session : sessions) {
-        if (session.second->getSessionId() != exclude_session_id) {
-            // Skip if session is null or closed
-            if (!session.second || !session.second->isActive()) {
-                logger.trace("Skipping inactive session");
+    for (const auto& session : members->second) {
+        // Skip if session is null or closed
+        if (!session || !session->isActive()) {
+            logger.trace("Skipping inactive session");
+            continue;
+        }
+        if (session->getSessionId() != exclude_session_id) {
+            if (hold && !session->isPlayer()) {
+                held++;
                 continue;
             }
-            session.second->send(message);
+            deltas += sendBroadcast(*session, message, delta);
             count++;
         }
     }
 
+    if (held > 0) {
+        Metrics::instance().increment(Counter::SPECTATOR_UPDATES_THINNED, held);
+    }
+    if (deltas > 0) {
+        Metrics::instance().increment(Counter::MOVE_DELTAS_SENT, deltas);
+    }
+
     logger.debug("Broadcast sent to " + std::to_string(count) + " sessions");
 }
 
+bool Server::sendBroadcast(const Session& session, const std::string& message,
+                           const std::string& delta) {
+    if (!delta.empty() && session.wantsDeltas()) {
+        session.send(delta);
+        return true;
+    }
+    session.send(message);
+    return false;
+}
+
+bool Server::holdForSpectators(const std::string& room, const std::string& message) {
+    bool thinning = overload_ && overload_->level() >= OverloadLevel::HIGH;
+
+    // Outside overload, only a move result superseding a held one needs the scan below
+    if (!thinning && spectator_updates_.empty()) {
+        return false;
+    }
+
+    if (message.find(R"("type":"move_result")") == std::string::npos) {
+        return false;
+    }
+
+    if (!thinning) {
+        // Sent to everyone: any held update is now stale
+        spectator_updates_.erase(room);
+        return false;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    auto& update = spectator_updates_[room];
+
+    if (now - update.last_sent >= spectatorInterval(overload_->level())) {
+        update.held.clear();
+        update.last_sent = now;
+        return false;
+    }
+
+    update.held = message;
+    return true;
+}
+
+void Server::flushSpectatorUpdate(OverloadLevel level) {
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+
+    auto now = std::chrono::steady_clock::now();
+
+    for (auto it = spectator_updates_.begin(); it != spectator_updates_.end();) {
+        auto& update = it->second;
+
+        if (update.held.empty()) {
+            // Nothing held: the room is forgotten once the overload is over
+            it = level >= OverloadLevel::HIGH ? std::next(it) : spectator_updates_.erase(it);
+            continue;
+        }
+        if (level >= OverloadLevel::HIGH && now - update.last_sent < spectatorInterval(level)) {
+            ++it;
+            continue;
+        }
+
+        // Full result even in delta mode: the skipped moves can't be replayed
+        auto members = room_sessions_.find(it->first);
+        if (members != room_sessions_.end()) {
+            for (const auto& session : members->second) {
+                if (session->isActive() && !session->isPlayer()) {
+                    session->send(update.held);
+                }
+            }
+        }
+
+        update.held.clear();
+        update.last_sent = now;
+        ++it;
+    }
+}
+
+std::chrono::milliseconds Server::spectatorInterval(OverloadLevel level) {
+    return level == OverloadLevel::CRITICAL ? std::chrono::milliseconds(2000)
+                                            : std::chrono::milliseconds(500);
+}
+
 void Server::unicastTo(const std::string& session_id, const std::string& message) {
     std::lock_guard<std::mutex> lock(sessions_mutex_);
 
@@ -274,14 +922,9 @@ void Server::handleSessionClosed(const std::string& session_id) {
     auto& logger = Logger::instance();
     logger.debug("Handling session closed: " + session_id);
 
-    // Queue for cleanup
-    {
-        std::lock_guard<std::mutex> lock(cleanup_mutex_);
-        sessions_to_cleanup_.push_back(session_id);
-    }
-
-    // Notify game controller immediately
-    shared_controller_->routeDisconnect(session_id);
+    // Queue for cleanup (the session already notified the controller of its room)
+    std::lock_guard<std::mutex> lock(cleanup_mutex_);
+    sessions_to_cleanup_.push_back(session_id);
 }
 
 void Server::cleanupLoop(std::stop_token st) {
@@ -295,6 +938,22 @@ void Server::cleanupLoop(std::stop_token st) {
 
         // Process cleanup queue
         cleanupClosedSessions();
+
+        // Reset the game if a disconnected player didn't come back in time
+        std::vector<std::shared_ptr<GameController>> controllers = {shared_controller_};
+        {
+            std::lock_guard<std::mutex> lock(rooms_mutex_);
+            for (const auto& room : rooms_) {
+                controllers.push_back(room.second);
+            }
+        }
+        for (const auto& controller : controllers) {
+            controller->expireSeatHolds();
+        }
+        controllers.clear();
+
+        // After the sessions are destroyed, since they use the controller of their room
+        pruneRooms();
     }
 
     logger.debug("Cleanup thread exiting");
@@ -316,18 +975,29 @@ void Server::cleanupClosedSessions() {
 
     logger.debug("Cleaning up " + std::to_string(to_cleanup.size()) + " sessions");
 
+    // Sessions are destroyed after releasing the lock: destroying a transport waits for the event
+    // loop to leave it, and the loop may be waiting for this lock (e.g. to broadcast).
+    std::vector<std::shared_ptr<Session>> removed;
+
     // Remove sessions from the main list
-    std::lock_guard<std::mutex> lock(sessions_mutex_);
-    for (const auto& session_id : to_cleanup) {
-        auto it = std::find_if(
-            sessions.begin(), sessions.end(),
-            [&session_id](const std::pair<const std::string, std::shared_ptr<Session>>& pair) {
-                return pair.first == session_id;
-            });
-
-        if (it != sessions.end()) {
-            logger.debug("Removing session from list: " + session_id);
-            sessions.erase(it);
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        for (const auto& session_id : to_cleanup) {
+            auto it = sessions.find(session_id);
+
+            if (it != sessions.end()) {
+                logger.debug("Removing session from list: " + session_id);
+
+                auto& members = room_sessions_[it->second->getRoom()];
+                auto member = std::find(members.begin(), members.end(), it->second);
+                if (member != members.end()) {
+                    *member = std::move(members.back());
+                    members.pop_back();
+                }
+
+                removed.push_back(std::move(it->second));
+                sessions.erase(it);
+            }
         }
     }
 }
\ No newline at end of file
@@ -1,17 +1,30 @@
 #pragma once
 
+#include <sys/socket.h>
+
 #include <atomic>
+#include <chrono>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
+#include "Compression.hpp"
+#include "EventLoop.hpp"
 #include "GameContext.hpp"
+#include "Handoff.hpp"
 #include "NetworkMode.hpp"
+#include "OverloadController.hpp"
 #include "ParserFactory.hpp"
+#include "RateLimiter.hpp"
 #include "Session.hpp"
-#include "TransportFactory.hpp"
+#include "SessionFactory.hpp"
+#include "TrafficRecorder.hpp"
+#include "UploadWorker.hpp"
 
 /**
  * @class Server
@@ -19,6 +32,11 @@
  *
  * Handles TCP/IPC socket binding, accepts connections, manages session lifecycle,
  * and provides broadcast/unicast messaging. All sessions share a common GameController.
+ *
+ * As a worker behind `chess_router`, the server accepts no connection itself:
+ * the router hands client sockets over with the room they asked for, and each
+ * room gets its own GameController, created with its first session and
+ * dropped once its last one is gone.
  */
 class Server {
    public:
@@ -36,7 +54,7 @@ class Server {
     ~Server() { stop(); }
 
     /**
-     * @brief Start TCP server on specified IP address.
+     * @brief Start TCP (or WebSocket) server on specified IP address.
      * @param ip IP address to bind (e.g., "0.0.0.0", "127.0.0.1")
      */
     void start(const std::string& ip);
@@ -47,6 +65,69 @@ class Server {
      */
     void start_unix(const std::string& socket_path);
 
+    /**
+     * @brief Start as a worker process, serving the clients handed over by the router.
+     * @param channel_path Path of the Unix socket the router connects to
+     */
+    void start_worker(const std::string& channel_path);
+
+    /**
+     * @brief Capture inbound session traffic to a file for later replay.
+     *
+     * Must be called before start(): only sessions accepted afterwards are recorded.
+     *
+     * @param path Capture file path
+     */
+    void enableTrafficRecording(const std::string& path);
+
+    /**
+     * @brief Limit the message rate of each session and client address.
+     *
+     * Must be called before start(). Messages over the limits are rejected
+     * before being parsed.
+     *
+     * @param limits Limits of each command class
+     */
+    void setRateLimits(const RateLimits& limits);
+
+    /**
+     * @brief Shed load when the server saturates instead of slowing every client down.
+     *
+     * Must be called before start().
+     *
+     * @param thresholds Signal thresholds of each overload level
+     */
+    void setOverloadControl(const OverloadThresholds& thresholds);
+
+    /**
+     * @brief Offer compression of large messages to the clients.
+     *
+     * Must be called before start(). Each client opts in after the handshake.
+     *
+     * @param settings Compression parameters and dictionary
+     * @throws std::runtime_error if the dictionary can't be loaded
+     */
+    void setCompression(const CompressionSettings& settings);
+
+    /**
+     * @brief Hold the seat of a disconnected player for it to resume, not reset the game.
+     *
+     * Must be called before start(). Holds are checked by the cleanup thread,
+     * so they last up to 5 s longer.
+     *
+     * @param grace Grace period (0: reset the game as soon as a player leaves)
+     */
+    void setResumeGrace(std::chrono::seconds grace);
+
+    /**
+     * @brief Cap the lag compensated on the clocks of timed games.
+     *
+     * Must be called before start().
+     *
+     * @param cap Most round trip not charged to a mover (0: no compensation)
+     */
+    void setMaxLagCompensation(std::chrono::milliseconds cap);
+
     /**
      * @brief Start accept and cleanup background threads.
      */
@@ -60,8 +141,24 @@ class Server {
    private:
     /**
      * @brief Setup send callbacks for controller to route messages.
+     * @param controller Game controller of the room
+     * @param room Room name (empty for the default room)
+     */
+    void setupSendCallbacks(GameController& controller, const std::string& room);
+
+    /**
+     * @brief Get the controller of a room, creating it if needed.
+     *
+     * Must be called with rooms_mutex_ held.
+     *
+     * @param room Room name (empty for the default room)
      */
-    void setupSendCallbacks();
+    std::shared_ptr<GameController> roomController(const std::string& room);
+
+    /**
+     * @brief Drop the named rooms left without sessions nor seat holds.
+     */
+    void pruneRooms();
 
     /**
      * @brief Accept loop - handles incoming connections.
@@ -69,6 +166,58 @@ class Server {
      */
     void acceptLoop(std::stop_token st);
 
+    /**
+     * @brief Handoff loop - receives the clients and rooms passed by the router (worker mode).
+     * @param st Stop token for thread termination
+     */
+    void handoffLoop(std::stop_token st);
+
+    /**
+     * @brief Create, register and start the session of a client.
+     * @param client_fd Client socket
+     * @param address Client IP address (empty for Unix socket clients)
+     * @param room Room name (empty for the default room)
+     * @param pending Bytes already read from the client
+     */
+    void addSession(int client_fd, const std::string& address, const std::string& room,
+                    std::string_view pending);
+
+    /**
+     * @brief Create and register the session of a client, without starting it.
+     *
+     * @param client_fd Client socket
+     * @param address Client IP address (empty for Unix socket clients)
+     * @param room Room name (empty for the default room)
+     * @param session_id Session ID kept from another worker (empty: new ID)
+     * @return Registered session
+     */
+    std::shared_ptr<Session> createSession(int client_fd, const std::string& address,
+                                           const std::string& room, std::string session_id);
+
+    /**
+     * @brief Move a room and its sessions out to another worker, through the router.
+     *
+     * The sessions stop being read, the room is unlinked from this process, and
+     * its state and sockets are sent as ROOM_STATE, ROOM_SESSIONS and ROOM_END
+     * packets. Replies ROOM_FAILED if the room isn't here (or is the default room).
+     *
+     * @param channel_fd Channel to the router
+     * @param room Room name
+     */
+    void migrateOut(int channel_fd, const std::string& room);
+
+    /**
+     * @brief Take over a room migrating in, one packet at a time.
+     *
+     * The room is opened on its first sessions (or at its end), and ROOM_READY
+     * is replied once it is complete. Replies ROOM_FAILED and closes the
+     * sockets received if the room can't be taken over.
+     *
+     * @param channel_fd Channel to the router
+     * @param packet ROOM_STATE, ROOM_SESSIONS, ROOM_END or ROOM_FAILED packet
+     */
+    void migrateIn(int channel_fd, Handoff& packet);
+
     /**
      * @brief Cleanup loop - removes closed sessions periodically.
      * @param st Stop token for thread termination
@@ -86,6 +235,43 @@ class Server {
      */
     void cleanupClosedSessions();
 
+    /**
+     * @brief Turn a client away while overloaded, with the delay to retry after.
+     * @param client_fd Accepted client socket (closed on return)
+     */
+    static void rejectConnection(int client_fd);
+
+    /**
+     * @brief Check whether spectators skip a broadcast, and remember it if so.
+     *
+     * Only move results are thinned: each one carries the whole board, so the
+     * latest one is enough to catch up. Must be called with sessions_mutex_ held.
+     *
+     * @param room Room of the broadcast
+     * @param message Broadcast message
+     * @return True if the message must only reach players
+     */
+    bool holdForSpectators(const std::string& room, const std::string& message);
+
+    /**
+     * @brief Send the latest held move results to spectators once due (sampling thread).
+     * @param level Current overload level
+     */
+    void flushSpectatorUpdate(OverloadLevel level);
+
+    /**
+     * @brief Minimum time between two move results sent to spectators.
+     * @param level Current overload level (HIGH or above)
+     */
+    static std::chrono::milliseconds spectatorInterval(OverloadLevel level);
+
+    /**
+     * @brief Format the IP address of a client.
+     * @param peer Address returned by accept()
+     * @return IP address, or empty for Unix socket clients
+     */
+    static std::string peerAddress(const sockaddr_storage& peer);
+
     /**
      * @brief Connect TCP socket.
      * @param ip IP address to bind
@@ -96,21 +282,35 @@ class Server {
     /**
      * @brief Connect Unix domain socket.
      * @param socket_path Path to socket file
+     * @param type Socket type (SOCK_SEQPACKET for the router channel)
      */
-    void connectIPC(const std::string& socket_path);
+    void connectIPC(const std::string& socket_path, int type = SOCK_STREAM);
 
     /**
-     * @brief Broadcast message to all connected sessions.
+     * @brief Broadcast message to all sessions of a room.
+     * @param room Room name
      * @param message Message to broadcast
+     * @param delta Compact form sent instead to sessions in delta mode (empty if none)
      */
-    void broadcastToAll(const std::string& message);
+    void broadcastToAll(const std::string& room, const std::string& message,
+                        const std::string& delta);
 
     /**
-     * @brief Broadcast message to all sessions except one.
+     * @brief Broadcast message to all sessions of a room except one.
+     * @param room Room name
      * @param exclude_session_id Session ID to exclude from broadcast
      * @param message Message to broadcast
+     * @param delta Compact form sent instead to sessions in delta mode (empty if none)
      */
-    void broadcastToOthers(const std::string& exclude_session_id, const std::string& message);
+    void broadcastToOthers(const std::string& room, const std::string& exclude_session_id,
+                           const std::string& message, const std::string& delta);
+
+    /**
+     * @brief Send a broadcast message to one session, in the form it asked for.
+     * @return True if the delta was sent
+     */
+    static bool sendBroadcast(const Session& session, const std::string& message,
+                              const std::string& delta);
 
     /**
      * @brief Send message to specific session.
@@ -119,22 +319,79 @@ class Server {
      */
     void unicastTo(const std::string& session_id, const std::string& message);
 
-    NetworkMode network;            ///< Network mode (TCP/IPC)
-    int port;                       ///< Server port (TCP mode)
-    int server_fd = -1;             ///< Server socket file descriptor
-    std::string unix_socket_path_;  ///< Unix socket path (IPC mode)
+    NetworkMode network;               ///< Network mode (TCP/IPC)
+    int port;                          ///< Server port (TCP mode)
+    ParserType parser_;                ///< Parser type of the room controllers
+    int server_fd = -1;                ///< Server socket file descriptor
+    std::string unix_socket_path_;     ///< Unix socket path (IPC mode)
+    bool worker_ = false;              ///< Clients handed over by the router
+    std::atomic<int> channel_fd_{-1};  ///< Connection from the router (worker mode)
 
     std::atomic<bool> running{false};  ///< Server running flag
 
+    /// Reads all sessions; declared before them since their transports leave it on destruction.
+    EventLoop loop_;
+
+    /// Compression offered to clients (null when disabled); outlives the sessions using it.
+    std::unique_ptr<Compression> compression_;
+
     std::map<std::string, std::shared_ptr<Session>> sessions;  ///< Active sessions map
     std::mutex sessions_mutex_;                                ///< Mutex for sessions access
 
+    /// Active sessions of each room, the broadcast recipients (sessions_mutex_).
+    std::unordered_map<std::string, std::vector<std::shared_ptr<Session>>> room_sessions_;
+
     std::vector<std::string> sessions_to_cleanup_;  ///< Closed sessions queue
     std::mutex cleanup_mutex_;                      ///< Mutex for cleanup queue
 
     std::jthread acceptThread;   ///< Accept loop thread
     std::jthread cleanupThread;  ///< Cleanup loop thread
 
-    /// All player sessions share the same GameController (common GameContext).
+    /**
+     * @struct SpectatorUpdate
+     * @brief Move results of a room sent to spectators while thinning.
+     */
+    struct SpectatorUpdate {
+        std::string held;                                 ///< Latest move result held back
+        std::chrono::steady_clock::time_point last_sent;  ///< Last one sent to spectators
+    };
+
+    /// Thinned spectator updates of each room (sessions_mutex_).
+    std::unordered_map<std::string, SpectatorUpdate> spectator_updates_;
+
+    /// Message rate limits, applied before parsing (null when disabled).
+    std::unique_ptr<RateLimiter> rate_limiter_;
+
+    /// Inbound traffic capture, shared by all sessions (null when recording is disabled).
+    std::shared_ptr<TrafficRecorder> recorder_;
+
+    /// Load shedding (null when disabled); declared before the controller, which uses it.
+    std::unique_ptr<OverloadController> overload_;
+
+    /// Upload playback of every room; declared before the controllers, which use it.
+    UploadWorker upload_worker_;
+
+    /// Sessions of the default room share the same GameController (common GameContext).
     std::shared_ptr<GameController> shared_controller_;
+
+    /// Controllers of the named rooms; locked before sessions_mutex_.
+    std::map<std::string, std::shared_ptr<GameController>> rooms_;
+    std::mutex rooms_mutex_;  ///< Mutex for rooms access
+
+    std::chrono::seconds resume_grace_{30};  ///< Seat hold grace period of every room
+    std::chrono::milliseconds max_lag_{500};  ///< Lag compensation cap of every room
+
+    /**
+     * @struct IncomingRoom
+     * @brief Room migrating in from another worker.
+     */
+    struct IncomingRoom {
+        std::string state;                              ///< Serialised room received so far
+        std::shared_ptr<GameController> controller;     ///< Set once the room is opened
+        size_t sessions = 0;                            ///< Sessions adopted
+        std::chrono::steady_clock::time_point started;  ///< First packet received
+    };
+
+    /// Rooms migrating in (handoff thread only).
+    std::map<std::string, IncomingRoom> incoming_rooms_;
 };
\ No newline at end of file
@@ -3,74 +3,351 @@
 #include <iostream>
 #include <string>
 
+#include "BufferPool.hpp"
+#include "CommandTable.hpp"
 #include "GameController.hpp"
+#include "IpcTransport.hpp"
 #include "Logger.hpp"
+#include "MemoryAccounting.hpp"
+#include "Metrics.hpp"
+#include "TcpTransport.hpp"
 
-Session::Session(std::unique_ptr<ITransport> transport, std::shared_ptr<GameController> controller)
-    : transport(std::move(transport)),
-      controller(std::move(controller)),
-      session_id_(generateSessionId()) {
+namespace {
+
+/// Sent once per streak of rate-limited messages; the following ones are dropped silently.
+const std::string kRateLimitedError = R"({"type":"error","error":"Rate limit exceeded"})";
+
+/// Sent plain to a compressing client whose session moves: its stream ends there.
+const std::string kCompressionDisabled =
+    R"({"type":"compression_disabled","reason":"migrated"})";
+
+/// Inserted into session IDs, so they stay unique when sessions move between workers.
+std::string session_id_prefix;
+
+}  // namespace
+
+Session::Session(GameController& controller, TrafficRecorder* recorder, std::string session_id)
+    : controller(controller),
+      recorder_(recorder),
+      session_id_(session_id.empty() ? generateSessionId() : std::move(session_id)) {
     auto& logger = Logger::instance();
     logger.info("Session created: " + session_id_);
 }
 
 Session::~Session() {
+    if (buffer.capacity() > 0) {
+        BufferPool::instance().release(buffer);
+    }
+}
+
+std::string Session::handshake() {
+    json handshake = {{"type", "session_created"},
+                      {"session_id", session_id_},
+                      {"resume_token", controller.issueResumeToken(session_id_)}};
+    if (!room_.empty()) {
+        handshake["room"] = room_;
+    }
+    if (compression_) {
+        handshake["compression"] = {{"algorithms", {"zstd"}},
+                                    {"dictionary_id", compression_->dictionaryId()},
+                                    {"min_size", compression_->settings().min_size}};
+    }
+    return handshake.dump();
+}
+
+std::string Session::enableCompression(const std::string& message) {
+    json error = {{"type", "error"}};
+
+    try {
+        json request = json::parse(message);
+        std::string algorithm = request.value("algorithm", "zstd");
+        uint32_t dictionary_id = request.value("dictionary_id", 0u);
+
+        if (!compression_) {
+            error["error"] = "Compression not offered";
+        } else if (algorithm != "zstd") {
+            error["error"] = "Unsupported compression algorithm: " + algorithm;
+        } else if (dictionary_id != 0 && dictionary_id != compression_->dictionaryId()) {
+            error["error"] = "Unknown compression dictionary";
+        } else if (compressing_) {
+            error["error"] = "Compression already enabled";
+        } else {
+            // Switched on by the caller, once this answer is sent
+            compressor_ = compression_->createCompressor(dictionary_id != 0);
+
+            json response = {{"type", "compression_enabled"},
+                             {"algorithm", algorithm},
+                             {"dictionary_id", dictionary_id},
+                             {"min_size", compression_->settings().min_size}};
+            return response.dump();
+        }
+    } catch (const std::exception& e) {
+        error["error"] = std::string("Cannot enable compression: ") + e.what();
+    }
+
+    return error.dump();
+}
+
+std::string Session::setBroadcastMode(const std::string& message) {
+    json response;
+
+    try {
+        json request = json::parse(message);
+        std::string mode = request.value("mode", "full");
+
+        if (mode == "delta" || mode == "full") {
+            delta_broadcasts_.store(mode == "delta", std::memory_order_relaxed);
+            response = {{"type", "broadcast_mode"}, {"mode", mode}};
+            Logger::instance().debug("Broadcast mode " + mode + " for session: " + session_id_);
+        } else {
+            response = {{"type", "error"}, {"error", "Unknown broadcast mode: " + mode}};
+        }
+    } catch (const std::exception& e) {
+        response = {{"type", "error"},
+                    {"error", std::string("Cannot set broadcast mode: ") + e.what()}};
+    }
+
+    return response.dump();
+}
+
+void Session::logCompressionStats() const {
+    std::lock_guard<std::mutex> lock(compressor_mutex_);
+    const auto& stats = compressor_->stats();
+    Logger::instance().info(
+        "Session " + session_id_ + " compressed " + std::to_string(stats.messages) +
+        " messages (" + std::to_string(stats.skipped) + " too small): " +
+        std::to_string(stats.bytes_in) + " -> " + std::to_string(stats.bytes_out) + " bytes in " +
+        std::to_string(stats.compress_ns / 1000) + " us");
+}
+
+void Session::setCloseCallback(CloseCallback callback) {
+    on_close_callback = callback;
+}
+
+void Session::setRateLimiter(std::unique_ptr<SessionRateLimiter> limiter) {
+    rate_limiter_ = std::move(limiter);
+}
+
+void Session::setCompression(const Compression* compression) {
+    compression_ = compression;
+}
+
+void Session::setRoom(std::string room) {
+    room_ = std::move(room);
+}
+
+void Session::setIdPrefix(std::string prefix) {
+    session_id_prefix = std::move(prefix);
+}
+
+std::string Session::generateSessionId() {
+    static std::atomic<uint64_t> counter{0};
+    return "session_" + session_id_prefix + std::to_string(++counter);
+}
+
+template <typename Transport>
+BasicSession<Transport>::BasicSession(std::unique_ptr<Transport> transport,
+                                      GameController& controller, TrafficRecorder* recorder,
+                                      std::string session_id)
+    : Session(controller, recorder, std::move(session_id)), transport(std::move(transport)) {}
+
+template <typename Transport>
+BasicSession<Transport>::~BasicSession() {
     close();
 }
 
-void Session::start() {
+template <typename Transport>
+void BasicSession<Transport>::start(std::string_view pending) {
     // Required since nothing prevents start() from being called twice for the same instance.
     if (active.exchange(true))
         return;
 
     auto& logger = Logger::instance();
     logger.info("Session started: " + session_id_);
+    Metrics::instance().increment(Counter::SESSIONS_OPENED);
 
-    // Set close callback BEFORE starting transport
-    // Use weak_ptr to avoid circular reference
-    std::weak_ptr<Session> weak_self = shared_from_this();
-    transport->setCloseCallback([weak_self]() {
-        if (auto self = weak_self.lock()) {
-            auto& logger = Logger::instance();
-            logger.info("Transport closed unexpectedly for session: " + self->session_id_);
-            self->close();  // Trigger session cleanup
-        }
-    });
+    if (recorder_) {
+        recorder_->recordOpen(session_id_);
+    }
 
-    // Start receiving messages
-    transport->start([this](const std::string& payload) { onReceive(payload); });
+    // Send handshake as part of session initialisation, ahead of any answer
+    send(handshake());
+
+    // Not read by the transport yet, so no other thread touches the buffer
+    if (!pending.empty()) {
+        onReceive(pending);
+    }
 
-    // Send handshake as part of session initialisation
-    json handshake = {{"type", "session_created"}, {"session_id", session_id_}};
-    send(handshake.dump());
+    // Start receiving messages (the transport reports its closure to this listener too)
+    transport->start(*this);
 }
 
-void Session::onReceive(const std::string& raw) {
+template <typename Transport>
+void BasicSession<Transport>::adopt(const SessionTransfer& transfer) {
+    if (active.exchange(true))
+        return;
+
+    Logger::instance().info("Session adopted after migration: " + session_id_);
+    Metrics::instance().increment(Counter::SESSIONS_OPENED);
+    Metrics::instance().increment(Counter::SESSIONS_MIGRATED_IN);
+
+    if (recorder_) {
+        recorder_->recordOpen(session_id_);
+    }
+
+    // No handshake: the client doesn't notice the move
+    delta_broadcasts_.store(transfer.delta_broadcasts, std::memory_order_relaxed);
+    if (!transfer.pending.empty()) {
+        onReceive(transfer.pending);
+    }
+
+    transport->start(*this);
+}
+
+template <typename Transport>
+std::optional<SessionTransfer> BasicSession<Transport>::detach() {
+    if (!active)
+        return std::nullopt;
+
+    int fd = transport->detach();
+    if (fd < 0) {
+        return std::nullopt;
+    }
+
+    // No longer read by the event loop: the buffer can be handed over from this thread
+    SessionTransfer transfer{session_id_, fd, buffer, wantsDeltas()};
+
+    if (compressing_.load(std::memory_order_acquire)) {
+        // The stream state can't move: the following messages are plain, here and there
+        std::lock_guard<std::mutex> lock(compressor_mutex_);
+        compressing_.store(false, std::memory_order_release);
+        transport->send(kCompressionDisabled + "\n");
+    }
+
+    return transfer;
+}
+
+template <typename Transport>
+void BasicSession<Transport>::release() {
+    if (!active.exchange(false))
+        return;
+
+    Metrics::instance().increment(Counter::SESSIONS_CLOSED);
+    Metrics::instance().increment(Counter::SESSIONS_MIGRATED_OUT);
+
+    // Only closes this process' copy of the socket
+    transport->close();
+
+    if (recorder_) {
+        recorder_->recordClose(session_id_);
+    }
+
+    Logger::instance().info("Session migrated: " + session_id_);
+}
+
+template <typename Transport>
+void BasicSession<Transport>::onReceive(std::string_view data) {
     // Required to prevent callback function from being called during shutdown.
     if (!active)
         return;
 
-    // Accumulate data into buffer
-    buffer += raw;
+    // One clock read for all the messages of this read: rate limits and move receive times
+    int64_t now_ns = RateLimiter::now();
 
     // Process all complete messages (delimited by '\n')
-    while (buffer.find('\n') != std::string::npos) {
-        // Extract one complete message
-        size_t pos = buffer.find('\n');
-        std::string message = buffer.substr(0, pos);
-        buffer.erase(0, pos + 1);
+    size_t pos;
+    while ((pos = data.find('\n')) != std::string_view::npos) {
+        if (buffer.empty()) {
+            // Whole message in this read: no need to copy it into the buffer
+            std::string_view message = data.substr(0, pos);
+            if (allow(message, now_ns)) {
+                handleMessage(std::string(message), now_ns);
+            }
+        } else {
+            buffer.append(data.substr(0, pos));
+            if (allow(buffer, now_ns)) {
+                handleMessage(buffer, now_ns);
+            }
+            buffer.clear();
+        }
+        data.remove_prefix(pos + 1);
+    }
 
-        // Parse and handle this complete message
-        handleMessage(message);
+    if (!data.empty()) {
+        // Keep the incomplete message until the next read
+        MemoryScope scope(MemoryTag::SESSIONS);
+        if (buffer.capacity() == 0) {
+            buffer = BufferPool::instance().acquire();
+        }
+        buffer.append(data);
+    } else if (buffer.capacity() > 0) {
+        // Nothing pending: give the buffer back while the session is idle
+        BufferPool::instance().release(buffer);
     }
 }
 
-void Session::handleMessage(const std::string& message) {
+template <typename Transport>
+void BasicSession<Transport>::onMessage(std::string_view message) {
+    if (!active)
+        return;
+
+    int64_t now_ns = RateLimiter::now();
+    if (allow(message, now_ns)) {
+        handleMessage(std::string(message), now_ns);
+    }
+}
+
+template <typename Transport>
+bool BasicSession<Transport>::allow(std::string_view message, int64_t now_ns) {
+    if (!rate_limiter_ || rate_limiter_->allow(message, now_ns)) {
+        rate_limited_ = false;
+        return true;
+    }
+
+    // Rejected before parsing; only the first rejection of a streak costs a write
+    if (!rate_limited_) {
+        rate_limited_ = true;
+        send(kRateLimitedError);
+    }
+    return false;
+}
+
+template <typename Transport>
+void BasicSession<Transport>::onTransportClosed() {
+    auto& logger = Logger::instance();
+    logger.info("Transport closed unexpectedly for session: " + session_id_);
+    close();  // Trigger session cleanup
+}
+
+template <typename Transport>
+void BasicSession<Transport>::handleMessage(const std::string& message, int64_t received_ns) {
     auto& logger = Logger::instance();
     logger.debug("Received: " + message);
+    Metrics::instance().increment(Counter::MESSAGES_RECEIVED);
+
+    // Connection setting, not recorded: replay clients only read plain messages
+    auto command = findCommand(commandName(message));
+    if (command == CommandId::ENABLE_COMPRESSION) {
+        send(enableCompression(message));
+
+        // The answer was the last plain message of any size
+        if (compressor_ && !compressing_) {
+            compressing_.store(true, std::memory_order_release);
+            logger.info("Compression enabled for session: " + session_id_);
+        }
+        return;
+    }
+    if (command == CommandId::SET_BROADCAST_MODE) {
+        send(setBroadcastMode(message));
+        return;
+    }
+
+    if (recorder_) {
+        recorder_->recordMessage(session_id_, message);
+    }
 
     // Route message to game controller
-    auto response = controller->routeMessage(message, session_id_);
+    auto response = controller.routeMessage(message, session_id_, received_ns);
 
     // Send response to requesting client
     if (response.has_value()) {
@@ -79,22 +356,57 @@ void Session::handleMessage(const std::string& message) {
     }
 }
 
-void Session::send(const std::string& msg) const {
+template <typename Transport>
+void BasicSession<Transport>::send(const std::string& msg) const {
     // Required to prevent sending messages through an inactive session.
     if (!active)
         return;
+
+    if (compressing_.load(std::memory_order_acquire)) {
+        // The client decodes the stream in order: compress and send in one step
+        std::lock_guard<std::mutex> lock(compressor_mutex_);
+
+        // detach() may have turned compression off meanwhile, after its last frame
+        if (compressing_.load(std::memory_order_relaxed)) {
+            try {
+                if (auto compressed = compressor_->compress(msg)) {
+                    transport->sendCompressed(*compressed);
+                    return;
+                }
+            } catch (const std::exception& e) {
+                // Plain messages remain readable whatever the state of the stream
+                Logger::instance().error("Compression failed for session " + session_id_ +
+                                         ": " + e.what());
+            }
+        }
+    }
+
     transport->send(msg + "\n");
 }
 
-void Session::close() {
+template <typename Transport>
+void BasicSession<Transport>::close() {
     if (!active.exchange(false))
         return;
 
+    Metrics::instance().increment(Counter::SESSIONS_CLOSED);
+
     // Close transport
     if (transport) {
         transport->close();
     }
 
+    if (compressing_) {
+        logCompressionStats();
+    }
+
+    if (recorder_) {
+        recorder_->recordClose(session_id_);
+    }
+
+    // Free or hold the seat in the game of this session's room
+    controller.routeDisconnect(session_id_);
+
     // Notify server about session closure
     if (on_close_callback) {
         on_close_callback(session_id_);
@@ -104,11 +416,7 @@ void Session::close() {
     logger.info("Session closed: " + session_id_);
 }
 
-void Session::setCloseCallback(CloseCallback callback) {
-    on_close_callback = std::move(callback);
-}
-
-std::string Session::generateSessionId() {
-    static std::atomic<uint64_t> counter{0};
-    return "session_" + std::to_string(++counter);
-}
\ No newline at end of file
+// Transports of the server, plus the runtime-polymorphic one
+template class BasicSession<ITransport>;
+template class BasicSession<TcpTransport>;
+template class BasicSession<IpcTransport>;
@@ -2,47 +2,147 @@
 
 #include <atomic>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
-#include <thread>
-#include <unordered_map>
+#include <string_view>
 #include <utility>
 
+#include "Compression.hpp"
 #include "GameController.hpp"
 #include "ITransport.hpp"
+#include "RateLimiter.hpp"
+#include "SmallFunction.hpp"
+#include "TrafficRecorder.hpp"
 
-using CloseCallback = std::function<void(const std::string& session_id)>;
+/// Called once when the session closes (stored inline, no allocation).
+using CloseCallback = SmallFunction<void(const std::string& session_id)>;
+
+/**
+ * @struct SessionTransfer
+ * @brief Connection of a session moving to another server process with its room.
+ */
+struct SessionTransfer {
+    std::string session_id;         ///< Kept by the session in the other process
+    int fd = -1;                    ///< Client socket (still owned by the detached session)
+    std::string pending;            ///< Incomplete message already read from the client
+    bool delta_broadcasts = false;  ///< Receives moves as `move_delta`
+};
 
 /**
  * @brief Represents a single connected client session.
  *
- * The Session owns an ITransport (Strategy), parses JSON, and routes commands
- * using GameController.
+ * The Session owns a transport, parses JSON, and routes commands using
+ * GameController. This base class holds the state of the session and is what
+ * the server keeps; BasicSession implements it for a transport type.
+ *
+ * Idle sessions are kept small: no thread, no receive buffer (one is borrowed
+ * from the BufferPool only while a message is split across reads), and plain
+ * references to the controller and recorder owned by the server.
+ *
+ * When the server offers compression, the handshake advertises it and the
+ * client may opt in with `enable_compression`: large messages are then sent
+ * compressed, as one zstd stream per connection.
+ *
+ * With `set_broadcast_mode` "delta", the moves of the other players arrive as
+ * `move_delta` (encoded move, ply, position hash) instead of a full `move_result`.
+ *
+ * Behind the router, a session may start with bytes the router already read
+ * from the client: they're handled before reading from the transport. When
+ * its room moves to another worker, the session is detached (its socket goes
+ * along) and adopted on the other side under the same ID, without a new
+ * handshake; a compressing client is told to start a new stream.
  */
-class Session : public std::enable_shared_from_this<Session> {
+class Session : public TransportListener {
    public:
-    explicit Session(std::unique_ptr<ITransport> transport,
-                     std::shared_ptr<GameController> controller);
-    ~Session();
+    virtual ~Session();
 
-    void start();                                             ///< Start receiving messages
-    void send(const std::string& msg) const;                  ///< Send message over transport
-    void close();                                             ///< Shutdown session
+    virtual void start(std::string_view pending = {}) = 0;    ///< Start receiving messages
+    virtual void adopt(const SessionTransfer& transfer) = 0;  ///< Start a migrated session
+    virtual std::optional<SessionTransfer> detach() = 0;      ///< Stop reading, to migrate
+    virtual void release() = 0;                               ///< Close after migrating
+    virtual void send(const std::string& msg) const = 0;      ///< Send message over transport
+    virtual void close() = 0;                                 ///< Shutdown session
     std::string getSessionId() const { return session_id_; }  ///< Getter for the session id
     bool isActive() const { return active.load(); }
+    bool wantsDeltas() const { return delta_broadcasts_.load(std::memory_order_relaxed); }
+    bool isPlayer() const { return controller.isPlayer(session_id_); }
+    const std::string& getRoom() const { return room_; }  ///< Empty for the default room
 
     void setCloseCallback(CloseCallback callback);
+    void setRateLimiter(std::unique_ptr<SessionRateLimiter> limiter);  ///< Before start()
+    void setCompression(const Compression* compression);               ///< Before start()
+    void setRoom(std::string room);                                    ///< Before start()
 
-   private:
-    void onReceive(
-        const std::string& raw);  ///< Accumulate payloads until having received a complete message
-    void handleMessage(const std::string& message);  ///< Route complete message
-    static std::string generateSessionId();          ///< Generate unique session ID
+    /// Make session IDs unique across the worker processes (set once, before any session).
+    static void setIdPrefix(std::string prefix);
+
+   protected:
+    Session(GameController& controller, TrafficRecorder* recorder, std::string session_id);
 
-    std::unique_ptr<ITransport> transport;
-    std::shared_ptr<GameController> controller;
+    std::string handshake();                                    ///< `session_created` message
+    std::string enableCompression(const std::string& message);  ///< Answer `enable_compression`
+    std::string setBroadcastMode(const std::string& message);   ///< Answer `set_broadcast_mode`
+    void logCompressionStats() const;                           ///< At close, if compressing
+    static std::string generateSessionId();                     ///< Generate unique session ID
+
+    GameController& controller;  ///< Shared controller, owned by the server
+    TrafficRecorder* recorder_;  ///< Inbound traffic capture (optional, owned by the server)
     CloseCallback on_close_callback;
+    std::unique_ptr<SessionRateLimiter> rate_limiter_;  ///< Message rate limits (optional)
+    const Compression* compression_ = nullptr;          ///< Compression offer (optional)
+    std::unique_ptr<MessageCompressor> compressor_;     ///< Set once the client opted in
+    std::atomic<bool> compressing_{false};              ///< Publishes compressor_ to senders
+    mutable std::mutex compressor_mutex_;               ///< Compress and send in stream order
+    std::atomic<bool> delta_broadcasts_{false};         ///< Receive moves as `move_delta`
     std::string session_id_;  ///< Unique identifier for this session
+    std::string room_;        ///< Room whose game the controller plays
     std::atomic<bool> active{
         false};          /// Useful to avoid passing messages in callback functions during shutdown.
-    std::string buffer;  /// Buffer to accumulate message fragments
-};
\ No newline at end of file
+    bool rate_limited_ = false;  ///< Last message was rate limited (event loop thread only)
+    std::string buffer;  /// Fragment of an incomplete message (pooled, empty when idle)
+};
+
+/**
+ * @class BasicSession
+ * @brief Session bound to its transport type at compile time.
+ *
+ * With a final transport (TcpTransport, IpcTransport), a message goes from
+ * the transport read to the controller, and the reply back to the transport,
+ * without a virtual call: the transport calls the session as this final type
+ * and the session calls the transport as its own. Two virtual calls remain
+ * around that path: the event loop dispatching to the transport
+ * (EventHandler), and broadcasts, which the server sends through Session.
+ * With ITransport, the transport is chosen at run time: WebSocket connections
+ * and test doubles use BasicSession<ITransport>.
+ *
+ * Member functions are defined in Session.cpp, which instantiates the
+ * supported transports.
+ *
+ * @tparam Transport ITransport or a final implementation of it
+ */
+template <typename Transport>
+class BasicSession final : public Session {
+   public:
+    explicit BasicSession(std::unique_ptr<Transport> transport, GameController& controller,
+                          TrafficRecorder* recorder = nullptr, std::string session_id = {});
+    ~BasicSession() override;
+
+    void start(std::string_view pending = {}) override;
+    void adopt(const SessionTransfer& transfer) override;
+    std::optional<SessionTransfer> detach() override;
+    void release() override;
+    void send(const std::string& msg) const override;
+    void close() override;
+
+   private:
+    friend Transport;  // Calls the listener functions below directly
+
+    void onReceive(std::string_view data) override;        ///< Split data into messages
+    void onMessage(std::string_view message) override;     ///< Handle a transport-framed message
+    void onTransportClosed() override;                     ///< Close after the peer left
+    bool allow(std::string_view message, int64_t now_ns);  ///< Rate limit check, before parsing
+    void handleMessage(const std::string& message, int64_t received_ns);  ///< Route it
+
+    std::unique_ptr<Transport> transport;
+};
@@ -0,0 +1,25 @@
+#include "SessionFactory.hpp"
+
+#include "IpcTransport.hpp"
+#include "TcpTransport.hpp"
+#include "TransportFactory.hpp"
+
+std::shared_ptr<Session> SessionFactory::create(int fd, NetworkMode network, EventLoop& loop,
+                                                GameController& controller,
+                                                TrafficRecorder* recorder,
+                                                std::string session_id) {
+    switch (network) {
+        case NetworkMode::IPC:
+            return std::make_shared<BasicSession<IpcTransport>>(
+                std::make_unique<IpcTransport>(fd, loop), controller, recorder,
+                std::move(session_id));
+        case NetworkMode::TCP:
+            return std::make_shared<BasicSession<TcpTransport>>(
+                std::make_unique<TcpTransport>(fd, loop), controller, recorder,
+                std::move(session_id));
+        default:
+            return std::make_shared<BasicSession<ITransport>>(
+                TransportFactory::create(fd, network, loop), controller, recorder,
+                std::move(session_id));
+    }
+}
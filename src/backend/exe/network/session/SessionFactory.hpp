@@ -0,0 +1,20 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "EventLoop.hpp"
+#include "NetworkMode.hpp"
+#include "Session.hpp"
+
+/**
+ * @brief Creates the session of an accepted socket, specialised on the transport of the mode.
+ *
+ * TCP and IPC sessions are bound to their transport at compile time; WebSocket
+ * sessions go through ITransport (see TransportFactory).
+ */
+struct SessionFactory {
+    static std::shared_ptr<Session> create(int fd, NetworkMode network, EventLoop& loop,
+                                           GameController& controller, TrafficRecorder* recorder,
+                                           std::string session_id = {});
+};
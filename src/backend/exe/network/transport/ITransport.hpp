@@ -1,7 +1,45 @@
 #pragma once
 
-#include <functional>
+#include <cstddef>
 #include <string>
+#include <string_view>
+
+/**
+ * @class TransportListener
+ * @brief Receiver of the data and closure of a transport (implemented by Session).
+ *
+ * A single interface pointer per transport replaces two std::function
+ * callbacks, which matters when thousands of connections sit idle.
+ */
+class TransportListener {
+   public:
+    virtual ~TransportListener() = default;
+
+    /**
+     * @brief Called when data is received on the transport.
+     *
+     * The view is only valid during the call: it points into the event loop
+     * read buffer, shared by all connections.
+     *
+     * @param data Raw bytes, possibly several or partial messages
+     */
+    virtual void onReceive(std::string_view data) = 0;
+
+    /**
+     * @brief Called when a whole message is received on a message-framed transport.
+     *
+     * Used instead of onReceive() by transports delimiting messages
+     * themselves (WebSocket). The view is only valid during the call.
+     *
+     * @param message One complete message
+     */
+    virtual void onMessage(std::string_view message) = 0;
+
+    /**
+     * @brief Called when the peer closes the connection or a read fails.
+     */
+    virtual void onTransportClosed() = 0;
+};
 
 /**
  * @class ITransport
@@ -17,18 +55,8 @@
  */
 class ITransport {
    public:
-    /**
-     * @brief Function type called when data is received on the transport.
-     *
-     * The callback receives raw text extracted from the socket or other transport
-     * mechanism.
-     */
-    using ReceiveCallback = std::function<void(const std::string&)>;
-
-    /**
-     * @brief Function type called when the transport closes unexpectedly.
-     */
-    using CloseCallback = std::function<void()>;
+    /// Zero byte and size in front of a compressed message (stream transports).
+    static constexpr size_t kCompressedHeaderSize = 5;
 
     /// Virtual destructor
     virtual ~ITransport() = default;
@@ -44,14 +72,15 @@ class ITransport {
     virtual bool connect() = 0;
 
     /**
-     * @brief Starts the transport input loop.
+     * @brief Starts the transport input.
      *
-     * Implementations typically start a background thread that continuously reads
-     * from the connection. When data is received, the provided callback is invoked.
+     * Implementations typically register the connection with the event loop.
+     * When data is received, or the connection is closed by the peer, the
+     * listener is notified.
      *
-     * @param onReceive Callback invoked each time a full payload is received.
+     * @param listener Receiver of the data, must outlive the transport.
      */
-    virtual void start(ReceiveCallback onReceive) = 0;
+    virtual void start(TransportListener& listener) = 0;
 
     /**
      * @brief Sends raw text data through the transport.
@@ -61,16 +90,39 @@ class ITransport {
     virtual void send(const std::string& data) = 0;
 
     /**
-     * @brief Closes the underlying transport connection.
+     * @brief Sends a compressed message through the transport.
      *
-     * Concrete implementations must stop background threads and release system
-     * resources.
+     * Stream transports frame it with a zero byte, which no JSON message
+     * starts with, followed by its size on 4 bytes (big-endian). Message
+     * transports may send it as a binary message instead.
+     *
+     * @param payload Compressed message
      */
-    virtual void close() = 0;
+    virtual void sendCompressed(std::string_view payload) {
+        std::string frame(kCompressedHeaderSize, '\0');
+        for (size_t i = 0; i < 4; ++i) {
+            frame[kCompressedHeaderSize - 1 - i] = static_cast<char>(payload.size() >> (8 * i));
+        }
+        frame.append(payload);
+        send(frame);
+    }
 
     /**
-     * @brief Sets a callback to be invoked when the transport closes unexpectedly.
-     * @param onClose Callback to handle connection closure.
+     * @brief Stops reading the connection and keeps it open for another process.
+     *
+     * Used to move a session to another server process: the socket can still be
+     * written to until close(), which then releases it without shutting the
+     * connection down. Waits for a read of the socket running on the event loop.
+     *
+     * @return Socket descriptor, or -1 if the connection can't be handed over
+     */
+    virtual int detach() { return -1; }
+
+    /**
+     * @brief Closes the underlying transport connection.
+     *
+     * Concrete implementations must stop notifying the listener and release
+     * system resources.
      */
-    virtual void setCloseCallback(CloseCallback onClose) = 0;
+    virtual void close() = 0;
 };
\ No newline at end of file
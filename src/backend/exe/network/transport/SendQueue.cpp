@@ -0,0 +1,132 @@
+#include "SendQueue.hpp"
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "Logger.hpp"
+#include "Metrics.hpp"
+
+void SendQueue::watch(uint64_t registration) {
+    registration_ = registration;
+    updateWatch();
+}
+
+bool SendQueue::write(int fd, iovec* iov, size_t count) {
+    if (failed_ || fd < 0) {
+        return false;
+    }
+
+    // Behind queued bytes: the stream stays in order
+    if (!empty()) {
+        return append(fd, iov, count);
+    }
+
+    while (count > 0) {
+        msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+
+        // A peer gone since the last read must not kill the whole server with SIGPIPE
+        ssize_t sent = sendmsg(fd, &msg, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return append(fd, iov, count);
+            }
+            fail(fd, "Write error: " + std::string(strerror(errno)));
+            return false;
+        }
+
+        // Skip what was written, possibly stopping inside a buffer
+        size_t written = static_cast<size_t>(sent);
+        while (count > 0 && written >= iov->iov_len) {
+            written -= iov->iov_len;
+            ++iov;
+            --count;
+        }
+        if (count > 0) {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + written;
+            iov->iov_len -= written;
+        }
+    }
+
+    return true;
+}
+
+bool SendQueue::flush(int fd) {
+    if (failed_ || fd < 0) {
+        return false;
+    }
+
+    while (!empty()) {
+        ssize_t sent =
+            ::send(fd, queued_.data() + offset_, queued_.size() - offset_, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return true;  // Still full: the loop calls again
+            }
+            fail(fd, "Write error: " + std::string(strerror(errno)));
+            return false;
+        }
+        offset_ += static_cast<size_t>(sent);
+    }
+
+    std::string().swap(queued_);
+    offset_ = 0;
+    updateWatch();
+    return true;
+}
+
+bool SendQueue::append(int fd, const iovec* iov, size_t count) {
+    size_t size = 0;
+    for (size_t i = 0; i < count; ++i) {
+        size += iov[i].iov_len;
+    }
+
+    if (queued_.size() - offset_ + size > kMaxQueuedSize) {
+        Metrics::instance().increment(Counter::SLOW_CLIENTS_DROPPED);
+        fail(fd, "Client not reading, " + std::to_string(queued_.size() - offset_) +
+                     " bytes unsent");
+        return false;
+    }
+
+    // Written bytes go first, so the queue never grows past the unsent ones
+    queued_.erase(0, offset_);
+    offset_ = 0;
+    for (size_t i = 0; i < count; ++i) {
+        queued_.append(static_cast<const char*>(iov[i].iov_base), iov[i].iov_len);
+    }
+
+    updateWatch();
+    return true;
+}
+
+void SendQueue::fail(int fd, const std::string& reason) {
+    Logger::instance().warning(reason + " on fd " + std::to_string(fd) + ", closing");
+
+    failed_ = true;
+    std::string().swap(queued_);
+    offset_ = 0;
+    updateWatch();
+
+    // The loop reads the end of stream and the session closes from there
+    shutdown(fd, SHUT_RDWR);
+}
+
+void SendQueue::updateWatch() {
+    bool wanted = !empty();
+    if (registration_ == 0 || wanted == watching_) {
+        return;
+    }
+
+    loop_.watchWritable(registration_, wanted);
+    watching_ = wanted;
+}
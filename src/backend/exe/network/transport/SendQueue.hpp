@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "EventLoop.hpp"
+
+struct iovec;
+
+/**
+ * @class SendQueue
+ * @brief Bytes a non-blocking socket didn't take yet, written out when it drains.
+ *
+ * Replies and broadcasts are written from the event loop thread, so a write
+ * must never wait for a client: what the socket doesn't take at once is
+ * queued, the loop watches the socket for writability meanwhile, and the
+ * transport flushes the queue from EventHandler::onWritable(). Later writes go
+ * after the queued bytes, keeping the stream in order.
+ *
+ * A client that stops reading would make the queue grow without bound: past
+ * kMaxQueuedSize, or on a write error, the connection is shut down. The loop
+ * then reads its end of stream and the session closes as if the peer had left.
+ *
+ * Not thread-safe: the transport serialises calls with its send lock. The
+ * queue holds no memory while empty.
+ */
+class SendQueue {
+   public:
+    static constexpr size_t kMaxQueuedSize = 1024 * 1024;  ///< Unsent bytes before dropping
+
+    /**
+     * @param loop Event loop watching the socket
+     */
+    explicit SendQueue(EventLoop& loop) : loop_(loop) {}
+
+    /**
+     * @brief Set the event loop registration of the socket, once it's watched.
+     *
+     * Bytes queued before are flushed as soon as the socket is writable.
+     *
+     * @param registration Registration ID returned by EventLoop::add()
+     */
+    void watch(uint64_t registration);
+
+    /**
+     * @brief Write buffers after the queued bytes, queueing what the socket doesn't take.
+     * @param fd Socket
+     * @param iov Buffers (advanced past the bytes written)
+     * @param count Number of buffers
+     * @return False if the connection failed (now or before), the data being dropped
+     */
+    bool write(int fd, iovec* iov, size_t count);
+
+    /**
+     * @brief Write queued bytes, once the socket is writable again (event loop thread).
+     * @param fd Socket
+     * @return False if the connection failed
+     */
+    bool flush(int fd);
+
+    /**
+     * @brief Check whether every byte was written.
+     */
+    bool empty() const { return offset_ == queued_.size(); }
+
+   private:
+    /**
+     * @brief Queue the rest of the buffers, or fail the connection past kMaxQueuedSize.
+     */
+    bool append(int fd, const iovec* iov, size_t count);
+
+    /**
+     * @brief Shut a connection down after a write error or an overflow.
+     * @param fd Socket
+     * @param reason Logged cause
+     */
+    void fail(int fd, const std::string& reason);
+
+    /**
+     * @brief Watch the socket for writability while bytes are queued, and only then.
+     */
+    void updateWatch();
+
+    EventLoop& loop_;
+    uint64_t registration_ = 0;  ///< Event loop registration (0 until watched)
+    bool watching_ = false;      ///< Writability watched
+    bool failed_ = false;        ///< Shut down: nothing is written any more
+    std::string queued_;         ///< Unsent bytes, from offset_
+    size_t offset_ = 0;          ///< Bytes of queued_ already written
+};
@@ -2,13 +2,17 @@
 
 #include "IpcTransport.hpp"
 #include "TcpTransport.hpp"
+#include "WebSocketTransport.hpp"
 
-std::unique_ptr<ITransport> TransportFactory::create(int fd, NetworkMode network) {
+std::unique_ptr<ITransport> TransportFactory::create(int fd, NetworkMode network,
+                                                     EventLoop& loop) {
     switch (network) {
         case NetworkMode::IPC:
-            return std::make_unique<IpcTransport>(fd);
+            return std::make_unique<IpcTransport>(fd, loop);
+        case NetworkMode::WEBSOCKET:
+            return std::make_unique<WebSocketTransport>(fd, loop);
         case NetworkMode::TCP:
         default:
-            return std::make_unique<TcpTransport>(fd);
+            return std::make_unique<TcpTransport>(fd, loop);
     }
 }
\ No newline at end of file
@@ -2,9 +2,10 @@
 
 #include <memory>
 
+#include "EventLoop.hpp"
 #include "ITransport.hpp"
 #include "NetworkMode.hpp"
 
 struct TransportFactory {
-    static std::unique_ptr<ITransport> create(int fd, NetworkMode network);
-};
\ No newline at end of file
+    static std::unique_ptr<ITransport> create(int fd, NetworkMode network, EventLoop& loop);
+};
@@ -1,52 +1,83 @@
 #pragma once
 
 #include <atomic>
-#include <thread>
+#include <cstdint>
+#include <mutex>
 
+#include "EventLoop.hpp"
 #include "ITransport.hpp"
+#include "SendQueue.hpp"
+
+template <typename Transport>
+class BasicSession;
 
 /**
  * @class IpcTransport
  * @brief Concrete transport implementation using POSIX Unix domain sockets
+ *
+ * This class implements the ITransport interface using a standard
+ * POSIX Unix domain socket. It provides a bidirectional text-based
+ * communication channel used by the server to exchange messages with
+ * remote clients (console frontend, GUI, etc.).
+ *
+ * Final, and calling its BasicSession<IpcTransport> directly, like TcpTransport.
  */
-class IpcTransport : public ITransport {
+class IpcTransport final : public ITransport, private EventHandler {
    public:
     /**
      * @brief Construct a transport from an already-accepted Unix socket descriptor.
      *
      * @param socket_fd File descriptor representing an open Unix domain socket connection.
+     * @param loop Event loop reading the socket.
      */
-    IpcTransport(int socket_fd);
+    IpcTransport(int socket_fd, EventLoop& loop);
 
     /**
-     * @brief Destructor closes the socket and stops background threads.
+     * @brief Destructor closes the socket and leaves the event loop.
      */
     ~IpcTransport();
 
     /**
-     * @brief Starts the asynchronous reading loop.
+     * @brief Starts reading the socket.
+     *
+     * This method registers the socket with the event loop. When data is
+     * available, the loop thread reads it and notifies the listener.
+     *
+     * @param listener Receiver of the data.
+     */
+    void start(TransportListener& listener) override;
+
+    /**
+     * @brief Starts reading the socket for a session bound to this transport type.
      *
-     * This method spawns a thread that monitors the socket for incoming data.
-     * When data is available, the thread invokes the provided callback.
+     * The data and closure then reach the session without a virtual call.
      *
-     * @param onReceive Functor invoked when a full text payload is received.
+     * @param session Receiver of the data.
      */
-    void start(ReceiveCallback onReceive) override;
+    void start(BasicSession<IpcTransport>& session);
 
     /**
      * @brief Sends raw text data to the connected client.
      *
-     * Internally this writes on the stored socket descriptor.
+     * Internally this writes on the stored socket descriptor, which is
+     * non-blocking: what it doesn't take is queued and written by the event
+     * loop once the client reads (see SendQueue).
      *
      * @param data The raw string to send.
      */
     void send(const std::string& data) override;
 
     /**
-     * @brief Closes the transport connection and terminates the reading loop.
+     * @brief Stops reading the socket and keeps it open for another process.
+     * @return The socket descriptor, or -1 if the transport is closed or has unsent data.
+     */
+    int detach() override;
+
+    /**
+     * @brief Closes the transport connection.
      *
      * This method:
-     * - Stops the background reading thread.
+     * - Removes the socket from the event loop.
      * - Shuts down the Unix socket connection.
      * - Closes the underlying socket file descriptor.
      *
@@ -55,13 +86,6 @@ class IpcTransport : public ITransport {
      */
     void close() override;
 
-    /**
-     * @brief Sets callback to be invoked when connection closes unexpectedly.
-     *
-     * @param onClose Callback function to handle connection closure.
-     */
-    void setCloseCallback(CloseCallback onClose) override;
-
     /**
      * @brief Implements the connect() method from ITransport.
      * Since the socket is already connected, this simply returns true.
@@ -69,8 +93,23 @@ class IpcTransport : public ITransport {
     bool connect() override;
 
    private:
-    int fd;                            ///< Underlying POSIX Unix socket descriptor.
-    std::jthread readerThread;         ///< Background thread reading the socket.
-    std::atomic<bool> running{false};  ///< Indicates whether the read loop is active.
-    CloseCallback closeCallback_;      ///< Callback invoked on unexpected closure.
-};
\ No newline at end of file
+    /**
+     * @brief Read available data (event loop thread).
+     */
+    void onReadable() override;
+
+    /**
+     * @brief Write queued data (event loop thread).
+     */
+    void onWritable() override;
+
+    int fd;                                 ///< Underlying POSIX Unix socket descriptor.
+    std::atomic<bool> running{true};        ///< False once the transport is closed.
+    EventLoop& loop_;                       ///< Event loop reading the socket.
+    TransportListener* listener_ = nullptr;  ///< Receiver of data and closure.
+    BasicSession<IpcTransport>* session_ = nullptr;  ///< Same receiver, called directly (if a session).
+    uint64_t registration_ = 0;             ///< Event loop registration ID (0 before start).
+    std::atomic<bool> detached_{false};     ///< Handed over: closed without shutdown.
+    std::mutex send_mutex_;                 ///< Serialises writes from all sending threads.
+    SendQueue outbound_{loop_};             ///< Data the socket didn't take yet (send_mutex_).
+};
@@ -1,24 +1,30 @@
 #include "TcpTransport.hpp"
 
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include <cstring>
 #include <iostream>
 
 #include "Logger.hpp"
+#include "Session.hpp"
 
 /**
  * @brief Constructs a POSIX TCP transport with an existing socket.
  * @param socket_fd The file descriptor of the connected socket.
+ * @param loop The event loop reading the socket.
  */
-TcpTransport::TcpTransport(int socket_fd) : fd(socket_fd) {}
+TcpTransport::TcpTransport(int socket_fd, EventLoop& loop) : fd(socket_fd), loop_(loop) {}
 
 /**
  * @brief Destructor ensures that the socket is closed.
  */
 TcpTransport::~TcpTransport() {
     close();
+
+    // Waits for a read of this socket still running on the loop thread
+    loop_.remove(registration_);
 }
 
 /**
@@ -32,82 +38,118 @@ bool TcpTransport::connect() {
     return true;
 }
 
-void TcpTransport::setCloseCallback(CloseCallback onClose) {
-    closeCallback_ = onClose;
-}
-
 /**
  * @brief Starts receiving data on the transport.
- * @param onReceive Callback function to handle received data.
+ * @param listener Receiver of the data.
  */
-void TcpTransport::start(ReceiveCallback onReceive) {
+void TcpTransport::start(TransportListener& listener) {
     // Required since nothing prevents start() from being called twice for the same instance.
-    if (running.exchange(true))
+    if (registration_ != 0 || !running.load())
         return;
 
     auto& logger = Logger::instance();
-    logger.trace("Starting reader thread for fd " + std::to_string(fd));
-
-    readerThread = std::jthread([this, onReceive](std::stop_token st) {
-        auto& logger = Logger::instance();
-        logger.trace("Reader thread started for fd " + std::to_string(fd));
-
-        char buffer[1024];
-        bool connection_closed_by_peer = false;
-
-        while (!st.stop_requested() && running.load()) {
-            logger.trace("Calling read() on fd " + std::to_string(fd));
-            ssize_t n = read(fd, buffer, sizeof(buffer));
-            logger.trace("read() returned " + std::to_string(n) + " for fd " + std::to_string(fd));
-
-            if (n <= 0) {
-                if (n == 0) {
-                    logger.trace("Client disconnected (EOF) on fd " + std::to_string(fd));
-                    connection_closed_by_peer = true;
-                } else {
-                    logger.error("Read error on fd " + std::to_string(fd) + ": " +
-                                 std::string(strerror(errno)));
-                    connection_closed_by_peer = true;
-                }
-                running = false;
-                break;
-            }
-
-            std::string payload(buffer, n);
-            onReceive(payload);
-        }
+    logger.trace("Registering fd " + std::to_string(fd) + " with the event loop");
 
-        logger.trace("Reader thread EXITING for fd " + std::to_string(fd));
+    listener_ = &listener;
+    registration_ = loop_.add(fd, *this);
 
-        // Notify session that connection died
-        if (connection_closed_by_peer && closeCallback_) {
-            logger.trace("Invoking close callback for fd " + std::to_string(fd));
-            closeCallback_();
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    outbound_.watch(registration_);
+}
+
+/**
+ * @brief Starts receiving data for a session of this transport type.
+ * @param session Receiver of the data, called without virtual dispatch.
+ */
+void TcpTransport::start(BasicSession<TcpTransport>& session) {
+    // Set before the socket is watched, so every read sees it
+    if (registration_ == 0) {
+        session_ = &session;
+    }
+    start(static_cast<TransportListener&>(session));
+}
+
+/**
+ * @brief Reads the data available on the socket (event loop thread).
+ */
+void TcpTransport::onReadable() {
+    auto buffer = loop_.readBuffer();
+    ssize_t n = read(fd, buffer.data(), buffer.size());
+
+    if (n > 0) {
+        std::string_view data(buffer.data(), n);
+        if (session_) {
+            session_->onReceive(data);
+        } else {
+            listener_->onReceive(data);
         }
-    });
+        return;
+    }
+
+    if (n < 0 && (errno == EINTR || errno == EAGAIN)) {
+        return;  // Level-triggered: the loop calls again
+    }
+
+    auto& logger = Logger::instance();
+    if (n == 0) {
+        logger.trace("Client disconnected (EOF) on fd " + std::to_string(fd));
+    } else {
+        logger.error("Read error on fd " + std::to_string(fd) + ": " + std::string(strerror(errno)));
+    }
+
+    // Notify session that connection died (it closes this transport)
+    if (session_) {
+        session_->onTransportClosed();
+    } else {
+        listener_->onTransportClosed();
+    }
+}
+
+/**
+ * @brief Writes the queued data the socket takes now (event loop thread).
+ */
+void TcpTransport::onWritable() {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    outbound_.flush(fd);
 }
 
 /**
- * @brief Sends data over the transport.
+ * @brief Sends data over the transport, queueing what the socket doesn't take at once.
  * @param data The data to send.
- * @return Number of bytes sent, or -1 on error.
  */
 void TcpTransport::send(const std::string& data) {
     if (!running.load()) {
         return;
     }
 
-    ssize_t sent = write(fd, data.data(), data.size());
-    if (sent < 0) {
-        auto& logger = Logger::instance();
-        logger.error("Write error on fd " + std::to_string(fd) + ": " +
-                     std::string(strerror(errno)));
-        running = false;
+    // Never waits for the client: the event loop thread sends too
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    iovec iov{const_cast<char*>(data.data()), data.size()};
+    outbound_.write(fd, &iov, 1);
+}
+
+/**
+ * @brief Stops reading the socket, which stays open for another process.
+ * @return The socket descriptor, or -1 if the transport is closed.
+ */
+int TcpTransport::detach() {
+    if (!running.load() || detached_.exchange(true))
+        return -1;
+
+    // Waits for a read of this socket still running on the loop thread
+    loop_.remove(registration_);
+
+    // Unsent bytes can't follow the socket: the session is closed instead
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    if (!outbound_.empty()) {
+        detached_.store(false);
+        return -1;
     }
+    return fd;
 }
 
 /**
- * @brief Closes the TCP socket and terminates the reading loop.
+ * @brief Closes the TCP socket and leaves the event loop.
  */
 void TcpTransport::close() {
     if (!running.exchange(false))
@@ -116,9 +158,16 @@ void TcpTransport::close() {
     auto& logger = Logger::instance();
     logger.debug("Closing transport on fd " + std::to_string(fd));
 
-    // Close socket first to unblock read()
+    loop_.remove(registration_);
+
+    // Under the send lock: nothing can be written to a descriptor closed (or reused) meanwhile
+    std::lock_guard<std::mutex> lock(send_mutex_);
+
     if (fd >= 0) {
-        shutdown(fd, SHUT_RDWR);
+        // A socket handed over lives on in the other process
+        if (!detached_.load()) {
+            shutdown(fd, SHUT_RDWR);
+        }
         ::close(fd);
         fd = -1;
     }
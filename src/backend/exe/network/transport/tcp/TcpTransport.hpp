@@ -1,9 +1,15 @@
 #pragma once
 
 #include <atomic>
-#include <thread>
+#include <cstdint>
+#include <mutex>
 
+#include "EventLoop.hpp"
 #include "ITransport.hpp"
+#include "SendQueue.hpp"
+
+template <typename Transport>
+class BasicSession;
 
 /**
  * @class TcpTransport
@@ -13,45 +19,68 @@
  * POSIX TCP/IP socket. It provides a bidirectional text-based
  * communication channel used by the server to exchange messages with
  * remote clients (console frontend, GUI, etc.).
+ *
+ * The class is final, and calls the BasicSession<TcpTransport> it feeds as
+ * such: between the read of the socket and the controller, and from the reply
+ * back to the socket, a message meets no virtual call. The event loop still
+ * reaches the transport through EventHandler, and broadcasts through Session.
  */
-class TcpTransport : public ITransport {
+class TcpTransport final : public ITransport, private EventHandler {
    public:
     /**
      * @brief Construct a transport from an already-accepted socket descriptor.
      *
      * @param socket_fd File descriptor representing an open TCP connection.
+     * @param loop Event loop reading the socket.
      */
-    TcpTransport(int socket_fd);
+    TcpTransport(int socket_fd, EventLoop& loop);
 
     /**
-     * @brief Destructor closes the socket and stops background threads.
+     * @brief Destructor closes the socket and leaves the event loop.
      */
     ~TcpTransport();
 
     /**
-     * @brief Starts the asynchronous reading loop.
+     * @brief Starts reading the socket.
      *
-     * This method spawns a thread that monitors the socket for incoming data.
-     * When data is available, the thread invokes the provided callback.
+     * This method registers the socket with the event loop. When data is
+     * available, the loop thread reads it and notifies the listener.
      *
-     * @param onReceive Functor invoked when a full text payload is received.
+     * @param listener Receiver of the data.
      */
-    void start(ReceiveCallback onReceive) override;
+    void start(TransportListener& listener) override;
+
+    /**
+     * @brief Starts reading the socket for a session bound to this transport type.
+     *
+     * The data and closure then reach the session without a virtual call.
+     *
+     * @param session Receiver of the data.
+     */
+    void start(BasicSession<TcpTransport>& session);
 
     /**
      * @brief Sends raw text data to the connected client.
      *
-     * Internally this writes on the stored socket descriptor.
+     * Internally this writes on the stored socket descriptor, which is
+     * non-blocking: what it doesn't take is queued and written by the event
+     * loop once the client reads (see SendQueue).
      *
      * @param data The raw string to send.
      */
     void send(const std::string& data) override;
 
     /**
-     * @brief Closes the transport connection and terminates the reading loop.
+     * @brief Stops reading the socket and keeps it open for another process.
+     * @return The socket descriptor, or -1 if the transport is closed or has unsent data.
+     */
+    int detach() override;
+
+    /**
+     * @brief Closes the transport connection.
      *
      * This method:
-     * - Stops the background reading thread.
+     * - Removes the socket from the event loop.
      * - Shuts down the TCP connection.
      * - Closes the underlying socket file descriptor.
      *
@@ -66,11 +95,24 @@ class TcpTransport : public ITransport {
      */
     bool connect() override;
 
-    void setCloseCallback(CloseCallback onClose) override;
-
    private:
-    int fd;                            ///< Underlying POSIX socket descriptor.
-    std::jthread readerThread;         ///< Background thread reading the socket.
-    std::atomic<bool> running{false};  ///< Indicates whether the read loop is active.
-    CloseCallback closeCallback_;
+    /**
+     * @brief Read available data (event loop thread).
+     */
+    void onReadable() override;
+
+    /**
+     * @brief Write queued data (event loop thread).
+     */
+    void onWritable() override;
+
+    int fd;                                 ///< Underlying POSIX socket descriptor.
+    std::atomic<bool> running{true};        ///< False once the transport is closed.
+    EventLoop& loop_;                       ///< Event loop reading the socket.
+    TransportListener* listener_ = nullptr;  ///< Receiver of data and closure.
+    BasicSession<TcpTransport>* session_ = nullptr;  ///< Same receiver, called directly (if a session).
+    uint64_t registration_ = 0;             ///< Event loop registration ID (0 before start).
+    std::atomic<bool> detached_{false};     ///< Handed over: closed without shutdown.
+    std::mutex send_mutex_;                 ///< Serialises writes from all sending threads.
+    SendQueue outbound_{loop_};             ///< Data the socket didn't take yet (send_mutex_).
 };
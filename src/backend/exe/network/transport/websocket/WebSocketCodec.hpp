@@ -0,0 +1,422 @@
+/**
+ * @file WebSocketCodec.hpp
+ * @brief WebSocket (RFC 6455) frame format, payload unmasking and handshake key.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/**
+ * @brief Stateless pieces of the WebSocket protocol, used by WebSocketTransport.
+ */
+namespace WebSocketCodec {
+
+/**
+ * @brief Frame opcodes.
+ */
+enum class Opcode : uint8_t {
+    CONTINUATION = 0x0,
+    TEXT = 0x1,
+    BINARY = 0x2,
+    CLOSE = 0x8,
+    PING = 0x9,
+    PONG = 0xA,
+};
+
+/**
+ * @brief Close status codes sent by the server.
+ */
+enum class CloseCode : uint16_t {
+    NORMAL = 1000,
+    GOING_AWAY = 1001,
+    PROTOCOL_ERROR = 1002,
+    UNSUPPORTED_DATA = 1003,
+    MESSAGE_TOO_BIG = 1009,
+};
+
+inline constexpr size_t kMaxHeaderSize = 14;           ///< 2 + 8 (64-bit length) + 4 (mask)
+inline constexpr size_t kMaxControlPayloadSize = 125;  ///< Control frames are never larger
+
+/**
+ * @struct FrameHeader
+ * @brief Decoded frame header.
+ */
+struct FrameHeader {
+    bool fin = false;               ///< Last frame of its message
+    uint8_t rsv = 0;                ///< Extension bits (none negotiated: must be 0)
+    Opcode opcode = Opcode::TEXT;   ///< Frame type
+    bool masked = false;            ///< Set on every client frame
+    uint64_t payload_size = 0;      ///< Payload length
+    bool valid_length = true;       ///< False for a 64-bit length with its top bit set
+    std::array<uint8_t, 4> mask{};  ///< Masking key (if masked)
+    size_t header_size = 0;         ///< Bytes taken by the header itself
+
+    /**
+     * @brief Check if the frame is a control frame (close, ping, pong).
+     */
+    bool isControl() const { return (static_cast<uint8_t>(opcode) & 0x8) != 0; }
+};
+
+/**
+ * @brief Decode a frame header.
+ *
+ * RFC 6455 requires the top bit of a 64-bit length to be 0: such a header is
+ * returned with valid_length unset and a zero payload_size, for the caller to
+ * fail the connection.
+ *
+ * @param data Bytes starting at a frame boundary
+ * @return Header, or nullopt if more bytes are needed
+ */
+inline std::optional<FrameHeader> parseFrameHeader(std::string_view data) {
+    if (data.size() < 2) {
+        return std::nullopt;
+    }
+
+    auto byte = [&data](size_t i) { return static_cast<uint8_t>(data[i]); };
+
+    FrameHeader header;
+    header.fin = (byte(0) & 0x80) != 0;
+    header.rsv = (byte(0) >> 4) & 0x7;
+    header.opcode = static_cast<Opcode>(byte(0) & 0x0F);
+    header.masked = (byte(1) & 0x80) != 0;
+
+    size_t size = 2;
+    uint64_t length = byte(1) & 0x7F;
+
+    if (length == 126) {
+        if (data.size() < size + 2) {
+            return std::nullopt;
+        }
+        length = (uint64_t{byte(2)} << 8) | byte(3);
+        size += 2;
+    } else if (length == 127) {
+        if (data.size() < size + 8) {
+            return std::nullopt;
+        }
+        length = 0;
+        for (size_t i = 0; i < 8; ++i) {
+            length = (length << 8) | byte(2 + i);
+        }
+        size += 8;
+
+        if (length >> 63) {
+            header.valid_length = false;
+            length = 0;
+        }
+    }
+
+    if (header.masked) {
+        if (data.size() < size + 4) {
+            return std::nullopt;
+        }
+        for (size_t i = 0; i < 4; ++i) {
+            header.mask[i] = byte(size + i);
+        }
+        size += 4;
+    }
+
+    header.payload_size = length;
+    header.header_size = size;
+    return header;
+}
+
+/**
+ * @brief Encode the header of a single-frame server message (FIN set, unmasked).
+ * @param opcode Frame type
+ * @param payload_size Payload length
+ * @param out Header bytes
+ * @return Header length
+ */
+inline size_t encodeFrameHeader(Opcode opcode, uint64_t payload_size,
+                                std::array<char, kMaxHeaderSize>& out) {
+    out[0] = static_cast<char>(0x80 | static_cast<uint8_t>(opcode));
+
+    if (payload_size < 126) {
+        out[1] = static_cast<char>(payload_size);
+        return 2;
+    }
+
+    if (payload_size <= 0xFFFF) {
+        out[1] = 126;
+        out[2] = static_cast<char>(payload_size >> 8);
+        out[3] = static_cast<char>(payload_size);
+        return 4;
+    }
+
+    out[1] = 127;
+    for (size_t i = 0; i < 8; ++i) {
+        out[2 + i] = static_cast<char>(payload_size >> (56 - 8 * i));
+    }
+    return 10;
+}
+
+/**
+ * @brief Unmask payload bytes in place.
+ *
+ * XORs 32 (AVX2) or 16 (SSE2, NEON) bytes per instruction, then 8 bytes per
+ * 64-bit word and the tail byte by byte. The offset keeps the mask aligned on
+ * payloads unmasked piece by piece, as they arrive.
+ *
+ * @param data Payload bytes
+ * @param size Number of bytes
+ * @param mask Masking key of the frame
+ * @param offset Position of data[0] in the frame payload
+ */
+inline void unmask(char* data, size_t size, const std::array<uint8_t, 4>& mask,
+                   uint64_t offset = 0) {
+    // Mask rotated so that its first byte applies to data[0]
+    std::array<uint8_t, 4> rotated;
+    for (size_t i = 0; i < 4; ++i) {
+        rotated[i] = mask[(offset + i) % 4];
+    }
+
+    uint32_t word;
+    std::memcpy(&word, rotated.data(), sizeof(word));
+
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    const __m256i mask256 = _mm256_set1_epi32(static_cast<int>(word));
+    for (; i + 32 <= size; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i),
+                            _mm256_xor_si256(chunk, mask256));
+    }
+#endif
+
+#if defined(__SSE2__)
+    const __m128i mask128 = _mm_set1_epi32(static_cast<int>(word));
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), _mm_xor_si128(chunk, mask128));
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t mask128 = vreinterpretq_u8_u32(vdupq_n_u32(word));
+    for (; i + 16 <= size; i += 16) {
+        uint8_t* p = reinterpret_cast<uint8_t*>(data + i);
+        vst1q_u8(p, veorq_u8(vld1q_u8(p), mask128));
+    }
+#endif
+
+    const uint64_t mask64 = (uint64_t{word} << 32) | word;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t chunk;
+        std::memcpy(&chunk, data + i, sizeof(chunk));
+        chunk ^= mask64;
+        std::memcpy(data + i, &chunk, sizeof(chunk));
+    }
+
+    for (; i < size; ++i) {
+        data[i] = static_cast<char>(data[i] ^ rotated[i % 4]);
+    }
+}
+
+/**
+ * @brief Compute the SHA-1 digest of a string (handshake only, not for security).
+ * @param input Bytes to hash
+ * @return 20-byte digest
+ */
+inline std::array<uint8_t, 20> sha1(std::string_view input) {
+    std::array<uint32_t, 5> h = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+    // Message, 0x80 terminator, zero padding and 64-bit bit length, in 64-byte blocks
+    std::string message(input);
+    uint64_t bit_length = static_cast<uint64_t>(input.size()) * 8;
+    message.push_back(static_cast<char>(0x80));
+    while (message.size() % 64 != 56) {
+        message.push_back('\0');
+    }
+    for (int i = 7; i >= 0; --i) {
+        message.push_back(static_cast<char>(bit_length >> (8 * i)));
+    }
+
+    auto rotl = [](uint32_t value, int bits) { return (value << bits) | (value >> (32 - bits)); };
+
+    for (size_t block = 0; block < message.size(); block += 64) {
+        std::array<uint32_t, 80> w;
+        for (size_t t = 0; t < 16; ++t) {
+            w[t] = (uint32_t{static_cast<uint8_t>(message[block + 4 * t])} << 24) |
+                   (uint32_t{static_cast<uint8_t>(message[block + 4 * t + 1])} << 16) |
+                   (uint32_t{static_cast<uint8_t>(message[block + 4 * t + 2])} << 8) |
+                   uint32_t{static_cast<uint8_t>(message[block + 4 * t + 3])};
+        }
+        for (size_t t = 16; t < 80; ++t) {
+            w[t] = rotl(w[t - 3] ^ w[t - 8] ^ w[t - 14] ^ w[t - 16], 1);
+        }
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (size_t t = 0; t < 80; ++t) {
+            uint32_t f, k;
+            if (t < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            } else if (t < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (t < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+
+            uint32_t temp = rotl(a, 5) + f + e + k + w[t];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = temp;
+        }
+
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+
+    std::array<uint8_t, 20> digest;
+    for (size_t i = 0; i < 20; ++i) {
+        digest[i] = static_cast<uint8_t>(h[i / 4] >> (24 - 8 * (i % 4)));
+    }
+    return digest;
+}
+
+/**
+ * @brief Encode bytes in base64 (with padding).
+ * @param data Bytes to encode
+ * @param size Number of bytes
+ * @return Base64 text
+ */
+inline std::string base64(const uint8_t* data, size_t size) {
+    static constexpr char kAlphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    std::string out;
+    out.reserve((size + 2) / 3 * 4);
+
+    for (size_t i = 0; i < size; i += 3) {
+        uint32_t group = uint32_t{data[i]} << 16;
+        if (i + 1 < size) {
+            group |= uint32_t{data[i + 1]} << 8;
+        }
+        if (i + 2 < size) {
+            group |= data[i + 2];
+        }
+
+        out.push_back(kAlphabet[(group >> 18) & 0x3F]);
+        out.push_back(kAlphabet[(group >> 12) & 0x3F]);
+        out.push_back(i + 1 < size ? kAlphabet[(group >> 6) & 0x3F] : '=');
+        out.push_back(i + 2 < size ? kAlphabet[group & 0x3F] : '=');
+    }
+
+    return out;
+}
+
+/**
+ * @brief Compute the Sec-WebSocket-Accept value answering a client key.
+ * @param client_key Sec-WebSocket-Key header value
+ * @return Accept key
+ */
+inline std::string acceptKey(std::string_view client_key) {
+    static constexpr std::string_view kGuid = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+    std::string input(client_key);
+    input.append(kGuid);
+
+    auto digest = sha1(input);
+    return base64(digest.data(), digest.size());
+}
+
+/**
+ * @brief Find a header value in an HTTP request head (case-insensitive name).
+ * @param request Request line and headers
+ * @param name Header name
+ * @return Value without surrounding spaces, or nullopt if absent
+ */
+inline std::optional<std::string_view> headerValue(std::string_view request,
+                                                   std::string_view name) {
+    auto lower = [](char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + 32) : c; };
+
+    size_t line_start = request.find("\r\n");
+    while (line_start != std::string_view::npos) {
+        line_start += 2;
+        size_t line_end = request.find("\r\n", line_start);
+        std::string_view line = request.substr(line_start, line_end - line_start);
+
+        size_t colon = line.find(':');
+        if (colon == name.size()) {
+            bool match = true;
+            for (size_t i = 0; i < name.size() && match; ++i) {
+                match = lower(line[i]) == lower(name[i]);
+            }
+
+            if (match) {
+                std::string_view value = line.substr(colon + 1);
+                while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+                    value.remove_prefix(1);
+                }
+                while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+                    value.remove_suffix(1);
+                }
+                return value;
+            }
+        }
+
+        line_start = line_end;
+    }
+
+    return std::nullopt;
+}
+
+/**
+ * @brief Check if a comma-separated header value contains a token (case-insensitive).
+ * @param value Header value (e.g. "keep-alive, Upgrade")
+ * @param token Token to find (lower case)
+ */
+inline bool hasToken(std::string_view value, std::string_view token) {
+    while (!value.empty()) {
+        size_t comma = value.find(',');
+        std::string_view item = value.substr(0, comma);
+
+        while (!item.empty() && item.front() == ' ') {
+            item.remove_prefix(1);
+        }
+        while (!item.empty() && item.back() == ' ') {
+            item.remove_suffix(1);
+        }
+
+        if (item.size() == token.size()) {
+            bool match = true;
+            for (size_t i = 0; i < token.size() && match; ++i) {
+                char c = item[i];
+                match = ((c >= 'A' && c <= 'Z') ? static_cast<char>(c + 32) : c) == token[i];
+            }
+            if (match) {
+                return true;
+            }
+        }
+
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        value.remove_prefix(comma + 1);
+    }
+
+    return false;
+}
+
+}  // namespace WebSocketCodec
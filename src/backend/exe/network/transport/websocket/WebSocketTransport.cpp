@@ -0,0 +1,462 @@
+#include "WebSocketTransport.hpp"
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "BufferPool.hpp"
+#include "Logger.hpp"
+
+using WebSocketCodec::CloseCode;
+using WebSocketCodec::Opcode;
+
+namespace {
+
+const std::string kBadRequest =
+    "HTTP/1.1 400 Bad Request\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+
+const std::string kUpgradeRequired =
+    "HTTP/1.1 426 Upgrade Required\r\nSec-WebSocket-Version: 13\r\nConnection: close\r\n"
+    "Content-Length: 0\r\n\r\n";
+
+}  // namespace
+
+/**
+ * @brief Constructs a WebSocket transport with an existing socket.
+ * @param socket_fd The file descriptor of the connected socket.
+ * @param loop The event loop reading the socket.
+ */
+WebSocketTransport::WebSocketTransport(int socket_fd, EventLoop& loop)
+    : fd(socket_fd), loop_(loop) {}
+
+/**
+ * @brief Destructor ensures that the socket is closed.
+ */
+WebSocketTransport::~WebSocketTransport() {
+    close();
+
+    // Waits for a read of this socket still running on the loop thread
+    loop_.remove(registration_);
+
+    if (message_.capacity() > 0) {
+        BufferPool::instance().release(message_);
+    }
+}
+
+/**
+ * @brief Implements the connect() method from ITransport.
+ * @return true Always returns true for already-connected sockets.
+ */
+bool WebSocketTransport::connect() {
+    // Socket is already connected, nothing to do
+    return true;
+}
+
+/**
+ * @brief Starts receiving data on the transport.
+ * @param listener Receiver of the messages.
+ */
+void WebSocketTransport::start(TransportListener& listener) {
+    // Required since nothing prevents start() from being called twice for the same instance.
+    if (registration_ != 0 || !running.load())
+        return;
+
+    auto& logger = Logger::instance();
+    logger.trace("Registering WebSocket fd " + std::to_string(fd) + " with the event loop");
+
+    listener_ = &listener;
+    registration_ = loop_.add(fd, *this);
+
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    outbound_.watch(registration_);
+}
+
+/**
+ * @brief Reads the data available on the socket (event loop thread).
+ */
+void WebSocketTransport::onReadable() {
+    auto buffer = loop_.readBuffer();
+    ssize_t n = read(fd, buffer.data(), buffer.size());
+
+    if (n > 0) {
+        std::span<char> data(buffer.data(), n);
+
+        if (upgraded_ || handshake(data)) {
+            decode(data);
+        }
+        return;
+    }
+
+    if (n < 0 && (errno == EINTR || errno == EAGAIN)) {
+        return;  // Level-triggered: the loop calls again
+    }
+
+    auto& logger = Logger::instance();
+    if (n == 0) {
+        logger.trace("Client disconnected (EOF) on fd " + std::to_string(fd));
+    } else {
+        logger.error("Read error on fd " + std::to_string(fd) + ": " + std::string(strerror(errno)));
+    }
+
+    // Notify session that connection died (it closes this transport)
+    listener_->onTransportClosed();
+}
+
+/**
+ * @brief Writes the queued data the socket takes now (event loop thread).
+ */
+void WebSocketTransport::onWritable() {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    outbound_.flush(fd);
+}
+
+bool WebSocketTransport::handshake(std::span<char>& data) {
+    auto& logger = Logger::instance();
+
+    size_t previous = request_.size();
+    request_.append(data.data(), data.size());
+
+    size_t end = request_.find("\r\n\r\n");
+    if (end == std::string::npos) {
+        if (request_.size() > kMaxRequestSize) {
+            logger.warning("WebSocket upgrade request too large on fd " + std::to_string(fd));
+            {
+                std::lock_guard<std::mutex> lock(send_mutex_);
+                iovec iov{const_cast<char*>(kBadRequest.data()), kBadRequest.size()};
+                writeAll(&iov, 1);
+            }
+            listener_->onTransportClosed();
+        }
+        return false;
+    }
+
+    // Header lines only, each one ending with CRLF
+    std::string_view head(request_.data(), end + 2);
+
+    auto upgrade = WebSocketCodec::headerValue(head, "Upgrade");
+    auto connection = WebSocketCodec::headerValue(head, "Connection");
+    auto version = WebSocketCodec::headerValue(head, "Sec-WebSocket-Version");
+    auto key = WebSocketCodec::headerValue(head, "Sec-WebSocket-Key");
+
+    bool valid = head.rfind("GET ", 0) == 0 && upgrade &&
+                 WebSocketCodec::hasToken(*upgrade, "websocket") && connection &&
+                 WebSocketCodec::hasToken(*connection, "upgrade") && key && !key->empty();
+
+    const std::string* rejection = nullptr;
+    if (!valid) {
+        rejection = &kBadRequest;
+    } else if (!version || *version != "13") {
+        rejection = &kUpgradeRequired;
+    }
+
+    if (rejection) {
+        logger.warning("Invalid WebSocket upgrade request on fd " + std::to_string(fd));
+        {
+            std::lock_guard<std::mutex> lock(send_mutex_);
+            iovec iov{const_cast<char*>(rejection->data()), rejection->size()};
+            writeAll(&iov, 1);
+        }
+        listener_->onTransportClosed();
+        return false;
+    }
+
+    std::string response =
+        "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+        "Sec-WebSocket-Accept: " +
+        WebSocketCodec::acceptKey(*key) + "\r\n\r\n";
+
+    // Bytes after the request are already frames
+    data = data.subspan(end + 4 - previous);
+    std::string().swap(request_);
+
+    {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        iovec iov{response.data(), response.size()};
+        writeAll(&iov, 1);
+        upgraded_ = true;
+
+        // Messages sent by the session meanwhile (e.g. its handshake)
+        for (const auto& message : queued_) {
+            writeFrame(Opcode::TEXT, message);
+        }
+        std::vector<std::string>().swap(queued_);
+    }
+
+    logger.debug("WebSocket upgrade completed on fd " + std::to_string(fd));
+    return true;
+}
+
+void WebSocketTransport::decode(std::span<char> data) {
+    while (running.load()) {
+        if (!frame_) {
+            if (data.empty() || !readHeader(data) || !beginFrame()) {
+                return;
+            }
+        }
+
+        // Payload bytes of this frame available in this read, unmasked in place
+        uint64_t remaining = frame_->payload_size - frame_received_;
+        size_t size = static_cast<size_t>(std::min<uint64_t>(remaining, data.size()));
+        char* chunk = data.data();
+
+        WebSocketCodec::unmask(chunk, size, frame_->mask, frame_received_);
+        frame_received_ += size;
+        data = data.subspan(size);
+
+        bool complete = frame_received_ == frame_->payload_size;
+
+        if (frame_->isControl()) {
+            if (complete && control_.empty()) {
+                if (!handleControlFrame(std::string_view(chunk, size))) {
+                    return;
+                }
+            } else {
+                control_.append(chunk, size);
+                if (complete) {
+                    std::string payload = std::move(control_);
+                    control_.clear();
+                    if (!handleControlFrame(payload)) {
+                        return;
+                    }
+                }
+            }
+        } else if (complete && frame_->fin && message_.empty() && frame_received_ == size) {
+            // Whole message in this read: no copy out of the read buffer
+            in_message_ = false;
+            deliver(std::string_view(chunk, size));
+        } else if (size > 0 || complete) {
+            if (message_.capacity() == 0) {
+                message_ = BufferPool::instance().acquire();
+            }
+            message_.append(chunk, size);
+
+            if (complete && frame_->fin) {
+                in_message_ = false;
+                deliver(message_);
+                BufferPool::instance().release(message_);
+            }
+        }
+
+        if (!complete) {
+            return;  // Rest of the payload in the next reads
+        }
+
+        frame_.reset();
+        frame_received_ = 0;
+    }
+}
+
+bool WebSocketTransport::readHeader(std::span<char>& data) {
+    if (header_size_ == 0) {
+        auto header = WebSocketCodec::parseFrameHeader(std::string_view(data.data(), data.size()));
+        if (header) {
+            frame_ = header;
+            data = data.subspan(header->header_size);
+            return true;
+        }
+    }
+
+    // Header split across reads: gather up to the longest possible header
+    size_t previous = header_size_;
+    size_t size = std::min(header_.size() - header_size_, data.size());
+    std::memcpy(header_.data() + header_size_, data.data(), size);
+    header_size_ += size;
+
+    auto header = WebSocketCodec::parseFrameHeader(std::string_view(header_.data(), header_size_));
+    if (!header) {
+        data = data.subspan(size);
+        return false;
+    }
+
+    frame_ = header;
+    header_size_ = 0;
+    data = data.subspan(header->header_size - previous);
+    return true;
+}
+
+bool WebSocketTransport::beginFrame() {
+    const auto& frame = *frame_;
+
+    // No extension is negotiated, and clients must mask every frame
+    if (frame.rsv != 0 || !frame.masked || !frame.valid_length) {
+        fail(CloseCode::PROTOCOL_ERROR);
+        return false;
+    }
+
+    if (frame.isControl()) {
+        bool known = frame.opcode == Opcode::CLOSE || frame.opcode == Opcode::PING ||
+                     frame.opcode == Opcode::PONG;
+        if (!known || !frame.fin || frame.payload_size > WebSocketCodec::kMaxControlPayloadSize) {
+            fail(CloseCode::PROTOCOL_ERROR);
+            return false;
+        }
+        return true;
+    }
+
+    switch (frame.opcode) {
+        case Opcode::CONTINUATION:
+            if (!in_message_) {
+                fail(CloseCode::PROTOCOL_ERROR);
+                return false;
+            }
+            break;
+        case Opcode::TEXT:
+            if (in_message_) {
+                fail(CloseCode::PROTOCOL_ERROR);
+                return false;
+            }
+            in_message_ = true;
+            break;
+        case Opcode::BINARY:
+            // Messages are JSON text
+            fail(CloseCode::UNSUPPORTED_DATA);
+            return false;
+        default:
+            fail(CloseCode::PROTOCOL_ERROR);
+            return false;
+    }
+
+    // message_ never exceeds the limit, so this can't wrap around
+    if (frame.payload_size > kMaxMessageSize - message_.size()) {
+        fail(CloseCode::MESSAGE_TOO_BIG);
+        return false;
+    }
+
+    return true;
+}
+
+bool WebSocketTransport::handleControlFrame(std::string_view payload) {
+    switch (frame_->opcode) {
+        case Opcode::PING: {
+            std::lock_guard<std::mutex> lock(send_mutex_);
+            writeFrame(Opcode::PONG, payload);
+            return true;
+        }
+        case Opcode::CLOSE: {
+            Logger::instance().trace("WebSocket close received on fd " + std::to_string(fd));
+            {
+                // Echo the status code, as the closing handshake requires
+                std::lock_guard<std::mutex> lock(send_mutex_);
+                if (!close_sent_) {
+                    writeFrame(Opcode::CLOSE, payload.substr(0, 2));
+                    close_sent_ = true;
+                }
+            }
+            listener_->onTransportClosed();
+            return false;
+        }
+        default:
+            return true;  // Unsolicited pong
+    }
+}
+
+void WebSocketTransport::deliver(std::string_view message) {
+    // Clients reusing the line protocol of the other transports end messages with a newline
+    if (!message.empty() && message.back() == '\n') {
+        message.remove_suffix(1);
+    }
+
+    listener_->onMessage(message);
+}
+
+void WebSocketTransport::fail(CloseCode code) {
+    Logger::instance().warning("WebSocket protocol error on fd " + std::to_string(fd) +
+                               ", closing with status " +
+                               std::to_string(static_cast<uint16_t>(code)));
+    {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        writeClose(code);
+    }
+    listener_->onTransportClosed();
+}
+
+/**
+ * @brief Sends data over the transport.
+ * @param data The data to send.
+ */
+void WebSocketTransport::send(const std::string& data) {
+    if (!running.load()) {
+        return;
+    }
+
+    std::string_view payload(data);
+    if (!payload.empty() && payload.back() == '\n') {
+        payload.remove_suffix(1);
+    }
+
+    std::lock_guard<std::mutex> lock(send_mutex_);
+
+    if (!upgraded_) {
+        queued_.emplace_back(payload);
+        return;
+    }
+
+    writeFrame(Opcode::TEXT, payload);
+}
+
+void WebSocketTransport::sendCompressed(std::string_view payload) {
+    if (!running.load()) {
+        return;
+    }
+
+    // Compression is negotiated by a client message, so the upgrade is done by then
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    if (upgraded_) {
+        writeFrame(Opcode::BINARY, payload);
+    }
+}
+
+void WebSocketTransport::writeClose(CloseCode code) {
+    if (!upgraded_ || close_sent_) {
+        return;
+    }
+
+    uint16_t status = static_cast<uint16_t>(code);
+    char payload[2] = {static_cast<char>(status >> 8), static_cast<char>(status)};
+    writeFrame(Opcode::CLOSE, std::string_view(payload, sizeof(payload)));
+    close_sent_ = true;
+}
+
+void WebSocketTransport::writeFrame(Opcode opcode, std::string_view payload) {
+    std::array<char, WebSocketCodec::kMaxHeaderSize> header;
+    size_t header_size = WebSocketCodec::encodeFrameHeader(opcode, payload.size(), header);
+
+    // Header and payload in one system call, without copying the payload
+    iovec iov[2] = {{header.data(), header_size},
+                    {const_cast<char*>(payload.data()), payload.size()}};
+    writeAll(iov, 2);
+}
+
+void WebSocketTransport::writeAll(iovec* iov, size_t count) {
+    // Never waits for the client: the event loop thread sends too
+    outbound_.write(fd, iov, count);
+}
+
+/**
+ * @brief Closes the socket, after a close frame, and leaves the event loop.
+ */
+void WebSocketTransport::close() {
+    if (!running.exchange(false))
+        return;
+
+    auto& logger = Logger::instance();
+    logger.debug("Closing WebSocket transport on fd " + std::to_string(fd));
+
+    loop_.remove(registration_);
+
+    // Under the send lock: no frame can be written to a descriptor closed (or reused) meanwhile
+    std::lock_guard<std::mutex> lock(send_mutex_);
+
+    writeClose(CloseCode::GOING_AWAY);
+
+    if (fd >= 0) {
+        shutdown(fd, SHUT_RDWR);
+        ::close(fd);
+        fd = -1;
+    }
+
+    logger.debug("Transport closed");
+}
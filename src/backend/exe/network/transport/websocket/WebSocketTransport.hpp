@@ -0,0 +1,188 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "EventLoop.hpp"
+#include "ITransport.hpp"
+#include "SendQueue.hpp"
+#include "WebSocketCodec.hpp"
+
+struct iovec;
+
+/**
+ * @class WebSocketTransport
+ * @brief Concrete transport implementation speaking WebSocket over POSIX TCP/IP sockets
+ *
+ * This class implements the ITransport interface for browser-based clients:
+ * it answers the HTTP upgrade request, then exchanges one JSON message per
+ * WebSocket text message. It runs on the event loop like the other
+ * transports, without a thread of its own, and queues what a slow client
+ * doesn't read yet (SendQueue).
+ *
+ * Frames are decoded as they arrive. A message received whole in one read is
+ * unmasked in place in the event loop read buffer and handed to the listener
+ * without a copy; fragmented messages and frames split across reads are
+ * unmasked straight into a buffer borrowed from the BufferPool until complete.
+ * Client pings are answered; binary messages are refused (the server only
+ * sends binary frames for compressed messages).
+ */
+class WebSocketTransport : public ITransport, private EventHandler {
+   public:
+    static constexpr size_t kMaxRequestSize = 8 * 1024;      ///< Largest upgrade request
+    static constexpr uint64_t kMaxMessageSize = 1024 * 1024;  ///< Largest message (after assembly)
+
+    /**
+     * @brief Construct a transport from an already-accepted socket descriptor.
+     *
+     * @param socket_fd File descriptor representing an open TCP connection.
+     * @param loop Event loop reading the socket.
+     */
+    WebSocketTransport(int socket_fd, EventLoop& loop);
+
+    /**
+     * @brief Destructor closes the socket and leaves the event loop.
+     */
+    ~WebSocketTransport();
+
+    /**
+     * @brief Starts reading the socket (upgrade request first, then frames).
+     * @param listener Receiver of the messages.
+     */
+    void start(TransportListener& listener) override;
+
+    /**
+     * @brief Sends a message to the client as one text frame.
+     *
+     * Messages sent before the upgrade completes are queued until then. The
+     * trailing newline added by the session is not sent.
+     *
+     * @param data Message to send.
+     */
+    void send(const std::string& data) override;
+
+    /**
+     * @brief Sends a compressed message to the client as one binary frame.
+     * @param payload Compressed message
+     */
+    void sendCompressed(std::string_view payload) override;
+
+    /**
+     * @brief Closes the transport connection, with a close frame if the upgrade completed.
+     */
+    void close() override;
+
+    /**
+     * @brief Implements the connect() method from ITransport.
+     * Since the socket is already connected, this simply returns true.
+     */
+    bool connect() override;
+
+   private:
+    /**
+     * @brief Read available data (event loop thread).
+     */
+    void onReadable() override;
+
+    /**
+     * @brief Write queued data (event loop thread).
+     */
+    void onWritable() override;
+
+    /**
+     * @brief Accumulate and answer the HTTP upgrade request.
+     * @param data Received bytes; the ones after the request are left in it
+     * @return True once upgraded, false while incomplete or after a rejection
+     */
+    bool handshake(std::span<char>& data);
+
+    /**
+     * @brief Decode frames, delivering each complete message.
+     * @param data Received bytes (unmasked in place)
+     */
+    void decode(std::span<char> data);
+
+    /**
+     * @brief Decode the header of the next frame, possibly split across reads.
+     * @param data Received bytes; the header ones are removed from it
+     * @return True once frame_ is set, false if more bytes are needed
+     */
+    bool readHeader(std::span<char>& data);
+
+    /**
+     * @brief Check a new frame against the protocol and the size limit.
+     * @return False if the connection was failed
+     */
+    bool beginFrame();
+
+    /**
+     * @brief Answer a complete control frame.
+     * @param payload Unmasked payload
+     * @return False if the connection is closing
+     */
+    bool handleControlFrame(std::string_view payload);
+
+    /**
+     * @brief Hand a complete message to the listener.
+     * @param message Unmasked message
+     */
+    void deliver(std::string_view message);
+
+    /**
+     * @brief Close the connection after a protocol error.
+     * @param code Close status sent to the client
+     */
+    void fail(WebSocketCodec::CloseCode code);
+
+    /**
+     * @brief Send a close frame once (send_mutex_ must be held).
+     * @param code Close status
+     */
+    void writeClose(WebSocketCodec::CloseCode code);
+
+    /**
+     * @brief Send one frame (send_mutex_ must be held).
+     * @param opcode Frame type
+     * @param payload Frame payload
+     */
+    void writeFrame(WebSocketCodec::Opcode opcode, std::string_view payload);
+
+    /**
+     * @brief Write whole buffers, queueing what the socket doesn't take (send_mutex_ must be held).
+     * @param iov Buffers
+     * @param count Number of buffers
+     */
+    void writeAll(iovec* iov, size_t count);
+
+    int fd;                                  ///< Underlying POSIX socket descriptor.
+    std::atomic<bool> running{true};         ///< False once the transport is closed.
+    EventLoop& loop_;                        ///< Event loop reading the socket.
+    TransportListener* listener_ = nullptr;  ///< Receiver of messages and closure.
+    uint64_t registration_ = 0;              ///< Event loop registration ID (0 before start).
+
+    // Event loop thread only
+    std::string request_;  ///< Upgrade request received so far (released once upgraded)
+
+    std::array<char, WebSocketCodec::kMaxHeaderSize> header_;  ///< Header split across reads
+    size_t header_size_ = 0;                                   ///< Bytes in header_
+
+    std::optional<WebSocketCodec::FrameHeader> frame_;  ///< Frame whose payload is being read
+    uint64_t frame_received_ = 0;                       ///< Payload bytes of frame_ read so far
+
+    bool in_message_ = false;  ///< A fragmented message awaits continuation frames
+    std::string message_;      ///< Fragments of the current message (pooled, empty when idle)
+    std::string control_;      ///< Control frame payload split across reads
+
+    std::mutex send_mutex_;            ///< Serialises frames from all sending threads
+    bool upgraded_ = false;            ///< Upgrade answered (written under send_mutex_)
+    bool close_sent_ = false;          ///< Close frame sent (send_mutex_)
+    std::vector<std::string> queued_;  ///< Messages sent before the upgrade (send_mutex_)
+    SendQueue outbound_{loop_};        ///< Data the socket didn't take yet (send_mutex_)
+};
@@ -0,0 +1,110 @@
+/**
+ * @file BufferPool.hpp
+ * @brief Pool of receive buffers lent to sessions holding a partial message.
+ */
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @class BufferPool
+ * @brief Recycles the buffers of sessions between two partial messages (Singleton pattern).
+ *
+ * Complete messages are handled straight from the event loop read buffer, so a
+ * session only needs its own buffer while a message is split across reads. It
+ * borrows one here and gives it back once the message is complete: idle
+ * sessions hold no receive memory.
+ */
+class BufferPool {
+   public:
+    static constexpr size_t kBufferCapacity = 4 * 1024;     ///< Capacity of new buffers
+    static constexpr size_t kMaxPooledCapacity = 64 * 1024;  ///< Larger buffers (uploads) are freed
+    static constexpr size_t kMaxPooled = 256;                ///< Buffers kept for reuse
+
+    /**
+     * @brief Get the pool instance.
+     * @return Reference to the pool instance
+     */
+    static BufferPool& instance() {
+        static BufferPool instance;
+        return instance;
+    }
+
+    /**
+     * @brief Borrow an empty buffer.
+     * @return Buffer with at least kBufferCapacity bytes reserved
+     */
+    std::string acquire() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!free_.empty()) {
+                std::string buffer = std::move(free_.back());
+                free_.pop_back();
+                return buffer;
+            }
+        }
+
+        std::string buffer;
+        buffer.reserve(kBufferCapacity);
+        return buffer;
+    }
+
+    /**
+     * @brief Give a buffer back.
+     * @param buffer Buffer to recycle (left empty without capacity)
+     */
+    void release(std::string& buffer) {
+        std::string recycled = std::move(buffer);
+        buffer = std::string();
+
+        if (recycled.capacity() > kMaxPooledCapacity) {
+            return;
+        }
+
+        recycled.clear();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_.size() < kMaxPooled) {
+            free_.push_back(std::move(recycled));
+        }
+    }
+
+    /**
+     * @brief Pre-allocate buffers, e.g. during startup.
+     *
+     * The buffers are written once, so their pages are faulted in before the
+     * first sessions need them.
+     *
+     * @param count Number of buffers to have in the pool
+     */
+    void reserve(size_t count) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_.reserve(kMaxPooled);
+        while (free_.size() < count && free_.size() < kMaxPooled) {
+            std::string buffer(kBufferCapacity, '\0');
+            buffer.clear();
+            free_.push_back(std::move(buffer));
+        }
+    }
+
+    /**
+     * @brief Get the number of buffers available.
+     */
+    size_t available() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return free_.size();
+    }
+
+    // Delete copy constructor and assignment operator (Singleton)
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+   private:
+    BufferPool() = default;
+
+    std::vector<std::string> free_;  ///< Buffers ready to lend
+    mutable std::mutex mutex_;       ///< Sessions run on any thread
+};
@@ -0,0 +1,105 @@
+/**
+ * @file CommandClass.hpp
+ * @brief Classification of raw messages by command, without parsing them.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @brief Command classes sharing a rate limit.
+ *
+ * Add new entries before COUNT and give them a name in kCommandClassNames.
+ * Each command declares its class in kCommands (CommandTable.hpp), the list
+ * of the commands of each class.
+ */
+enum class CommandClass : uint8_t {
+    MOVE,     ///< Moves played or queued
+    QUERY,    ///< Reads of the game or server state, and pings
+    CONTROL,  ///< Changes of seat, game or session settings, and anything unrecognised
+    UPLOAD,   ///< upload_game chunks
+    COUNT
+};
+
+/// Number of command classes.
+inline constexpr size_t kCommandClassCount = static_cast<size_t>(CommandClass::COUNT);
+
+/// Command class names, in the order of the CommandClass enum (used by `--rate-limit`).
+inline constexpr std::array<std::string_view, kCommandClassCount> kCommandClassNames = {
+    "move", "query", "control", "upload"};
+
+/**
+ * @brief Find the "command" value of a raw JSON message.
+ *
+ * Scans the message without parsing nor allocating, so it can run on every
+ * message before the JSON parser. Only a `"command"` key of the top-level
+ * object counts, not one nested in another field, and the last one wins, as
+ * with the parser.
+ *
+ * @param message Raw message (one line)
+ * @return Command name, empty if none is recognisable
+ */
+constexpr std::string_view commandName(std::string_view message) {
+    constexpr std::string_view key = "command";
+
+    auto skip_spaces = [&message](size_t i) {
+        while (i < message.size() && (message[i] == ' ' || message[i] == '\t' ||
+                                      message[i] == '\r' || message[i] == '\n')) {
+            ++i;
+        }
+        return i;
+    };
+
+    // End of the string starting after the quote at pos (its closing quote), npos if unterminated
+    auto string_end = [&message](size_t pos) {
+        while (pos < message.size() && message[pos] != '"') {
+            pos += message[pos] == '\\' ? 2 : 1;
+        }
+        return pos < message.size() ? pos : std::string_view::npos;
+    };
+
+    std::string_view command;
+    int depth = 0;
+
+    for (size_t i = 0; i < message.size(); ++i) {
+        char c = message[i];
+        if (c == '{' || c == '[') {
+            ++depth;
+        } else if (c == '}' || c == ']') {
+            --depth;
+        }
+        if (c != '"') {
+            continue;
+        }
+
+        size_t end = string_end(i + 1);
+        if (end == std::string_view::npos) {
+            return {};
+        }
+        std::string_view text = message.substr(i + 1, end - i - 1);
+        i = end;
+
+        // A key is followed by a colon; values of nested objects are one level deeper
+        size_t pos = skip_spaces(end + 1);
+        if (depth != 1 || text != key || pos >= message.size() || message[pos] != ':') {
+            continue;
+        }
+
+        pos = skip_spaces(pos + 1);
+        if (pos >= message.size() || message[pos] != '"') {
+            return {};
+        }
+        end = string_end(pos + 1);
+        if (end == std::string_view::npos) {
+            return {};
+        }
+        command = message.substr(pos + 1, end - pos - 1);
+        i = end;
+    }
+
+    return command;
+}
@@ -0,0 +1,201 @@
+/**
+ * @file CommandTable.hpp
+ * @brief Commands of the protocol, found by name through a compile-time perfect hash.
+ */
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "CommandClass.hpp"
+
+/**
+ * @brief Commands a client can send.
+ *
+ * Add new entries before COUNT and describe them in kCommands, in the same order.
+ */
+enum class CommandId : uint8_t {
+    UPLOAD_GAME,
+    JOIN_GAME,
+    START_GAME,
+    MAKE_MOVE,
+    END_GAME,
+    DISPLAY_BOARD,
+    GET_SNAPSHOT,
+    RESUME,
+    RESYNC,
+    GET_STATS,
+    ENABLE_COMPRESSION,  ///< Handled by the session
+    SET_BROADCAST_MODE,  ///< Handled by the session
+    SET_POSITION,
+    LEGAL_MOVES,
+    PREMOVE,
+    PING,
+    COUNT                ///< Also stands for an unknown command
+};
+
+/// Number of commands.
+inline constexpr size_t kCommandCount = static_cast<size_t>(CommandId::COUNT);
+
+/**
+ * @brief JSON type expected for a command field.
+ */
+enum class FieldType : uint8_t { STRING, BOOLEAN, UNSIGNED, OBJECT };
+
+/**
+ * @struct CommandField
+ * @brief Field of a command message, checked before the command is handled.
+ */
+struct CommandField {
+    std::string_view name;  ///< Empty past the last field
+    FieldType type = FieldType::STRING;
+    bool required = true;  ///< Optional fields are only type-checked when present
+};
+
+/// Most fields a command declares.
+inline constexpr size_t kMaxCommandFields = 4;
+
+/**
+ * @struct CommandSpec
+ * @brief Name, rate limit class and field schema of a command.
+ */
+struct CommandSpec {
+    std::string_view name;
+    CommandClass command_class = CommandClass::CONTROL;
+    std::array<CommandField, kMaxCommandFields> fields{};
+};
+
+/// Commands, in the order of the CommandId enum.
+inline constexpr std::array<CommandSpec, kCommandCount> kCommands = {{
+    {"upload_game",
+     CommandClass::UPLOAD,
+     {{{"metadata", FieldType::OBJECT}, {"data", FieldType::STRING}}}},
+    {"join_game",
+     CommandClass::CONTROL,
+     {{{"single_player", FieldType::BOOLEAN}, {"color", FieldType::STRING}}}},
+    {"start_game",
+     CommandClass::CONTROL,
+     {{{"clock_ms", FieldType::UNSIGNED, false}, {"increment_ms", FieldType::UNSIGNED, false}}}},
+    {"make_move", CommandClass::MOVE, {{{"move", FieldType::STRING}}}},
+    {"end_game", CommandClass::CONTROL, {}},
+    {"display_board", CommandClass::QUERY, {}},
+    {"get_snapshot", CommandClass::QUERY, {}},
+    {"resume", CommandClass::CONTROL, {{{"token", FieldType::STRING}}}},
+    {"resync", CommandClass::QUERY, {{{"since", FieldType::UNSIGNED, false}}}},
+    {"get_stats", CommandClass::QUERY, {}},
+    {"enable_compression", CommandClass::CONTROL, {}},
+    {"set_broadcast_mode", CommandClass::CONTROL, {}},
+    {"set_position", CommandClass::CONTROL, {{{"fen", FieldType::STRING}}}},
+    {"legal_moves", CommandClass::QUERY, {{{"push", FieldType::BOOLEAN, false}}}},
+    {"premove", CommandClass::MOVE, {{{"move", FieldType::STRING}}}},
+    {"ping",
+     CommandClass::QUERY,
+     {{{"t0", FieldType::UNSIGNED, false}, {"echo", FieldType::UNSIGNED, false}}}},
+}};
+
+namespace command_table {
+
+/// Hash slots: a power of two, four per command so a collision-free seed comes quickly.
+inline constexpr size_t kSlotCount = std::bit_ceil(kCommandCount * 4);
+
+/**
+ * @brief Seeded FNV-1a hash of a command name.
+ */
+constexpr uint32_t hash(std::string_view name, uint32_t seed) {
+    uint32_t h = 2166136261u ^ seed;
+    for (char c : name) {
+        h ^= static_cast<uint8_t>(c);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+constexpr size_t slot(std::string_view name, uint32_t seed) {
+    return hash(name, seed) & (kSlotCount - 1);
+}
+
+/**
+ * @brief Find the first seed giving each command a slot of its own.
+ * @return Seed, or UINT32_MAX if none was found
+ */
+constexpr uint32_t findSeed() {
+    for (uint32_t seed = 0; seed < 100000; ++seed) {
+        std::array<bool, kSlotCount> used{};
+        bool collision = false;
+        for (const auto& command : kCommands) {
+            size_t index = slot(command.name, seed);
+            collision = collision || used[index];
+            used[index] = true;
+        }
+        if (!collision) {
+            return seed;
+        }
+    }
+    return UINT32_MAX;
+}
+
+inline constexpr uint32_t kSeed = findSeed();
+static_assert(kSeed != UINT32_MAX, "No perfect hash seed for the command names");
+
+/// Command of each slot (COUNT for empty slots).
+inline constexpr std::array<CommandId, kSlotCount> kSlots = [] {
+    std::array<CommandId, kSlotCount> slots{};
+    slots.fill(CommandId::COUNT);
+    for (size_t i = 0; i < kCommandCount; ++i) {
+        slots[slot(kCommands[i].name, kSeed)] = static_cast<CommandId>(i);
+    }
+    return slots;
+}();
+
+}  // namespace command_table
+
+/**
+ * @brief Find a command by name: one hash, one table read and one comparison.
+ * @param name Command name
+ * @return Command, or CommandId::COUNT if unknown
+ */
+constexpr CommandId findCommand(std::string_view name) {
+    CommandId id = command_table::kSlots[command_table::slot(name, command_table::kSeed)];
+    if (id == CommandId::COUNT || kCommands[static_cast<size_t>(id)].name != name) {
+        return CommandId::COUNT;
+    }
+    return id;
+}
+
+/**
+ * @brief Get the description of a known command.
+ */
+constexpr const CommandSpec& commandSpec(CommandId id) {
+    return kCommands[static_cast<size_t>(id)];
+}
+
+/**
+ * @brief Find the class of a raw JSON message from its "command" value.
+ *
+ * Messages without a recognisable command fall into CONTROL.
+ *
+ * @param message Raw message (one line)
+ * @return Command class
+ */
+constexpr CommandClass classifyCommand(std::string_view message) {
+    CommandId id = findCommand(commandName(message));
+    return id == CommandId::COUNT ? CommandClass::CONTROL : commandSpec(id).command_class;
+}
+
+static_assert(
+    [] {
+        for (size_t i = 0; i < kCommandCount; ++i) {
+            if (findCommand(kCommands[i].name) != static_cast<CommandId>(i)) {
+                return false;
+            }
+        }
+        return true;
+    }(),
+    "kCommands must follow the order of CommandId");
+static_assert(findCommand("make_move") == CommandId::MAKE_MOVE);
+static_assert(findCommand("set_broadcast_mode") == CommandId::SET_BROADCAST_MODE);
+static_assert(findCommand("make_moves") == CommandId::COUNT);
@@ -0,0 +1,173 @@
+#include "Compression.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#include "Metrics.hpp"
+
+#ifdef CHESS_COMPRESSION_ZSTD
+
+#include <zstd.h>
+
+namespace {
+
+/**
+ * @brief Throw if a zstd function failed.
+ * @param result Return value of the zstd function
+ * @param what Operation, for the error message
+ */
+size_t check(size_t result, const char* what) {
+    if (ZSTD_isError(result)) {
+        throw std::runtime_error(std::string(what) + ": " + ZSTD_getErrorName(result));
+    }
+    return result;
+}
+
+}  // namespace
+
+MessageCompressor::MessageCompressor(const CompressionSettings& settings,
+                                     const ZSTD_CDict_s* dictionary)
+    : settings_(settings), context_(ZSTD_createCCtx()) {
+    if (!context_) {
+        throw std::runtime_error("Failed to create compression context");
+    }
+
+    try {
+        // The size of a stream is unknown, so zstd would size its match tables for
+        // the largest input: bounding them by the window keeps each connection small
+        check(ZSTD_CCtx_setParameter(context_, ZSTD_c_compressionLevel, settings.level),
+              "Compression level");
+        check(ZSTD_CCtx_setParameter(context_, ZSTD_c_windowLog, settings.window_log),
+              "Window size");
+        check(ZSTD_CCtx_setParameter(context_, ZSTD_c_hashLog, settings.window_log),
+              "Hash size");
+        check(ZSTD_CCtx_setParameter(context_, ZSTD_c_chainLog, settings.window_log),
+              "Chain size");
+
+        if (dictionary) {
+            check(ZSTD_CCtx_refCDict(context_, dictionary), "Compression dictionary");
+        }
+    } catch (...) {
+        ZSTD_freeCCtx(context_);
+        throw;
+    }
+
+    Metrics::instance().increment(Counter::COMPRESSED_SESSIONS);
+}
+
+MessageCompressor::~MessageCompressor() {
+    ZSTD_freeCCtx(context_);
+}
+
+std::optional<std::string_view> MessageCompressor::compress(std::string_view message) {
+    if (message.size() < settings_.min_size) {
+        ++stats_.skipped;
+        Metrics::instance().increment(Counter::COMPRESSION_SKIPPED);
+        return std::nullopt;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Flushed, not ended: the frame (and its history) continues with the next message
+    output_.resize(ZSTD_compressBound(message.size()) + 16);
+    ZSTD_inBuffer input = {message.data(), message.size(), 0};
+    ZSTD_outBuffer output = {output_.data(), output_.size(), 0};
+
+    size_t remaining;
+    do {
+        if (output.pos == output.size) {
+            output_.resize(output_.size() * 2);
+            output.dst = output_.data();
+            output.size = output_.size();
+        }
+        remaining = check(ZSTD_compressStream2(context_, &output, &input, ZSTD_e_flush),
+                          "Compression");
+    } while (remaining != 0);
+
+    output_.resize(output.pos);
+
+    int64_t elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+
+    ++stats_.messages;
+    stats_.bytes_in += message.size();
+    stats_.bytes_out += output_.size();
+    stats_.compress_ns += elapsed_ns;
+
+    auto& metrics = Metrics::instance();
+    metrics.increment(Counter::COMPRESSED_MESSAGES);
+    metrics.increment(Counter::COMPRESSION_BYTES_IN, message.size());
+    metrics.increment(Counter::COMPRESSION_BYTES_OUT, output_.size());
+    metrics.increment(Counter::COMPRESSION_NS, elapsed_ns);
+
+    return std::string_view(output_);
+}
+
+bool Compression::supported() {
+    return true;
+}
+
+Compression::Compression(CompressionSettings settings) : settings_(std::move(settings)) {
+    if (settings_.dictionary_path.empty()) {
+        return;
+    }
+
+    std::ifstream file(settings_.dictionary_path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open compression dictionary: " +
+                                 settings_.dictionary_path);
+    }
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    // Clients quote the ID to use the dictionary: raw content has none
+    dictionary_id_ = ZSTD_getDictID_fromDict(content.data(), content.size());
+    if (dictionary_id_ == 0) {
+        throw std::runtime_error("Not a trained zstd dictionary: " + settings_.dictionary_path);
+    }
+
+    dictionary_ = ZSTD_createCDict(content.data(), content.size(), settings_.level);
+    if (!dictionary_) {
+        throw std::runtime_error("Invalid compression dictionary: " + settings_.dictionary_path);
+    }
+}
+
+Compression::~Compression() {
+    ZSTD_freeCDict(dictionary_);
+}
+
+std::unique_ptr<MessageCompressor> Compression::createCompressor(bool use_dictionary) const {
+    return std::make_unique<MessageCompressor>(settings_, use_dictionary ? dictionary_ : nullptr);
+}
+
+#else  // Built without zstd: compression is never offered
+
+MessageCompressor::MessageCompressor(const CompressionSettings& settings, const ZSTD_CDict_s*)
+    : settings_(settings) {
+    throw std::runtime_error("Compression not supported by this build");
+}
+
+MessageCompressor::~MessageCompressor() = default;
+
+std::optional<std::string_view> MessageCompressor::compress(std::string_view) {
+    return std::nullopt;
+}
+
+bool Compression::supported() {
+    return false;
+}
+
+Compression::Compression(CompressionSettings settings) : settings_(std::move(settings)) {
+    throw std::runtime_error("Compression not supported by this build (zstd not found)");
+}
+
+Compression::~Compression() = default;
+
+std::unique_ptr<MessageCompressor> Compression::createCompressor(bool) const {
+    return std::make_unique<MessageCompressor>(settings_, nullptr);
+}
+
+#endif
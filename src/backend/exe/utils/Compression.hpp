@@ -0,0 +1,145 @@
+/**
+ * @file Compression.hpp
+ * @brief Negotiated zstd compression of large outgoing messages.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// Opaque zstd types, so that the header builds without zstd
+struct ZSTD_CCtx_s;
+struct ZSTD_CDict_s;
+
+/**
+ * @struct CompressionSettings
+ * @brief Server-wide compression parameters.
+ */
+struct CompressionSettings {
+    size_t min_size = 256;        ///< Smaller messages (e.g. move results) are sent as is
+    int level = 3;                ///< zstd compression level
+    int window_log = 16;          ///< History kept across messages (64 KiB)
+    std::string dictionary_path;  ///< Trained dictionary (none if empty)
+};
+
+/**
+ * @struct CompressionStats
+ * @brief Work done by the compressor of one connection.
+ */
+struct CompressionStats {
+    uint64_t messages = 0;    ///< Messages compressed
+    uint64_t skipped = 0;     ///< Messages under the size threshold
+    uint64_t bytes_in = 0;    ///< Size of the compressed messages
+    uint64_t bytes_out = 0;   ///< Size of their compressed form
+    int64_t compress_ns = 0;  ///< Time spent compressing
+};
+
+/**
+ * @class MessageCompressor
+ * @brief Compressor of the outgoing messages of one connection.
+ *
+ * All messages of a connection form a single zstd frame that is never ended:
+ * each one is flushed separately, so the client can decode it on arrival,
+ * while later messages still match against the history (and the dictionary)
+ * of the earlier ones. Board dumps then mostly compress to references to the
+ * previous board. The client must decode the messages in order with a single
+ * streaming decompressor.
+ *
+ * Not thread-safe: the session serialises compression and sending.
+ */
+class MessageCompressor {
+   public:
+    /**
+     * @brief Create the compression context.
+     * @param settings Server settings (must outlive the compressor)
+     * @param dictionary Digested dictionary, or null
+     * @throws std::runtime_error if zstd fails to allocate the context
+     */
+    MessageCompressor(const CompressionSettings& settings, const ZSTD_CDict_s* dictionary);
+
+    /**
+     * @brief Destructor frees the compression context.
+     */
+    ~MessageCompressor();
+
+    MessageCompressor(const MessageCompressor&) = delete;
+    MessageCompressor& operator=(const MessageCompressor&) = delete;
+
+    /**
+     * @brief Compress a message, unless it is under the size threshold.
+     * @param message Message to send
+     * @return Compressed message (valid until the next call), or nullopt to send it as is
+     * @throws std::runtime_error on compression failure (the stream is then unusable)
+     */
+    std::optional<std::string_view> compress(std::string_view message);
+
+    /**
+     * @brief Get the statistics of this connection.
+     */
+    const CompressionStats& stats() const { return stats_; }
+
+   private:
+    const CompressionSettings& settings_;  ///< Server settings
+    ZSTD_CCtx_s* context_ = nullptr;       ///< Streaming context, reused across messages
+    std::string output_;                   ///< Last compressed message
+    CompressionStats stats_;               ///< Work done so far
+};
+
+/**
+ * @class Compression
+ * @brief Compression offered to the clients of the server.
+ *
+ * Holds the settings and the trained dictionary, digested once and shared
+ * by the compressors of all connections. Clients opt in after the handshake,
+ * so the ones unaware of compression are not affected.
+ */
+class Compression {
+   public:
+    /**
+     * @brief Check if the server was built with zstd.
+     */
+    static bool supported();
+
+    /**
+     * @brief Load the dictionary, if any.
+     * @param settings Compression parameters
+     * @throws std::runtime_error if zstd is not supported or the dictionary can't be loaded
+     */
+    explicit Compression(CompressionSettings settings);
+
+    /**
+     * @brief Destructor frees the dictionary.
+     */
+    ~Compression();
+
+    Compression(const Compression&) = delete;
+    Compression& operator=(const Compression&) = delete;
+
+    /**
+     * @brief Get the compression parameters.
+     */
+    const CompressionSettings& settings() const { return settings_; }
+
+    /**
+     * @brief Get the ID of the dictionary, which clients quote to use it.
+     * @return Dictionary ID, 0 without dictionary
+     */
+    uint32_t dictionaryId() const { return dictionary_id_; }
+
+    /**
+     * @brief Create the compressor of a connection that opted in.
+     * @param use_dictionary True if the client has the server dictionary
+     * @return New compressor
+     */
+    std::unique_ptr<MessageCompressor> createCompressor(bool use_dictionary) const;
+
+   private:
+    CompressionSettings settings_;        ///< Compression parameters
+    ZSTD_CDict_s* dictionary_ = nullptr;  ///< Digested dictionary (null without one)
+    uint32_t dictionary_id_ = 0;          ///< ID of the dictionary
+};
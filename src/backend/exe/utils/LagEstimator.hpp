@@ -0,0 +1,88 @@
+/**
+ * @file LagEstimator.hpp
+ * @brief Round trip of a client, estimated from ping exchanges.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class LagEstimator
+ * @brief Smallest of the latest round trip samples of a client.
+ *
+ * Like NTP, the minimum filters out the samples inflated by queueing on the
+ * way: the fastest exchange is the closest to the path's own latency. Each
+ * sample is measured on the server's steady clock alone, from a `pong` sent
+ * to the `ping` echoing it, so the clocks of the client never enter it. Only
+ * the echo of the latest pong counts: a client can't make a round trip up.
+ */
+class LagEstimator {
+   public:
+    static constexpr size_t kSamples = 8;  ///< Samples kept, newest replacing oldest
+
+    /**
+     * @brief Add a round trip sample.
+     * @param rtt_ns Round trip in nanoseconds (ignored unless positive)
+     */
+    void addSample(int64_t rtt_ns) {
+        if (rtt_ns <= 0) {
+            return;
+        }
+        samples_[next_] = rtt_ns;
+        next_ = (next_ + 1) % kSamples;
+        count_ = std::min(count_ + 1, kSamples);
+    }
+
+    /**
+     * @brief Remember the send time of a pong, the only one whose echo is accepted next.
+     * @param sent_ns Send time on the steady clock, in nanoseconds
+     */
+    void pongSent(int64_t sent_ns) { pong_ns_ = sent_ns; }
+
+    /**
+     * @brief Add the round trip closed by a ping echoing the latest pong.
+     * @param echo_us Echoed send time of the pong, in microseconds
+     * @param received_ns Receive time of the ping, in nanoseconds
+     * @return False if the echo isn't that of the latest pong (no sample added)
+     */
+    bool addEcho(uint64_t echo_us, int64_t received_ns) {
+        if (pong_ns_ <= 0 || echo_us != static_cast<uint64_t>(pong_ns_ / 1000)) {
+            return false;
+        }
+        addSample(received_ns - pong_ns_);
+        pong_ns_ = 0;  // One sample per pong
+        return true;
+    }
+
+    /**
+     * @brief Get the estimated round trip.
+     * @return Nanoseconds, 0 before the first sample
+     */
+    int64_t roundTrip() const {
+        if (count_ == 0) {
+            return 0;
+        }
+        return *std::min_element(samples_.begin(), samples_.begin() + count_);
+    }
+
+    /**
+     * @brief Get the round trip to compensate, up to a cap.
+     * @param cap_ns Most compensation granted (a client may delay its pings on purpose)
+     */
+    int64_t compensation(int64_t cap_ns) const { return std::min(roundTrip(), cap_ns); }
+
+    /**
+     * @brief Get the number of samples kept.
+     */
+    size_t samples() const { return count_; }
+
+   private:
+    std::array<int64_t, kSamples> samples_{};
+    size_t next_ = 0;
+    size_t count_ = 0;
+    int64_t pong_ns_ = 0;  ///< Send time of the latest pong not echoed yet (0: none)
+};
@@ -1,8 +1,11 @@
 #include "Logger.hpp"
 
+#include <cstdlib>
 #include <filesystem>
 #include <vector>
 
+#include "MemoryAccounting.hpp"
+
 Logger::Logger() {
     // change this with one of the values: `info`, `debug`, `warn`, `err`, `trace`, `critical`
     const auto debug_level = spdlog::level::info;
@@ -23,9 +26,13 @@ Logger::Logger() {
     console_sink_ = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
     console_sink_->set_level(debug_level);
 
+    // Worker processes started by the router each get their own file
+    const char* log_file = std::getenv("CHESS_LOG_FILE");
+    std::string log_name = log_file ? log_file : "server.log";
+
     // File sink (overwrites on each run)
     file_sink_=
-        std::make_shared<spdlog::sinks::basic_file_sink_mt>((log_dir / "server.log").string(),
+        std::make_shared<spdlog::sinks::basic_file_sink_mt>((log_dir / log_name).string(),
                                                             true  // truncate file
         );
     file_sink_->set_level(debug_level);
@@ -51,26 +58,32 @@ Logger& Logger::instance() {
 }
 
 void Logger::info(const std::string& message) {
+    MemoryScope scope(MemoryTag::LOGGING);
     logger_->info(message);
 }
 
 void Logger::debug(const std::string& message) {
+    MemoryScope scope(MemoryTag::LOGGING);
     logger_->debug(message);
 }
 
 void Logger::trace(const std::string& message) {
+    MemoryScope scope(MemoryTag::LOGGING);
     logger_->trace(message);
 }
 
 void Logger::warning(const std::string& message) {
+    MemoryScope scope(MemoryTag::LOGGING);
     logger_->warn(message);
 }
 
 void Logger::error(const std::string& message) {
+    MemoryScope scope(MemoryTag::LOGGING);
     logger_->error(message);
 }
 
 void Logger::critical(const std::string& msg) {
+    MemoryScope scope(MemoryTag::LOGGING);
     logger_->critical(msg);
 }
 
@@ -0,0 +1,147 @@
+#include "MemoryAccounting.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+/// Subsystem names, in the order of the MemoryTag enum.
+constexpr std::array<const char*, static_cast<size_t>(MemoryTag::COUNT)> kTagNames = {
+    "other", "sessions", "rooms", "uploads", "parser", "json", "logging",
+};
+
+/**
+ * @brief Counters of one subsystem, on their own cache line to avoid false sharing.
+ */
+struct alignas(64) TagCounters {
+    std::atomic<int64_t> live_bytes{0};
+    std::atomic<uint64_t> allocations{0};
+};
+
+std::array<TagCounters, static_cast<size_t>(MemoryTag::COUNT)> counters;
+
+}  // namespace
+
+#ifdef CHESS_MEMORY_ACCOUNTING
+
+namespace {
+
+/**
+ * @brief Prefix of every accounted allocation.
+ *
+ * 16 bytes, so the user pointer keeps the alignment guaranteed by malloc.
+ */
+struct alignas(16) AllocationHeader {
+    uint64_t size;
+    MemoryTag tag;
+};
+
+static_assert(sizeof(AllocationHeader) == 16);
+
+void* accountedAlloc(size_t size) noexcept {
+    auto* header = static_cast<AllocationHeader*>(std::malloc(sizeof(AllocationHeader) + size));
+    if (!header) {
+        return nullptr;
+    }
+
+    header->size = size;
+    header->tag = current_memory_tag;
+
+    auto& tag = counters[static_cast<size_t>(header->tag)];
+    tag.live_bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+    tag.allocations.fetch_add(1, std::memory_order_relaxed);
+
+    return header + 1;
+}
+
+void accountedFree(void* ptr) noexcept {
+    if (!ptr) {
+        return;
+    }
+
+    auto* header = static_cast<AllocationHeader*>(ptr) - 1;
+    counters[static_cast<size_t>(header->tag)].live_bytes.fetch_sub(
+        static_cast<int64_t>(header->size), std::memory_order_relaxed);
+
+    std::free(header);
+}
+
+void* accountedNew(size_t size) {
+    void* ptr = accountedAlloc(size);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+}  // namespace
+
+// Replacements of the global allocation functions. Over-aligned variants are left to the
+// standard library: they are paired with their own deallocation functions.
+void* operator new(size_t size) {
+    return accountedNew(size);
+}
+
+void* operator new[](size_t size) {
+    return accountedNew(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return accountedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return accountedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    accountedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    accountedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    accountedFree(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    accountedFree(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    accountedFree(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    accountedFree(ptr);
+}
+
+#endif  // CHESS_MEMORY_ACCOUNTING
+
+namespace MemoryAccounting {
+
+bool enabled() {
+#ifdef CHESS_MEMORY_ACCOUNTING
+    return true;
+#else
+    return false;
+#endif
+}
+
+int64_t liveBytes(MemoryTag tag) {
+    return counters[static_cast<size_t>(tag)].live_bytes.load(std::memory_order_relaxed);
+}
+
+uint64_t allocations(MemoryTag tag) {
+    return counters[static_cast<size_t>(tag)].allocations.load(std::memory_order_relaxed);
+}
+
+const char* tagName(MemoryTag tag) {
+    return kTagNames[static_cast<size_t>(tag)];
+}
+
+}  // namespace MemoryAccounting
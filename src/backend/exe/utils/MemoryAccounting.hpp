@@ -0,0 +1,82 @@
+/**
+ * @file MemoryAccounting.hpp
+ * @brief Per-subsystem accounting of heap allocations.
+ *
+ * When the backend is built with `-DCHESS_MEMORY_ACCOUNTING=ON`, the global
+ * operator new/delete are replaced (MemoryAccounting.cpp) so that every
+ * allocation is charged to the subsystem tag of the calling thread, set by a
+ * MemoryScope. Frees are charged back to the tag of the allocation, whichever
+ * thread releases it, so live bytes per tag are exact.
+ *
+ * Without the option, MemoryScope only writes a thread-local byte and the
+ * stats report accounting as disabled.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Subsystems memory is charged to.
+ *
+ * Add new entries before COUNT and give them a name in MemoryAccounting.cpp.
+ */
+enum class MemoryTag : uint8_t { OTHER, SESSIONS, ROOMS, UPLOADS, PARSER, JSON, LOGGING, COUNT };
+
+/**
+ * @brief Tag charged by allocations of the current thread.
+ */
+inline thread_local MemoryTag current_memory_tag = MemoryTag::OTHER;
+
+/**
+ * @class MemoryScope
+ * @brief RAII guard charging the allocations of its scope to a subsystem.
+ *
+ * Scopes nest: the innermost one wins and the previous tag is restored on exit.
+ */
+class MemoryScope {
+   public:
+    explicit MemoryScope(MemoryTag tag) : previous_(current_memory_tag) {
+        current_memory_tag = tag;
+    }
+
+    ~MemoryScope() { current_memory_tag = previous_; }
+
+    MemoryScope(const MemoryScope&) = delete;
+    MemoryScope& operator=(const MemoryScope&) = delete;
+
+   private:
+    MemoryTag previous_;  ///< Tag restored on exit
+};
+
+namespace MemoryAccounting {
+
+/**
+ * @brief Check whether allocations are being accounted.
+ * @return True if built with CHESS_MEMORY_ACCOUNTING
+ */
+bool enabled();
+
+/**
+ * @brief Get the live bytes charged to a subsystem.
+ * @param tag Subsystem
+ * @return Bytes currently allocated (0 if accounting is disabled)
+ */
+int64_t liveBytes(MemoryTag tag);
+
+/**
+ * @brief Get the number of allocations charged to a subsystem since startup.
+ * @param tag Subsystem
+ * @return Allocation count (0 if accounting is disabled)
+ */
+uint64_t allocations(MemoryTag tag);
+
+/**
+ * @brief Get the name of a subsystem, as reported by get_stats.
+ * @param tag Subsystem
+ * @return Lowercase name
+ */
+const char* tagName(MemoryTag tag);
+
+}  // namespace MemoryAccounting
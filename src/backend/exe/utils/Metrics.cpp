@@ -0,0 +1,182 @@
+#include "Metrics.hpp"
+
+#include <malloc.h>
+
+#if defined(CHESS_ALLOCATOR_JEMALLOC)
+#include <jemalloc/jemalloc.h>
+#elif defined(CHESS_ALLOCATOR_MIMALLOC)
+#include <mimalloc.h>
+#endif
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "MemoryAccounting.hpp"
+#include "OverloadPolicy.hpp"
+
+namespace {
+
+/// Counter names, in the order of the Counter enum.
+constexpr std::array<const char*, static_cast<size_t>(Counter::COUNT)> kCounterNames = {
+    "sessions_opened",      "sessions_closed",       "messages_received",
+    "uploads_started",      "uploads_completed",     "uploads_aborted",
+    "game_resets",          "rate_limited_session",  "rate_limited_address",
+    "connections_shed",     "uploads_deferred",      "spectator_updates_thinned",
+    "compressed_sessions",  "compressed_messages",   "compression_skipped",
+    "compression_bytes_in", "compression_bytes_out", "compression_ns",
+    "move_deltas_sent",     "snapshots_sent",        "events_replayed",
+    "resync_snapshots",     "seats_held",            "seats_resumed",
+    "handoffs_received",    "rooms_opened",          "rooms_closed",
+    "rooms_migrated_out",   "rooms_migrated_in",     "sessions_migrated_out",
+    "sessions_migrated_in", "move_cache_hits",       "move_cache_misses",
+    "games_loaded",         "game_loads_rejected",   "premoves_played",
+    "premoves_cancelled",   "slow_clients_dropped",
+};
+
+/**
+ * @brief Read resident memory and thread count of the current process.
+ */
+nlohmann::json sampleProcess() {
+    nlohmann::json process = {{"rss_kb", 0}, {"threads", 0}, {"open_fds", 0}};
+
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmRSS:", 0) == 0) {
+            process["rss_kb"] = std::stoll(line.substr(6));
+        } else if (line.rfind("Threads:", 0) == 0) {
+            process["threads"] = std::stoll(line.substr(8));
+        }
+    }
+
+    std::error_code ec;
+    size_t fds = 0;
+    for (auto it = std::filesystem::directory_iterator("/proc/self/fd", ec);
+         !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+        fds++;
+    }
+    process["open_fds"] = fds;
+
+    return process;
+}
+
+/**
+ * @brief Read the statistics of the allocator selected at build time (CHESS_ALLOCATOR).
+ *
+ * `in_use_bytes` is reported by every allocator, so tools can compare builds.
+ */
+nlohmann::json sampleAllocator() {
+#if defined(CHESS_ALLOCATOR_JEMALLOC)
+    // Statistics are cached by jemalloc until the epoch is advanced
+    uint64_t epoch = 1;
+    size_t epoch_size = sizeof(epoch);
+    mallctl("epoch", &epoch, &epoch_size, &epoch, epoch_size);
+
+    auto read = [](const char* name) {
+        size_t value = 0;
+        size_t size = sizeof(value);
+        mallctl(name, &value, &size, nullptr, 0);
+        return value;
+    };
+
+    return {{"name", "jemalloc"},
+            {"in_use_bytes", read("stats.allocated")},
+            {"active_bytes", read("stats.active")},
+            {"resident_bytes", read("stats.resident")},
+            {"mapped_bytes", read("stats.mapped")}};
+#elif defined(CHESS_ALLOCATOR_MIMALLOC)
+    size_t elapsed_ms, user_ms, system_ms, rss, peak_rss, commit, peak_commit, page_faults;
+    mi_process_info(&elapsed_ms, &user_ms, &system_ms, &rss, &peak_rss, &commit, &peak_commit,
+                    &page_faults);
+
+    return {{"name", "mimalloc"},
+            {"in_use_bytes", commit},
+            {"peak_commit_bytes", peak_commit},
+            {"resident_bytes", rss},
+            {"page_faults", page_faults}};
+#elif defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return {{"name", "glibc"},
+            {"arena_bytes", info.arena},
+            {"mmap_bytes", info.hblkhd},
+            {"in_use_bytes", info.uordblks},
+            {"free_bytes", info.fordblks}};
+#else
+    return {{"name", "unknown"}};
+#endif
+}
+
+}  // namespace
+
+Metrics& Metrics::instance() {
+    static Metrics instance;
+    return instance;
+}
+
+nlohmann::json Metrics::snapshot() const {
+    nlohmann::json counters;
+    for (size_t i = 0; i < counters_.size(); ++i) {
+        counters[kCounterNames[i]] = counters_[i].load(std::memory_order_relaxed);
+    }
+
+    uint64_t sessions_active = get(Counter::SESSIONS_OPENED) - get(Counter::SESSIONS_CLOSED);
+
+    nlohmann::json memory = {{"accounting", MemoryAccounting::enabled()}};
+    if (MemoryAccounting::enabled()) {
+        nlohmann::json subsystems;
+        for (size_t i = 0; i < static_cast<size_t>(MemoryTag::COUNT); ++i) {
+            auto tag = static_cast<MemoryTag>(i);
+            subsystems[MemoryAccounting::tagName(tag)] = {
+                {"live_bytes", MemoryAccounting::liveBytes(tag)},
+                {"allocations", MemoryAccounting::allocations(tag)}};
+        }
+        memory["subsystems"] = subsystems;
+
+        if (sessions_active > 0) {
+            memory["bytes_per_session"] = MemoryAccounting::liveBytes(MemoryTag::SESSIONS) /
+                                          static_cast<int64_t>(sessions_active);
+        }
+    }
+
+    // Bandwidth saved by compression, and what it cost
+    uint64_t compressed_sessions = get(Counter::COMPRESSED_SESSIONS);
+    uint64_t bytes_in = get(Counter::COMPRESSION_BYTES_IN);
+    uint64_t bytes_out = get(Counter::COMPRESSION_BYTES_OUT);
+    uint64_t compress_us = get(Counter::COMPRESSION_NS) / 1000;
+
+    nlohmann::json compression = {
+        {"sessions", compressed_sessions},
+        {"bytes_saved", bytes_in - bytes_out},
+        {"ratio", bytes_out > 0 ? static_cast<double>(bytes_in) / bytes_out : 0.0},
+        {"compress_us", compress_us}};
+    if (compressed_sessions > 0) {
+        compression["bytes_saved_per_session"] = (bytes_in - bytes_out) / compressed_sessions;
+        compression["compress_us_per_session"] = compress_us / compressed_sessions;
+    }
+
+    // Opening positions found in the move cache shared by the games
+    uint64_t cache_hits = get(Counter::MOVE_CACHE_HITS);
+    uint64_t cache_lookups = cache_hits + get(Counter::MOVE_CACHE_MISSES);
+    nlohmann::json move_cache = {
+        {"hits", cache_hits},
+        {"lookups", cache_lookups},
+        {"hit_rate",
+         cache_lookups > 0 ? static_cast<double>(cache_hits) / cache_lookups : 0.0}};
+
+    return {{"counters", counters},
+            {"sessions_active", sessions_active},
+            {"process", sampleProcess()},
+            {"startup",
+             {{"time_to_ready_us", time_to_ready_us_.load(std::memory_order_relaxed)},
+              {"warmup_us", warmup_us_.load(std::memory_order_relaxed)}}},
+            {"overload",
+             {{"level", kOverloadLevelNames[overload_level_.load(std::memory_order_relaxed)]},
+              {"loop_lag_us", loop_lag_us_.load(std::memory_order_relaxed)},
+              {"ready_depth", ready_depth_.load(std::memory_order_relaxed)},
+              {"rss_bytes", overload_rss_bytes_.load(std::memory_order_relaxed)}}},
+            {"compression", compression},
+            {"move_cache", move_cache},
+            {"allocator", sampleAllocator()},
+            {"memory", memory}};
+}
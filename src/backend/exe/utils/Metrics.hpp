@@ -0,0 +1,146 @@
+/**
+ * @file Metrics.hpp
+ * @brief Process-wide counters reported by the `get_stats` command.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Monotonic event counters.
+ *
+ * Add new entries before COUNT and give them a name in Metrics.cpp.
+ */
+enum class Counter : size_t {
+    SESSIONS_OPENED,
+    SESSIONS_CLOSED,
+    MESSAGES_RECEIVED,
+    UPLOADS_STARTED,
+    UPLOADS_COMPLETED,
+    UPLOADS_ABORTED,
+    GAME_RESETS,
+    RATE_LIMITED_SESSION,
+    RATE_LIMITED_ADDRESS,
+    CONNECTIONS_SHED,
+    UPLOADS_DEFERRED,
+    SPECTATOR_UPDATES_THINNED,
+    COMPRESSED_SESSIONS,
+    COMPRESSED_MESSAGES,
+    COMPRESSION_SKIPPED,
+    COMPRESSION_BYTES_IN,
+    COMPRESSION_BYTES_OUT,
+    COMPRESSION_NS,
+    MOVE_DELTAS_SENT,
+    SNAPSHOTS_SENT,
+    EVENTS_REPLAYED,
+    RESYNC_SNAPSHOTS,
+    SEATS_HELD,
+    SEATS_RESUMED,
+    HANDOFFS_RECEIVED,
+    ROOMS_OPENED,
+    ROOMS_CLOSED,
+    ROOMS_MIGRATED_OUT,
+    ROOMS_MIGRATED_IN,
+    SESSIONS_MIGRATED_OUT,
+    SESSIONS_MIGRATED_IN,
+    MOVE_CACHE_HITS,
+    MOVE_CACHE_MISSES,
+    GAMES_LOADED,
+    GAME_LOADS_REJECTED,
+    PREMOVES_PLAYED,
+    PREMOVES_CANCELLED,
+    SLOW_CLIENTS_DROPPED,
+    COUNT
+};
+
+/**
+ * @class Metrics
+ * @brief Lock-free counters for the whole backend application (Singleton pattern).
+ *
+ * Counters are relaxed atomics, so incrementing one costs a single uncontended
+ * instruction on the hot path. The snapshot also samples process resources
+ * (RSS, threads, file descriptors), the allocator and, when enabled, the memory
+ * charged to each subsystem (MemoryAccounting), which the soak test uses to
+ * detect leaks.
+ */
+class Metrics {
+   public:
+    /**
+     * @brief Get the metrics instance.
+     * @return Reference to the metrics instance
+     */
+    static Metrics& instance();
+
+    /**
+     * @brief Increment a counter.
+     * @param counter Counter to increment
+     * @param value Increment
+     */
+    void increment(Counter counter, uint64_t value = 1) {
+        counters_[static_cast<size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Read a counter.
+     * @param counter Counter to read
+     * @return Current value
+     */
+    uint64_t get(Counter counter) const {
+        return counters_[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Record the startup durations, reported by the snapshot.
+     * @param time_to_ready From the start of main() to the listener accepting clients
+     * @param warmup Duration of the warm-up phase (included in time_to_ready)
+     */
+    void setStartupTimes(std::chrono::microseconds time_to_ready,
+                         std::chrono::microseconds warmup) {
+        time_to_ready_us_.store(time_to_ready.count(), std::memory_order_relaxed);
+        warmup_us_.store(warmup.count(), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Record the last overload sample, reported by the snapshot.
+     * @param level Shedding level (OverloadLevel)
+     * @param loop_lag_us Event loop lag
+     * @param ready_depth Most connections ready at once
+     * @param rss_bytes Resident memory
+     */
+    void setOverload(int level, int64_t loop_lag_us, uint64_t ready_depth, int64_t rss_bytes) {
+        overload_level_.store(level, std::memory_order_relaxed);
+        loop_lag_us_.store(loop_lag_us, std::memory_order_relaxed);
+        ready_depth_.store(ready_depth, std::memory_order_relaxed);
+        overload_rss_bytes_.store(rss_bytes, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Build a JSON snapshot of counters, process, allocator and memory statistics.
+     * @return JSON object
+     */
+    nlohmann::json snapshot() const;
+
+    // Delete copy constructor and assignment operator (Singleton)
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+   private:
+    /**
+     * @brief Private constructor (Singleton)
+     */
+    Metrics() = default;
+
+    std::array<std::atomic<uint64_t>, static_cast<size_t>(Counter::COUNT)> counters_{};
+    std::atomic<int64_t> time_to_ready_us_{0};    ///< Startup to accepting clients
+    std::atomic<int64_t> warmup_us_{0};           ///< Warm-up phase of the startup
+    std::atomic<int> overload_level_{0};          ///< Shedding level of the last overload sample
+    std::atomic<int64_t> loop_lag_us_{0};         ///< Event loop lag of the last overload sample
+    std::atomic<uint64_t> ready_depth_{0};        ///< Ready connections of the last sample
+    std::atomic<int64_t> overload_rss_bytes_{0};  ///< RSS of the last overload sample
+};
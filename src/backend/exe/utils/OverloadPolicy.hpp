@@ -0,0 +1,122 @@
+/**
+ * @file OverloadPolicy.hpp
+ * @brief Overload levels and the hysteresis deciding the current one.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Load shedding levels, each one adding to the measures of the previous one.
+ *
+ * Player moves are never shed: every measure frees the event loop and the game
+ * lock for them.
+ */
+enum class OverloadLevel : uint8_t {
+    NORMAL,    ///< Nothing shed
+    ELEVATED,  ///< Upload playback paused, new uploads rejected with a retry delay
+    HIGH,      ///< Spectators only get the latest move update periodically
+    CRITICAL,  ///< New connections rejected with a retry delay
+    COUNT
+};
+
+/// Level names, in the order of the OverloadLevel enum.
+inline constexpr std::array<const char*, static_cast<size_t>(OverloadLevel::COUNT)>
+    kOverloadLevelNames = {"normal", "elevated", "high", "critical"};
+
+/**
+ * @struct OverloadSample
+ * @brief Load signals measured by one sample.
+ */
+struct OverloadSample {
+    int64_t loop_lag_us = 0;   ///< Event loop delay to serve a wake-up
+    uint64_t ready_depth = 0;  ///< Most connections ready at once since the previous sample
+    int64_t rss_bytes = 0;     ///< Resident memory
+};
+
+/**
+ * @struct OverloadThresholds
+ * @brief Signal values entering the ELEVATED, HIGH and CRITICAL levels.
+ */
+struct OverloadThresholds {
+    std::array<int64_t, 3> loop_lag_us = {10'000, 50'000, 200'000};  ///< Event loop lag
+    std::array<uint64_t, 3> ready_depth = {32, 48, 64};  ///< Ready connections (64 per wait)
+    int64_t max_rss_bytes = 0;            ///< 70, 85 and 95% of this memory (0: not watched)
+    int64_t cooldown_ns = 2'000'000'000;  ///< Calm time before stepping down one level
+};
+
+/**
+ * @class OverloadPolicy
+ * @brief Turn load samples into a shedding level.
+ *
+ * The level rises as soon as a signal crosses a threshold, but only steps down
+ * one level per cooldown period without crossing it again, so shedding doesn't
+ * flap while the load hovers around a threshold.
+ */
+class OverloadPolicy {
+   public:
+    explicit OverloadPolicy(const OverloadThresholds& thresholds) : thresholds_(thresholds) {}
+
+    /**
+     * @brief Level required by a sample alone, without hysteresis.
+     * @param thresholds Thresholds of each signal
+     * @param sample Load signals
+     * @return Highest level reached by any signal
+     */
+    static OverloadLevel classify(const OverloadThresholds& thresholds,
+                                  const OverloadSample& sample) {
+        int level = 0;
+
+        for (int i = 0; i < 3; ++i) {
+            if (sample.loop_lag_us >= thresholds.loop_lag_us[i] ||
+                sample.ready_depth >= thresholds.ready_depth[i]) {
+                level = i + 1;
+            }
+        }
+
+        if (thresholds.max_rss_bytes > 0) {
+            constexpr std::array<int64_t, 3> kRssPercent = {70, 85, 95};
+            for (int i = 0; i < 3; ++i) {
+                if (sample.rss_bytes * 100 >= thresholds.max_rss_bytes * kRssPercent[i]) {
+                    level = std::max(level, i + 1);
+                }
+            }
+        }
+
+        return static_cast<OverloadLevel>(level);
+    }
+
+    /**
+     * @brief Account for a new sample.
+     * @param sample Load signals
+     * @param now_ns Sample time, on a monotonic clock
+     * @return New level
+     */
+    OverloadLevel update(const OverloadSample& sample, int64_t now_ns) {
+        OverloadLevel required = classify(thresholds_, sample);
+
+        if (required >= level_) {
+            level_ = required;
+            calm_since_ns_ = now_ns;
+        } else if (now_ns - calm_since_ns_ >= thresholds_.cooldown_ns) {
+            level_ = static_cast<OverloadLevel>(static_cast<int>(level_) - 1);
+            calm_since_ns_ = now_ns;
+        }
+
+        return level_;
+    }
+
+    /**
+     * @brief Get the current level.
+     */
+    OverloadLevel level() const { return level_; }
+
+   private:
+    OverloadThresholds thresholds_;
+    OverloadLevel level_ = OverloadLevel::NORMAL;
+    int64_t calm_since_ns_ = 0;  ///< Last sample requiring the current level
+};
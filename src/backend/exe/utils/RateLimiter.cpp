@@ -0,0 +1,125 @@
+#include "RateLimiter.hpp"
+
+#include <chrono>
+
+#include "Metrics.hpp"
+
+namespace {
+
+/// Sessions created between two sweeps of the address registry.
+constexpr size_t kSweepPeriod = 256;
+
+}  // namespace
+
+RateLimits RateLimits::defaults() {
+    RateLimits limits;
+
+    // move, query, control, upload (4 KB chunks: 1000 chunks is a 4 MB file)
+    limits.per_session = {RateLimit{10, 20}, RateLimit{5, 10}, RateLimit{5, 10},
+                          RateLimit{1000, 1000}};
+
+    // Several players and spectators may share an address (e.g. localhost)
+    limits.per_address = {RateLimit{80, 160}, RateLimit{40, 80}, RateLimit{40, 80},
+                          RateLimit{4000, 4000}};
+
+    return limits;
+}
+
+bool RateLimits::set(const std::string& spec, bool address) {
+    size_t equal = spec.find('=');
+    size_t slash = spec.find('/', equal);
+    if (equal == std::string::npos || slash == std::string::npos) {
+        return false;
+    }
+
+    std::string_view name = std::string_view(spec).substr(0, equal);
+
+    for (size_t i = 0; i < kCommandClassCount; ++i) {
+        if (kCommandClassNames[i] != name) {
+            continue;
+        }
+
+        try {
+            RateLimit limit{std::stod(spec.substr(equal + 1, slash - equal - 1)),
+                            std::stod(spec.substr(slash + 1))};
+            if (!limit.unlimited() && limit.burst < 1.0) {
+                return false;  // Nothing would ever pass
+            }
+            (address ? per_address : per_session)[i] = limit;
+            return true;
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+SessionRateLimiter::SessionRateLimiter(const RateLimits& limits,
+                                       std::shared_ptr<AddressBuckets> address, int64_t now_ns)
+    : limits_(limits), address_(std::move(address)) {
+    for (size_t i = 0; i < kCommandClassCount; ++i) {
+        buckets_[i] = TokenBucket(limits_.per_session[i], now_ns);
+    }
+}
+
+bool SessionRateLimiter::allow(std::string_view message, int64_t now_ns) {
+    auto index = static_cast<size_t>(classifyCommand(message));
+
+    if (!buckets_[index].tryConsume(limits_.per_session[index], now_ns)) {
+        Metrics::instance().increment(Counter::RATE_LIMITED_SESSION);
+        return false;
+    }
+
+    if (address_ && !address_->buckets[index].tryConsume(limits_.per_address[index], now_ns)) {
+        Metrics::instance().increment(Counter::RATE_LIMITED_ADDRESS);
+        return false;
+    }
+
+    return true;
+}
+
+RateLimiter::RateLimiter(RateLimits limits) : limits_(limits) {}
+
+std::unique_ptr<SessionRateLimiter> RateLimiter::createSessionLimiter(const std::string& address) {
+    int64_t now_ns = now();
+    std::shared_ptr<AddressBuckets> buckets;
+
+    if (!address.empty()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto& entry = addresses_[address];
+        buckets = entry.lock();
+        if (!buckets) {
+            buckets = std::make_shared<AddressBuckets>();
+            for (size_t i = 0; i < kCommandClassCount; ++i) {
+                buckets->buckets[i] = TokenBucket(limits_.per_address[i], now_ns);
+            }
+            entry = buckets;
+        }
+
+        if (++created_since_sweep_ >= kSweepPeriod) {
+            sweep();
+        }
+    }
+
+    return std::make_unique<SessionRateLimiter>(limits_, std::move(buckets), now_ns);
+}
+
+int64_t RateLimiter::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void RateLimiter::sweep() {
+    created_since_sweep_ = 0;
+
+    for (auto it = addresses_.begin(); it != addresses_.end();) {
+        if (it->second.expired()) {
+            it = addresses_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
@@ -0,0 +1,117 @@
+/**
+ * @file RateLimiter.hpp
+ * @brief Per-session and per-address message rate limiting.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "CommandTable.hpp"
+#include "TokenBucket.hpp"
+
+/**
+ * @struct RateLimits
+ * @brief Limits of each command class, per session and per client address.
+ */
+struct RateLimits {
+    std::array<RateLimit, kCommandClassCount> per_session;  ///< Limits of one connection
+    std::array<RateLimit, kCommandClassCount> per_address;  ///< Limits shared by an IP address
+
+    /**
+     * @brief Default limits, generous enough for play, uploads and spectating.
+     */
+    static RateLimits defaults();
+
+    /**
+     * @brief Override one limit from a `<class>=<rate>/<burst>` specification (e.g. `move=10/20`).
+     * @param spec Specification, as given on the command line
+     * @param address True to set the per-address limit, false for the per-session one
+     * @return False if the specification is invalid
+     */
+    bool set(const std::string& spec, bool address);
+};
+
+/**
+ * @struct AddressBuckets
+ * @brief Buckets shared by all sessions of one client address.
+ */
+struct AddressBuckets {
+    std::array<TokenBucket, kCommandClassCount> buckets;  ///< One bucket per command class
+};
+
+/**
+ * @class SessionRateLimiter
+ * @brief Buckets of one session, checked on the event loop thread before parsing.
+ *
+ * Each message consumes a token of its command class in the session bucket,
+ * then in the bucket of its address (not for Unix sockets, which have none).
+ */
+class SessionRateLimiter {
+   public:
+    /**
+     * @brief Create full buckets.
+     * @param limits Server limits (must outlive the session)
+     * @param address Buckets of the session address (null if none)
+     * @param now_ns Current time in nanoseconds (steady clock)
+     */
+    SessionRateLimiter(const RateLimits& limits, std::shared_ptr<AddressBuckets> address,
+                       int64_t now_ns);
+
+    /**
+     * @brief Check a raw message against the session and address limits.
+     * @param message Raw message (one line)
+     * @param now_ns Current time in nanoseconds (steady clock)
+     * @return True if the message may be handled
+     */
+    bool allow(std::string_view message, int64_t now_ns);
+
+   private:
+    const RateLimits& limits_;                             ///< Server limits
+    std::array<TokenBucket, kCommandClassCount> buckets_;  ///< Session buckets
+    std::shared_ptr<AddressBuckets> address_;              ///< Address buckets (optional)
+};
+
+/**
+ * @class RateLimiter
+ * @brief Server-wide limits and registry of the address buckets.
+ */
+class RateLimiter {
+   public:
+    /**
+     * @brief Create a rate limiter.
+     * @param limits Limits of each command class
+     */
+    explicit RateLimiter(RateLimits limits);
+
+    /**
+     * @brief Create the limiter of a new session.
+     * @param address Client IP address (empty for Unix sockets)
+     * @return Session limiter, sharing the buckets of other sessions from the same address
+     */
+    std::unique_ptr<SessionRateLimiter> createSessionLimiter(const std::string& address);
+
+    /**
+     * @brief Current time for the buckets, in nanoseconds.
+     */
+    static int64_t now();
+
+   private:
+    /**
+     * @brief Drop the entries of addresses without sessions (caller holds the lock).
+     */
+    void sweep();
+
+    RateLimits limits_;  ///< Limits of each command class
+
+    /// Buckets of each address, alive as long as one of its sessions
+    std::unordered_map<std::string, std::weak_ptr<AddressBuckets>> addresses_;
+    size_t created_since_sweep_ = 0;  ///< Sessions created since the last sweep
+    std::mutex mutex_;                ///< Sessions are created on the accept thread
+};
@@ -0,0 +1,152 @@
+/**
+ * @file SlabPool.hpp
+ * @brief Fixed-size slots carved from slabs, recycled without the global allocator.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+/**
+ * @class SlabPool
+ * @brief Pool of equal slots, allocated a slab of kSlotsPerSlab at a time.
+ *
+ * Freed slots go on a free list and are handed out again newest first, while
+ * still warm in the cache. Slabs are only released with the pool, so once the
+ * pool has grown to the peak number of objects, allocating and freeing one is
+ * a few pointer writes under a lock. Slots are aligned on cache lines: two
+ * objects never share a line, and the first line of each holds its first
+ * members.
+ *
+ * @tparam Size Object size
+ * @tparam Align Object alignment
+ */
+template <size_t Size, size_t Align>
+class SlabPool {
+   public:
+    static constexpr size_t kCacheLine = 64;
+    static constexpr size_t kSlotsPerSlab = 16;
+
+    SlabPool() = default;
+    SlabPool(const SlabPool&) = delete;
+    SlabPool& operator=(const SlabPool&) = delete;
+
+    /**
+     * @brief Get the pool shared by every object of this size and alignment.
+     *
+     * Never destroyed: objects may be freed by other static destructors.
+     */
+    static SlabPool& instance() {
+        static auto* pool = new SlabPool();
+        return *pool;
+    }
+
+    /**
+     * @brief Take a free slot, adding a slab if none is left.
+     * @return Uninitialised storage for one object
+     */
+    void* allocate() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!free_) {
+            grow();
+        }
+        Slot* slot = free_;
+        free_ = slot->next;
+        ++in_use_;
+        return slot->storage;
+    }
+
+    /**
+     * @brief Give a slot back (its object already destroyed).
+     */
+    void deallocate(void* storage) {
+        auto* slot = static_cast<Slot*>(storage);
+        std::lock_guard<std::mutex> lock(mutex_);
+        slot->next = free_;
+        free_ = slot;
+        --in_use_;
+    }
+
+    /**
+     * @brief Get the number of slots handed out.
+     */
+    size_t inUse() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return in_use_;
+    }
+
+    /**
+     * @brief Get the number of slots of all slabs.
+     */
+    size_t capacity() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return slabs_.size() * kSlotsPerSlab;
+    }
+
+   private:
+    /// Object storage, or the next free slot while free
+    union alignas(std::max(Align, kCacheLine)) Slot {
+        Slot* next;
+        std::byte storage[Size];
+    };
+
+    /// Add a slab, its slots on the free list in address order
+    void grow() {
+        auto& slab = slabs_.emplace_back(std::make_unique<Slot[]>(kSlotsPerSlab));
+        for (size_t i = kSlotsPerSlab; i-- > 0;) {
+            slab[i].next = free_;
+            free_ = &slab[i];
+        }
+    }
+
+    mutable std::mutex mutex_;
+    Slot* free_ = nullptr;
+    size_t in_use_ = 0;
+    std::vector<std::unique_ptr<Slot[]>> slabs_;
+};
+
+/**
+ * @class SlabAllocator
+ * @brief Standard allocator drawing single objects from the SlabPool of their size.
+ *
+ * Meant for std::allocate_shared: the control block and the object then share
+ * one slot. Arrays go to the global allocator.
+ */
+template <typename T>
+class SlabAllocator {
+   public:
+    using value_type = T;
+
+    SlabAllocator() = default;
+
+    template <typename U>
+    SlabAllocator(const SlabAllocator<U>&) noexcept {}  // NOLINT: rebinding is implicit
+
+    T* allocate(size_t n) {
+        if (n != 1) {
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{alignof(T)}));
+        }
+        return static_cast<T*>(Pool::instance().allocate());
+    }
+
+    void deallocate(T* object, size_t n) noexcept {
+        if (n != 1) {
+            ::operator delete(object, std::align_val_t{alignof(T)});
+            return;
+        }
+        Pool::instance().deallocate(object);
+    }
+
+    template <typename U>
+    bool operator==(const SlabAllocator<U>&) const noexcept {
+        return true;
+    }
+
+   private:
+    using Pool = SlabPool<sizeof(T), alignof(T)>;
+};
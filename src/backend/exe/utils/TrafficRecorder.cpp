@@ -0,0 +1,45 @@
+#include "TrafficRecorder.hpp"
+
+#include <stdexcept>
+
+TrafficRecorder::TrafficRecorder(const std::string& path)
+    : path_(path), out_(path, std::ios::out | std::ios::trunc),
+      start_time_(std::chrono::steady_clock::now()) {
+    if (!out_) {
+        throw std::runtime_error("Cannot open traffic capture file: " + path);
+    }
+
+    out_ << "# chess-traffic v1\n";
+}
+
+TrafficRecorder::~TrafficRecorder() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    out_.flush();
+}
+
+void TrafficRecorder::recordOpen(const std::string& session_id) {
+    write(session_id, "open", "");
+}
+
+void TrafficRecorder::recordMessage(const std::string& session_id, const std::string& message) {
+    write(session_id, "msg", message);
+}
+
+void TrafficRecorder::recordClose(const std::string& session_id) {
+    write(session_id, "close", "");
+}
+
+void TrafficRecorder::write(const std::string& session_id, const char* event,
+                            const std::string& payload) {
+    // Timestamp taken outside the lock so that contention doesn't skew the capture
+    auto now = std::chrono::steady_clock::now();
+    auto t_us = std::chrono::duration_cast<std::chrono::microseconds>(now - start_time_).count();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    out_ << t_us << '\t' << session_id << '\t' << event << '\t' << payload << '\n';
+
+    // Session boundaries are rare: flush them so a crashed server still leaves a usable capture
+    if (payload.empty()) {
+        out_.flush();
+    }
+}
@@ -0,0 +1,83 @@
+/**
+ * @file TrafficRecorder.hpp
+ * @brief Capture of inbound session traffic for offline replay.
+ *
+ * Writes one record per line, tab-separated:
+ *
+ *     <t_us>\t<session_id>\t<event>\t<payload>
+ *
+ * where `t_us` is the number of microseconds since the recorder was opened,
+ * `event` is one of `open`, `msg` or `close`, and `payload` is the complete
+ * application message (only set for `msg`). Messages are newline-delimited on
+ * the wire, so a payload never contains a line break. The first line of the
+ * file is the `# chess-traffic v1` header.
+ *
+ * The file is consumed by the `chess_replay` tool (src/backend/tools/replay).
+ */
+
+#pragma once
+
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+/**
+ * @class TrafficRecorder
+ * @brief Thread-safe writer of timestamped session frames.
+ *
+ * One instance is shared by all sessions of a server. Recording is only
+ * enabled when the server is started with `--record <file>`.
+ */
+class TrafficRecorder {
+   public:
+    /**
+     * @brief Open the capture file (truncated if it exists).
+     * @param path Output file path
+     * @throws std::runtime_error if the file cannot be opened
+     */
+    explicit TrafficRecorder(const std::string& path);
+
+    /**
+     * @brief Destructor flushes pending records.
+     */
+    ~TrafficRecorder();
+
+    /**
+     * @brief Record a new client session.
+     * @param session_id Session ID
+     */
+    void recordOpen(const std::string& session_id);
+
+    /**
+     * @brief Record a complete inbound application message.
+     * @param session_id Session ID
+     * @param message Message content (without the trailing '\n')
+     */
+    void recordMessage(const std::string& session_id, const std::string& message);
+
+    /**
+     * @brief Record a session closure.
+     * @param session_id Session ID
+     */
+    void recordClose(const std::string& session_id);
+
+    /**
+     * @brief Get the capture file path.
+     */
+    const std::string& getPath() const { return path_; }
+
+    TrafficRecorder(const TrafficRecorder&) = delete;
+    TrafficRecorder& operator=(const TrafficRecorder&) = delete;
+
+   private:
+    /**
+     * @brief Append one record to the capture file.
+     */
+    void write(const std::string& session_id, const char* event, const std::string& payload);
+
+    std::string path_;                                  ///< Capture file path
+    std::ofstream out_;                                 ///< Capture file stream
+    std::mutex mutex_;                                  ///< Serialises writers
+    std::chrono::steady_clock::time_point start_time_;  ///< Time origin of the capture
+};
@@ -0,0 +1,121 @@
+#include "Warmup.hpp"
+
+#include <chess.hpp>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "BufferPool.hpp"
+#include "ChessGame.hpp"
+#include "Logger.hpp"
+#include "Metrics.hpp"
+#include "ParserFactory.hpp"
+
+namespace {
+
+/// Sample game in simple notation, with a comment, captures and castling.
+const std::string kSimpleGame = R"(// Warm-up game
+e2-e4
+e7-e5
+g1-f3
+b8-c6
+f1-c4
+g8-f6
+e1-g1
+f6-e4
+d2-d4
+e5-d4
+)";
+
+/// Sample game in PGN, with tags, castling, captures, checks and a comment.
+const std::string kPgnGame = R"([Event "Warm-up"]
+[Site "Local"]
+[Result "1-0"]
+
+1. e4 e5 2. Nf3 Nc6 3. Bb5 a6 4. Ba4 Nf6 5. O-O Be7 6. Re1 b5 7. Bb3 d6
+8. c3 O-O 9. h3 Nb8 10. d4 Nbd7 {Breyer} 11. Nbd2 Bb7 12. Bc2 Re8 13. Nf1 Bf8
+14. Ng3 g6 15. a4 c5 16. d5 c4 17. Bg5 h6 18. Be3 Nc5 19. Qd2 h5 20. Bg5 Qc7
+21. Bxf6 Nxa4 22. Bxa4 bxa4 23. Qg5 Kh7 24. Qxh5+ Kg8 25. Qg4 Qd8 1-0)";
+
+/// Single moves as sent by the make_move command.
+const std::vector<std::string> kSimpleMoves = {"e2-e4", "g8-f6", "e1-g1", "a7-a8"};
+const std::vector<std::string> kPgnMoves = {"e4",  "Nf3",  "O-O", "O-O-O", "exd5",
+                                            "Qh5+", "e8=Q", "Rxa8#", "Nbd7"};
+
+/**
+ * @brief Time a task.
+ */
+template <typename Task>
+std::chrono::microseconds timed(Task task) {
+    auto start = std::chrono::steady_clock::now();
+    task();
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+}
+
+}  // namespace
+
+WarmupReport Warmup::run() {
+    WarmupReport report;
+
+    report.total = timed([&report] {
+        auto simple = std::async(std::launch::async, [] { return timed(warmSimpleParser); });
+        auto pgn = std::async(std::launch::async, [] { return timed(warmPgnParser); });
+        auto chess = std::async(std::launch::async, [] { return timed(warmChess); });
+        report.pools = timed(warmPools);
+
+        report.simple_parser = simple.get();
+        report.pgn_parser = pgn.get();
+        report.chess = chess.get();
+    });
+
+    return report;
+}
+
+void Warmup::warmSimpleParser() {
+    auto parser = ParserFactory::createParser(ParserType::SIMPLE_NOTATION);
+
+    parser->parseGame(kSimpleGame);
+    for (const auto& move : kSimpleMoves) {
+        parser->parseMove(move);
+    }
+}
+
+void Warmup::warmPgnParser() {
+    auto parser = ParserFactory::createParser(ParserType::PGN);
+
+    parser->parseGame(kPgnGame);
+    for (const auto& move : kPgnMoves) {
+        parser->parseMove(move);
+    }
+}
+
+void Warmup::warmChess() {
+    // Allocates the move cache shared by the games and stores the starting position
+    ChessGame game;
+
+    chess::Board board;
+
+    // Follow the first legal move a few plies, generating SAN for every move on the way
+    for (int ply = 0; ply < 16; ++ply) {
+        chess::Movelist moves;
+        chess::movegen::legalmoves(moves, board);
+        if (moves.empty()) {
+            break;
+        }
+
+        for (const auto& move : moves) {
+            chess::uci::moveToSan(board, move);
+        }
+
+        board.makeMove(moves[ply % moves.size()]);
+        board.isGameOver();
+    }
+}
+
+void Warmup::warmPools() {
+    BufferPool::instance().reserve(BufferPool::kMaxPooled);
+
+    // First /proc reads and JSON serialisation of get_stats
+    Metrics::instance().snapshot().dump();
+}
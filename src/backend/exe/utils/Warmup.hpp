@@ -0,0 +1,60 @@
+/**
+ * @file Warmup.hpp
+ * @brief Startup phase taking cold-path costs before the server accepts clients.
+ */
+
+#pragma once
+
+#include <chrono>
+
+/**
+ * @struct WarmupReport
+ * @brief Duration of each warm-up task and of the whole phase.
+ */
+struct WarmupReport {
+    std::chrono::microseconds simple_parser{0};  ///< Simple notation parser DFA warm-up
+    std::chrono::microseconds pgn_parser{0};     ///< PGN parser DFA warm-up
+    std::chrono::microseconds chess{0};          ///< Move generation and SAN warm-up
+    std::chrono::microseconds pools{0};          ///< Buffer pool pre-allocation
+    std::chrono::microseconds total{0};          ///< Wall time of the parallel phase
+};
+
+/**
+ * @class Warmup
+ * @brief Runs the warm-up tasks in parallel, before the listener is bound.
+ *
+ * ANTLR builds its DFA cache lazily, one decision at a time, the first time a
+ * parser meets each kind of input; move generation and SAN code pages and the
+ * session buffer pool are cold too. Without this phase, the first real moves
+ * pay for all of it. The DFA cache is static per grammar, so warming one
+ * parser instance benefits every session.
+ */
+class Warmup {
+   public:
+    /**
+     * @brief Run all warm-up tasks and wait for them.
+     * @return Durations, for the startup report
+     */
+    static WarmupReport run();
+
+   private:
+    /**
+     * @brief Parse sample moves and games in simple notation.
+     */
+    static void warmSimpleParser();
+
+    /**
+     * @brief Parse sample moves and games in PGN/SAN notation.
+     */
+    static void warmPgnParser();
+
+    /**
+     * @brief Generate legal moves and their SAN along a short game, and allocate the move cache.
+     */
+    static void warmChess();
+
+    /**
+     * @brief Fill the session buffer pool and sample the metrics once.
+     */
+    static void warmPools();
+};
@@ -26,6 +26,16 @@ std::unique_ptr<IGameParser> ParserFactory::createParser(const std::string& type
     return createParser(parseParserType(type_str));
 }
 
+IGameParser& ParserFactory::sharedParser(ParserType type) {
+    // Released: rooms may still parse while static destructors run
+    if (type == ParserType::PGN) {
+        static IGameParser* pgn = createParser(ParserType::PGN).release();
+        return *pgn;
+    }
+    static IGameParser* simple = createParser(ParserType::SIMPLE_NOTATION).release();
+    return *simple;
+}
+
 ParserType ParserFactory::parseParserType(const std::string& type_str) {
     // Convert to lowercase for case-insensitive comparison
     std::string lower = type_str;
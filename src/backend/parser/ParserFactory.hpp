@@ -34,6 +34,16 @@ public:
      * @return Unique pointer to the created parser
      */
     static std::unique_ptr<IGameParser> createParser(const std::string& type_str);
+
+    /**
+     * @brief Get the parser of a type shared by the whole process
+     *
+     * Parsers keep no state between calls, so every room can use the same
+     * one instead of creating its own.
+     * @param type The parser type
+     * @return Parser created on first use, never destroyed
+     */
+    static IGameParser& sharedParser(ParserType type);
     
     /**
      * @brief Parse parser type from string
@@ -0,0 +1,78 @@
+/**
+ * @file HashRing.hpp
+ * @brief Consistent hashing of room names onto worker processes.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @class HashRing
+ * @brief Ring of virtual nodes mapping keys to a fixed set of nodes.
+ *
+ * Each node owns many points of a 64-bit ring, and a key belongs to the node of
+ * the first point following its hash. Growing from N to N + 1 nodes only moves
+ * about 1 / (N + 1) of the keys, so rooms stay on their worker when the router
+ * restarts with more workers.
+ */
+class HashRing {
+   public:
+    static constexpr int kDefaultReplicas = 160;  ///< Points per node (about 5% imbalance)
+
+    /**
+     * @brief Build the ring.
+     * @param nodes Number of nodes (at least 1)
+     * @param replicas Points per node
+     */
+    explicit HashRing(size_t nodes, int replicas = kDefaultReplicas) {
+        nodes = std::max<size_t>(nodes, 1);
+        points_.reserve(nodes * replicas);
+
+        for (size_t node = 0; node < nodes; ++node) {
+            for (int replica = 0; replica < replicas; ++replica) {
+                std::string point =
+                    "worker-" + std::to_string(node) + "#" + std::to_string(replica);
+                points_.emplace_back(hash(point), static_cast<uint32_t>(node));
+            }
+        }
+
+        std::sort(points_.begin(), points_.end());
+    }
+
+    /**
+     * @brief Find the node of a key.
+     * @param key Room name
+     * @return Node index
+     */
+    size_t nodeFor(std::string_view key) const {
+        uint64_t position = hash(key);
+        auto it = std::lower_bound(points_.begin(), points_.end(),
+                                   std::make_pair(position, uint32_t{0}));
+        return it == points_.end() ? points_.front().second : it->second;
+    }
+
+    /**
+     * @brief Hash a key onto the ring (FNV-1a, then mixed to spread similar names).
+     */
+    static constexpr uint64_t hash(std::string_view key) {
+        uint64_t value = 0xcbf29ce484222325ULL;
+        for (char c : key) {
+            value = (value ^ static_cast<uint8_t>(c)) * 0x100000001b3ULL;
+        }
+
+        // splitmix64 finaliser
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+        return value ^ (value >> 31);
+    }
+
+   private:
+    std::vector<std::pair<uint64_t, uint32_t>> points_;  ///< Sorted (position, node) points
+};
@@ -0,0 +1,441 @@
+#include "Router.hpp"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+#include <utility>
+
+#include "Handoff.hpp"
+
+namespace {
+
+constexpr int kTickMs = 100;    ///< Loop wake-up, for the room waits and the supervision
+constexpr int kMaxEvents = 64;  ///< Events handled per epoll_wait()
+
+constexpr auto kMigrationTimeout = std::chrono::seconds(10);    ///< Whole migration
+constexpr auto kForwardWait = std::chrono::milliseconds(1000);  ///< Per packet forwarded
+
+}  // namespace
+
+Router::Router(RouterSettings settings, WorkerPool& pool)
+    : settings_(std::move(settings)), pool_(pool), ring_(pool.size()) {}
+
+Router::~Router() {
+    stop();
+}
+
+void Router::start() {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        throw std::runtime_error("Cannot create socket: " + std::string(strerror(errno)));
+    }
+
+    int opt = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(settings_.port);
+    if (inet_pton(AF_INET, settings_.ip.c_str(), &addr.sin_addr) <= 0) {
+        throw std::runtime_error("Invalid address: " + settings_.ip);
+    }
+
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        throw std::runtime_error("Bind failed: " + std::string(strerror(errno)));
+    }
+    if (listen(listen_fd_, SOMAXCONN) < 0) {
+        throw std::runtime_error("Listen failed: " + std::string(strerror(errno)));
+    }
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        throw std::runtime_error("Cannot create epoll: " + std::string(strerror(errno)));
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = listen_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &event);
+
+    thread_ = std::jthread([this](std::stop_token st) { run(st); });
+}
+
+void Router::stop() {
+    if (thread_.joinable()) {
+        thread_.request_stop();
+        thread_.join();
+    }
+
+    for (const auto& client : pending_) {
+        close(client.first);
+    }
+    pending_.clear();
+
+    if (migration_) {
+        for (const auto& client : migration_->held) {
+            close(client.first);
+        }
+        migration_.reset();
+    }
+    channels_.clear();
+
+    if (epoll_fd_ >= 0) {
+        close(epoll_fd_);
+        epoll_fd_ = -1;
+    }
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+        listen_fd_ = -1;
+    }
+}
+
+std::optional<std::string> Router::requestedRoom(std::string_view line) {
+    auto request = nlohmann::json::parse(line, nullptr, false);
+
+    if (!request.is_object() || request.value("command", "") != "join_room" ||
+        !request.contains("room") || !request["room"].is_string()) {
+        return std::nullopt;
+    }
+
+    return request["room"].get<std::string>();
+}
+
+bool Router::validRoom(std::string_view room) {
+    if (room.empty() || room.size() > HandoffChannel::kMaxRoomSize) {
+        return false;
+    }
+
+    return std::all_of(room.begin(), room.end(), [](char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+               c == '_' || c == '-' || c == '.';
+    });
+}
+
+void Router::migrate(const std::string& room, std::optional<size_t> target) {
+    std::lock_guard<std::mutex> lock(requests_mutex_);
+    requests_.emplace_back(room, target);
+}
+
+void Router::run(std::stop_token st) {
+    epoll_event events[kMaxEvents];
+
+    while (!st.stop_requested()) {
+        watchChannels();
+
+        int count = epoll_wait(epoll_fd_, events, kMaxEvents, kTickMs);
+        if (count < 0 && errno != EINTR) {
+            std::cerr << "epoll_wait failed: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+            auto channel = channels_.find(fd);
+
+            if (fd == listen_fd_) {
+                acceptClients();
+            } else if (channel != channels_.end() && pool_.channelFd(channel->second) == fd) {
+                readChannel(channel->second);
+            } else {
+                readClient(fd);
+            }
+        }
+
+        expireClients();
+        expireMigration();
+        startMigration();
+        pool_.supervise();
+    }
+}
+
+void Router::watchChannels() {
+    // Forget the channels closed (their socket numbers may be reused by clients)
+    for (auto it = channels_.begin(); it != channels_.end();) {
+        if (pool_.channelFd(it->second) != it->first) {
+            it = channels_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (size_t worker = 0; worker < pool_.size(); ++worker) {
+        int fd = pool_.channelFd(worker);
+        if (fd < 0 || channels_.count(fd)) {
+            continue;
+        }
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) == 0 || errno == EEXIST) {
+            channels_[fd] = worker;
+        }
+    }
+}
+
+void Router::readChannel(size_t worker) {
+    auto packet = pool_.receive(worker);
+    if (!packet) {
+        // Channel closed: a worker of the migration is gone
+        if (migration_ && (migration_->source == worker || migration_->target == worker)) {
+            finishMigration(false, "worker " + std::to_string(worker) + " lost");
+        }
+        return;
+    }
+
+    if (!migration_ || packet->room != migration_->room) {
+        std::cerr << "Unexpected packet from worker " << worker << std::endl;
+        for (int fd : packet->fds) {
+            close(fd);
+        }
+        return;
+    }
+
+    if (packet->kind == HandoffKind::ROOM_FAILED) {
+        finishMigration(false, packet->payload);
+        return;
+    }
+
+    if (packet->kind == HandoffKind::ROOM_READY && worker == migration_->target) {
+        auto summary = nlohmann::json::parse(packet->payload, nullptr, false);
+        auto pause = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - migration_->started);
+
+        std::string outcome = std::to_string(summary.value("sessions", 0)) + " sessions, " +
+                              std::to_string(pause.count()) + " us (export " +
+                              std::to_string(migration_->export_us) + " us, import " +
+                              std::to_string(summary.value("import_us", int64_t{-1})) + " us)";
+        finishMigration(true, outcome);
+        return;
+    }
+
+    if (worker != migration_->source || packet->kind == HandoffKind::ROOM_READY) {
+        std::cerr << "Unexpected packet from worker " << worker << std::endl;
+        for (int fd : packet->fds) {
+            close(fd);
+        }
+        return;
+    }
+
+    if (packet->kind == HandoffKind::ROOM_END) {
+        auto summary = nlohmann::json::parse(packet->payload, nullptr, false);
+        migration_->export_us = summary.value("export_us", int64_t{-1});
+    }
+
+    // Room data from the source goes to the target as is
+    bool forwarded = pool_.send(migration_->target, packet->kind, packet->room,
+                                packet->payload, packet->fds, kForwardWait);
+
+    // The target has its own copies of the sockets now (or they are lost with the room)
+    for (int fd : packet->fds) {
+        close(fd);
+    }
+
+    if (!forwarded) {
+        pool_.send(migration_->target, HandoffKind::ROOM_FAILED, packet->room, "Source lost");
+        finishMigration(false, "worker " + std::to_string(migration_->target) + " not reading");
+    }
+}
+
+void Router::startMigration() {
+    while (!migration_) {
+        std::pair<std::string, std::optional<size_t>> request;
+        {
+            std::lock_guard<std::mutex> lock(requests_mutex_);
+            if (requests_.empty()) {
+                return;
+            }
+            request = std::move(requests_.front());
+            requests_.pop_front();
+        }
+
+        const std::string& room = request.first;
+        size_t source = validRoom(room) ? ownerOf(room) : 0;
+        size_t target = request.second.value_or((source + 1) % pool_.size());
+
+        if (!validRoom(room)) {
+            std::cout << "Cannot migrate room " << room << ": invalid room name" << std::endl;
+        } else if (target >= pool_.size() || target == source) {
+            std::cout << "Cannot migrate room " << room << ": already on worker " << source
+                      << " or no worker " << target << std::endl;
+        } else if (pool_.channelFd(target) < 0 ||
+                   !pool_.send(source, HandoffKind::MIGRATE, room, std::string_view())) {
+            std::cout << "Cannot migrate room " << room << ": worker unavailable" << std::endl;
+        } else {
+            std::cout << "Migrating room " << room << " from worker " << source << " to worker "
+                      << target << "..." << std::endl;
+            migration_.emplace();
+            migration_->room = room;
+            migration_->source = source;
+            migration_->target = target;
+            migration_->started = std::chrono::steady_clock::now();
+        }
+    }
+}
+
+void Router::expireMigration() {
+    if (migration_ && std::chrono::steady_clock::now() - migration_->started > kMigrationTimeout) {
+        finishMigration(false, "timed out");
+    }
+}
+
+void Router::finishMigration(bool moved, const std::string& outcome) {
+    Migration migration = std::move(*migration_);
+    migration_.reset();
+
+    if (moved) {
+        if (migration.target == ring_.nodeFor(migration.room)) {
+            owners_.erase(migration.room);
+        } else {
+            owners_[migration.room] = migration.target;
+        }
+        std::cout << "Room " << migration.room << " migrated to worker " << migration.target
+                  << ": " << outcome << std::endl;
+    } else {
+        // The room stays with (or is reopened by) its owner
+        std::cout << "Migration of room " << migration.room << " failed: " << outcome
+                  << std::endl;
+    }
+
+    for (auto& client : migration.held) {
+        route(client.first, migration.room, client.second);
+    }
+}
+
+size_t Router::ownerOf(const std::string& room) const {
+    auto it = owners_.find(room);
+    return it != owners_.end() ? it->second : ring_.nodeFor(room);
+}
+
+void Router::acceptClients() {
+    while (true) {
+        int client_fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                std::cerr << "Accept failed: " << strerror(errno) << std::endl;
+            }
+            return;
+        }
+
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.fd = client_fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, client_fd, &event) < 0) {
+            close(client_fd);
+            continue;
+        }
+
+        pending_[client_fd].deadline = std::chrono::steady_clock::now() + settings_.room_wait;
+    }
+}
+
+void Router::readClient(int client_fd) {
+    auto it = pending_.find(client_fd);
+    if (it == pending_.end()) {
+        return;
+    }
+
+    std::string& received = it->second.received;
+    char buffer[HandoffChannel::kMaxPendingSize];
+    size_t room_left = HandoffChannel::kMaxPendingSize - received.size();
+
+    ssize_t bytes = recv(client_fd, buffer, room_left, 0);
+    if (bytes == 0 || (bytes < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+        // Gone before being handed over
+        forget(client_fd);
+        close(client_fd);
+        return;
+    }
+    if (bytes > 0) {
+        received.append(buffer, static_cast<size_t>(bytes));
+    }
+
+    size_t newline = received.find('\n');
+    if (newline == std::string::npos) {
+        if (received.size() >= HandoffChannel::kMaxPendingSize) {
+            // No line fits the handoff: the worker deals with it in the default room
+            std::string pending = std::move(received);
+            forget(client_fd);
+            route(client_fd, std::string(), pending);
+        }
+        return;
+    }
+
+    std::string pending = std::move(received);
+    forget(client_fd);
+
+    auto room = requestedRoom(std::string_view(pending).substr(0, newline));
+    if (!room) {
+        // Any other first command is for the default room
+        route(client_fd, std::string(), pending);
+    } else if (!validRoom(*room)) {
+        reject(client_fd, "Invalid room name", false);
+    } else {
+        route(client_fd, *room, std::string_view(pending).substr(newline + 1));
+    }
+}
+
+void Router::expireClients() {
+    auto now = std::chrono::steady_clock::now();
+
+    for (auto it = pending_.begin(); it != pending_.end();) {
+        if (now < it->second.deadline) {
+            ++it;
+            continue;
+        }
+
+        // No join_room in time: the client is for the default room
+        int client_fd = it->first;
+        std::string pending = std::move(it->second.received);
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, client_fd, nullptr);
+        it = pending_.erase(it);
+
+        route(client_fd, std::string(), pending);
+    }
+}
+
+void Router::route(int client_fd, const std::string& room, std::string_view pending) {
+    if (migration_ && migration_->room == room) {
+        // Handed over once the room has settled on a worker
+        migration_->held.emplace_back(client_fd, std::string(pending));
+        return;
+    }
+
+    // The worker's transport expects a blocking socket, as accepted by the server itself
+    int flags = fcntl(client_fd, F_GETFL, 0);
+    fcntl(client_fd, F_SETFL, flags & ~O_NONBLOCK);
+
+    if (!pool_.handOff(ownerOf(room), client_fd, room, pending)) {
+        reject(client_fd, "Room unavailable", true);
+        return;
+    }
+
+    // The worker has its own copy of the socket now
+    close(client_fd);
+}
+
+void Router::reject(int client_fd, const std::string& error, bool retry) {
+    nlohmann::json response = {{"type", "error"}, {"error", error}};
+    if (retry) {
+        response["retry_after_ms"] = 1000;
+    }
+
+    std::string message = response.dump() + "\n";
+    send(client_fd, message.data(), message.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+    close(client_fd);
+}
+
+void Router::forget(int client_fd) {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, client_fd, nullptr);
+    pending_.erase(client_fd);
+}
@@ -0,0 +1,178 @@
+/**
+ * @file Router.hpp
+ * @brief Front process accepting clients and handing them to the worker of their room.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "HashRing.hpp"
+#include "WorkerPool.hpp"
+
+/**
+ * @struct RouterSettings
+ * @brief Listening address and room selection of the router.
+ */
+struct RouterSettings {
+    std::string ip = "127.0.0.1";              ///< Listening address
+    int port = 2000;                           ///< Listening port
+    std::chrono::milliseconds room_wait{200};  ///< Wait for a join_room line
+};
+
+/**
+ * @class Router
+ * @brief Accepts TCP clients and passes each one to the worker owning its room.
+ *
+ * A client may send `{"command":"join_room","room":"<name>"}` as its first
+ * line. Without it (another first line, or nothing within the room wait), the
+ * client goes to the default room, and whatever it sent is passed on to the
+ * worker with the socket. Rooms are spread over the workers by consistent
+ * hashing, so all the clients of a room share one process and one game, while
+ * a crashing worker only takes its own rooms down.
+ *
+ * A room can be moved to another worker while it is played: the router asks
+ * the owner to send the room out, forwards its state and client sockets to the
+ * new worker, and holds the clients joining the room meanwhile. The room then
+ * stays on that worker until it moves again.
+ */
+class Router {
+   public:
+    /**
+     * @brief Create the router.
+     * @param settings Router settings
+     * @param pool Started worker pool
+     */
+    Router(RouterSettings settings, WorkerPool& pool);
+
+    /**
+     * @brief Destructor stops the router.
+     */
+    ~Router();
+
+    Router(const Router&) = delete;
+    Router& operator=(const Router&) = delete;
+
+    /**
+     * @brief Bind the listening socket and start routing clients.
+     * @throws std::runtime_error if the socket can't be bound
+     */
+    void start();
+
+    /**
+     * @brief Stop accepting clients and close the ones not handed over yet.
+     */
+    void stop();
+
+    /**
+     * @brief Read the room a first line asks for.
+     * @param line First line sent by the client (without the newline)
+     * @return Room name, or nullopt if the line isn't a join_room command
+     */
+    static std::optional<std::string> requestedRoom(std::string_view line);
+
+    /**
+     * @brief Check a room name: 1 to 64 letters, digits, '_', '-' or '.'.
+     */
+    static bool validRoom(std::string_view room);
+
+    /**
+     * @brief Queue the migration of a room to another worker (any thread).
+     *
+     * Migrations run one at a time, in the order requested, and their outcome
+     * is printed.
+     *
+     * @param room Room name
+     * @param target Worker index (default: the worker after the current owner)
+     */
+    void migrate(const std::string& room, std::optional<size_t> target = std::nullopt);
+
+   private:
+    /**
+     * @struct PendingClient
+     * @brief Client accepted but not handed over yet.
+     */
+    struct PendingClient {
+        std::string received;                            ///< Bytes read so far
+        std::chrono::steady_clock::time_point deadline;  ///< End of the room wait
+    };
+
+    /**
+     * @struct Migration
+     * @brief Room being moved between two workers.
+     */
+    struct Migration {
+        std::string room;                               ///< Room name
+        size_t source = 0;                              ///< Current owner
+        size_t target = 0;                              ///< New owner
+        std::chrono::steady_clock::time_point started;  ///< MIGRATE sent
+        int64_t export_us = -1;                         ///< Reported by the source
+        std::vector<std::pair<int, std::string>> held;  ///< Clients joining meanwhile
+    };
+
+    void run(std::stop_token st);     ///< Router loop
+    void acceptClients();             ///< Accept every waiting connection
+    void readClient(int client_fd);   ///< Read until the first line is complete
+    void expireClients();             ///< Route the clients whose wait is over
+    void forget(int client_fd);       ///< Stop watching a pending client
+    void watchChannels();             ///< Watch the worker channels (re)connected
+    void readChannel(size_t worker);  ///< Handle a packet sent by a worker
+    void startMigration();            ///< Start the next migration requested, if idle
+    void expireMigration();           ///< Give up on a migration taking too long
+
+    /**
+     * @brief End the current migration and hand the held clients to the room's owner.
+     * @param moved True if the target took the room over
+     * @param outcome Printed summary
+     */
+    void finishMigration(bool moved, const std::string& outcome);
+
+    /**
+     * @brief Worker owning a room: where it was moved to, else its place on the ring.
+     */
+    size_t ownerOf(const std::string& room) const;
+
+    /**
+     * @brief Hand a client over to the worker of its room and close the router's copy.
+     * @param client_fd Client socket, no longer watched
+     * @param room Room name (empty for the default room)
+     * @param pending Bytes read from the client and not consumed by the router
+     */
+    void route(int client_fd, const std::string& room, std::string_view pending);
+
+    /**
+     * @brief Send an error to a client and close it.
+     * @param client_fd Client socket, no longer watched
+     * @param error Error message
+     * @param retry True if the client may retry later
+     */
+    void reject(int client_fd, const std::string& error, bool retry);
+
+    RouterSettings settings_;
+    WorkerPool& pool_;
+    HashRing ring_;
+
+    int listen_fd_ = -1;  ///< Listening TCP socket
+    int epoll_fd_ = -1;   ///< Listening socket and pending clients
+
+    std::map<int, PendingClient> pending_;  ///< Clients waiting for their room (router thread)
+    std::map<int, size_t> channels_;        ///< Watched worker channels and their worker
+    std::map<std::string, size_t> owners_;  ///< Rooms moved off their ring worker
+    std::optional<Migration> migration_;    ///< Migration in progress (router thread)
+
+    /// Migrations requested and not started yet: room and target worker.
+    std::deque<std::pair<std::string, std::optional<size_t>>> requests_;
+    std::mutex requests_mutex_;  ///< Mutex for requests_
+
+    std::jthread thread_;  ///< Router loop thread
+};
@@ -0,0 +1,251 @@
+#include "WorkerPool.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "Handoff.hpp"
+
+extern char** environ;
+
+WorkerPool::WorkerPool(WorkerSettings settings) : settings_(std::move(settings)) {
+    workers_.resize(std::max<size_t>(settings_.count, 1));
+
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        std::string name = "chess_worker_" + std::to_string(getpid()) + "_" + std::to_string(i);
+        workers_[i].socket_path = settings_.socket_dir + "/" + name + ".sock";
+        workers_[i].log_file = "worker_" + std::to_string(i) + ".log";
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    stop();
+}
+
+void WorkerPool::start(std::chrono::milliseconds timeout) {
+    for (auto& worker : workers_) {
+        spawn(worker);
+    }
+
+    // Workers warm up before listening: wait for all of them at once
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        while (!connect(workers_[i])) {
+            int status;
+            if (waitpid(workers_[i].pid, &status, WNOHANG) == workers_[i].pid) {
+                workers_[i].pid = -1;
+                throw std::runtime_error("Worker " + std::to_string(i) + " exited during startup");
+            }
+            if (std::chrono::steady_clock::now() > deadline) {
+                throw std::runtime_error("Worker " + std::to_string(i) + " not ready after " +
+                                         std::to_string(timeout.count()) + " ms");
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+}
+
+void WorkerPool::stop() {
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        if (workers_[i].pid >= 0) {
+            std::cout << "Worker " << i << ": " << workers_[i].handoffs << " clients, "
+                      << workers_[i].restarts << " restarts" << std::endl;
+        }
+        terminate(workers_[i]);
+    }
+}
+
+bool WorkerPool::handOff(size_t index, int client_fd, std::string_view room,
+                         std::string_view pending) {
+    if (!send(index, HandoffKind::CLIENT, room, pending, {client_fd})) {
+        return false;
+    }
+
+    workers_[index].handoffs++;
+    return true;
+}
+
+bool WorkerPool::send(size_t index, HandoffKind kind, std::string_view room,
+                      std::string_view payload, const std::vector<int>& fds,
+                      std::chrono::milliseconds wait) {
+    Worker& worker = workers_[index];
+    auto deadline = std::chrono::steady_clock::now() + wait;
+
+    while (worker.channel_fd >= 0) {
+        if (HandoffChannel::send(worker.channel_fd, kind, room, payload, fds)) {
+            return true;
+        }
+
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            // Worker busy: not a failure of the channel
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now());
+            pollfd writable{worker.channel_fd, POLLOUT, 0};
+            if (left.count() <= 0 || poll(&writable, 1, static_cast<int>(left.count())) <= 0) {
+                return false;
+            }
+            continue;
+        }
+
+        // Dead worker: supervise() restarts it
+        std::cerr << "Handoff to worker " << index << " failed: " << strerror(errno) << std::endl;
+        close(worker.channel_fd);
+        worker.channel_fd = -1;
+    }
+
+    return false;
+}
+
+std::optional<Handoff> WorkerPool::receive(size_t index) {
+    Worker& worker = workers_[index];
+    if (worker.channel_fd < 0) {
+        return std::nullopt;
+    }
+
+    try {
+        if (auto packet = HandoffChannel::receive(worker.channel_fd)) {
+            return packet;
+        }
+        std::cerr << "Worker " << index << " closed its channel" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Worker " << index << ": " << e.what() << std::endl;
+    }
+
+    close(worker.channel_fd);
+    worker.channel_fd = -1;
+    return std::nullopt;
+}
+
+void WorkerPool::supervise() {
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        Worker& worker = workers_[i];
+
+        int status;
+        if (worker.pid >= 0 && waitpid(worker.pid, &status, WNOHANG) == worker.pid) {
+            std::cerr << "Worker " << i << " exited (status " << status << "), restarting"
+                      << std::endl;
+            worker.pid = -1;
+            terminate(worker);
+
+            worker.restarts++;
+            spawn(worker);
+        }
+
+        // Connected once it is warm: meanwhile its rooms are refused
+        if (worker.pid >= 0 && worker.channel_fd < 0 && connect(worker)) {
+            std::cerr << "Worker " << i << " ready" << std::endl;
+        }
+    }
+}
+
+void WorkerPool::spawn(Worker& worker) {
+    int stdin_pipe[2];
+    if (pipe2(stdin_pipe, O_CLOEXEC) < 0) {
+        throw std::runtime_error("Cannot create pipe: " + std::string(strerror(errno)));
+    }
+
+    // Built before fork(): the child must not allocate
+    std::vector<std::string> args = {settings_.server_path, "--worker", worker.socket_path};
+    args.insert(args.end(), settings_.server_args.begin(), settings_.server_args.end());
+
+    std::vector<char*> argv;
+    for (auto& arg : args) {
+        argv.push_back(arg.data());
+    }
+    argv.push_back(nullptr);
+
+    std::string log_variable = "CHESS_LOG_FILE=" + worker.log_file;
+    std::vector<char*> envp = {log_variable.data()};
+    for (char** variable = environ; *variable; ++variable) {
+        if (std::strncmp(*variable, "CHESS_LOG_FILE=", 15) != 0) {
+            envp.push_back(*variable);
+        }
+    }
+    envp.push_back(nullptr);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(stdin_pipe[0]);
+        close(stdin_pipe[1]);
+        throw std::runtime_error("Cannot fork: " + std::string(strerror(errno)));
+    }
+
+    if (pid == 0) {
+        // Child: stdin from the pipe, console output discarded (workers log to their file)
+        dup2(stdin_pipe[0], STDIN_FILENO);
+
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (null_fd >= 0) {
+            dup2(null_fd, STDOUT_FILENO);
+            dup2(null_fd, STDERR_FILENO);
+        }
+
+        execve(argv[0], argv.data(), envp.data());
+        _exit(127);
+    }
+
+    close(stdin_pipe[0]);
+    worker.pid = pid;
+    worker.stdin_fd = stdin_pipe[1];
+}
+
+bool WorkerPool::connect(Worker& worker) {
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, worker.socket_path.c_str(), sizeof(addr.sun_path) - 1);
+
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return false;
+    }
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    worker.channel_fd = fd;
+    return true;
+}
+
+void WorkerPool::terminate(Worker& worker) {
+    if (worker.channel_fd >= 0) {
+        close(worker.channel_fd);
+        worker.channel_fd = -1;
+    }
+
+    // EOF on stdin stops the server like pressing Enter
+    if (worker.stdin_fd >= 0) {
+        close(worker.stdin_fd);
+        worker.stdin_fd = -1;
+    }
+
+    if (worker.pid >= 0) {
+        int status;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (waitpid(worker.pid, &status, WNOHANG) == 0) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                kill(worker.pid, SIGKILL);
+                waitpid(worker.pid, &status, 0);
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        worker.pid = -1;
+    }
+
+    unlink(worker.socket_path.c_str());
+}
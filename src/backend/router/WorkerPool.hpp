@@ -0,0 +1,138 @@
+/**
+ * @file WorkerPool.hpp
+ * @brief chess_server worker processes started and supervised by the router.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Handoff.hpp"
+
+/**
+ * @struct WorkerSettings
+ * @brief How to start the worker processes.
+ */
+struct WorkerSettings {
+    std::string server_path;               ///< chess_server executable
+    std::string socket_dir = "/tmp";       ///< Directory of the handoff sockets
+    std::vector<std::string> server_args;  ///< Extra arguments of every worker
+    size_t count = 1;                      ///< Number of workers
+};
+
+/**
+ * @class WorkerPool
+ * @brief Runs N chess_server processes in worker mode and hands clients over to them.
+ *
+ * Each worker listens on its own Unix seqpacket socket, which the pool connects
+ * to once the worker is up; the channel is non-blocking, so a busy worker
+ * can't stall the router. A worker that exits is restarted without blocking
+ * the router: its rooms are unavailable (and their games lost) until it is
+ * back, while the other workers carry on. Workers stop when their stdin is
+ * closed, which also happens if the router dies.
+ */
+class WorkerPool {
+   public:
+    /**
+     * @brief Create the pool (no process is started yet).
+     * @param settings Worker settings
+     */
+    explicit WorkerPool(WorkerSettings settings);
+
+    /**
+     * @brief Destructor stops the workers.
+     */
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * @brief Start every worker and wait until they all accept handoffs.
+     * @param timeout Maximum waiting time
+     * @throws std::runtime_error if a worker can't be started in time
+     */
+    void start(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Stop every worker.
+     */
+    void stop();
+
+    /**
+     * @brief Number of workers.
+     */
+    size_t size() const { return workers_.size(); }
+
+    /**
+     * @brief Pass a client socket to a worker.
+     * @param worker Worker index
+     * @param client_fd Client socket (still to be closed by the caller)
+     * @param room Room name
+     * @param pending Bytes already read from the client
+     * @return False if the worker is down or restarting
+     */
+    bool handOff(size_t worker, int client_fd, std::string_view room, std::string_view pending);
+
+    /**
+     * @brief Send a packet to a worker, waiting for room in its channel if needed.
+     * @param worker Worker index
+     * @param kind Purpose of the packet
+     * @param room Room name
+     * @param payload Payload
+     * @param fds Sockets (still to be closed by the caller)
+     * @param wait Longest wait for a full channel
+     * @return False if the worker is down, restarting or not reading in time
+     */
+    bool send(size_t worker, HandoffKind kind, std::string_view room, std::string_view payload,
+              const std::vector<int>& fds = {},
+              std::chrono::milliseconds wait = std::chrono::milliseconds(0));
+
+    /**
+     * @brief Read the next packet sent by a worker, once its channel is readable.
+     * @param worker Worker index
+     * @return Packet, or nullopt if the channel failed (it is closed, to be reconnected)
+     */
+    std::optional<Handoff> receive(size_t worker);
+
+    /**
+     * @brief Channel socket of a worker, to watch for its packets.
+     * @return Socket, or -1 while the worker is down or restarting
+     */
+    int channelFd(size_t worker) const { return workers_[worker].channel_fd; }
+
+    /**
+     * @brief Restart the workers that exited and connect to the restarted ones (router thread).
+     */
+    void supervise();
+
+   private:
+    /**
+     * @struct Worker
+     * @brief One worker process and its handoff channel.
+     */
+    struct Worker {
+        pid_t pid = -1;           ///< Process ID (-1 when not running)
+        int stdin_fd = -1;        ///< Write end of its stdin: closing it stops the worker
+        int channel_fd = -1;      ///< Connected handoff socket (-1 until connected)
+        std::string socket_path;  ///< Handoff socket path
+        std::string log_file;     ///< Log file name, in the server log directory
+        int restarts = 0;         ///< Times the worker was restarted
+        uint64_t handoffs = 0;    ///< Clients handed over
+    };
+
+    void spawn(Worker& worker);      ///< Start the process
+    bool connect(Worker& worker);    ///< Try to connect to its socket once
+    void terminate(Worker& worker);  ///< Stop the process and close its sockets
+
+    WorkerSettings settings_;
+    std::vector<Worker> workers_;
+};
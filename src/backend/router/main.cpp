@@ -0,0 +1,112 @@
+#include <signal.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "Router.hpp"
+#include "WorkerPool.hpp"
+
+using namespace std;
+
+void printUsage(const string& program_name) {
+    cout << "Usage: " << program_name << " [OPTIONS] [-- <chess_server options>]\n"
+         << "Options:\n"
+         << "  -h                  Show this help message\n"
+         << "  -i <ip address>     Router ip address (default: 127.0.0.1)\n"
+         << "  -p <port>           Router port (default: 2000)\n"
+         << "  --workers <N>       Worker processes (default: number of cores)\n"
+         << "  --server <path>     chess_server executable (default: next to the router)\n"
+         << "  --socket-dir <dir>  Directory of the worker sockets (default: /tmp)\n"
+         << "  --room-wait-ms <ms> Wait for a join_room line before using the default room\n"
+         << "                      (default: 200)\n"
+         << "Options after `--` are passed to every worker (e.g. `-- --parser pgn`).\n";
+}
+
+/**
+ * @brief Path of the chess_server executable installed next to this one.
+ */
+string defaultServerPath() {
+    error_code ec;
+    auto self = filesystem::read_symlink("/proc/self/exe", ec);
+    return ec ? string("./chess_server") : (self.parent_path() / "chess_server").string();
+}
+
+int main(int argc, char* argv[]) {
+    RouterSettings router_settings;
+    WorkerSettings worker_settings;
+    worker_settings.server_path = defaultServerPath();
+    worker_settings.count = max(1u, thread::hardware_concurrency());
+
+    const string program_name = argv[0];
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+
+        if (arg == "--help" || arg == "-h") {
+            printUsage(program_name);
+            return 0;
+        } else if ((arg == "--ip" || arg == "-i") && i + 1 < argc) {
+            router_settings.ip = argv[++i];
+        } else if ((arg == "--port" || arg == "-p") && i + 1 < argc) {
+            router_settings.port = stoi(argv[++i]);
+        } else if (arg == "--workers" && i + 1 < argc) {
+            worker_settings.count = max(1, stoi(argv[++i]));
+        } else if (arg == "--server" && i + 1 < argc) {
+            worker_settings.server_path = argv[++i];
+        } else if (arg == "--socket-dir" && i + 1 < argc) {
+            worker_settings.socket_dir = argv[++i];
+        } else if (arg == "--room-wait-ms" && i + 1 < argc) {
+            router_settings.room_wait = chrono::milliseconds(stoi(argv[++i]));
+        } else if (arg == "--") {
+            worker_settings.server_args.assign(argv + i + 1, argv + argc);
+            break;
+        }
+    }
+
+    // A client closing before its handoff must not kill the router
+    signal(SIGPIPE, SIG_IGN);
+
+    try {
+        cout << "Starting " << worker_settings.count << " workers ("
+             << worker_settings.server_path << ")..." << endl;
+
+        WorkerPool pool(worker_settings);
+        pool.start(chrono::seconds(30));
+
+        Router router(router_settings, pool);
+        router.start();
+
+        cout << "Router running on " << router_settings.ip << ":" << router_settings.port << endl;
+        cout << "Type `migrate <room> [worker]` to move a room, or press Enter to stop the "
+                "router..."
+             << endl;
+
+        string line;
+        while (getline(cin, line) && !line.empty()) {
+            istringstream command(line);
+            string verb, room;
+            command >> verb >> room;
+
+            size_t worker;
+            if (verb == "migrate" && !room.empty()) {
+                router.migrate(room, command >> worker ? optional<size_t>(worker) : nullopt);
+            } else {
+                cout << "Unknown command: " << line << endl;
+            }
+        }
+
+        cout << "Shutting down router..." << endl;
+        router.stop();
+        pool.stop();
+    } catch (const exception& e) {
+        cerr << "Router error: " << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
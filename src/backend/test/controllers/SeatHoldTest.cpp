@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GameController.hpp"
+
+namespace {
+
+/// Room with a white and a black player, each holding a resume token.
+class SeatHoldTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        controller_.setSendCallbacks(
+            [](const std::string&, const std::string&) {},
+            [this](const std::string&, const std::string& message, bool, const std::string&) {
+                broadcasts_.push_back(json::parse(message));
+            });
+
+        white_token_ = controller_.issueResumeToken("white");
+        controller_.issueResumeToken("black");
+        join("white", "white");
+        join("black", "black");
+        ASSERT_TRUE(controller_.isPlayer("white"));
+        ASSERT_TRUE(controller_.isPlayer("black"));
+    }
+
+    void join(const std::string& session_id, const std::string& color) {
+        json request = {{"command", "join_game"}, {"single_player", false}, {"color", color}};
+        controller_.routeMessage(request.dump(), session_id);
+    }
+
+    json resume(const std::string& session_id, const std::string& token) {
+        json request = {{"command", "resume"}, {"token", token}};
+        return json::parse(controller_.routeMessage(request.dump(), session_id).value());
+    }
+
+    std::string lastBroadcastType() const {
+        return broadcasts_.empty() ? std::string() : broadcasts_.back().value("type", "");
+    }
+
+    UploadWorker uploads_;  ///< Outlives the controller
+    GameController controller_{ParserType::SIMPLE_NOTATION, uploads_};
+    std::vector<json> broadcasts_;
+    std::string white_token_;
+};
+
+}  // namespace
+
+TEST_F(SeatHoldTest, ResumesHeldSeatWithinGracePeriod) {
+    controller_.setResumeGrace(std::chrono::seconds(30));
+
+    controller_.routeDisconnect("white");
+    EXPECT_TRUE(controller_.hasSeatHolds());
+    EXPECT_TRUE(controller_.isPlayer("white"));  // Still seated, the game goes on
+    EXPECT_EQ(lastBroadcastType(), "player_disconnected");
+
+    controller_.issueResumeToken("white-2");
+    json response = resume("white-2", white_token_);
+    EXPECT_EQ(response["type"], "resumed");
+    EXPECT_EQ(response["color"], "white");
+    EXPECT_EQ(lastBroadcastType(), "player_reconnected");
+
+    EXPECT_TRUE(controller_.isPlayer("white-2"));
+    EXPECT_FALSE(controller_.isPlayer("white"));
+    EXPECT_FALSE(controller_.hasSeatHolds());
+
+    // Nothing left to expire, and the new session can drop and resume again with the token
+    controller_.expireSeatHolds();
+    EXPECT_TRUE(controller_.isPlayer("white-2"));
+    controller_.routeDisconnect("white-2");
+    EXPECT_TRUE(controller_.hasSeatHolds());
+    EXPECT_EQ(resume("white-3", white_token_)["type"], "resumed");
+}
+
+TEST_F(SeatHoldTest, ReleasesSeatAfterGracePeriod) {
+    controller_.setResumeGrace(std::chrono::seconds(1));
+
+    controller_.routeDisconnect("white");
+    controller_.expireSeatHolds();
+    EXPECT_TRUE(controller_.isPlayer("white"));  // Too early
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    controller_.expireSeatHolds();
+    EXPECT_FALSE(controller_.hasSeatHolds());
+    EXPECT_FALSE(controller_.isPlayer("white"));
+    EXPECT_EQ(lastBroadcastType(), "game_reset");
+
+    json response = resume("white-2", white_token_);
+    EXPECT_EQ(response["type"], "error");
+    EXPECT_EQ(response["error"], "Unknown or expired resume token");
+    EXPECT_FALSE(controller_.isPlayer("white-2"));
+}
+
+TEST_F(SeatHoldTest, ReleasesSeatAtOnceWithoutGracePeriod) {
+    controller_.setResumeGrace(std::chrono::seconds(0));
+
+    controller_.routeDisconnect("white");
+    EXPECT_FALSE(controller_.hasSeatHolds());
+    EXPECT_FALSE(controller_.isPlayer("white"));
+    EXPECT_EQ(lastBroadcastType(), "game_reset");
+
+    EXPECT_EQ(resume("white-2", white_token_)["type"], "error");
+}
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include "EventLog.hpp"
+
+TEST(EventLogTest, StampsSequenceAsFirstMember) {
+    EXPECT_EQ(EventLog::stamp(R"({"type":"game_started"})", 7),
+              R"({"seq":7,"type":"game_started"})");
+    EXPECT_EQ(EventLog::stamp("{}", 1), R"({"seq":1})");
+}
+
+TEST(EventLogTest, ReplaysMissedEventsInOrder) {
+    EventLog log(4);
+    EXPECT_EQ(log.replaySince(0), "[]");
+
+    log.append(R"({"n":1})");
+    log.append(R"({"n":2})");
+    log.append(R"({"n":3})");
+
+    EXPECT_EQ(log.lastSequence(), 3u);
+    EXPECT_EQ(log.replaySince(1), R"([{"seq":2,"n":2},{"seq":3,"n":3}])");
+    EXPECT_EQ(log.replaySince(3), "[]");
+    EXPECT_EQ(log.missedSince(1), 2u);
+}
+
+TEST(EventLogTest, NeedsSnapshotOnceEventsAreDropped) {
+    EventLog log(2);
+    for (int i = 1; i <= 5; ++i) {
+        log.append("{\"n\":" + std::to_string(i) + "}");
+    }
+
+    EXPECT_EQ(log.firstSequence(), 4u);
+    EXPECT_EQ(log.replaySince(3), R"([{"seq":4,"n":4},{"seq":5,"n":5}])");
+    EXPECT_FALSE(log.replaySince(2).has_value());
+    EXPECT_FALSE(log.replaySince(0).has_value());
+
+    // A number from the future (e.g. before a server restart) can't be trusted either
+    EXPECT_FALSE(log.replaySince(6).has_value());
+}
+
+TEST(EventLogTest, RestoredLogCarriesOnNumbering) {
+    EventLog log(3);
+    for (int i = 1; i <= 4; ++i) {
+        log.append("{\"n\":" + std::to_string(i) + "}");
+    }
+
+    EventLog copy(3);
+    copy.restore(log.lastSequence(), log.entries());
+
+    EXPECT_EQ(copy.firstSequence(), 2u);
+    EXPECT_EQ(copy.replaySince(1), log.replaySince(1));
+    EXPECT_EQ(copy.append(R"({"n":5})"), R"({"seq":5,"n":5})");
+}
+
+TEST(EventLogTest, EmptyLogReplaysNothing) {
+    EventLog log;
+    EXPECT_EQ(log.firstSequence(), 0u);
+    EXPECT_EQ(log.replaySince(0), "[]");
+    EXPECT_TRUE(log.entries().empty());
+
+    log.restore(0, {});
+    EXPECT_EQ(log.append("{}"), R"({"seq":1})");
+    EXPECT_EQ(log.replaySince(0), R"([{"seq":1}])");
+}
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include "FenValidator.hpp"
+
+namespace {
+
+constexpr std::string_view kStart = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+}  // namespace
+
+TEST(FenValidatorTest, AcceptsLegalPositions) {
+    EXPECT_EQ(fen::validate(kStart), "");
+    EXPECT_EQ(fen::validate("rnbqkbnr/pppp1ppp/8/4p3/4P3/8/PPPP1PPP/RNBQKBNR w KQkq e6 0 2"), "");
+    EXPECT_EQ(fen::validate("8/8/8/8/8/8/8/K6k b - - 12 40"), "");
+
+    // EPD: no move counters
+    EXPECT_EQ(fen::validate("4k3/8/8/8/8/8/8/4K2R w K -"), "");
+}
+
+TEST(FenValidatorTest, RejectsMalformedFields) {
+    EXPECT_EQ(fen::validate(""), "Missing FEN fields");
+    EXPECT_EQ(fen::validate("8/8/8/8/8/8/8/K6k w -"), "Missing FEN fields");
+    EXPECT_EQ(fen::validate("8/8/8/8/8/8/8/K6k w - - 0 1 extra"), "Too many FEN fields");
+    EXPECT_EQ(fen::validate("8/8/8/8/8/8/8/K5k w - - 0 1"), "Invalid piece placement in FEN");
+    EXPECT_EQ(fen::validate("8/8/8/8/8/8/54/K6k w - - 0 1"), "Invalid rank in FEN");
+    EXPECT_EQ(fen::validate("8/8/8/8/8/8/8/K6x w - - 0 1"), "Invalid piece placement in FEN");
+    EXPECT_EQ(fen::validate("8/8/8/8/8/8/8/K6k x - - 0 1"), "Invalid side to move");
+    EXPECT_EQ(fen::validate("8/8/8/8/8/8/8/K6k w - - a 1"), "Invalid move counters");
+    EXPECT_EQ(fen::validate("8/8/8/8/8/8/8/K6k w - - 0 0"), "Invalid move counters");
+}
+
+TEST(FenValidatorTest, RejectsIllegalPositions) {
+    EXPECT_EQ(fen::validate("8/8/8/8/8/8/8/K7 w - - 0 1"), "Each side needs exactly one king");
+    EXPECT_EQ(fen::validate("k7/8/8/8/8/8/8/KK6 w - - 0 1"), "Each side needs exactly one king");
+    EXPECT_EQ(fen::validate("k6P/8/8/8/8/8/8/K7 w - - 0 1"), "Pawn on the first or last rank");
+    EXPECT_EQ(fen::validate("k7/8/8/8/8/8/8/K6p b - - 0 1"), "Pawn on the first or last rank");
+
+    // Black to move... but it's white that is in check, by the rook or by the knight
+    EXPECT_EQ(fen::validate("k7/8/8/8/8/8/8/K6r b - - 0 1"), "Side not to move is in check");
+    EXPECT_EQ(fen::validate("k7/8/8/8/8/8/2n5/K7 b - - 0 1"), "Side not to move is in check");
+    EXPECT_EQ(fen::validate("8/8/8/8/8/8/8/Kk6 w - - 0 1"), "Side not to move is in check");
+    EXPECT_EQ(fen::validate("k7/8/8/8/8/8/8/K6r w - - 0 1"), "");
+}
+
+TEST(FenValidatorTest, ChecksCastlingAndEnPassant) {
+    EXPECT_EQ(fen::validate("4k3/8/8/8/8/8/8/4K3 w K - 0 1"),
+              "Castling rights without king and rook");
+    EXPECT_EQ(fen::validate("r3k3/8/8/8/8/8/8/4K2R w Kq - 0 1"), "");
+    EXPECT_EQ(fen::validate("r3k3/8/8/8/8/8/8/4K2R w qK - 0 1"), "Invalid castling rights");
+    EXPECT_EQ(fen::validate("r3k3/8/8/8/8/8/8/4K2R w KK - 0 1"), "Invalid castling rights");
+
+    EXPECT_EQ(fen::validate("4k3/8/8/8/4P3/8/8/4K3 b - e3 0 1"), "");
+    EXPECT_EQ(fen::validate("4k3/8/8/8/4P3/8/8/4K3 w - e3 0 1"), "Invalid en passant square");
+    EXPECT_EQ(fen::validate("4k3/8/8/8/8/8/8/4K3 b - e3 0 1"), "Invalid en passant square");
+}
+
+TEST(FenValidatorTest, ReadsEpdRecords) {
+    EXPECT_EQ(fen::fromEpd("4k3/8/8/8/8/8/8/4K2R w K - bm Rh8+; id \"test 1\";"),
+              "4k3/8/8/8/8/8/8/4K2R w K - 0 1");
+    EXPECT_EQ(fen::fromEpd(""), std::nullopt);
+    EXPECT_EQ(fen::fromEpd("# comment"), std::nullopt);
+    EXPECT_EQ(fen::validate(*fen::fromEpd("4k3/8/8/8/8/8/8/4K2R w")), "Missing FEN fields");
+}
+
+// No exceptions nor allocations: usable at compile time
+static_assert(fen::validate(kStart).empty());
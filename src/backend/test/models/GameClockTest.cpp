@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include "GameClock.hpp"
+
+namespace {
+
+constexpr int64_t kMs = 1'000'000;
+
+}  // namespace
+
+TEST(GameClockTest, ChargesTheSideToMoveOnly) {
+    GameClock clock;
+    clock.start({60'000, 0}, true, 0);
+
+    MoveTiming timing{5'000 * kMs, 0};
+    EXPECT_EQ(clock.remaining(true, timing), 55'000 * kMs);
+    EXPECT_EQ(clock.remaining(false, timing), 60'000 * kMs);
+
+    clock.punch(timing);
+    EXPECT_FALSE(clock.whiteToMove());
+    EXPECT_EQ(clock.banked(true), 55'000 * kMs);
+    EXPECT_EQ(clock.turnStart(), 5'000 * kMs);
+}
+
+TEST(GameClockTest, CompensatesLagAndAddsIncrement) {
+    GameClock clock;
+    clock.start({60'000, 2'000}, true, 0);
+
+    // 3 s to the server, of which 200 ms were the round trip
+    clock.punch({3'000 * kMs, 200 * kMs});
+    EXPECT_EQ(clock.banked(true), (60'000 - 2'800 + 2'000) * kMs);
+
+    // Lag over the think time is never a bonus
+    clock.punch({3'100 * kMs, 500 * kMs});
+    EXPECT_EQ(clock.banked(false), 62'000 * kMs);
+}
+
+TEST(GameClockTest, BoundsClientTimeControls) {
+    auto blitz = TimeControl::fromClient(180'000, 2'000);
+    ASSERT_TRUE(blitz.has_value());
+    EXPECT_EQ(blitz->base_ms, 180'000);
+    EXPECT_EQ(blitz->increment_ms, 2'000);
+
+    EXPECT_TRUE(TimeControl::fromClient(TimeControl::kMaxMs, TimeControl::kMaxMs).has_value());
+    EXPECT_FALSE(TimeControl::fromClient(TimeControl::kMaxMs + 1, 0).has_value());
+    EXPECT_FALSE(TimeControl::fromClient(0, TimeControl::kMaxMs + 1).has_value());
+
+    // Would turn negative as int64_t, or overflow once in nanoseconds
+    EXPECT_FALSE(TimeControl::fromClient(uint64_t{1} << 63, 0).has_value());
+    EXPECT_FALSE(TimeControl::fromClient(UINT64_MAX, UINT64_MAX).has_value());
+
+    // The longest clock still counts down in nanoseconds
+    GameClock clock;
+    clock.start(*TimeControl::fromClient(TimeControl::kMaxMs, TimeControl::kMaxMs), true, 0);
+    clock.punch({1'000 * kMs, 0});
+    EXPECT_EQ(clock.banked(true), (2 * TimeControl::kMaxMs - 1'000) * kMs);
+}
+
+TEST(GameClockTest, FlagFallsOnlyWhenTimed) {
+    GameClock clock;
+    clock.start({1'000, 0}, true, 0);
+    EXPECT_FALSE(clock.flagged({1'000 * kMs, 0}));
+    EXPECT_TRUE(clock.flagged({1'001 * kMs, 0}));
+    EXPECT_FALSE(clock.flagged({1'001 * kMs, 100 * kMs}));
+
+    clock.stop();
+    EXPECT_FALSE(clock.enabled());
+    EXPECT_FALSE(clock.flagged({10'000 * kMs, 0}));
+
+    GameClock untimed;
+    untimed.start({}, true, 0);
+    EXPECT_FALSE(untimed.enabled());
+}
+
+TEST(GameClockTest, RestoresSavedState) {
+    GameClock clock;
+    clock.restore(10 * kMs, 20 * kMs, kMs, 100 * kMs, false);
+    EXPECT_TRUE(clock.enabled());
+    EXPECT_EQ(clock.remaining(false, {105 * kMs, 0}), 15 * kMs);
+    EXPECT_EQ(clock.remaining(true, {105 * kMs, 0}), 10 * kMs);
+    EXPECT_EQ(clock.increment(), kMs);
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "GameContext.hpp"
+
+namespace {
+
+ParsedMove simple(const std::string& from, const std::string& to) {
+    return {from + "-" + to, from, to, false};
+}
+
+/// Game in progress between two sessions, loads done as the controller does them.
+class GameLoadTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        context_.setSendCallbacks(
+            [](const std::string&, const std::string&) {},
+            [this](const std::string&, const std::string& message, bool, const std::string&) {
+                broadcasts_.push_back(message);
+            });
+
+        context_.handleJoinRequest("white", "white");
+        context_.handleJoinRequest("black", "black");
+        context_.handleStartRequest("white");
+        ASSERT_EQ(context_.getState(), GameState::InProgress);
+        broadcasts_.clear();
+    }
+
+    /// Play the moves on a copy of the game: the number played, all of them or the load fails.
+    size_t playOnCopy(const std::vector<ParsedMove>& moves) {
+        loaded_ = *context_.getChessGame();
+        base_ply_ = loaded_.getPly();
+        base_hash_ = loaded_.getPositionHash();
+        return loaded_.playMoves(moves);
+    }
+
+    json commit() {
+        return context_.handleLoadRequest("white", base_ply_, base_hash_, std::move(loaded_));
+    }
+
+    GameContext context_;
+    std::vector<std::string> broadcasts_;
+    ChessGame loaded_;
+    int base_ply_ = 0;
+    std::string base_hash_;
+};
+
+}  // namespace
+
+TEST_F(GameLoadTest, CommitsWholeGameInOneEvent) {
+    std::vector<ParsedMove> moves = {simple("e2", "e4"), simple("e7", "e5"), simple("g1", "f3")};
+    ASSERT_EQ(playOnCopy(moves), moves.size());
+
+    // Nothing reaches the room before the commit
+    EXPECT_EQ(context_.getChessGame()->getPly(), base_ply_);
+    EXPECT_TRUE(broadcasts_.empty());
+
+    json response = commit();
+    EXPECT_EQ(response["type"], "game_loaded");
+    EXPECT_EQ(response["moves"], 3);
+    EXPECT_EQ(context_.getChessGame()->getPly(), base_ply_ + 3);
+    EXPECT_EQ(context_.getState(), GameState::InProgress);
+    EXPECT_EQ(broadcasts_.size(), 1u);
+}
+
+TEST_F(GameLoadTest, IllegalMoveLeavesGameUntouched) {
+    std::vector<ParsedMove> moves = {simple("e2", "e4"), simple("e7", "e5"), simple("e2", "e4")};
+    EXPECT_EQ(playOnCopy(moves), 2u);
+
+    // The load is refused: the room's game never saw the first two moves
+    EXPECT_EQ(context_.getChessGame()->getPly(), base_ply_);
+    EXPECT_EQ(context_.getChessGame()->getPositionHash(), base_hash_);
+    EXPECT_TRUE(broadcasts_.empty());
+}
+
+TEST_F(GameLoadTest, MoveAfterMateIsRefused) {
+    // Fool's mate, then a move the game can no longer take
+    std::vector<ParsedMove> moves = {simple("f2", "f3"), simple("e7", "e5"), simple("g2", "g4"),
+                                     simple("d8", "h4"), simple("a2", "a3")};
+    EXPECT_EQ(playOnCopy(moves), 4u);
+    EXPECT_TRUE(loaded_.isCheckmate());
+
+    EXPECT_EQ(context_.getChessGame()->getPly(), base_ply_);
+    EXPECT_EQ(context_.getState(), GameState::InProgress);
+    EXPECT_TRUE(broadcasts_.empty());
+}
+
+TEST_F(GameLoadTest, GameEndingWithFileEndsTheGame) {
+    std::vector<ParsedMove> moves = {simple("f2", "f3"), simple("e7", "e5"), simple("g2", "g4"),
+                                     simple("d8", "h4")};
+    ASSERT_EQ(playOnCopy(moves), moves.size());
+
+    json response = commit();
+    EXPECT_EQ(response["type"], "game_loaded");
+    EXPECT_EQ(response["end"], "checkmate");
+    EXPECT_EQ(context_.getState(), GameState::GameOver);
+}
+
+TEST_F(GameLoadTest, RefusesCopyOfMovedGame) {
+    std::vector<ParsedMove> moves = {simple("d2", "d4"), simple("d7", "d5")};
+    ASSERT_EQ(playOnCopy(moves), moves.size());
+
+    // A player moved while the upload was checked
+    json move = context_.handleMoveRequest("white", simple("e2", "e4"));
+    ASSERT_EQ(move["type"], "move_result");
+    broadcasts_.clear();
+
+    json response = commit();
+    EXPECT_EQ(response["type"], "error");
+    EXPECT_EQ(response["error"], "Game changed while loading");
+    EXPECT_EQ(context_.getChessGame()->getPly(), base_ply_ + 1);
+    EXPECT_TRUE(broadcasts_.empty());
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include <type_traits>
+
+#include "GameState.hpp"
+
+TEST(GameStateTest, StateIsOneTriviallyCopyableByte) {
+    EXPECT_EQ(sizeof(GameState), 1u);
+    EXPECT_TRUE(std::is_trivially_copyable_v<GameState>);
+}
+
+TEST(GameStateTest, NamesRoundTrip) {
+    for (auto state : {GameState::WaitingForPlayers, GameState::ReadyToStart,
+                       GameState::InProgress, GameState::GameOver}) {
+        EXPECT_EQ(parseGameState(stateName(state)), state);
+    }
+    EXPECT_EQ(parseGameState("Paused"), std::nullopt);
+}
+
+TEST(GameStateTest, FollowsTheGameLifecycle) {
+    GameState state = GameState::WaitingForPlayers;
+    state = nextState(state, GameEvent::Started);
+    EXPECT_EQ(state, GameState::WaitingForPlayers);
+
+    state = nextState(state, GameEvent::PlayersJoined);
+    EXPECT_EQ(state, GameState::ReadyToStart);
+    state = nextState(state, GameEvent::Started);
+    EXPECT_EQ(state, GameState::InProgress);
+    state = nextState(state, GameEvent::Ended);
+    EXPECT_EQ(state, GameState::GameOver);
+    state = nextState(state, GameEvent::Reset);
+    EXPECT_EQ(state, GameState::WaitingForPlayers);
+}
+
+TEST(GameStateTest, RejectsCommandsOutOfState) {
+    EXPECT_TRUE(accepts(GameState::WaitingForPlayers, GameCommand::Join));
+    EXPECT_EQ(rejection(GameState::WaitingForPlayers, GameCommand::Move),
+              "Cannot move: game not started");
+    EXPECT_EQ(rejection(GameState::ReadyToStart, GameCommand::Join),
+              "Both players already joined");
+    EXPECT_TRUE(accepts(GameState::InProgress, GameCommand::DisplayBoard));
+    EXPECT_EQ(rejection(GameState::GameOver, GameCommand::Start), "Game is over. Reset first");
+
+    // A game can be reset in every state but the initial one
+    EXPECT_FALSE(accepts(GameState::WaitingForPlayers, GameCommand::End));
+    EXPECT_TRUE(accepts(GameState::ReadyToStart, GameCommand::End));
+    EXPECT_TRUE(accepts(GameState::InProgress, GameCommand::End));
+    EXPECT_TRUE(accepts(GameState::GameOver, GameCommand::End));
+
+    // The start position is set before the game starts
+    EXPECT_TRUE(accepts(GameState::WaitingForPlayers, GameCommand::SetPosition));
+    EXPECT_TRUE(accepts(GameState::ReadyToStart, GameCommand::SetPosition));
+    EXPECT_FALSE(accepts(GameState::InProgress, GameCommand::SetPosition));
+    EXPECT_FALSE(accepts(GameState::GameOver, GameCommand::SetPosition));
+
+    // Premoves are queued during the game only, like moves
+    EXPECT_TRUE(accepts(GameState::InProgress, GameCommand::Premove));
+    EXPECT_EQ(rejection(GameState::ReadyToStart, GameCommand::Premove), "Game not started yet");
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include "MoveCache.hpp"
+
+namespace {
+
+CachedMoves makeEntry(std::initializer_list<std::pair<uint16_t, std::string_view>> moves) {
+    CachedMoves entry;
+    for (const auto& [move, san] : moves) {
+        entry.moves[entry.count] = move;
+        std::copy(san.begin(), san.end(), entry.san[entry.count].begin());
+        entry.count++;
+    }
+    return entry;
+}
+
+}  // namespace
+
+TEST(MoveCacheTest, MissesUnknownPositions) {
+    MoveCache cache(16);
+    CachedMoves out;
+
+    // Includes key 0, which an empty slot must not match
+    EXPECT_FALSE(cache.lookup(0, out));
+    EXPECT_FALSE(cache.lookup(0x1234, out));
+}
+
+TEST(MoveCacheTest, ReturnsStoredMovesAndSan) {
+    MoveCache cache(16);
+    cache.store(0xabcd, makeEntry({{796, "e4"}, {1, "Nf3"}, {2, "exd8=Q+"}, {3, "Qh4xe1#"},
+                                   {4, "O-O-O"}}));
+
+    CachedMoves out;
+    ASSERT_TRUE(cache.lookup(0xabcd, out));
+    ASSERT_EQ(out.count, 5);
+    EXPECT_EQ(out.moves[0], 796);
+    EXPECT_EQ(out.moves[4], 4);
+    EXPECT_EQ(out.sanOf(0), "e4");
+    EXPECT_EQ(out.sanOf(2), "exd8=Q+");
+    EXPECT_EQ(out.sanOf(4), "O-O-O");
+}
+
+TEST(MoveCacheTest, KeepsTerminalPositions) {
+    MoveCache cache(16);
+    cache.store(42, CachedMoves{});
+
+    CachedMoves out = makeEntry({{1, "e4"}});
+    ASSERT_TRUE(cache.lookup(42, out));
+    EXPECT_EQ(out.count, 0);
+}
+
+TEST(MoveCacheTest, CollidingPositionReplacesTheSlot) {
+    MoveCache cache(16);
+    cache.store(1, makeEntry({{10, "d4"}}));
+    cache.store(1 + 16, makeEntry({{20, "c4"}}));
+
+    CachedMoves out;
+    EXPECT_FALSE(cache.lookup(1, out));
+    ASSERT_TRUE(cache.lookup(1 + 16, out));
+    EXPECT_EQ(out.sanOf(0), "c4");
+}
+
+TEST(MoveCacheTest, RoundsSlotsToPowerOfTwo) {
+    EXPECT_EQ(MoveCache(100).slots(), 64u);
+    EXPECT_EQ(MoveCache(0).slots(), 1u);
+}
+
+TEST(MoveCacheTest, KeepsMovesWithoutSan) {
+    MoveCache cache(16);
+    cache.store(7, makeEntry({{10, ""}, {11, ""}}));
+
+    CachedMoves out;
+    ASSERT_TRUE(cache.lookup(7, out));
+    EXPECT_EQ(out.count, 2);
+    EXPECT_FALSE(out.hasSan());
+
+    // A game that needed the SAN completes the entry
+    cache.store(7, makeEntry({{10, "e4"}, {11, "d4"}}));
+    ASSERT_TRUE(cache.lookup(7, out));
+    EXPECT_TRUE(out.hasSan());
+    EXPECT_EQ(out.sanOf(1), "d4");
+    EXPECT_TRUE(CachedMoves{}.hasSan());
+}
@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+
+#include "MoveMasks.hpp"
+
+namespace {
+
+constexpr int square(char file, char rank) {
+    return (rank - '1') * 8 + (file - 'a');
+}
+
+}  // namespace
+
+TEST(MoveMasksTest, GroupsDestinationsByOrigin) {
+    MoveMasks masks;
+    masks.add(square('e', '2'), square('e', '3'));
+    masks.add(square('e', '2'), square('e', '4'));
+    masks.add(square('g', '1'), square('f', '3'));
+
+    EXPECT_EQ(masks.count(), 3);
+    EXPECT_TRUE(masks.allows(square('e', '2'), square('e', '4')));
+    EXPECT_FALSE(masks.allows(square('e', '2'), square('e', '5')));
+    EXPECT_FALSE(masks.allows(square('d', '2'), square('d', '4')));
+
+    // Origins in square order: g1 (bit 6) before e2 (bit 12)
+    EXPECT_EQ(MoveMasks::toHex(masks.origins), "0000000000001040");
+    auto targets = masks.targetsHex();
+    ASSERT_EQ(targets.size(), 2u);
+    EXPECT_EQ(targets[0], "0000000000200000");  // g1: f3
+    EXPECT_EQ(targets[1], "0000000010100000");  // e2: e3, e4
+}
+
+TEST(MoveMasksTest, CountsPromotionsOnce) {
+    MoveMasks masks;
+    for (int i = 0; i < 4; ++i) {
+        masks.add(square('a', '7'), square('a', '8'));
+    }
+    EXPECT_EQ(masks.count(), 1);
+}
+
+TEST(MoveMasksTest, FormatsFullMasks) {
+    EXPECT_EQ(MoveMasks::toHex(0), "0000000000000000");
+    EXPECT_EQ(MoveMasks::toHex(~uint64_t{0}), "ffffffffffffffff");
+    EXPECT_TRUE(MoveMasks{}.targetsHex().empty());
+}
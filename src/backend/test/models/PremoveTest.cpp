@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "GameContext.hpp"
+
+namespace {
+
+ParsedMove simple(const std::string& from, const std::string& to) {
+    return {from + "-" + to, from, to, false};
+}
+
+/// Game in progress between two sessions, white to move.
+class PremoveTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        context_.setSendCallbacks(
+            [this](const std::string& session_id, const std::string& message) {
+                unicasts_.emplace_back(session_id, message);
+            },
+            [](const std::string&, const std::string&, bool, const std::string&) {});
+
+        context_.handleJoinRequest("white", "white");
+        context_.handleJoinRequest("black", "black");
+        context_.handleStartRequest("white");
+        ASSERT_EQ(context_.getState(), GameState::InProgress);
+    }
+
+    json premove(const std::string& player_id, std::optional<ParsedMove> move) {
+        return context_.handlePremoveRequest(player_id, std::move(move));
+    }
+
+    GameContext context_;
+    std::vector<std::pair<std::string, std::string>> unicasts_;
+};
+
+}  // namespace
+
+TEST_F(PremoveTest, PlaysInTheOpponentsMove) {
+    json queued = premove("black", simple("e7", "e5"));
+    EXPECT_EQ(queued["type"], "premoves");
+    EXPECT_EQ(queued["queued"], 1);
+
+    // Answered within the same request: nothing can come between the two moves
+    json response = context_.handleMoveRequest("white", simple("e2", "e4"));
+    ASSERT_EQ(response["type"], "move_result");
+    ASSERT_TRUE(response.contains("premove"));
+    EXPECT_EQ(response["premove"]["type"], "move_result");
+    EXPECT_EQ(response["premove"]["premove"], true);
+    EXPECT_EQ(context_.getChessGame()->getPly(), 2);
+    EXPECT_EQ(context_.getChessGame()->getCurrentPlayer(), chess::Color::WHITE);
+}
+
+TEST_F(PremoveTest, PlaysQueueOneMovePerTurn) {
+    premove("black", simple("e7", "e5"));
+    premove("black", simple("g8", "f6"));
+
+    context_.handleMoveRequest("white", simple("e2", "e4"));
+    EXPECT_EQ(context_.getChessGame()->getPly(), 2);
+
+    json response = context_.handleMoveRequest("white", simple("g1", "f3"));
+    ASSERT_TRUE(response.contains("premove"));
+    EXPECT_EQ(context_.getChessGame()->getPly(), 4);
+
+    // Queue empty: the next white move waits for black
+    response = context_.handleMoveRequest("white", simple("b1", "c3"));
+    EXPECT_FALSE(response.contains("premove"));
+    EXPECT_EQ(context_.getChessGame()->getPly(), 5);
+}
+
+TEST_F(PremoveTest, PlaysAtOnceOnOwnTurn) {
+    json response = premove("white", simple("e2", "e4"));
+    EXPECT_EQ(response["type"], "move_result");
+    EXPECT_EQ(context_.getChessGame()->getPly(), 1);
+}
+
+TEST_F(PremoveTest, IllegalPremoveDropsTheRestOfTheQueue) {
+    // The queen is still blocked by the e7 pawn
+    premove("black", simple("d8", "h4"));
+    premove("black", simple("e7", "e5"));
+
+    json response = context_.handleMoveRequest("white", simple("e2", "e4"));
+    EXPECT_EQ(response["type"], "move_result");
+    EXPECT_FALSE(response.contains("premove"));
+    EXPECT_EQ(context_.getChessGame()->getPly(), 1);
+
+    ASSERT_FALSE(unicasts_.empty());
+    EXPECT_EQ(unicasts_.back().first, "black");
+    json cancelled = json::parse(unicasts_.back().second);
+    EXPECT_EQ(cancelled["type"], "premove_cancelled");
+    EXPECT_EQ(cancelled["dropped"], 2);
+
+    // e7-e5 was dropped as well: black moves by hand, and white's next move gets no answer
+    context_.handleMoveRequest("black", simple("d7", "d5"));
+    response = context_.handleMoveRequest("white", simple("g1", "f3"));
+    EXPECT_FALSE(response.contains("premove"));
+    EXPECT_EQ(context_.getChessGame()->getPly(), 3);
+}
+
+TEST_F(PremoveTest, ClearingEmptiesTheQueue) {
+    premove("black", simple("e7", "e5"));
+    premove("black", simple("g8", "f6"));
+
+    json cleared = premove("black", std::nullopt);
+    EXPECT_EQ(cleared["type"], "premoves");
+    EXPECT_EQ(cleared["queued"], 0);
+
+    json response = context_.handleMoveRequest("white", simple("e2", "e4"));
+    EXPECT_FALSE(response.contains("premove"));
+    EXPECT_EQ(context_.getChessGame()->getPly(), 1);
+}
+
+TEST_F(PremoveTest, SpectatorsCannotPremove) {
+    json response = premove("spectator", simple("e7", "e5"));
+    EXPECT_EQ(response["type"], "error");
+    EXPECT_EQ(response["error"], "Only players can premove");
+}
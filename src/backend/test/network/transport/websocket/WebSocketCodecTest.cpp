@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "WebSocketCodec.hpp"
+
+using namespace WebSocketCodec;
+
+namespace {
+
+/// Reference byte-by-byte unmasking.
+std::string unmaskScalar(std::string data, const std::array<uint8_t, 4>& mask, uint64_t offset) {
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<char>(data[i] ^ mask[(offset + i) % 4]);
+    }
+    return data;
+}
+
+std::string bytes(std::initializer_list<uint8_t> values) {
+    return std::string(values.begin(), values.end());
+}
+
+}  // namespace
+
+TEST(WebSocketCodecTest, ParsesMaskedTextFrameHeader) {
+    // RFC 6455 section 5.7: masked "Hello"
+    std::string frame = bytes({0x81, 0x85, 0x37, 0xfa, 0x21, 0x3d, 0x7f, 0x9f, 0x4d, 0x51, 0x58});
+
+    auto header = parseFrameHeader(frame);
+    ASSERT_TRUE(header.has_value());
+    EXPECT_TRUE(header->fin);
+    EXPECT_EQ(header->opcode, Opcode::TEXT);
+    EXPECT_TRUE(header->masked);
+    EXPECT_EQ(header->payload_size, 5u);
+    EXPECT_EQ(header->header_size, 6u);
+
+    std::string payload = frame.substr(header->header_size);
+    unmask(payload.data(), payload.size(), header->mask);
+    EXPECT_EQ(payload, "Hello");
+}
+
+TEST(WebSocketCodecTest, ParsesExtendedLengths) {
+    auto medium = parseFrameHeader(bytes({0x82, 0x7E, 0x01, 0x00}));
+    ASSERT_TRUE(medium.has_value());
+    EXPECT_EQ(medium->payload_size, 256u);
+    EXPECT_EQ(medium->header_size, 4u);
+
+    auto large = parseFrameHeader(bytes({0x82, 0x7F, 0, 0, 0, 0, 0, 1, 0, 0}));
+    ASSERT_TRUE(large.has_value());
+    EXPECT_EQ(large->payload_size, 65536u);
+    EXPECT_EQ(large->header_size, 10u);
+}
+
+TEST(WebSocketCodecTest, RejectsLengthWithTopBitSet) {
+    auto header = parseFrameHeader(bytes({0x80, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                          0xFF, 0x01, 0x02, 0x03, 0x04}));
+    ASSERT_TRUE(header.has_value());
+    EXPECT_FALSE(header->valid_length);
+    EXPECT_EQ(header->payload_size, 0u);
+    EXPECT_EQ(header->header_size, 14u);
+
+    auto largest =
+        parseFrameHeader(bytes({0x82, 0x7F, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}));
+    ASSERT_TRUE(largest.has_value());
+    EXPECT_TRUE(largest->valid_length);
+    EXPECT_EQ(largest->payload_size, (uint64_t{1} << 63) - 1);
+}
+
+TEST(WebSocketCodecTest, IncompleteHeaderNeedsMoreBytes) {
+    EXPECT_FALSE(parseFrameHeader(bytes({0x81})).has_value());
+    EXPECT_FALSE(parseFrameHeader(bytes({0x81, 0xFE, 0x01})).has_value());
+    EXPECT_FALSE(parseFrameHeader(bytes({0x81, 0x85, 0x37, 0xfa, 0x21})).has_value());
+}
+
+TEST(WebSocketCodecTest, ReportsControlFramesAndReservedBits) {
+    auto ping = parseFrameHeader(bytes({0x89, 0x00}));
+    ASSERT_TRUE(ping.has_value());
+    EXPECT_TRUE(ping->isControl());
+
+    auto continuation = parseFrameHeader(bytes({0x40, 0x00}));
+    ASSERT_TRUE(continuation.has_value());
+    EXPECT_FALSE(continuation->fin);
+    EXPECT_FALSE(continuation->isControl());
+    EXPECT_EQ(continuation->rsv, 4);
+}
+
+TEST(WebSocketCodecTest, EncodedHeadersParseBack) {
+    for (uint64_t size : {0ull, 125ull, 126ull, 65535ull, 65536ull, 5'000'000ull}) {
+        std::array<char, kMaxHeaderSize> header;
+        size_t header_size = encodeFrameHeader(Opcode::TEXT, size, header);
+
+        auto parsed = parseFrameHeader(std::string_view(header.data(), header_size));
+        ASSERT_TRUE(parsed.has_value()) << size;
+        EXPECT_TRUE(parsed->fin);
+        EXPECT_FALSE(parsed->masked);
+        EXPECT_EQ(parsed->opcode, Opcode::TEXT);
+        EXPECT_EQ(parsed->payload_size, size);
+        EXPECT_EQ(parsed->header_size, header_size);
+    }
+}
+
+TEST(WebSocketCodecTest, VectorUnmaskingMatchesScalar) {
+    const std::array<uint8_t, 4> mask = {0x12, 0x34, 0x56, 0x78};
+
+    std::string data;
+    for (int i = 0; i < 300; ++i) {
+        data.push_back(static_cast<char>(i * 7));
+    }
+
+    // Every size and mask phase, to cover the vector, word and tail loops
+    for (size_t size = 0; size < data.size(); size += 7) {
+        for (uint64_t offset = 0; offset < 4; ++offset) {
+            std::string actual = data.substr(0, size);
+            unmask(actual.data(), actual.size(), mask, offset);
+            EXPECT_EQ(actual, unmaskScalar(data.substr(0, size), mask, offset))
+                << "size " << size << ", offset " << offset;
+        }
+    }
+}
+
+TEST(WebSocketCodecTest, UnmaskingInPiecesKeepsMaskPhase) {
+    const std::array<uint8_t, 4> mask = {0xA1, 0xB2, 0xC3, 0xD4};
+    std::string payload(1000, 'x');
+    std::string masked = unmaskScalar(payload, mask, 0);
+
+    // Unmasked as it would arrive, over reads of unaligned sizes
+    size_t position = 0;
+    for (size_t piece : {3u, 17u, 64u, 1u, 500u, 415u}) {
+        unmask(masked.data() + position, piece, mask, position);
+        position += piece;
+    }
+
+    EXPECT_EQ(masked, payload);
+}
+
+TEST(WebSocketCodecTest, Sha1KnownDigest) {
+    auto digest = sha1("abc");
+    EXPECT_EQ(base64(digest.data(), digest.size()), "qZk+NkcGgWq6PiVxeFDCbJzQ2J0=");
+}
+
+TEST(WebSocketCodecTest, AcceptKeyFromRfc) {
+    EXPECT_EQ(acceptKey("dGhlIHNhbXBsZSBub25jZQ=="), "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=");
+}
+
+TEST(WebSocketCodecTest, Base64Padding) {
+    const uint8_t data[] = {'f', 'o', 'o', 'b', 'a', 'r'};
+    EXPECT_EQ(base64(data, 0), "");
+    EXPECT_EQ(base64(data, 1), "Zg==");
+    EXPECT_EQ(base64(data, 2), "Zm8=");
+    EXPECT_EQ(base64(data, 6), "Zm9vYmFy");
+}
+
+TEST(WebSocketCodecTest, FindsHeadersCaseInsensitively) {
+    std::string_view request =
+        "GET /chess HTTP/1.1\r\n"
+        "Host: localhost:2000\r\n"
+        "upgrade:  WebSocket \r\n"
+        "Connection: keep-alive, Upgrade\r\n"
+        "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n";
+
+    EXPECT_EQ(headerValue(request, "Upgrade"), "WebSocket");
+    EXPECT_EQ(headerValue(request, "sec-websocket-key"), "dGhlIHNhbXBsZSBub25jZQ==");
+    EXPECT_FALSE(headerValue(request, "Sec-WebSocket-Version").has_value());
+
+    EXPECT_TRUE(hasToken(*headerValue(request, "Connection"), "upgrade"));
+    EXPECT_TRUE(hasToken(*headerValue(request, "Upgrade"), "websocket"));
+    EXPECT_FALSE(hasToken("keep-alive", "upgrade"));
+}
@@ -0,0 +1,147 @@
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "EventLoop.hpp"
+#include "WebSocketTransport.hpp"
+
+namespace {
+
+constexpr int kTimeoutMs = 2000;
+
+const std::string kUpgradeRequest =
+    "GET / HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+    "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+
+std::string bytes(std::initializer_list<uint8_t> values) {
+    return std::string(values.begin(), values.end());
+}
+
+/// Masked client frame header (zero mask: the payload goes as is) with a 64-bit length.
+std::string longHeader(uint8_t first, uint64_t length) {
+    std::string header = bytes({first, 0xFF});
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        header += static_cast<char>(length >> shift);
+    }
+    return header + bytes({0, 0, 0, 0});
+}
+
+/// Transport on one end of a socket pair, the test playing the client on the other.
+class WebSocketTransportTest : public ::testing::Test, public TransportListener {
+   protected:
+    void SetUp() override {
+        int fds[2];
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+        fcntl(fds[0], F_SETFL, O_NONBLOCK);
+        client_ = fds[1];
+
+        transport_ = std::make_unique<WebSocketTransport>(fds[0], loop_);
+        loop_.start();
+        transport_->start(*this);
+
+        write(kUpgradeRequest);
+        std::string response = readUntil("\r\n\r\n");
+        ASSERT_EQ(response.rfind("HTTP/1.1 101", 0), 0u) << response;
+    }
+
+    void TearDown() override {
+        loop_.stop();
+        transport_.reset();
+        ::close(client_);
+    }
+
+    void onReceive(std::string_view) override {}
+
+    void onMessage(std::string_view message) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        messages_.emplace_back(message);
+    }
+
+    // Like the session: the transport is closed once the connection failed
+    void onTransportClosed() override {
+        closed_ = true;
+        transport_->close();
+    }
+
+    void write(const std::string& data) {
+        ASSERT_EQ(::write(client_, data.data(), data.size()), static_cast<ssize_t>(data.size()));
+    }
+
+    /// Read until the pattern (if any), the end of stream or the timeout.
+    std::string readUntil(std::string_view pattern) {
+        std::string data;
+        while (pattern.empty() || data.find(pattern) == std::string::npos) {
+            pollfd ready{client_, POLLIN, 0};
+            if (poll(&ready, 1, kTimeoutMs) <= 0) {
+                break;
+            }
+            char buffer[4096];
+            ssize_t n = read(client_, buffer, sizeof(buffer));
+            if (n <= 0) {
+                break;
+            }
+            data.append(buffer, n);
+        }
+        return data;
+    }
+
+    /// Close status sent by the server before closing the connection, or 0 if none.
+    uint16_t closeStatus() {
+        std::string data = readUntil(std::string_view());  // Up to the end of stream
+        size_t frame = data.find(bytes({0x88, 0x02}));
+        if (frame == std::string::npos || data.size() < frame + 4) {
+            return 0;
+        }
+        return static_cast<uint16_t>((static_cast<uint8_t>(data[frame + 2]) << 8) |
+                                     static_cast<uint8_t>(data[frame + 3]));
+    }
+
+    EventLoop loop_;
+    std::unique_ptr<WebSocketTransport> transport_;
+    int client_ = -1;
+    std::atomic<bool> closed_{false};
+    std::mutex mutex_;
+    std::vector<std::string> messages_;
+};
+
+}  // namespace
+
+TEST_F(WebSocketTransportTest, DeliversWholeMessage) {
+    write(bytes({0x81, 0x82, 0, 0, 0, 0}) + "hi");
+    write(bytes({0x88, 0x80, 0, 0, 0, 0}));
+
+    EXPECT_EQ(closeStatus(), 0u);  // Empty close echoed back
+    EXPECT_TRUE(closed_);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ASSERT_EQ(messages_.size(), 1u);
+    EXPECT_EQ(messages_[0], "hi");
+}
+
+TEST_F(WebSocketTransportTest, RejectsLengthWithTopBitSet) {
+    // One byte of a fragmented message, then a continuation of 2^64-1 bytes
+    write(bytes({0x01, 0x81, 0, 0, 0, 0}) + "x");
+    write(longHeader(0x80, UINT64_MAX));
+
+    EXPECT_EQ(closeStatus(), static_cast<uint16_t>(WebSocketCodec::CloseCode::PROTOCOL_ERROR));
+    EXPECT_TRUE(closed_);
+}
+
+TEST_F(WebSocketTransportTest, RejectsFragmentsOverMessageLimit) {
+    write(bytes({0x01, 0x81, 0, 0, 0, 0}) + "x");
+    write(longHeader(0x80, WebSocketTransport::kMaxMessageSize));
+
+    EXPECT_EQ(closeStatus(), static_cast<uint16_t>(WebSocketCodec::CloseCode::MESSAGE_TOO_BIG));
+    EXPECT_TRUE(closed_);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    EXPECT_TRUE(messages_.empty());
+}
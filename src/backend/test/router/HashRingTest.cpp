@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "HashRing.hpp"
+
+TEST(HashRingTest, MapsRoomsToStableNodes) {
+    HashRing ring(4);
+    HashRing same(4);
+
+    for (int i = 0; i < 100; ++i) {
+        std::string room = "room-" + std::to_string(i);
+        EXPECT_LT(ring.nodeFor(room), 4u);
+        EXPECT_EQ(ring.nodeFor(room), same.nodeFor(room));
+    }
+
+    EXPECT_EQ(HashRing(1).nodeFor("anything"), 0u);
+}
+
+TEST(HashRingTest, SpreadsRoomsEvenly) {
+    HashRing ring(4);
+    std::vector<int> rooms(4, 0);
+
+    for (int i = 0; i < 10000; ++i) {
+        rooms[ring.nodeFor("room-" + std::to_string(i))]++;
+    }
+
+    for (int count : rooms) {
+        EXPECT_GT(count, 2500 * 0.8);
+        EXPECT_LT(count, 2500 * 1.2);
+    }
+}
+
+TEST(HashRingTest, AddingANodeOnlyMovesItsShare) {
+    HashRing before(4);
+    HashRing after(5);
+
+    int moved = 0;
+    for (int i = 0; i < 10000; ++i) {
+        std::string room = "room-" + std::to_string(i);
+        size_t node = after.nodeFor(room);
+        if (node != before.nodeFor(room)) {
+            // Rooms only move to the new node
+            EXPECT_EQ(node, 4u);
+            moved++;
+        }
+    }
+
+    // About 1 / 5 of the rooms
+    EXPECT_GT(moved, 10000 / 5 * 0.8);
+    EXPECT_LT(moved, 10000 / 5 * 1.2);
+}
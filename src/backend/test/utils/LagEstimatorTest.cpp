@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#include "LagEstimator.hpp"
+
+TEST(LagEstimatorTest, KeepsFastestRecentSample) {
+    LagEstimator lag;
+    EXPECT_EQ(lag.roundTrip(), 0);
+
+    lag.addSample(300);
+    lag.addSample(120);
+    lag.addSample(900);
+    EXPECT_EQ(lag.roundTrip(), 120);
+    EXPECT_EQ(lag.samples(), 3u);
+
+    // The fast sample ages out after kSamples newer ones
+    for (size_t i = 0; i < LagEstimator::kSamples; ++i) {
+        lag.addSample(400);
+    }
+    EXPECT_EQ(lag.roundTrip(), 400);
+    EXPECT_EQ(lag.samples(), LagEstimator::kSamples);
+}
+
+TEST(LagEstimatorTest, IgnoresNonPositiveSamples) {
+    LagEstimator lag;
+    lag.addSample(0);
+    lag.addSample(-50);
+    EXPECT_EQ(lag.samples(), 0u);
+    EXPECT_EQ(lag.roundTrip(), 0);
+}
+
+TEST(LagEstimatorTest, CapsCompensation) {
+    LagEstimator lag;
+    lag.addSample(800);
+    EXPECT_EQ(lag.compensation(500), 500);
+    EXPECT_EQ(lag.compensation(1000), 800);
+    EXPECT_EQ(lag.compensation(0), 0);
+}
+
+TEST(LagEstimatorTest, OnlyTakesTheEchoOfTheLatestPong) {
+    LagEstimator lag;
+
+    // No pong sent yet, then a made-up echo
+    EXPECT_FALSE(lag.addEcho(0, 5'000'000));
+    lag.pongSent(1'000'000);
+    EXPECT_FALSE(lag.addEcho(0, 5'000'000));
+    EXPECT_FALSE(lag.addEcho(UINT64_MAX, 5'000'000));
+    EXPECT_EQ(lag.samples(), 0u);
+
+    EXPECT_TRUE(lag.addEcho(1'000, 1'300'000));
+    EXPECT_EQ(lag.roundTrip(), 300'000);
+
+    // Echoing the same pong twice adds nothing
+    EXPECT_FALSE(lag.addEcho(1'000, 9'000'000));
+    EXPECT_EQ(lag.samples(), 1u);
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include "OverloadPolicy.hpp"
+
+namespace {
+
+constexpr int64_t kMillisecond = 1'000'000;
+
+OverloadSample lag(int64_t loop_lag_us) {
+    OverloadSample sample;
+    sample.loop_lag_us = loop_lag_us;
+    return sample;
+}
+
+}  // namespace
+
+TEST(OverloadPolicyTest, ClassifiesEachSignal) {
+    OverloadThresholds thresholds;
+    thresholds.max_rss_bytes = 1000;
+
+    EXPECT_EQ(OverloadPolicy::classify(thresholds, {}), OverloadLevel::NORMAL);
+    EXPECT_EQ(OverloadPolicy::classify(thresholds, lag(10'000)), OverloadLevel::ELEVATED);
+    EXPECT_EQ(OverloadPolicy::classify(thresholds, lag(250'000)), OverloadLevel::CRITICAL);
+
+    OverloadSample ready;
+    ready.ready_depth = 48;
+    EXPECT_EQ(OverloadPolicy::classify(thresholds, ready), OverloadLevel::HIGH);
+
+    OverloadSample memory;
+    memory.rss_bytes = 900;  // 90% of the limit
+    EXPECT_EQ(OverloadPolicy::classify(thresholds, memory), OverloadLevel::HIGH);
+}
+
+TEST(OverloadPolicyTest, HighestSignalWins) {
+    OverloadThresholds thresholds;
+    thresholds.max_rss_bytes = 1000;
+
+    OverloadSample sample = lag(10'000);
+    sample.rss_bytes = 960;
+    EXPECT_EQ(OverloadPolicy::classify(thresholds, sample), OverloadLevel::CRITICAL);
+}
+
+TEST(OverloadPolicyTest, MemoryIgnoredWithoutLimit) {
+    OverloadSample sample;
+    sample.rss_bytes = int64_t{1} << 40;
+    EXPECT_EQ(OverloadPolicy::classify(OverloadThresholds{}, sample), OverloadLevel::NORMAL);
+}
+
+TEST(OverloadPolicyTest, RisesImmediately) {
+    OverloadPolicy policy(OverloadThresholds{});
+
+    EXPECT_EQ(policy.update(lag(0), 0), OverloadLevel::NORMAL);
+    EXPECT_EQ(policy.update(lag(300'000), 100 * kMillisecond), OverloadLevel::CRITICAL);
+}
+
+TEST(OverloadPolicyTest, StepsDownOneLevelPerCooldown) {
+    OverloadThresholds thresholds;
+    thresholds.cooldown_ns = 1000 * kMillisecond;
+    OverloadPolicy policy(thresholds);
+
+    policy.update(lag(300'000), 0);
+
+    // Calm, but not for long enough
+    EXPECT_EQ(policy.update(lag(0), 500 * kMillisecond), OverloadLevel::CRITICAL);
+    EXPECT_EQ(policy.update(lag(0), 1000 * kMillisecond), OverloadLevel::HIGH);
+    EXPECT_EQ(policy.update(lag(0), 1500 * kMillisecond), OverloadLevel::HIGH);
+    EXPECT_EQ(policy.update(lag(0), 2000 * kMillisecond), OverloadLevel::ELEVATED);
+    EXPECT_EQ(policy.update(lag(0), 3000 * kMillisecond), OverloadLevel::NORMAL);
+}
+
+TEST(OverloadPolicyTest, LoadAtCurrentLevelRestartsCooldown) {
+    OverloadThresholds thresholds;
+    thresholds.cooldown_ns = 1000 * kMillisecond;
+    OverloadPolicy policy(thresholds);
+
+    policy.update(lag(60'000), 0);  // HIGH
+    policy.update(lag(0), 900 * kMillisecond);
+    policy.update(lag(60'000), 950 * kMillisecond);
+
+    EXPECT_EQ(policy.update(lag(0), 1500 * kMillisecond), OverloadLevel::HIGH);
+    EXPECT_EQ(policy.update(lag(0), 1950 * kMillisecond), OverloadLevel::ELEVATED);
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include "CommandTable.hpp"
+#include "TokenBucket.hpp"
+
+namespace {
+
+constexpr int64_t kSecond = 1'000'000'000;
+
+}  // namespace
+
+TEST(TokenBucketTest, AllowsBurstThenRejects) {
+    RateLimit limit{10, 3};
+    TokenBucket bucket(limit, 0);
+
+    EXPECT_TRUE(bucket.tryConsume(limit, 0));
+    EXPECT_TRUE(bucket.tryConsume(limit, 0));
+    EXPECT_TRUE(bucket.tryConsume(limit, 0));
+    EXPECT_FALSE(bucket.tryConsume(limit, 0));
+}
+
+TEST(TokenBucketTest, RefillsAtRate) {
+    RateLimit limit{10, 1};
+    TokenBucket bucket(limit, 0);
+
+    EXPECT_TRUE(bucket.tryConsume(limit, 0));
+    EXPECT_FALSE(bucket.tryConsume(limit, kSecond / 20));  // Half a token
+    EXPECT_TRUE(bucket.tryConsume(limit, kSecond / 10));
+}
+
+TEST(TokenBucketTest, RefillIsCappedByBurst) {
+    RateLimit limit{100, 2};
+    TokenBucket bucket(limit, 0);
+
+    // A long idle period doesn't accumulate more than the burst
+    EXPECT_TRUE(bucket.tryConsume(limit, 60 * kSecond));
+    EXPECT_TRUE(bucket.tryConsume(limit, 60 * kSecond));
+    EXPECT_FALSE(bucket.tryConsume(limit, 60 * kSecond));
+}
+
+TEST(TokenBucketTest, ZeroRateIsUnlimited) {
+    RateLimit limit{0, 0};
+    TokenBucket bucket(limit, 0);
+
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(bucket.tryConsume(limit, 0));
+    }
+}
+
+TEST(CommandClassTest, ClassifiesKnownCommands) {
+    EXPECT_EQ(classifyCommand(R"({"command":"make_move","move":"e2-e4"})"), CommandClass::MOVE);
+    EXPECT_EQ(classifyCommand(R"({"command": "display_board"})"), CommandClass::QUERY);
+    EXPECT_EQ(classifyCommand(R"({"command" : "get_stats"})"), CommandClass::QUERY);
+    EXPECT_EQ(classifyCommand(R"({"command":"get_snapshot"})"), CommandClass::QUERY);
+    EXPECT_EQ(classifyCommand(R"({"command":"resync","since":42})"), CommandClass::QUERY);
+    EXPECT_EQ(classifyCommand(R"({"metadata":{},"command":"upload_game"})"), CommandClass::UPLOAD);
+    EXPECT_EQ(classifyCommand(R"({"command":"join_game","color":"white"})"),
+              CommandClass::CONTROL);
+}
+
+TEST(CommandClassTest, UnrecognisedMessagesAreControl) {
+    EXPECT_EQ(classifyCommand(""), CommandClass::CONTROL);
+    EXPECT_EQ(classifyCommand("not json"), CommandClass::CONTROL);
+    EXPECT_EQ(classifyCommand(R"({"command":42})"), CommandClass::CONTROL);
+    EXPECT_EQ(classifyCommand(R"({"command":"make_move)"), CommandClass::CONTROL);
+    EXPECT_EQ(classifyCommand(R"({"move":"e2-e4"})"), CommandClass::CONTROL);
+}
+
+TEST(CommandClassTest, ExtractsCommandName) {
+    EXPECT_EQ(commandName(R"({"command":"enable_compression","dictionary_id":7})"),
+              "enable_compression");
+    EXPECT_EQ(commandName(R"({"command":"upload_game","data":"\"enable_compression\""})"),
+              "upload_game");
+    EXPECT_EQ(commandName(R"({"move":"e2-e4"})"), "");
+}
+
+TEST(CommandClassTest, IgnoresNestedCommandKeys) {
+    EXPECT_EQ(commandName(R"({"metadata":{"command":"get_stats"},"command":"make_move"})"),
+              "make_move");
+    EXPECT_EQ(commandName(R"({"metadata":{"command":"x"},"command":"upload_game","data":""})"),
+              "upload_game");
+    EXPECT_EQ(commandName(R"({"command":"join_game","list":[{"command":"enable_compression"}]})"),
+              "join_game");
+    EXPECT_EQ(commandName(R"({"metadata":{"command":"enable_compression"}})"), "");
+
+    // Neither a value spelling the key nor brackets inside strings change the level
+    EXPECT_EQ(commandName(R"({"name":"command","text":"{\"command\":\"x\"}","command":"ping"})"),
+              "ping");
+
+    // As with the parser, the last top-level key wins
+    EXPECT_EQ(commandName(R"({"command":"get_stats","command":"make_move"})"), "make_move");
+}
+
+static_assert(classifyCommand(R"({"metadata":{"command":"get_stats"},"command":"make_move"})") ==
+              CommandClass::MOVE);
+
+// The classifier runs before parsing, on every message: it must be usable at compile time
+static_assert(classifyCommand(R"({"command":"make_move"})") == CommandClass::MOVE);
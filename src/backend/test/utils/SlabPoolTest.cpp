@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "SlabPool.hpp"
+
+namespace {
+
+using SmallPool = SlabPool<40, 8>;
+using LargePool = SlabPool<100, 8>;
+
+}  // namespace
+
+TEST(SlabPoolTest, ReusesFreedSlotsNewestFirst) {
+    SmallPool pool;
+    void* first = pool.allocate();
+    void* second = pool.allocate();
+    EXPECT_EQ(pool.inUse(), 2u);
+    EXPECT_EQ(pool.capacity(), SmallPool::kSlotsPerSlab);
+
+    pool.deallocate(first);
+    pool.deallocate(second);
+    EXPECT_EQ(pool.allocate(), second);
+    EXPECT_EQ(pool.allocate(), first);
+}
+
+TEST(SlabPoolTest, GrowsBySlabWithCacheLineSlots) {
+    constexpr size_t kCount = LargePool::kSlotsPerSlab + 1;
+    LargePool pool;
+
+    std::set<uintptr_t> slots;
+    for (size_t i = 0; i < kCount; ++i) {
+        auto address = reinterpret_cast<uintptr_t>(pool.allocate());
+        EXPECT_EQ(address % LargePool::kCacheLine, 0u);
+        slots.insert(address);
+    }
+    EXPECT_EQ(slots.size(), kCount);
+    EXPECT_EQ(pool.capacity(), 2 * LargePool::kSlotsPerSlab);
+
+    // Slots don't overlap: each spans whole cache lines
+    for (auto it = std::next(slots.begin()); it != slots.end(); ++it) {
+        EXPECT_GE(*it - *std::prev(it), 128u);
+    }
+}
+
+TEST(SlabAllocatorTest, RecyclesSharedObjects) {
+    const void* address = nullptr;
+    {
+        auto room = std::allocate_shared<std::string>(SlabAllocator<std::string>(), "room");
+        EXPECT_EQ(*room, "room");
+        address = room.get();
+    }
+
+    // Same slot again: the object and its control block went back to their pool
+    auto next = std::allocate_shared<std::string>(SlabAllocator<std::string>(), "next");
+    EXPECT_EQ(static_cast<const void*>(next.get()), address);
+}
+
+TEST(SlabAllocatorTest, SendsArraysToTheGlobalAllocator) {
+    std::vector<int, SlabAllocator<int>> numbers = {1, 2, 3};
+    numbers.push_back(4);
+    EXPECT_EQ(numbers.size(), 4u);
+    EXPECT_EQ(numbers.back(), 4);
+}
@@ -0,0 +1,167 @@
+#include "LineClient.hpp"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+std::string Endpoint::describe() const {
+    return local ? ("unix:" + socket_path) : ("tcp:" + ip + ":" + std::to_string(port));
+}
+
+LineClient::LineClient(const Endpoint& endpoint) {
+    if (endpoint.local) {
+        fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd_ < 0) {
+            throw std::runtime_error("Cannot create Unix socket: " + std::string(strerror(errno)));
+        }
+
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (endpoint.socket_path.length() >= sizeof(addr.sun_path)) {
+            close();
+            throw std::runtime_error("Socket path too long: " + endpoint.socket_path);
+        }
+        strncpy(addr.sun_path, endpoint.socket_path.c_str(), sizeof(addr.sun_path) - 1);
+
+        if (::connect(fd_, (sockaddr*)&addr, sizeof(addr)) < 0) {
+            close();
+            throw std::runtime_error("Cannot connect to " + endpoint.describe() + ": " +
+                                     std::string(strerror(errno)));
+        }
+    } else {
+        fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd_ < 0) {
+            throw std::runtime_error("Cannot create TCP socket: " + std::string(strerror(errno)));
+        }
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(endpoint.port);
+        if (inet_pton(AF_INET, endpoint.ip.c_str(), &addr.sin_addr) <= 0) {
+            close();
+            throw std::runtime_error("Invalid IP address: " + endpoint.ip);
+        }
+
+        if (::connect(fd_, (sockaddr*)&addr, sizeof(addr)) < 0) {
+            close();
+            throw std::runtime_error("Cannot connect to " + endpoint.describe() + ": " +
+                                     std::string(strerror(errno)));
+        }
+    }
+
+    // Reads are driven by poll(), so they must never block
+    fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL, 0) | O_NONBLOCK);
+}
+
+LineClient::~LineClient() {
+    close();
+}
+
+bool LineClient::sendLine(const std::string& line) {
+    if (fd_ < 0) {
+        return false;
+    }
+
+    std::string framed = line + "\n";
+    size_t offset = 0;
+
+    while (offset < framed.size()) {
+        ssize_t n = ::send(fd_, framed.data() + offset, framed.size() - offset, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // Socket buffer full: wait until the server drains it
+                pollfd pfd{fd_, POLLOUT, 0};
+                poll(&pfd, 1, 1000);
+                continue;
+            }
+            return false;
+        }
+        offset += static_cast<size_t>(n);
+    }
+
+    return true;
+}
+
+bool LineClient::readLines(std::vector<std::string>& lines) {
+    // Lines already pulled by waitLine() come first
+    for (auto& line : queued_) {
+        lines.push_back(std::move(line));
+    }
+    queued_.clear();
+
+    return fill(lines);
+}
+
+bool LineClient::fill(std::vector<std::string>& lines) {
+    if (fd_ < 0) {
+        return false;
+    }
+
+    char chunk[4096];
+
+    while (true) {
+        ssize_t n = ::read(fd_, chunk, sizeof(chunk));
+        if (n > 0) {
+            buffer_.append(chunk, static_cast<size_t>(n));
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+
+        bool alive = (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+
+        // Split complete messages
+        size_t start = 0;
+        size_t pos;
+        while ((pos = buffer_.find('\n', start)) != std::string::npos) {
+            lines.emplace_back(buffer_, start, pos - start);
+            start = pos + 1;
+        }
+        buffer_.erase(0, start);
+
+        return alive;
+    }
+}
+
+std::optional<std::string> LineClient::waitLine(std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    while (queued_.empty()) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0 || fd_ < 0) {
+            return std::nullopt;
+        }
+
+        pollfd pfd{fd_, POLLIN, 0};
+        if (poll(&pfd, 1, static_cast<int>(remaining.count())) <= 0) {
+            continue;
+        }
+
+        if (!fill(queued_) && queued_.empty()) {
+            return std::nullopt;
+        }
+    }
+
+    std::string line = std::move(queued_.front());
+    queued_.erase(queued_.begin());
+    return line;
+}
+
+void LineClient::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
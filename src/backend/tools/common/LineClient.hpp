@@ -0,0 +1,104 @@
+/**
+ * @file LineClient.hpp
+ * @brief Minimal client speaking the server's newline-delimited protocol.
+ *
+ * Shared by the load and benchmark tools, which must not depend on the
+ * frontend or on the server sources.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @struct Endpoint
+ * @brief Address of a running chess_server (TCP or Unix socket).
+ */
+struct Endpoint {
+    bool local = false;                             ///< True for Unix socket (IPC)
+    std::string ip = "127.0.0.1";                   ///< Server IP address (TCP)
+    int port = 2000;                                ///< Server port (TCP)
+    std::string socket_path = "/tmp/chess_server.sock";  ///< Socket path (IPC)
+
+    /**
+     * @brief Human readable address, for reports.
+     */
+    std::string describe() const;
+};
+
+/**
+ * @class LineClient
+ * @brief Blocking-connect, non-blocking-read client connection.
+ *
+ * Outgoing messages are framed with a trailing '\n'. Incoming bytes are
+ * buffered until complete lines are available.
+ */
+class LineClient {
+   public:
+    /**
+     * @brief Connect to the server.
+     * @param endpoint Server address
+     * @throws std::runtime_error on connection failure
+     */
+    explicit LineClient(const Endpoint& endpoint);
+
+    /**
+     * @brief Destructor closes the connection.
+     */
+    ~LineClient();
+
+    LineClient(const LineClient&) = delete;
+    LineClient& operator=(const LineClient&) = delete;
+
+    /**
+     * @brief Get the socket file descriptor (for poll()).
+     */
+    int fd() const { return fd_; }
+
+    /**
+     * @brief Check if the connection is still open.
+     */
+    bool isOpen() const { return fd_ >= 0; }
+
+    /**
+     * @brief Send one message followed by '\n'.
+     * @param line Message content
+     * @return False if the connection failed
+     */
+    bool sendLine(const std::string& line);
+
+    /**
+     * @brief Read whatever is available without blocking.
+     * @param lines Complete lines are appended here
+     * @return False on EOF or read error
+     */
+    bool readLines(std::vector<std::string>& lines);
+
+    /**
+     * @brief Block until one complete line is received.
+     * @param timeout Maximum waiting time
+     * @return The line, or nullopt on timeout or closure
+     */
+    std::optional<std::string> waitLine(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Close the connection.
+     */
+    void close();
+
+   private:
+    /**
+     * @brief Read available bytes from the socket and split complete lines.
+     * @param lines Complete lines are appended here
+     * @return False on EOF or read error
+     */
+    bool fill(std::vector<std::string>& lines);
+
+    int fd_ = -1;                      ///< Socket file descriptor
+    std::string buffer_;               ///< Partial line accumulator
+    std::vector<std::string> queued_;  ///< Lines read but not yet returned by waitLine()
+};
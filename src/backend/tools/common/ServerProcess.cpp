@@ -0,0 +1,145 @@
+#include "ServerProcess.hpp"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+ProcessSample sampleProcess(pid_t pid) {
+    ProcessSample sample;
+    const std::string proc_dir = "/proc/" + std::to_string(pid);
+
+    std::ifstream status(proc_dir + "/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmRSS:", 0) == 0) {
+            sample.rss_kb = std::stoll(line.substr(6));
+        } else if (line.rfind("Threads:", 0) == 0) {
+            sample.threads = std::stoll(line.substr(8));
+        }
+    }
+
+    std::error_code ec;
+    for (auto it = std::filesystem::directory_iterator(proc_dir + "/fd", ec);
+         !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+        sample.open_fds++;
+    }
+
+    return sample;
+}
+
+ServerProcess::ServerProcess(const std::string& server_path, const std::vector<std::string>& args) {
+    int stdin_pipe[2];
+    if (pipe(stdin_pipe) < 0) {
+        throw std::runtime_error("Cannot create pipe: " + std::string(strerror(errno)));
+    }
+
+    spawn_time_ = std::chrono::steady_clock::now();
+    pid_ = fork();
+
+    if (pid_ < 0) {
+        ::close(stdin_pipe[0]);
+        ::close(stdin_pipe[1]);
+        throw std::runtime_error("Cannot fork: " + std::string(strerror(errno)));
+    }
+
+    if (pid_ == 0) {
+        // Child: stdin from the pipe, console output discarded
+        dup2(stdin_pipe[0], STDIN_FILENO);
+        ::close(stdin_pipe[0]);
+        ::close(stdin_pipe[1]);
+
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (null_fd >= 0) {
+            dup2(null_fd, STDOUT_FILENO);
+            dup2(null_fd, STDERR_FILENO);
+            ::close(null_fd);
+        }
+
+        std::vector<char*> argv;
+        argv.push_back(const_cast<char*>(server_path.c_str()));
+        for (const auto& arg : args) {
+            argv.push_back(const_cast<char*>(arg.c_str()));
+        }
+        argv.push_back(nullptr);
+
+        execv(server_path.c_str(), argv.data());
+        _exit(127);
+    }
+
+    ::close(stdin_pipe[0]);
+    stdin_fd_ = stdin_pipe[1];
+}
+
+ServerProcess::~ServerProcess() {
+    stop();
+}
+
+std::chrono::microseconds ServerProcess::waitReady(const Endpoint& endpoint,
+                                                   std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    while (std::chrono::steady_clock::now() < deadline) {
+        try {
+            LineClient client(endpoint);
+            if (client.waitLine(std::chrono::milliseconds(1000))) {
+                return std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - spawn_time_);
+            }
+        } catch (const std::exception&) {
+            // Not listening yet
+        }
+
+        int status;
+        if (waitpid(pid_, &status, WNOHANG) == pid_) {
+            pid_ = -1;
+            throw std::runtime_error("Server exited during startup");
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    throw std::runtime_error("Server not ready after " + std::to_string(timeout.count()) + " ms");
+}
+
+bool ServerProcess::sendInput(const std::string& line) {
+    if (stdin_fd_ < 0) {
+        return false;
+    }
+
+    std::string data = line + "\n";
+    return write(stdin_fd_, data.data(), data.size()) == static_cast<ssize_t>(data.size());
+}
+
+int ServerProcess::stop() {
+    if (pid_ < 0) {
+        return -1;
+    }
+
+    // EOF on stdin stops the server like pressing Enter
+    if (stdin_fd_ >= 0) {
+        ::close(stdin_fd_);
+        stdin_fd_ = -1;
+    }
+
+    int status = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+    while (waitpid(pid_, &status, WNOHANG) == 0) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            kill(pid_, SIGKILL);
+            waitpid(pid_, &status, 0);
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    pid_ = -1;
+    return status;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file ServerProcess.hpp
+ * @brief Spawning and resource sampling of a chess_server process.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "LineClient.hpp"
+
+/**
+ * @struct ProcessSample
+ * @brief Resource usage of a process, read from /proc.
+ */
+struct ProcessSample {
+    int64_t rss_kb = 0;    ///< Resident set size
+    int64_t threads = 0;   ///< Number of threads
+    int64_t open_fds = 0;  ///< Number of open file descriptors
+};
+
+/**
+ * @brief Sample the resource usage of a process.
+ * @param pid Process ID
+ * @return Sample (all zero if the process is gone)
+ */
+ProcessSample sampleProcess(pid_t pid);
+
+/**
+ * @class ServerProcess
+ * @brief Runs chess_server as a child process.
+ *
+ * The server stops when Enter is pressed, so the child's stdin is a pipe that
+ * is closed to request a clean shutdown. Server console output is discarded
+ * (the server also logs to its log file).
+ */
+class ServerProcess {
+   public:
+    /**
+     * @brief Spawn the server.
+     * @param server_path Path to the chess_server executable
+     * @param args Command line arguments
+     * @throws std::runtime_error if the process cannot be spawned
+     */
+    ServerProcess(const std::string& server_path, const std::vector<std::string>& args);
+
+    /**
+     * @brief Destructor stops the server.
+     */
+    ~ServerProcess();
+
+    ServerProcess(const ServerProcess&) = delete;
+    ServerProcess& operator=(const ServerProcess&) = delete;
+
+    /**
+     * @brief Get the child process ID.
+     */
+    pid_t pid() const { return pid_; }
+
+    /**
+     * @brief Wait until the server accepts connections and sends its handshake.
+     * @param endpoint Server address
+     * @param timeout Maximum waiting time
+     * @return Time from spawn to the first handshake
+     * @throws std::runtime_error on timeout
+     */
+    std::chrono::microseconds waitReady(const Endpoint& endpoint,
+                                        std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Write a line to the server's stdin (e.g. a chess_router command).
+     * @param line Line without its newline
+     * @return False if the server is stopped or not reading its stdin
+     */
+    bool sendInput(const std::string& line);
+
+    /**
+     * @brief Request a clean shutdown, killing the server if it doesn't exit in time.
+     * @return Exit status as returned by waitpid(), or -1 if already stopped
+     */
+    int stop();
+
+   private:
+    pid_t pid_ = -1;                                     ///< Child process ID
+    int stdin_fd_ = -1;                                  ///< Write end of the child's stdin
+    std::chrono::steady_clock::time_point spawn_time_;  ///< Time of fork()
+};
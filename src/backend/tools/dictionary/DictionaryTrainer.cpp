@@ -0,0 +1,121 @@
+#include "DictionaryTrainer.hpp"
+
+#include <zdict.h>
+#include <zstd.h>
+
+#include <iomanip>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+
+using json = nlohmann::json;
+
+namespace {
+
+/// Compression level of the evaluation, the server default.
+constexpr int kLevel = 3;
+
+std::string joinMessage(const std::string& color) {
+    return json{{"command", "join_game"}, {"single_player", false}, {"color", color}}.dump();
+}
+
+std::string moveMessage(const std::string& move) {
+    return json{{"command", "make_move"}, {"move", move}}.dump();
+}
+
+}  // namespace
+
+void DictionaryReport::print(std::ostream& os) const {
+    auto ratio = [this](size_t compressed) {
+        return compressed > 0 ? static_cast<double>(corpus_bytes) / compressed : 0.0;
+    };
+
+    os << "Corpus:             " << samples << " messages, " << corpus_bytes << " bytes\n"
+       << std::fixed << std::setprecision(2)
+       << "Without dictionary: " << plain_bytes << " bytes (ratio " << ratio(plain_bytes)
+       << ")\n"
+       << "With dictionary:    " << dictionary_bytes << " bytes (ratio "
+       << ratio(dictionary_bytes) << ")\n"
+       << "Dictionary ID:      " << dictionary_id << "\n";
+}
+
+DictionaryTrainer::DictionaryTrainer(Endpoint endpoint, TrainerOptions options)
+    : endpoint_(std::move(endpoint)), options_(options) {}
+
+void DictionaryTrainer::playGame(const std::vector<std::string>& moves) {
+    LineClient white(endpoint_), black(endpoint_);
+    drain(white, options_.timeout);  // Handshakes
+    drain(black, options_.timeout);
+
+    request(white, black, joinMessage("white"));
+    request(black, white, joinMessage("black"));
+    request(white, black, json{{"command", "start_game"}}.dump());
+
+    for (size_t m = 0; m < moves.size(); ++m) {
+        bool white_turn = m % 2 == 0;
+        request(white_turn ? white : black, white_turn ? black : white, moveMessage(moves[m]));
+        request(white, black, json{{"command", "display_board"}}.dump());
+    }
+
+    request(white, black, json{{"command", "end_game"}}.dump());
+}
+
+void DictionaryTrainer::request(LineClient& sender, LineClient& other,
+                                const std::string& message) {
+    if (!sender.sendLine(message)) {
+        throw std::runtime_error("Connection to " + endpoint_.describe() + " lost");
+    }
+    drain(sender, options_.timeout);
+    drain(other, options_.quiet);
+}
+
+void DictionaryTrainer::drain(LineClient& client, std::chrono::milliseconds wait) {
+    while (auto line = client.waitLine(wait)) {
+        corpus_.push_back(std::move(*line));
+        wait = options_.quiet;
+    }
+}
+
+std::string DictionaryTrainer::train() const {
+    // ZDICT takes the samples concatenated, with their sizes
+    std::string samples;
+    std::vector<size_t> sizes;
+    for (const auto& message : corpus_) {
+        samples += message;
+        sizes.push_back(message.size());
+    }
+
+    std::string dictionary(options_.dictionary_size, '\0');
+    size_t size = ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(), samples.data(),
+                                        sizes.data(), static_cast<unsigned>(sizes.size()));
+    if (ZDICT_isError(size)) {
+        throw std::runtime_error(std::string("Training failed: ") + ZDICT_getErrorName(size) +
+                                 " (" + std::to_string(corpus_.size()) +
+                                 " messages, play more games)");
+    }
+
+    dictionary.resize(size);
+    return dictionary;
+}
+
+DictionaryReport DictionaryTrainer::evaluate(const std::string& dictionary) const {
+    DictionaryReport report;
+    report.samples = corpus_.size();
+    report.dictionary_id = ZDICT_getDictID(dictionary.data(), dictionary.size());
+
+    ZSTD_CCtx* context = ZSTD_createCCtx();
+    ZSTD_CDict* digested = ZSTD_createCDict(dictionary.data(), dictionary.size(), kLevel);
+    std::string output;
+
+    for (const auto& message : corpus_) {
+        output.resize(ZSTD_compressBound(message.size()));
+        report.corpus_bytes += message.size();
+        report.plain_bytes += ZSTD_compressCCtx(context, output.data(), output.size(),
+                                                message.data(), message.size(), kLevel);
+        report.dictionary_bytes += ZSTD_compress_usingCDict(
+            context, output.data(), output.size(), message.data(), message.size(), digested);
+    }
+
+    ZSTD_freeCDict(digested);
+    ZSTD_freeCCtx(context);
+    return report;
+}
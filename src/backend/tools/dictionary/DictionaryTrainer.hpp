@@ -0,0 +1,105 @@
+/**
+ * @file DictionaryTrainer.hpp
+ * @brief Training of the zstd dictionary offered by chess_server to its clients.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "LineClient.hpp"
+
+/**
+ * @struct TrainerOptions
+ * @brief Corpus collection and training settings.
+ */
+struct TrainerOptions {
+    size_t dictionary_size = 8 * 1024;        ///< Maximum dictionary size
+    std::chrono::milliseconds quiet{20};      ///< Silence ending the messages of a request
+    std::chrono::milliseconds timeout{2000};  ///< Maximum wait for a response
+};
+
+/**
+ * @struct DictionaryReport
+ * @brief Compression of the corpus, message by message, with and without the dictionary.
+ *
+ * The server compresses each connection as one stream, which also matches
+ * earlier messages: these figures are a lower bound of its savings.
+ */
+struct DictionaryReport {
+    size_t samples = 0;           ///< Messages in the corpus
+    size_t corpus_bytes = 0;      ///< Total size of the messages
+    size_t plain_bytes = 0;       ///< Compressed one by one, without dictionary
+    size_t dictionary_bytes = 0;  ///< Compressed one by one, with the dictionary
+    uint32_t dictionary_id = 0;   ///< ID quoted by clients in `enable_compression`
+
+    /**
+     * @brief Print a human readable summary.
+     * @param os Output stream
+     */
+    void print(std::ostream& os) const;
+};
+
+/**
+ * @class DictionaryTrainer
+ * @brief Collects real server messages by playing games, then trains a dictionary on them.
+ *
+ * Each game is played by two clients (white and black) against a running
+ * server, with a board display after every move, so the corpus holds the
+ * messages compression matters for: move results, board dumps and
+ * broadcasts, as the server formats them.
+ */
+class DictionaryTrainer {
+   public:
+    /**
+     * @brief Create a trainer.
+     * @param endpoint Server address
+     * @param options Collection and training settings
+     */
+    DictionaryTrainer(Endpoint endpoint, TrainerOptions options);
+
+    /**
+     * @brief Play a game and add every message received to the corpus.
+     * @param moves Moves in the server notation, white first
+     * @throws std::runtime_error if the server can't be reached
+     */
+    void playGame(const std::vector<std::string>& moves);
+
+    /**
+     * @brief Train the dictionary on the corpus collected so far.
+     * @return Dictionary content
+     * @throws std::runtime_error if zstd fails (e.g. corpus too small)
+     */
+    std::string train() const;
+
+    /**
+     * @brief Measure the dictionary on the corpus.
+     * @param dictionary Dictionary content
+     * @return Corpus and compression sizes
+     */
+    DictionaryReport evaluate(const std::string& dictionary) const;
+
+   private:
+    /**
+     * @brief Send a request and collect the messages it causes on both connections.
+     * @param sender Connection sending the request
+     * @param other Other player's connection, receiving the broadcasts
+     * @param message Request
+     */
+    void request(LineClient& sender, LineClient& other, const std::string& message);
+
+    /**
+     * @brief Collect messages of a connection until it goes quiet.
+     * @param client Connection
+     * @param wait Maximum wait for the first message
+     */
+    void drain(LineClient& client, std::chrono::milliseconds wait);
+
+    Endpoint endpoint_;                ///< Server address
+    TrainerOptions options_;           ///< Collection and training settings
+    std::vector<std::string> corpus_;  ///< Messages received so far
+};
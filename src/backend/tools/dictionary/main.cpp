@@ -0,0 +1,112 @@
+#include <fstream>
+#include <iostream>
+
+#include "DictionaryTrainer.hpp"
+
+using namespace std;
+
+void printUsage(const string& program_name) {
+    cout << "Usage: " << program_name << " -o <dictionary> <game>... [OPTIONS]\n"
+         << "Options:\n"
+         << "  -h                  Show this help message\n"
+         << "  -o <dictionary>     Dictionary to write, for `chess_server --compression-dict`\n"
+         << "  <game>              Game file: one move per line, `//` comments (e.g. test/game)\n"
+         << "  -i <ip address>     Server ip address (default: 127.0.0.1)\n"
+         << "  -p <port>           Server port (default: 2000)\n"
+         << "  --local             Use local IPC network (instead of TCP)\n"
+         << "  --socket <socket>   Socket path (only for IPC) (default: `/tmp/chess_server.sock`)\n"
+         << "  --size <bytes>      Maximum dictionary size (default: 8192)\n"
+         << "  --rounds <N>        Times each game is played (default: 1)\n";
+}
+
+/**
+ * @brief Read the moves of a game file.
+ * @param path Game file
+ * @return Moves, comments and blank lines skipped
+ */
+vector<string> readGame(const string& path) {
+    ifstream file(path);
+    if (!file) {
+        throw runtime_error("Cannot open game file: " + path);
+    }
+
+    vector<string> moves;
+    string line;
+    while (getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!line.empty() && line.rfind("//", 0) != 0) {
+            moves.push_back(line);
+        }
+    }
+    return moves;
+}
+
+int main(int argc, char* argv[]) {
+    Endpoint endpoint;
+    TrainerOptions options;
+    string output_path;
+    vector<string> game_paths;
+    size_t rounds = 1;
+
+    const string program_name = argv[0];
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+
+        if (arg == "--help" || arg == "-h") {
+            printUsage(program_name);
+            return 0;
+        } else if (arg == "-o" && i + 1 < argc) {
+            output_path = argv[++i];
+        } else if ((arg == "--ip" || arg == "-i") && i + 1 < argc) {
+            endpoint.ip = argv[++i];
+        } else if ((arg == "--port" || arg == "-p") && i + 1 < argc) {
+            endpoint.port = stoi(argv[++i]);
+        } else if (arg == "--local") {
+            endpoint.local = true;
+        } else if (arg == "--socket" && i + 1 < argc) {
+            endpoint.socket_path = argv[++i];
+        } else if (arg == "--size" && i + 1 < argc) {
+            options.dictionary_size = stoul(argv[++i]);
+        } else if (arg == "--rounds" && i + 1 < argc) {
+            rounds = max<size_t>(1, stoul(argv[++i]));
+        } else {
+            game_paths.push_back(arg);
+        }
+    }
+
+    if (output_path.empty() || game_paths.empty()) {
+        printUsage(program_name);
+        return 1;
+    }
+
+    try {
+        DictionaryTrainer trainer(endpoint, options);
+
+        cout << "Playing " << game_paths.size() << " game(s) " << rounds << " time(s) against "
+             << endpoint.describe() << endl;
+        for (size_t round = 0; round < rounds; ++round) {
+            for (const auto& path : game_paths) {
+                trainer.playGame(readGame(path));
+            }
+        }
+
+        string dictionary = trainer.train();
+
+        ofstream output(output_path, ios::binary);
+        output.write(dictionary.data(), static_cast<streamsize>(dictionary.size()));
+        if (!output) {
+            throw runtime_error("Cannot write dictionary: " + output_path);
+        }
+
+        cout << "Dictionary:         " << dictionary.size() << " bytes written to " << output_path
+             << "\n";
+        trainer.evaluate(dictionary).print(cout);
+        return 0;
+    } catch (const exception& e) {
+        cerr << "Dictionary training failed: " << e.what() << endl;
+        return 2;
+    }
+}
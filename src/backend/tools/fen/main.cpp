@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <chess.hpp>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "FenValidator.hpp"
+
+using namespace std;
+
+void printUsage(const string& program_name) {
+    cout << "Usage: " << program_name << " [OPTIONS]\n"
+         << "Options:\n"
+         << "  -h                  Show this help message\n"
+         << "  -f <path>           EPD file of the positions (default: built-in positions)\n"
+         << "  --rounds <N>        Passes over the positions (default: 1000)\n";
+}
+
+/// Positions used without an EPD file, including a few the validator rejects.
+const vector<string> kBuiltinPositions = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "4k3/8/8/8/8/8/8/4K3 w - e3 0 1",
+    "4k3/8/8/8/8/8/8/4K2R w Kq - 0 1",
+    "4k3/8/8/8/8/8/8/8 w - - 0 1",
+    "4k3/4Q3/8/8/8/8/8/4K3 w - - 0 1",
+};
+
+/**
+ * @brief Time a function over every position.
+ * @return Nanoseconds per position
+ */
+template <typename Function>
+double timePerPosition(const vector<string>& positions, size_t rounds, Function&& function) {
+    auto start = chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; ++round) {
+        for (const string& fen : positions) {
+            function(fen);
+        }
+    }
+    auto elapsed = chrono::duration<double, nano>(chrono::steady_clock::now() - start);
+    return elapsed.count() / static_cast<double>(rounds * positions.size());
+}
+
+int main(int argc, char* argv[]) {
+    string epd_path;
+    size_t rounds = 1000;
+
+    const string program_name = argv[0];
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+
+        if (arg == "--help" || arg == "-h") {
+            printUsage(program_name);
+            return 0;
+        } else if (arg == "-f" && i + 1 < argc) {
+            epd_path = argv[++i];
+        } else if (arg == "--rounds" && i + 1 < argc) {
+            rounds = max<size_t>(1, stoul(argv[++i]));
+        }
+    }
+
+    vector<string> positions;
+    if (epd_path.empty()) {
+        positions = kBuiltinPositions;
+    } else {
+        ifstream file(epd_path);
+        if (!file) {
+            cerr << "Cannot open " << epd_path << "\n";
+            return 1;
+        }
+        string line;
+        while (getline(file, line)) {
+            if (auto fen = fen::fromEpd(line)) {
+                positions.push_back(*fen);
+            }
+        }
+    }
+    if (positions.empty()) {
+        cerr << "No positions to load\n";
+        return 1;
+    }
+
+    // The board alone is only timed on legal positions: it doesn't check them
+    vector<string> legal;
+    for (const string& fen : positions) {
+        if (fen::validate(fen).empty()) {
+            legal.push_back(fen);
+        }
+    }
+    size_t rejected = positions.size() - legal.size();
+
+    // Sinks keep the optimiser from dropping the timed calls
+    size_t errors = 0;
+    uint64_t hashes = 0;
+    chess::Board board;
+
+    double validate_ns = timePerPosition(positions, rounds, [&errors](const string& fen) {
+        errors += fen::validate(fen).size();
+    });
+    double load_ns = 0.0;
+    if (!legal.empty()) {
+        load_ns = timePerPosition(legal, rounds, [&board, &hashes](const string& fen) {
+            board.setFen(fen);
+            hashes ^= board.hash();
+        });
+    }
+    double checked_load_ns =
+        timePerPosition(positions, rounds, [&board, &hashes](const string& fen) {
+            if (fen::validate(fen).empty()) {
+                board.setFen(fen);
+                hashes ^= board.hash();
+            }
+        });
+
+    cout << positions.size() << " positions, " << rejected << " rejected, " << rounds
+         << " rounds\n"
+         << "validate:          " << validate_ns << " ns/position\n"
+         << "setFen (legal):    " << load_ns << " ns/position\n"
+         << "validate + setFen: " << checked_load_ns << " ns/position\n"
+         << "(checksum " << (hashes ^ errors) << ")\n";
+
+    return 0;
+}
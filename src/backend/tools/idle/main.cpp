@@ -0,0 +1,179 @@
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <thread>
+
+#include "LineClient.hpp"
+#include "ServerProcess.hpp"
+
+using namespace std;
+using json = nlohmann::json;
+
+/**
+ * @struct IdleSample
+ * @brief Server resources with a given number of idle connections.
+ */
+struct IdleSample {
+    ProcessSample process;    ///< RSS, threads and fds from /proc
+    int64_t heap_in_use = 0;  ///< Allocator bytes in use (from get_stats)
+    json memory;              ///< Per-subsystem accounting (from get_stats, if enabled)
+};
+
+void printUsage(const string& program_name) {
+    cout << "Usage: " << program_name << " (--server <path> | --pid <pid>) [OPTIONS]\n"
+         << "Options:\n"
+         << "  -h                  Show this help message\n"
+         << "  --server <path>     Spawn this chess_server on a private Unix socket\n"
+         << "  --pid <pid>         Attach to an already running server instead\n"
+         << "  -i <ip address>     Server ip address, with --pid (default: 127.0.0.1)\n"
+         << "  -p <port>           Server port, with --pid (default: 2000)\n"
+         << "  --local             Use local IPC network, with --pid\n"
+         << "  --socket <socket>   Socket path (default: `/tmp/chess_server.sock`)\n"
+         << "  --connections <N>   Idle connections to open (default: 1000)\n"
+         << "  --settle-ms <ms>    Idle time before sampling (default: 1000)\n";
+}
+
+/**
+ * @brief Raise the open file limit: the benchmark holds one descriptor per connection.
+ */
+void raiseFileDescriptorLimit() {
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+/**
+ * @brief Sample the server once its sessions are idle.
+ */
+IdleSample sample(const Endpoint& endpoint, pid_t pid, chrono::milliseconds settle) {
+    this_thread::sleep_for(settle);
+
+    IdleSample s;
+
+    // The stats connection is open in both samples, so it cancels out
+    LineClient client(endpoint);
+    client.waitLine(chrono::seconds(2));
+    client.sendLine(json{{"command", "get_stats"}}.dump());
+
+    if (auto line = client.waitLine(chrono::seconds(2))) {
+        auto stats = json::parse(*line);
+        s.heap_in_use = stats["allocator"].value("in_use_bytes", int64_t{0});
+        s.memory = stats.value("memory", json::object());
+    }
+
+    s.process = sampleProcess(pid);
+    return s;
+}
+
+/**
+ * @brief Print the cost of one idle connection.
+ */
+void report(const IdleSample& before, const IdleSample& after, size_t connections) {
+    auto per_connection = [connections](int64_t delta) {
+        return static_cast<double>(delta) / static_cast<double>(connections);
+    };
+
+    int64_t rss_bytes = (after.process.rss_kb - before.process.rss_kb) * 1024;
+    int64_t heap_bytes = after.heap_in_use - before.heap_in_use;
+
+    cout << fixed << setprecision(1);
+    cout << "Idle connections:        " << connections << "\n"
+         << "RSS per connection:      " << per_connection(rss_bytes) << " bytes\n"
+         << "Heap per connection:     " << per_connection(heap_bytes) << " bytes\n"
+         << "Threads per connection:  "
+         << per_connection(after.process.threads - before.process.threads) << "\n"
+         << "Fds per connection:      "
+         << per_connection(after.process.open_fds - before.process.open_fds) << "\n";
+
+    // Only reported by servers built with CHESS_MEMORY_ACCOUNTING
+    if (after.memory.value("accounting", false)) {
+        cout << "Charged to sessions:     " << after.memory.value("bytes_per_session", int64_t{0})
+             << " bytes per session\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Endpoint endpoint;
+    string server_path;
+    pid_t pid = -1;
+    size_t connections = 1000;
+    chrono::milliseconds settle{1000};
+
+    const string program_name = argv[0];
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+
+        if (arg == "--help" || arg == "-h") {
+            printUsage(program_name);
+            return 0;
+        } else if (arg == "--server" && i + 1 < argc) {
+            server_path = argv[++i];
+        } else if (arg == "--pid" && i + 1 < argc) {
+            pid = stoi(argv[++i]);
+        } else if ((arg == "--ip" || arg == "-i") && i + 1 < argc) {
+            endpoint.ip = argv[++i];
+        } else if ((arg == "--port" || arg == "-p") && i + 1 < argc) {
+            endpoint.port = stoi(argv[++i]);
+        } else if (arg == "--local") {
+            endpoint.local = true;
+        } else if (arg == "--socket" && i + 1 < argc) {
+            endpoint.socket_path = argv[++i];
+        } else if (arg == "--connections" && i + 1 < argc) {
+            connections = max<size_t>(1, stoul(argv[++i]));
+        } else if (arg == "--settle-ms" && i + 1 < argc) {
+            settle = chrono::milliseconds(stoi(argv[++i]));
+        }
+    }
+
+    if (server_path.empty() == (pid < 0)) {
+        printUsage(program_name);
+        return 1;
+    }
+
+    raiseFileDescriptorLimit();
+
+    try {
+        unique_ptr<ServerProcess> server;
+
+        if (!server_path.empty()) {
+            // Private socket, so the benchmark can run next to a live server
+            endpoint.local = true;
+            endpoint.socket_path = "/tmp/chess_idle_" + to_string(getpid()) + ".sock";
+
+            server = make_unique<ServerProcess>(
+                server_path, vector<string>{"--local", "--socket", endpoint.socket_path});
+            server->waitReady(endpoint, chrono::seconds(30));
+            pid = server->pid();
+        }
+
+        cout << "Idle connection benchmark against " << endpoint.describe() << " (pid " << pid
+             << ")" << endl;
+
+        IdleSample before = sample(endpoint, pid, settle);
+
+        // Each client waits for its handshake, so the session exists server-side
+        vector<unique_ptr<LineClient>> clients;
+        clients.reserve(connections);
+        for (size_t i = 0; i < connections; ++i) {
+            clients.push_back(make_unique<LineClient>(endpoint));
+            if (!clients.back()->waitLine(chrono::seconds(5))) {
+                throw runtime_error("No handshake on connection " + to_string(i + 1));
+            }
+        }
+
+        IdleSample after = sample(endpoint, pid, settle);
+        report(before, after, connections);
+
+        return 0;
+    } catch (const exception& e) {
+        cerr << "Idle benchmark failed: " << e.what() << endl;
+        return 2;
+    }
+}
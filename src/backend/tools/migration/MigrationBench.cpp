@@ -0,0 +1,210 @@
+#include "MigrationBench.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <stdexcept>
+#include <thread>
+
+using json = nlohmann::json;
+
+namespace {
+
+/// Moves of the game: the opening is played first, then one move per migration.
+const std::vector<std::string> kMoves = {
+    "e2-e4", "e7-e5", "g1-f3", "b8-c6", "f1-c4", "g8-f6", "d2-d3", "f8-c5", "c2-c3", "d7-d6",
+    "b1-d2", "c8-e6", "h2-h3", "h7-h6", "a2-a3", "a7-a6", "b2-b4", "c5-b6", "a3-a4", "a6-a5"};
+constexpr size_t kOpeningMoves = 4;
+
+std::string joinMessage(const std::string& color) {
+    return json{{"command", "join_game"}, {"single_player", false}, {"color", color}}.dump();
+}
+
+std::string moveMessage(const std::string& move) {
+    return json{{"command", "make_move"}, {"move", move}}.dump();
+}
+
+const std::string kSnapshotMessage = json{{"command", "get_snapshot"}}.dump();
+
+}  // namespace
+
+MigrationBench::MigrationBench(Endpoint endpoint, ServerProcess& router, MigrationOptions options)
+    : endpoint_(std::move(endpoint)), router_(router), options_(std::move(options)) {}
+
+bool MigrationBench::run(std::ostream& os) {
+    size_t max_rounds = kMoves.size() - kOpeningMoves;
+    if (options_.rounds > max_rounds) {
+        os << "Rounds limited to " << max_rounds << " (length of the scripted game)" << std::endl;
+        options_.rounds = max_rounds;
+    }
+
+    // Game in progress: both seats taken, the opening played
+    white_ = join();
+    black_ = join();
+    prober_ = join();
+
+    white_->sendLine(joinMessage("white"));
+    white_->waitLine(options_.timeout);
+    black_->sendLine(joinMessage("black"));
+    black_->waitLine(options_.timeout);
+    white_->sendLine(json{{"command", "start_game"}}.dump());
+    white_->waitLine(options_.timeout);
+
+    while (moves_played_ < kOpeningMoves) {
+        playMove();
+    }
+
+    os << "Attaching " << options_.spectators << " spectators to room " << options_.room << "..."
+       << std::endl;
+    spectators_.reserve(options_.spectators);
+    for (size_t i = 0; i < options_.spectators; ++i) {
+        spectators_.push_back(join());
+    }
+
+    os << std::setw(8) << "round" << std::setw(12) << "kind" << std::setw(14) << "pause_us"
+       << std::setw(10) << "probes" << "\n";
+
+    for (size_t round = 1; round <= options_.rounds; ++round) {
+        for (bool migrate : {false, true}) {
+            rounds_.push_back(probe(migrate));
+
+            const auto& r = rounds_.back();
+            os << std::setw(8) << round << std::setw(12) << (migrate ? "migration" : "baseline")
+               << std::setw(14) << r.pause.count() << std::setw(10) << r.probes << std::endl;
+        }
+
+        // The seats moved with the room: the player to move can play
+        playMove();
+    }
+
+    size_t lost = checkSpectators(static_cast<int64_t>(moves_played_));
+    report(os);
+
+    os << "Spectators out of step: " << lost << " / " << spectators_.size() << "\n";
+    return lost == 0;
+}
+
+std::unique_ptr<LineClient> MigrationBench::join() {
+    auto client = std::make_unique<LineClient>(endpoint_);
+    client->sendLine(json{{"command", "join_room"}, {"room", options_.room}}.dump());
+
+    if (!waitFor(*client, "session_created")) {
+        throw std::runtime_error("No handshake from room " + options_.room);
+    }
+    return client;
+}
+
+std::optional<json> MigrationBench::waitFor(LineClient& client, const std::string& type) {
+    auto deadline = std::chrono::steady_clock::now() + options_.timeout;
+
+    while (true) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        if (left.count() <= 0) {
+            return std::nullopt;
+        }
+
+        auto line = client.waitLine(left);
+        if (!line) {
+            return std::nullopt;
+        }
+
+        auto message = json::parse(*line, nullptr, false);
+        if (message.is_object() && message.value("type", "") == type) {
+            return message;
+        }
+    }
+}
+
+MigrationRound MigrationBench::probe(bool migrate) {
+    MigrationRound round;
+    round.migrated = migrate;
+
+    auto end = std::chrono::steady_clock::now() + options_.window;
+    if (migrate && !router_.sendInput("migrate " + options_.room)) {
+        throw std::runtime_error("Router not reading its commands");
+    }
+
+    // Answers stop while the room moves, then resume from the new worker
+    while (std::chrono::steady_clock::now() < end) {
+        auto sent = std::chrono::steady_clock::now();
+        prober_->sendLine(kSnapshotMessage);
+
+        if (!waitFor(*prober_, "snapshot")) {
+            throw std::runtime_error("Prober lost during round " +
+                                     std::to_string(rounds_.size() / 2 + 1));
+        }
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - sent);
+        round.pause = std::max(round.pause, elapsed);
+        round.probes++;
+    }
+
+    return round;
+}
+
+void MigrationBench::playMove() {
+    LineClient& player = moves_played_ % 2 == 0 ? *white_ : *black_;
+    player.sendLine(moveMessage(kMoves[moves_played_]));
+    moves_played_++;
+
+    auto deadline = std::chrono::steady_clock::now() + options_.timeout;
+    while (ply() != static_cast<int64_t>(moves_played_)) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            throw std::runtime_error("Move " + kMoves[moves_played_ - 1] + " not played");
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    // Drop the broadcasts piling up on the players' connections
+    std::vector<std::string> lines;
+    white_->readLines(lines);
+    black_->readLines(lines);
+}
+
+int64_t MigrationBench::ply() {
+    prober_->sendLine(kSnapshotMessage);
+    auto snapshot = waitFor(*prober_, "snapshot");
+    return snapshot ? snapshot->value("ply", int64_t{-1}) : -1;
+}
+
+size_t MigrationBench::checkSpectators(int64_t expected) {
+    for (auto& spectator : spectators_) {
+        spectator->sendLine(kSnapshotMessage);
+    }
+
+    size_t out_of_step = 0;
+    for (auto& spectator : spectators_) {
+        auto snapshot = waitFor(*spectator, "snapshot");
+        if (!snapshot || snapshot->value("ply", int64_t{-1}) != expected) {
+            out_of_step++;
+        }
+    }
+    return out_of_step;
+}
+
+void MigrationBench::report(std::ostream& os) const {
+    auto percentiles = [&os](bool migrated, const std::string& label,
+                             const std::vector<MigrationRound>& rounds) {
+        std::vector<int64_t> pauses;
+        for (const auto& r : rounds) {
+            if (r.migrated == migrated) {
+                pauses.push_back(r.pause.count());
+            }
+        }
+        if (pauses.empty()) {
+            return;
+        }
+
+        std::sort(pauses.begin(), pauses.end());
+        auto at = [&pauses](double q) {
+            return pauses[static_cast<size_t>(q * static_cast<double>(pauses.size() - 1))];
+        };
+        os << label << "p50 " << at(0.5) << " us, p90 " << at(0.9) << " us, max "
+           << pauses.back() << " us\n";
+    };
+
+    os << "\nLongest answer time with " << spectators_.size() << " spectators in the room:\n";
+    percentiles(false, "  without migration: ", rounds_);
+    percentiles(true, "  with migration:    ", rounds_);
+}
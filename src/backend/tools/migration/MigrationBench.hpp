@@ -0,0 +1,129 @@
+/**
+ * @file MigrationBench.hpp
+ * @brief Pause seen by the clients of a room moved between chess_router workers.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "LineClient.hpp"
+#include "ServerProcess.hpp"
+
+/**
+ * @struct MigrationOptions
+ * @brief Migration benchmark settings.
+ */
+struct MigrationOptions {
+    std::string room = "bench";               ///< Room moved back and forth
+    size_t spectators = 1000;                 ///< Idle clients attached to the room
+    size_t rounds = 5;                        ///< Migrations measured
+    std::chrono::milliseconds window{2000};   ///< Probing time of each round
+    std::chrono::milliseconds timeout{5000};  ///< Response timeout
+};
+
+/**
+ * @struct MigrationRound
+ * @brief Longest snapshot round trip seen during one probing window.
+ */
+struct MigrationRound {
+    bool migrated = false;               ///< False for the baseline rounds
+    std::chrono::microseconds pause{0};  ///< Longest round trip (the pause when migrating)
+    size_t probes = 0;                   ///< Snapshots answered during the window
+};
+
+/**
+ * @class MigrationBench
+ * @brief Migrates a played room through a running chess_router and measures the pause.
+ *
+ * Two players start a game in the room, watched by many spectators. A prober
+ * in the room asks for snapshots back to back: the longest answer time of a
+ * window is the pause of its clients. Rounds without a migration give the
+ * baseline. After each round the player to move plays, which checks that the
+ * seats moved along, and at the end every spectator must still be connected
+ * and see the same position as the players (no game reset).
+ */
+class MigrationBench {
+   public:
+    /**
+     * @brief Construct a migration benchmark.
+     * @param endpoint Router address
+     * @param router Router process, taking the `migrate` commands on its stdin
+     * @param options Benchmark settings
+     */
+    MigrationBench(Endpoint endpoint, ServerProcess& router, MigrationOptions options);
+
+    /**
+     * @brief Set the room up, run the rounds and print the report.
+     * @param os Progress and report output
+     * @return True if no client was lost and the game carried on
+     */
+    bool run(std::ostream& os);
+
+    /**
+     * @brief Get the measured rounds.
+     */
+    const std::vector<MigrationRound>& getRounds() const { return rounds_; }
+
+   private:
+    /**
+     * @brief Connect a client to the room and wait for its handshake.
+     * @throws std::runtime_error if the client doesn't get in
+     */
+    std::unique_ptr<LineClient> join();
+
+    /**
+     * @brief Wait for a message of a given type, skipping the others.
+     * @return The message, or nullopt on timeout or closure
+     */
+    std::optional<nlohmann::json> waitFor(LineClient& client, const std::string& type);
+
+    /**
+     * @brief Probe the room for one window, after requesting a migration if asked.
+     * @param migrate True to move the room at the start of the window
+     */
+    MigrationRound probe(bool migrate);
+
+    /**
+     * @brief Play the next move of the game and wait for the prober to see it.
+     * @throws std::runtime_error if the move isn't played in time
+     */
+    void playMove();
+
+    /**
+     * @brief Current half-move number, from a prober snapshot.
+     * @return Ply, or -1 without an answer
+     */
+    int64_t ply();
+
+    /**
+     * @brief Ask every spectator for a snapshot and count the ones out of step.
+     * @param expected Ply every spectator must see
+     * @return Spectators lost or seeing another position
+     */
+    size_t checkSpectators(int64_t expected);
+
+    /**
+     * @brief Print the rounds and the pause percentiles.
+     */
+    void report(std::ostream& os) const;
+
+    Endpoint endpoint_;
+    ServerProcess& router_;
+    MigrationOptions options_;
+
+    std::unique_ptr<LineClient> white_;                    ///< Player 1
+    std::unique_ptr<LineClient> black_;                    ///< Player 2
+    std::unique_ptr<LineClient> prober_;                   ///< Snapshot requests back to back
+    std::vector<std::unique_ptr<LineClient>> spectators_;  ///< Idle clients of the room
+
+    size_t moves_played_ = 0;             ///< Moves of the game played so far
+    std::vector<MigrationRound> rounds_;  ///< Baseline and migration rounds
+};
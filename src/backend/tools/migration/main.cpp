@@ -0,0 +1,105 @@
+#include <signal.h>
+#include <sys/resource.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "MigrationBench.hpp"
+#include "ServerProcess.hpp"
+
+using namespace std;
+
+void printUsage(const string& program_name) {
+    cout << "Usage: " << program_name << " --router <path> [OPTIONS]\n"
+         << "Options:\n"
+         << "  -h                  Show this help message\n"
+         << "  --router <path>     Spawn this chess_router\n"
+         << "  --server <path>     chess_server of its workers (default: next to the router)\n"
+         << "  -p <port>           Router port (default: 2100)\n"
+         << "  --workers <N>       Worker processes, at least 2 (default: 2)\n"
+         << "  --room <name>       Room to migrate (default: bench)\n"
+         << "  --spectators <N>    Idle clients in the room (default: 1000)\n"
+         << "  --rounds <N>        Migrations measured (default: 5)\n"
+         << "  --window-ms <ms>    Probing time of each round (default: 2000)\n";
+}
+
+/**
+ * @brief Raise the open file limit: the benchmark and the workers (which inherit it) hold one
+ * descriptor per spectator.
+ */
+void raiseFileDescriptorLimit() {
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Endpoint endpoint;
+    endpoint.port = 2100;
+    MigrationOptions options;
+    string router_path;
+    string server_path;
+    int workers = 2;
+
+    const string program_name = argv[0];
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+
+        if (arg == "--help" || arg == "-h") {
+            printUsage(program_name);
+            return 0;
+        } else if (arg == "--router" && i + 1 < argc) {
+            router_path = argv[++i];
+        } else if (arg == "--server" && i + 1 < argc) {
+            server_path = argv[++i];
+        } else if ((arg == "--port" || arg == "-p") && i + 1 < argc) {
+            endpoint.port = stoi(argv[++i]);
+        } else if (arg == "--workers" && i + 1 < argc) {
+            workers = max(2, stoi(argv[++i]));
+        } else if (arg == "--room" && i + 1 < argc) {
+            options.room = argv[++i];
+        } else if (arg == "--spectators" && i + 1 < argc) {
+            options.spectators = stoul(argv[++i]);
+        } else if (arg == "--rounds" && i + 1 < argc) {
+            options.rounds = max<size_t>(1, stoul(argv[++i]));
+        } else if (arg == "--window-ms" && i + 1 < argc) {
+            options.window = chrono::milliseconds(stoi(argv[++i]));
+        }
+    }
+
+    if (router_path.empty()) {
+        printUsage(program_name);
+        return 1;
+    }
+
+    // A router gone during a round must not kill the benchmark
+    signal(SIGPIPE, SIG_IGN);
+    raiseFileDescriptorLimit();
+
+    try {
+        vector<string> args = {"-p", to_string(endpoint.port), "--workers", to_string(workers)};
+        if (!server_path.empty()) {
+            args.insert(args.end(), {"--server", server_path});
+        }
+        args.insert(args.end(), {"--", "--no-rate-limit"});
+
+        ServerProcess router(router_path, args);
+        router.waitReady(endpoint, chrono::seconds(60));
+
+        cout << "Migration benchmark: room " << options.room << " moved " << options.rounds
+             << " times between " << workers << " workers (" << endpoint.describe() << ")"
+             << endl;
+
+        MigrationBench bench(endpoint, router, options);
+        bool ok = bench.run(cout);
+
+        return ok ? 0 : 1;
+    } catch (const exception& e) {
+        cerr << "Migration benchmark failed: " << e.what() << endl;
+        return 2;
+    }
+}
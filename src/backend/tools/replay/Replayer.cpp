@@ -0,0 +1,272 @@
+#include "Replayer.hpp"
+
+#include <poll.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <ostream>
+#include <string_view>
+
+namespace {
+
+/// Response types of each command, besides "error". Anything else is a push.
+const std::map<std::string_view, std::vector<std::string_view>> kResponseTypes = {
+    // The last chunk of an upload is answered by the playback of the game
+    {"upload_game",
+     {"upload_progress", "game_loaded", "move_result", "game_complete", "game_over"}},
+    {"join_game", {"join_success"}},
+    {"start_game", {"game_started"}},
+    {"make_move", {"move_result", "game_over"}},
+    {"end_game", {"game_reset"}},
+    {"display_board", {"board_display"}},
+    {"get_snapshot", {"snapshot"}},
+    {"resume", {"resumed"}},
+    {"resync", {"resync", "snapshot"}},
+    {"get_stats", {"stats"}},
+    {"enable_compression", {"compression_enabled"}},
+    {"set_broadcast_mode", {"broadcast_mode"}},
+    {"set_position", {"position_set"}},
+    {"legal_moves", {"legal_moves"}},
+    {"premove", {"premoves", "move_result", "game_over"}},
+    {"ping", {"pong"}},
+};
+
+/**
+ * @brief Check whether a received line answers a command.
+ * @param command Command of the request
+ * @param type Type of the line
+ */
+bool answers(std::string_view command, std::string_view type) {
+    if (type == "error") {
+        return true;
+    }
+
+    auto it = kResponseTypes.find(command);
+    return it != kResponseTypes.end() &&
+           std::find(it->second.begin(), it->second.end(), type) != it->second.end();
+}
+
+/**
+ * @brief Get a string field of a JSON line.
+ * @return Field value, empty if the line isn't a JSON object or has no such string field
+ */
+std::string stringField(const std::string& line, const char* key) {
+    auto parsed = nlohmann::json::parse(line, nullptr, false);
+    if (!parsed.is_object()) {
+        return {};
+    }
+
+    auto it = parsed.find(key);
+    return it != parsed.end() && it->is_string() ? it->get<std::string>() : std::string();
+}
+
+}  // namespace
+
+int64_t ReplayReport::percentile(double p) const {
+    if (latencies_us.empty()) {
+        return 0;
+    }
+
+    std::vector<int64_t> sorted = latencies_us;
+    std::sort(sorted.begin(), sorted.end());
+
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+    rank = std::clamp<size_t>(rank, 1, sorted.size());
+    return sorted[rank - 1];
+}
+
+void ReplayReport::print(std::ostream& os) const {
+    double throughput = duration_s > 0.0 ? messages_sent / duration_s : 0.0;
+
+    os << "Replay of " << capture << " against " << endpoint << " at "
+       << (speed == 0.0 ? std::string("max") : std::to_string(speed) + "x") << " speed\n"
+       << "  sessions:          " << sessions << "\n"
+       << "  messages sent:     " << messages_sent << "\n"
+       << "  responses:         " << responses << " (unanswered: " << messages_sent - responses
+       << ")\n"
+       << "  pushes:            " << pushes << "\n"
+       << "  connection errors: " << connection_errors << "\n"
+       << "  duration:          " << std::fixed << std::setprecision(3) << duration_s << " s\n"
+       << "  throughput:        " << std::setprecision(1) << throughput << " msg/s\n"
+       << "  latency (us):      min " << percentile(0) << ", p50 " << percentile(50) << ", p90 "
+       << percentile(90) << ", p99 " << percentile(99) << ", max " << percentile(100) << "\n";
+}
+
+nlohmann::json ReplayReport::toJson() const {
+    return {{"capture", capture},
+            {"endpoint", endpoint},
+            {"speed", speed},
+            {"sessions", sessions},
+            {"messages_sent", messages_sent},
+            {"responses", responses},
+            {"pushes", pushes},
+            {"connection_errors", connection_errors},
+            {"duration_s", duration_s},
+            {"throughput_msg_s", duration_s > 0.0 ? messages_sent / duration_s : 0.0},
+            {"latency_us",
+             {{"min", percentile(0)},
+              {"p50", percentile(50)},
+              {"p90", percentile(90)},
+              {"p99", percentile(99)},
+              {"max", percentile(100)}}}};
+}
+
+Replayer::Replayer(Endpoint endpoint, ReplayOptions options)
+    : endpoint_(std::move(endpoint)), options_(options) {}
+
+ReplayReport Replayer::run(const std::vector<TrafficEvent>& events) {
+    ReplayReport report;
+    report.endpoint = endpoint_.describe();
+    report.speed = options_.speed;
+
+    const auto start = Clock::now();
+
+    for (const auto& event : events) {
+        if (options_.speed > 0.0) {
+            // Keep the recorded inter-arrival times, scaled by the replay speed
+            auto offset = std::chrono::microseconds(
+                static_cast<int64_t>(static_cast<double>(event.t_us) / options_.speed));
+            pump(start + offset, report);
+        } else {
+            // As fast as possible, but a session still waits for its previous response, as a
+            // real client would
+            waitIdle(event.session_id, report);
+        }
+
+        fire(event, report);
+    }
+
+    // Drain responses to the last requests
+    auto drain_deadline = Clock::now() + options_.drain_timeout;
+    while (Clock::now() < drain_deadline) {
+        bool idle = std::all_of(connections_.begin(), connections_.end(),
+                                [](const auto& pair) { return pair.second.outstanding.empty(); });
+        if (idle) {
+            break;
+        }
+        pump(std::min(drain_deadline, Clock::now() + std::chrono::milliseconds(10)), report);
+    }
+
+    report.duration_s = std::chrono::duration<double>(Clock::now() - start).count();
+    connections_.clear();
+
+    return report;
+}
+
+void Replayer::pump(Clock::time_point deadline, ReplayReport& report) {
+    std::vector<pollfd> fds;
+    std::vector<Connection*> owners;
+
+    do {
+        fds.clear();
+        owners.clear();
+        for (auto& [id, connection] : connections_) {
+            if (connection.client && connection.client->isOpen()) {
+                fds.push_back({connection.client->fd(), POLLIN, 0});
+                owners.push_back(&connection);
+            }
+        }
+
+        auto remaining =
+            std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now());
+        int timeout_ms = static_cast<int>(std::max<int64_t>(remaining.count(), 0));
+
+        if (poll(fds.data(), fds.size(), timeout_ms) <= 0) {
+            continue;
+        }
+
+        const auto now = Clock::now();
+        std::vector<std::string> lines;
+
+        for (size_t i = 0; i < fds.size(); ++i) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+
+            lines.clear();
+            bool alive = owners[i]->client->readLines(lines);
+
+            auto& outstanding = owners[i]->outstanding;
+            for (const auto& line : lines) {
+                // The oldest request this line answers, if any
+                const std::string type = stringField(line, "type");
+                auto request = std::find_if(
+                    outstanding.begin(), outstanding.end(),
+                    [&type](const Request& r) { return answers(r.command, type); });
+                if (request == outstanding.end()) {
+                    report.pushes++;
+                    continue;
+                }
+
+                report.latencies_us.push_back(
+                    std::chrono::duration_cast<std::chrono::microseconds>(now - request->sent)
+                        .count());
+                outstanding.erase(request);
+                report.responses++;
+            }
+
+            if (!alive) {
+                owners[i]->client->close();
+                owners[i]->outstanding.clear();
+            }
+        }
+    } while (Clock::now() < deadline);
+}
+
+void Replayer::waitIdle(const std::string& session_id, ReplayReport& report) {
+    auto it = connections_.find(session_id);
+    if (it == connections_.end()) {
+        return;
+    }
+
+    auto deadline = Clock::now() + options_.drain_timeout;
+    while (!it->second.outstanding.empty() && Clock::now() < deadline) {
+        pump(std::min(deadline, Clock::now() + std::chrono::milliseconds(1)), report);
+    }
+
+    // Give up on requests without response (e.g. a dropped upload chunk)
+    it->second.outstanding.clear();
+}
+
+void Replayer::fire(const TrafficEvent& event, ReplayReport& report) {
+    auto it = connections_.find(event.session_id);
+
+    // Sessions recorded mid-flight have no `open` event: connect lazily
+    if (event.type != TrafficEvent::Type::CLOSE && it == connections_.end()) {
+        Connection connection;
+        try {
+            connection.client = std::make_unique<LineClient>(endpoint_);
+        } catch (const std::exception&) {
+            report.connection_errors++;
+            return;
+        }
+
+        // Consume the session_created handshake, so it isn't taken for a response
+        connection.client->waitLine(std::chrono::milliseconds(1000));
+
+        it = connections_.emplace(event.session_id, std::move(connection)).first;
+        report.sessions++;
+    }
+
+    switch (event.type) {
+        case TrafficEvent::Type::OPEN:
+            break;
+
+        case TrafficEvent::Type::MESSAGE:
+            if (!it->second.client->sendLine(event.payload)) {
+                report.connection_errors++;
+                return;
+            }
+            it->second.outstanding.push_back(
+                {Clock::now(), stringField(event.payload, "command")});
+            report.messages_sent++;
+            break;
+
+        case TrafficEvent::Type::CLOSE:
+            if (it != connections_.end()) {
+                connections_.erase(it);
+            }
+            break;
+    }
+}
@@ -0,0 +1,132 @@
+/**
+ * @file Replayer.hpp
+ * @brief Drives a chess_server with recorded session traffic.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+#include "LineClient.hpp"
+#include "TrafficLog.hpp"
+
+/**
+ * @struct ReplayOptions
+ * @brief Replay pacing settings.
+ */
+struct ReplayOptions {
+    /// Time scaling: 1 = recorded pace, N = N times faster, 0 = as fast as possible.
+    double speed = 1.0;
+
+    /// How long to wait for outstanding responses once all events were sent.
+    std::chrono::milliseconds drain_timeout{2000};
+};
+
+/**
+ * @struct ReplayReport
+ * @brief Latency and throughput figures of one replay run.
+ *
+ * The latency of a request is the time between sending it and receiving the
+ * first line on the same connection whose type answers its command (or an
+ * error). Broadcasts and other pushes interleaved with responses are counted
+ * apart, so they neither answer a request early nor shift later requests.
+ */
+struct ReplayReport {
+    std::string capture;                ///< Capture file name
+    std::string endpoint;               ///< Replayed server address
+    double speed = 1.0;                 ///< Replay speed (0 = max)
+    size_t sessions = 0;                ///< Connections opened
+    size_t messages_sent = 0;           ///< Requests sent
+    size_t responses = 0;               ///< Requests answered
+    size_t pushes = 0;                  ///< Lines received answering no outstanding request
+    size_t connection_errors = 0;       ///< Failed connects or sends
+    double duration_s = 0.0;            ///< Wall time of the replay
+    std::vector<int64_t> latencies_us;  ///< Per-request latency
+
+    /**
+     * @brief Get a latency percentile.
+     * @param p Percentile in [0, 100]
+     * @return Latency in microseconds (0 if no sample)
+     */
+    int64_t percentile(double p) const;
+
+    /**
+     * @brief Print a human readable summary.
+     */
+    void print(std::ostream& os) const;
+
+    /**
+     * @brief Machine readable summary (for diffing runs across builds).
+     */
+    nlohmann::json toJson() const;
+};
+
+/**
+ * @class Replayer
+ * @brief Opens one connection per recorded session and re-sends its messages.
+ *
+ * Single threaded: all connections are multiplexed with poll(), so the
+ * replayer itself doesn't add scheduling noise to the measurements.
+ */
+class Replayer {
+   public:
+    /**
+     * @brief Construct a replayer.
+     * @param endpoint Server to drive
+     * @param options Replay pacing
+     */
+    Replayer(Endpoint endpoint, ReplayOptions options);
+
+    /**
+     * @brief Replay a capture.
+     * @param events Recorded events, sorted by timestamp
+     * @return Measurements
+     */
+    ReplayReport run(const std::vector<TrafficEvent>& events);
+
+   private:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Request waiting for its response.
+     */
+    struct Request {
+        Clock::time_point sent;  ///< Send time
+        std::string command;     ///< Command name (empty if none)
+    };
+
+    /**
+     * @brief Replayed connection state.
+     */
+    struct Connection {
+        std::unique_ptr<LineClient> client;
+        std::vector<Request> outstanding;  ///< Unanswered requests, oldest first
+    };
+
+    /**
+     * @brief Receive and account for pending lines until the deadline.
+     * @param deadline Time at which to return
+     * @param report Report to update
+     */
+    void pump(Clock::time_point deadline, ReplayReport& report);
+
+    /**
+     * @brief Wait until a connection has no outstanding request (max speed only).
+     */
+    void waitIdle(const std::string& session_id, ReplayReport& report);
+
+    /**
+     * @brief Execute one recorded event.
+     */
+    void fire(const TrafficEvent& event, ReplayReport& report);
+
+    Endpoint endpoint_;                              ///< Server address
+    ReplayOptions options_;                          ///< Pacing settings
+    std::map<std::string, Connection> connections_;  ///< Open connections by recorded session ID
+};
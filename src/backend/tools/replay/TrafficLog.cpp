@@ -0,0 +1,59 @@
+#include "TrafficLog.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+std::vector<TrafficEvent> loadTrafficLog(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Cannot open traffic capture: " + path);
+    }
+
+    std::vector<TrafficEvent> events;
+    std::string line;
+    size_t line_number = 0;
+
+    while (std::getline(in, line)) {
+        line_number++;
+
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        // <t_us>\t<session_id>\t<event>\t<payload>; the payload may itself contain tabs
+        size_t first = line.find('\t');
+        size_t second = (first == std::string::npos) ? first : line.find('\t', first + 1);
+        size_t third = (second == std::string::npos) ? second : line.find('\t', second + 1);
+
+        if (third == std::string::npos) {
+            throw std::runtime_error("Malformed record at " + path + ":" +
+                                     std::to_string(line_number));
+        }
+
+        TrafficEvent event;
+        event.t_us = std::stoll(line.substr(0, first));
+        event.session_id = line.substr(first + 1, second - first - 1);
+
+        std::string type = line.substr(second + 1, third - second - 1);
+        if (type == "open") {
+            event.type = TrafficEvent::Type::OPEN;
+        } else if (type == "close") {
+            event.type = TrafficEvent::Type::CLOSE;
+        } else if (type == "msg") {
+            event.type = TrafficEvent::Type::MESSAGE;
+            event.payload = line.substr(third + 1);
+        } else {
+            throw std::runtime_error("Unknown event `" + type + "` at " + path + ":" +
+                                     std::to_string(line_number));
+        }
+
+        events.push_back(std::move(event));
+    }
+
+    // Writers serialise on a mutex but take their timestamp before it: restore the order
+    std::stable_sort(events.begin(), events.end(),
+                     [](const TrafficEvent& a, const TrafficEvent& b) { return a.t_us < b.t_us; });
+
+    return events;
+}
@@ -0,0 +1,31 @@
+/**
+ * @file TrafficLog.hpp
+ * @brief Reader for traffic captures written by the server's TrafficRecorder.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @struct TrafficEvent
+ * @brief One recorded session event.
+ */
+struct TrafficEvent {
+    enum class Type { OPEN, MESSAGE, CLOSE };
+
+    int64_t t_us = 0;        ///< Microseconds since the start of the capture
+    std::string session_id;  ///< Recorded session ID
+    Type type = Type::MESSAGE;
+    std::string payload;  ///< Application message (MESSAGE only)
+};
+
+/**
+ * @brief Load a capture file, sorted by timestamp.
+ * @param path Capture file written with `chess_server --record <file>`
+ * @return Recorded events
+ * @throws std::runtime_error if the file cannot be read or is malformed
+ */
+std::vector<TrafficEvent> loadTrafficLog(const std::string& path);
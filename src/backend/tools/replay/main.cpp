@@ -0,0 +1,78 @@
+#include <fstream>
+#include <iostream>
+
+#include "Replayer.hpp"
+#include "TrafficLog.hpp"
+
+using namespace std;
+
+void printUsage(const string& program_name) {
+    cout << "Usage: " << program_name << " -f <capture> [OPTIONS]\n"
+         << "Options:\n"
+         << "  -h                  Show this help message\n"
+         << "  -f <capture>        Traffic capture written by `chess_server --record <file>`\n"
+         << "  -i <ip address>     Server ip address (default: 127.0.0.1)\n"
+         << "  -p <port>           Server port (default: 2000)\n"
+         << "  --local             Use local IPC network (instead of TCP)\n"
+         << "  --socket <socket>   Socket path (only for IPC) (default: `/tmp/chess_server.sock`)\n"
+         << "  --speed <N|max>     Replay speed factor (default: 1)\n"
+         << "  --json <file>       Also write the report as JSON\n";
+}
+
+int main(int argc, char* argv[]) {
+    Endpoint endpoint;
+    ReplayOptions options;
+    string capture_path;
+    string json_path;
+
+    const string program_name = argv[0];
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+
+        if (arg == "--help" || arg == "-h") {
+            printUsage(program_name);
+            return 0;
+        } else if (arg == "-f" && i + 1 < argc) {
+            capture_path = argv[++i];
+        } else if ((arg == "--ip" || arg == "-i") && i + 1 < argc) {
+            endpoint.ip = argv[++i];
+        } else if ((arg == "--port" || arg == "-p") && i + 1 < argc) {
+            endpoint.port = stoi(argv[++i]);
+        } else if (arg == "--local") {
+            endpoint.local = true;
+        } else if (arg == "--socket" && i + 1 < argc) {
+            endpoint.socket_path = argv[++i];
+        } else if (arg == "--speed" && i + 1 < argc) {
+            string speed = argv[++i];
+            options.speed = (speed == "max") ? 0.0 : stod(speed);
+        } else if (arg == "--json" && i + 1 < argc) {
+            json_path = argv[++i];
+        }
+    }
+
+    if (capture_path.empty() || options.speed < 0.0) {
+        printUsage(program_name);
+        return 1;
+    }
+
+    try {
+        auto events = loadTrafficLog(capture_path);
+
+        Replayer replayer(endpoint, options);
+        auto report = replayer.run(events);
+        report.capture = capture_path;
+
+        report.print(cout);
+
+        if (!json_path.empty()) {
+            ofstream out(json_path);
+            out << report.toJson().dump(2) << "\n";
+        }
+    } catch (const exception& e) {
+        cerr << "Replay failed: " << e.what() << endl;
+        return 2;
+    }
+
+    return 0;
+}
@@ -0,0 +1,196 @@
+#include "SoakTest.hpp"
+
+#include <iomanip>
+#include <nlohmann/json.hpp>
+#include <thread>
+
+using json = nlohmann::json;
+
+namespace {
+
+/// Short opening played by the game scenarios (simple notation).
+const std::vector<std::string> kOpening = {"e2-e4", "e7-e5", "g1-f3", "b8-c6"};
+
+std::string joinMessage(const std::string& color) {
+    return json{{"command", "join_game"}, {"single_player", false}, {"color", color}}.dump();
+}
+
+std::string moveMessage(const std::string& move) {
+    return json{{"command", "make_move"}, {"move", move}}.dump();
+}
+
+}  // namespace
+
+SoakTest::SoakTest(Endpoint endpoint, pid_t pid, SoakOptions options)
+    : endpoint_(std::move(endpoint)), pid_(pid), options_(options) {}
+
+bool SoakTest::run(std::ostream& os) {
+    os << std::setw(10) << "iteration" << std::setw(12) << "rss_kb" << std::setw(10) << "threads"
+       << std::setw(10) << "fds" << std::setw(14) << "heap_bytes" << std::setw(10) << "uploads"
+       << "\n";
+
+    auto print = [&os](const SoakSample& s) {
+        os << std::setw(10) << s.iteration << std::setw(12) << s.process.rss_kb << std::setw(10)
+           << s.process.threads << std::setw(10) << s.process.open_fds << std::setw(14)
+           << s.heap_in_use << std::setw(10) << s.uploads_pending << std::endl;
+    };
+
+    samples_.push_back(sample(0));
+    print(samples_.back());
+
+    for (size_t i = 1; i <= options_.iterations; ++i) {
+        runScenario(i);
+
+        if (i % options_.sample_every == 0 || i == options_.iterations) {
+            samples_.push_back(sample(i));
+            print(samples_.back());
+        }
+    }
+
+    if (samples_.size() <= options_.warmup_samples + 2) {
+        os << "Not enough samples for the growth analysis\n";
+        return true;
+    }
+
+    std::vector<int64_t> rss, threads, fds, heap, uploads;
+    for (size_t i = options_.warmup_samples; i < samples_.size(); ++i) {
+        rss.push_back(samples_[i].process.rss_kb);
+        threads.push_back(samples_[i].process.threads);
+        fds.push_back(samples_[i].process.open_fds);
+        heap.push_back(samples_[i].heap_in_use);
+        uploads.push_back(samples_[i].uploads_pending);
+    }
+
+    // Memory tolerances absorb allocator caching; fds, threads and uploads must plateau exactly
+    bool ok = true;
+    ok &= checkSeries("rss_kb", rss, rss.front() / 10 + 1024, os);
+    ok &= checkSeries("threads", threads, 2, os);
+    ok &= checkSeries("open_fds", fds, 2, os);
+    ok &= checkSeries("heap_bytes", heap, heap.front() / 10 + 256 * 1024, os);
+    ok &= checkSeries("uploads_pending", uploads, 0, os);
+
+    os << (ok ? "Soak test PASSED" : "Soak test FAILED") << std::endl;
+    return ok;
+}
+
+void SoakTest::runScenario(size_t iteration) {
+    switch (iteration % 4) {
+        case 0: {
+            // Full game ended by a player (resetGame)
+            LineClient white(endpoint_), black(endpoint_);
+            white.waitLine(options_.timeout);
+            black.waitLine(options_.timeout);
+
+            request(white, joinMessage("white"));
+            request(black, joinMessage("black"));
+            request(white, json{{"command", "start_game"}}.dump());
+            for (size_t m = 0; m < kOpening.size(); ++m) {
+                request(m % 2 == 0 ? white : black, moveMessage(kOpening[m]));
+            }
+            request(white, json{{"command", "end_game"}}.dump());
+            break;
+        }
+
+        case 1: {
+            // Player drop in the middle of a game (routeDisconnect)
+            LineClient black(endpoint_);
+            black.waitLine(options_.timeout);
+            {
+                LineClient white(endpoint_);
+                white.waitLine(options_.timeout);
+
+                request(white, joinMessage("white"));
+                request(black, joinMessage("black"));
+                request(black, json{{"command", "start_game"}}.dump());
+                request(white, moveMessage(kOpening[0]));
+            }
+            // Wait for the game_reset broadcast caused by white's disconnection (the
+            // server holds no seat: --resume-grace 0)
+            black.waitLine(options_.timeout);
+            break;
+        }
+
+        case 2: {
+            // Upload abandoned before its last chunk
+            LineClient player(endpoint_);
+            player.waitLine(options_.timeout);
+
+            request(player, json{{"command", "join_game"}, {"single_player", true}, {"color", ""}}
+                                .dump());
+            request(player, json{{"command", "start_game"}}.dump());
+
+            json chunk = {{"command", "upload_game"},
+                          {"metadata",
+                           {{"filename", "soak_" + std::to_string(iteration)},
+                            {"total_size", 12},
+                            {"chunks_total", 2},
+                            {"chunk_current", 1}}},
+                          {"data", "e2-e4\n"}};
+            request(player, chunk.dump());
+            break;
+        }
+
+        default: {
+            // Spectator
+            LineClient spectator(endpoint_);
+            spectator.waitLine(options_.timeout);
+
+            request(spectator, json{{"command", "display_board"}}.dump());
+            request(spectator, json{{"command", "get_stats"}}.dump());
+            break;
+        }
+    }
+}
+
+void SoakTest::request(LineClient& client, const std::string& message) {
+    if (client.sendLine(message)) {
+        client.waitLine(options_.timeout);
+    }
+}
+
+SoakSample SoakTest::sample(size_t iteration) {
+    // Let the server reap closed sessions before measuring
+    std::this_thread::sleep_for(options_.settle);
+
+    SoakSample s;
+    s.iteration = iteration;
+
+    try {
+        LineClient client(endpoint_);
+        client.waitLine(options_.timeout);
+        client.sendLine(json{{"command", "get_stats"}}.dump());
+
+        if (auto line = client.waitLine(options_.timeout)) {
+            auto stats = json::parse(*line);
+            s.heap_in_use = stats["allocator"].value("in_use_bytes", int64_t{0});
+            s.uploads_pending = stats.value("uploads_pending", int64_t{0});
+        }
+
+        // Sampled while the stats connection is open, consistently at every checkpoint
+        s.process = sampleProcess(pid_);
+    } catch (const std::exception&) {
+        s.process = sampleProcess(pid_);
+    }
+
+    return s;
+}
+
+bool SoakTest::checkSeries(const std::string& name, const std::vector<int64_t>& values,
+                           int64_t tolerance, std::ostream& os) const {
+    size_t increases = 0;
+    for (size_t i = 1; i < values.size(); ++i) {
+        if (values[i] > values[i - 1]) {
+            increases++;
+        }
+    }
+
+    int64_t growth = values.back() - values.front();
+    bool monotonic = increases * 4 >= (values.size() - 1) * 3;  // 75% of steps increase
+    bool leaking = growth > tolerance && monotonic;
+
+    os << "  " << std::left << std::setw(16) << name << std::right << " growth " << growth
+       << " (tolerance " << tolerance << "), " << increases << "/" << values.size() - 1
+       << " increasing steps: " << (leaking ? "LEAK" : "ok") << "\n";
+
+    return !leaking;
+}
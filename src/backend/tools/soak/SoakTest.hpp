@@ -0,0 +1,110 @@
+/**
+ * @file SoakTest.hpp
+ * @brief Long-running connect/play/disconnect churn with leak detection.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "LineClient.hpp"
+#include "ServerProcess.hpp"
+
+/**
+ * @struct SoakOptions
+ * @brief Soak test settings.
+ */
+struct SoakOptions {
+    size_t iterations = 2000;                  ///< Churn scenarios to run
+    size_t sample_every = 100;                 ///< Iterations between two resource samples
+    size_t warmup_samples = 2;                 ///< Samples ignored by the growth analysis
+    std::chrono::milliseconds settle{6000};    ///< Idle time before sampling (> server cleanup period)
+    std::chrono::milliseconds timeout{2000};   ///< Response timeout
+};
+
+/**
+ * @struct SoakSample
+ * @brief Resources of the server at one checkpoint.
+ */
+struct SoakSample {
+    size_t iteration = 0;      ///< Iterations completed
+    ProcessSample process;     ///< RSS, threads and fds from /proc
+    int64_t heap_in_use = 0;   ///< Allocator bytes in use (from get_stats)
+    int64_t uploads_pending = 0;  ///< Partial uploads held by the server (from get_stats)
+};
+
+/**
+ * @class SoakTest
+ * @brief Churns games through a running server and checks resources don't grow.
+ *
+ * Each iteration runs one of these scenarios, in turn:
+ * - two players join, start, play and end the game (resetGame),
+ * - two players join, start, play and white drops (routeDisconnect),
+ * - a single player starts an upload and drops before the last chunk,
+ * - a spectator queries the board and the stats.
+ *
+ * After warm-up, a series is reported as leaking when it grew by more than its
+ * tolerance and most steps were increases, i.e. the growth is monotonic rather
+ * than noise around a plateau.
+ */
+class SoakTest {
+   public:
+    /**
+     * @brief Construct a soak test.
+     * @param endpoint Server address
+     * @param pid Server process ID (for /proc sampling)
+     * @param options Soak settings
+     */
+    SoakTest(Endpoint endpoint, pid_t pid, SoakOptions options);
+
+    /**
+     * @brief Run the churn and the analysis.
+     * @param os Progress and report output
+     * @return True if no resource grew monotonically
+     */
+    bool run(std::ostream& os);
+
+    /**
+     * @brief Get the collected samples.
+     */
+    const std::vector<SoakSample>& getSamples() const { return samples_; }
+
+   private:
+    /**
+     * @brief Run one churn scenario.
+     * @param iteration Iteration number (selects the scenario)
+     */
+    void runScenario(size_t iteration);
+
+    /**
+     * @brief Send a request and wait for the next line.
+     */
+    void request(LineClient& client, const std::string& message);
+
+    /**
+     * @brief Sample the server resources.
+     */
+    SoakSample sample(size_t iteration);
+
+    /**
+     * @brief Check one series for monotonic growth.
+     * @param name Series name, for the report
+     * @param values Series values (warm-up excluded)
+     * @param tolerance Growth allowed between first and last value
+     * @param os Report output
+     * @return True if the series is not growing
+     */
+    bool checkSeries(const std::string& name, const std::vector<int64_t>& values,
+                     int64_t tolerance, std::ostream& os) const;
+
+    Endpoint endpoint_;                ///< Server address
+    pid_t pid_;                        ///< Server process ID
+    SoakOptions options_;              ///< Soak settings
+    std::vector<SoakSample> samples_;  ///< Checkpoints
+};
@@ -0,0 +1,94 @@
+#include <unistd.h>
+
+#include <iostream>
+#include <memory>
+
+#include "ServerProcess.hpp"
+#include "SoakTest.hpp"
+
+using namespace std;
+
+void printUsage(const string& program_name) {
+    cout << "Usage: " << program_name << " (--server <path> | --pid <pid>) [OPTIONS]\n"
+         << "Options:\n"
+         << "  -h                  Show this help message\n"
+         << "  --server <path>     Spawn this chess_server on a private Unix socket\n"
+         << "  --pid <pid>         Attach to an already running server instead (started with\n"
+         << "                      `--resume-grace 0`: dropped players must free their seat)\n"
+         << "  -i <ip address>     Server ip address, with --pid (default: 127.0.0.1)\n"
+         << "  -p <port>           Server port, with --pid (default: 2000)\n"
+         << "  --local             Use local IPC network, with --pid\n"
+         << "  --socket <socket>   Socket path (default: `/tmp/chess_server.sock`)\n"
+         << "  --iterations <N>    Churn scenarios to run (default: 2000)\n"
+         << "  --sample-every <N>  Iterations between two samples (default: 100)\n"
+         << "  --settle-ms <ms>    Idle time before each sample (default: 6000)\n";
+}
+
+int main(int argc, char* argv[]) {
+    Endpoint endpoint;
+    SoakOptions options;
+    string server_path;
+    pid_t pid = -1;
+
+    const string program_name = argv[0];
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+
+        if (arg == "--help" || arg == "-h") {
+            printUsage(program_name);
+            return 0;
+        } else if (arg == "--server" && i + 1 < argc) {
+            server_path = argv[++i];
+        } else if (arg == "--pid" && i + 1 < argc) {
+            pid = stoi(argv[++i]);
+        } else if ((arg == "--ip" || arg == "-i") && i + 1 < argc) {
+            endpoint.ip = argv[++i];
+        } else if ((arg == "--port" || arg == "-p") && i + 1 < argc) {
+            endpoint.port = stoi(argv[++i]);
+        } else if (arg == "--local") {
+            endpoint.local = true;
+        } else if (arg == "--socket" && i + 1 < argc) {
+            endpoint.socket_path = argv[++i];
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            options.iterations = stoul(argv[++i]);
+        } else if (arg == "--sample-every" && i + 1 < argc) {
+            options.sample_every = max<size_t>(1, stoul(argv[++i]));
+        } else if (arg == "--settle-ms" && i + 1 < argc) {
+            options.settle = chrono::milliseconds(stoi(argv[++i]));
+        }
+    }
+
+    if (server_path.empty() == (pid < 0)) {
+        printUsage(program_name);
+        return 1;
+    }
+
+    try {
+        unique_ptr<ServerProcess> server;
+
+        if (!server_path.empty()) {
+            // Private socket, so the soak test can run next to a live server. Without seat
+            // holds, a dropped player resets the game at once, as the scenarios expect
+            endpoint.local = true;
+            endpoint.socket_path = "/tmp/chess_soak_" + to_string(getpid()) + ".sock";
+
+            server = make_unique<ServerProcess>(
+                server_path, vector<string>{"--local", "--socket", endpoint.socket_path,
+                                            "--resume-grace", "0"});
+            server->waitReady(endpoint, chrono::seconds(30));
+            pid = server->pid();
+        }
+
+        cout << "Soak test: " << options.iterations << " iterations against "
+             << endpoint.describe() << " (pid " << pid << ")" << endl;
+
+        SoakTest soak(endpoint, pid, options);
+        bool ok = soak.run(cout);
+
+        return ok ? 0 : 1;
+    } catch (const exception& e) {
+        cerr << "Soak test failed: " << e.what() << endl;
+        return 2;
+    }
+}